@@ -416,6 +416,116 @@ typedef struct {
   SIL_TYPE20_DMI_INFO  T20[SIL_MAX_SOCKETS_SUPPORTED][SIL_MAX_CHANNELS_PER_SOCKET][SIL_MAX_DIMMS_PER_CHANNEL];
 } SIL_DMI_INFO;
 
+#define SIL_SPD_SIZE                 1024 /// SPD5 hub NVM size in bytes
+
+/// Bit of a DIMM in SIL_SPD_CACHE.ValidMap
+#define SIL_SPD_CACHE_BIT(Socket, Channel, Dimm) \
+  (1u << ((((Socket) * SIL_MAX_CHANNELS_PER_SOCKET) + (Channel)) * SIL_MAX_DIMMS_PER_CHANNEL + (Dimm)))
+
+/// Per boot SPD cache, allocated by the Host and registered with xPrfSetSpdCache
+typedef struct {
+  uint16_t  SmbusBase;      ///< FCH SMBus controller IO base for the DIMMs not in APOB, 0 to disable
+  uint8_t   SmbusAddress[SIL_MAX_SOCKETS_SUPPORTED][SIL_MAX_CHANNELS_PER_SOCKET][SIL_MAX_DIMMS_PER_CHANNEL];
+                            ///< 7-bit SPD hub address of the DIMM on SmbusBase, 0 if not reachable
+  uint32_t  ValidMap;       ///< SIL_SPD_CACHE_BIT of every DIMM held in Spd
+  uint8_t   Spd[SIL_MAX_SOCKETS_SUPPORTED][SIL_MAX_CHANNELS_PER_SOCKET][SIL_MAX_DIMMS_PER_CHANNEL][SIL_SPD_SIZE];
+                            ///< SPD contents, indexed by the SMBIOS (translated) channel
+} SIL_SPD_CACHE;
+
+#define SIL_MEMORY_RANGE_MAX         128        /// Max ranges in the system memory range map
+#define SIL_MEMORY_RANGE_NO_DOMAIN   0xFFFFFFFF /// Range is not attached to a NUMA domain
+
+/**
+ * @brief Attribute of a system memory range
+ *
+ * @details Where the sources of the map overlap, the attribute with the higher
+ *          value wins, e.g. an MMIO hole carved out of DRAM is reported as MMIO.
+ */
+typedef enum {
+  SilMemRangeDram = 0,          ///< Usable DRAM
+  SilMemRangeReserved,          ///< DRAM reserved by the firmware, not usable by the OS
+  SilMemRangeCxl,               ///< CXL attached memory, not available until later in POST
+  SilMemRangeMmio,              ///< MMIO
+  SilMemRangePcieConfig,        ///< PCIe enhanced configuration space (MMCFG)
+  SilMemRangeSnpRmp,            ///< SNP reverse map table
+  SilMemRangeTypeMax            ///< Not a valid attribute
+} SIL_MEMORY_RANGE_TYPE;
+
+/// One range of the system memory range map
+typedef struct {
+  uint64_t  Base;               ///< Base address of the range
+  uint64_t  Size;               ///< Size of the range in bytes
+  uint32_t  Type;               ///< SIL_MEMORY_RANGE_TYPE
+  uint32_t  Domain;             ///< NUMA domain of the memory, SIL_MEMORY_RANGE_NO_DOMAIN for MMIO
+} SIL_MEMORY_RANGE;
+
+#define SIL_MEMORY_FILL_MAX_DOMAINS  SIL_MAX_SOCKETS_SUPPORTED  /// NUMA domains reported by xPrfFillMemory
+
+/// Physical range filled by xPrfFillMemory
+typedef struct {
+  uint64_t  Base;               ///< Base address, 64 byte aligned
+  uint64_t  Size;               ///< Size in bytes, multiple of 64
+} SIL_MEMORY_FILL_RANGE;
+
+/**
+ * @brief Per NUMA domain statistics of xPrfFillMemory
+ *
+ * @details Bandwidth in bytes per second is Bytes * TSC frequency / ElapsedTsc.
+ *          A domain well below the others points at a degraded channel.
+ */
+typedef struct {
+  uint64_t  Bytes;              ///< Bytes of the domain memory filled
+  uint64_t  ElapsedTsc;         ///< TSC ticks from the start of the fill to the completion of the domain
+  uint32_t  ThreadCount;        ///< Threads that filled part of the domain memory, BSP included
+  bool      Complete;           ///< All the domain memory has been filled
+} SIL_MEMORY_FILL_DOMAIN_STATS;
+
+/// Statistics of xPrfFillMemory, indexed by NUMA domain
+typedef struct {
+  SIL_MEMORY_FILL_DOMAIN_STATS  Domain[SIL_MEMORY_FILL_MAX_DOMAINS];
+} SIL_MEMORY_FILL_STATS;
+
+
+#pragma pack (push, 1)
+
+#define SIL_TPH_ST_TABLE_REVISION    1   /// Revision of SIL_TPH_ST_TABLE
+
+/// TPH steering tag of one L3 cache (one CCX)
+typedef struct {
+  uint32_t  ProximityDomain;          ///< NUMA proximity domain of the CCX
+  uint32_t  FirstApicId;              ///< APIC ID of the first thread in the CCX
+  uint16_t  SteeringTag;              ///< ST value that injects into this L3
+  uint8_t   Socket;                   ///< Socket of the CCX
+  uint8_t   Die;                      ///< Die of the CCX
+  uint8_t   Ccd;                      ///< Logical CCD of the CCX
+  uint8_t   Complex;                  ///< Logical complex in the CCD
+  uint8_t   SocketCcx;                ///< CCX index on the socket
+  uint8_t   ThreadCount;              ///< Threads sharing this L3
+} SIL_TPH_ST_L3_ENTRY;
+
+/// Default TPH steering tag of the devices below one root port
+typedef struct {
+  uint32_t  PortAddress;              ///< PCI address (PCI_ADDR.AddressValue) of the root port
+  uint16_t  SteeringTag;              ///< Default ST for the devices below the port
+  uint16_t  L3Index;                  ///< Index of the target in the L3 entries
+} SIL_TPH_ST_PORT_ENTRY;
+
+/**
+ * @brief TPH steering tag table
+ *
+ * @details The header is followed by L3Count SIL_TPH_ST_L3_ENTRY and then PortCount
+ *          SIL_TPH_ST_PORT_ENTRY. The table is packed and can be returned as is in an
+ *          ACPI Buffer object, for example by a root port _DSM.
+ */
+typedef struct {
+  uint16_t  Revision;                 ///< SIL_TPH_ST_TABLE_REVISION
+  uint16_t  L3Count;                  ///< Number of SIL_TPH_ST_L3_ENTRY
+  uint16_t  PortCount;                ///< Number of SIL_TPH_ST_PORT_ENTRY
+  uint16_t  Reserved;                 ///< Reserved
+  uint32_t  Length;                   ///< Table length in bytes, header included
+} SIL_TPH_ST_TABLE;
+
+#pragma pack (pop)
 
 /*********************************************************************
  * API Function prototypes
@@ -442,6 +552,26 @@ xPrfSetSnpRmp (
   uint64_t  SnpRmpTableSize
   );
 
+/**
+ * xPrfClearSnpRmp
+ *
+ * @brief   Zero the SNP RMP table in parallel on the parked APs
+ *
+ * @details The RMP programmed by xPrfSetSnpRmp is cleared with xPrfFillMemory,
+ *          so the APs of each socket clear the socket local portion.
+ *
+ * @param[out] Stats    Bytes, elapsed TSC ticks and completion per NUMA domain
+ *
+ * @retval SilPass              The RMP is cleared.
+ * @retval SilInvalidParameter  Stats is NULL.
+ * @retval SilNotFound          The RMP is not programmed.
+ * @retval Others               See xPrfFillMemory.
+ **/
+SIL_STATUS
+xPrfClearSnpRmp (
+  SIL_MEMORY_FILL_STATS  *Stats
+  );
+
 /**
  * xPrfGetSystemMemoryMap
  * @brief Get top of memory (Tom2) for the Host along with
@@ -480,6 +610,67 @@ xPrfGetLowUsableDramAddress (
   uint32_t    ApobBaseAddress
   );
 
+/**
+ * xPrfGetMemoryRangeMap
+ *
+ * @brief   Get the system memory range map.
+ *
+ * @details The map is a list of non-overlapping ranges sorted by address, with
+ *          adjacent ranges of the same attribute and domain merged. It is built
+ *          from the DF DRAM address maps, the APOB memory holes, MMCFG and the
+ *          SNP RMP MSRs on the first call and cached, so every caller reads the
+ *          same array. Address space not described by any source is not listed.
+ *          The map is rebuilt after xPrfSetSnpRmp.
+ *
+ * @param[out] RangeMap     Cached array of SIL_MEMORY_RANGE, owned by xPRF
+ * @param[out] RangeCount   Number of ranges in RangeMap
+ *
+ * @retval SilPass              Map returned.
+ * @retval SilInvalidParameter  NULL pointer.
+ * @retval SilNotFound          The APOB memory map is not available.
+ * @retval SilOutOfResources    More ranges than SIL_MEMORY_RANGE_MAX.
+ **/
+SIL_STATUS
+xPrfGetMemoryRangeMap (
+  const SIL_MEMORY_RANGE  **RangeMap,
+  uint32_t                *RangeCount
+  );
+
+/**
+ * xPrfFillMemory
+ *
+ * @brief   Fill physical memory with a pattern in parallel on the parked APs
+ *
+ * @details Used for ECC initialization of reserved areas, security clears
+ *          and memory tests. The ranges are split by NUMA domain along the
+ *          memory range map (see xPrfGetMemoryRangeMap), and each parked AP
+ *          fills the memory of its own domain with non-temporal stores, in
+ *          chunks. The BSP fills the memory of its own domain, then that of
+ *          the domains no AP was started on, so the ranges are fully filled
+ *          even when no AP is parked (CONFIG_CCX_MP_SERVICES disabled).
+ *          openSIL data must not be in the ranges.
+ *
+ * @param[in]  Ranges       Physical ranges to fill
+ * @param[in]  RangeCount   Number of ranges
+ * @param[in]  Pattern      64 bit pattern written to every 8 bytes
+ * @param[out] Stats        Bytes, elapsed TSC ticks and completion per NUMA domain
+ *
+ * @retval SilPass              The ranges are filled.
+ * @retval SilInvalidParameter  NULL pointer, a range is not 64 byte aligned or
+ *                              is not backed by memory (MMIO, PCIe config or
+ *                              unmapped).
+ * @retval SilOutOfResources    The ranges split in too many pieces.
+ * @retval SilOutOfBounds       A range is not addressable in this build.
+ * @retval Others               Failure to build the memory range map.
+ **/
+SIL_STATUS
+xPrfFillMemory (
+  const SIL_MEMORY_FILL_RANGE  *Ranges,
+  uint32_t                     RangeCount,
+  uint64_t                     Pattern,
+  SIL_MEMORY_FILL_STATS        *Stats
+  );
+
 /*
  * Prototypes for RAS xPRF services
  */
@@ -561,6 +752,26 @@ xPrfCollectCoreMcaInfo (
   void *Buffer
 );
 
+/**
+ * xPrfBuildCoreMcaBankMap
+ *
+ * @brief   Build the MCA bank descriptor table of the currently executing cpu.
+ *
+ * @details The Host keeps one SIL_CORE_MCA_BANK_MAP per thread, built once at
+ *          init, and passes it to the MCA services so that they only visit the
+ *          populated banks.
+ *
+ * @note    ***This function is executed on all processors by the Host in a
+ *          multi-processor environment.
+ *
+ * @param   Buffer  Pointer to the SIL_CORE_MCA_BANK_MAP (defined in
+ *                  RasClass-api.h) of the currently executing processor.
+ */
+void
+xPrfBuildCoreMcaBankMap (
+  void *Buffer
+);
+
 /**
  * xPrfCollectMcaErrorInfo
  *
@@ -569,7 +780,8 @@ xPrfCollectCoreMcaInfo (
  *
  * @details It is the responsibility of the Host to ensure the input buffer is
  *          sufficient to contain the SIL_RAS_MCA_ERROR_INFO_V2 (defined in
- *          RasClass-api.h).
+ *          RasClass-api.h). The banks are discovered from MCG_CAP and MCA_IPID,
+ *          see xPrfCollectMcaErrorInfoWithBankMap to use a bank map instead.
  *
  * @note    ***This function is executed on all processors by the Host in a
  *          multi-processor environment.
@@ -582,6 +794,79 @@ xPrfCollectMcaErrorInfo (
   void *Buffer
 );
 
+/**
+ * xPrfCollectMcaErrorInfoWithBankMap
+ *
+ * @brief   Search the MCA banks of the executing thread for errors, visiting
+ *          only the banks of its bank map.
+ *
+ * @param   RasMcaErrorInfo Output, the banks that hold an error
+ * @param   BankMap         Bank map of the executing core from xPrfBuildCoreMcaBankMap, or NULL
+ */
+void
+xPrfCollectMcaErrorInfoWithBankMap (
+  SIL_RAS_MCA_ERROR_INFO_V2 *RasMcaErrorInfo,
+  SIL_CORE_MCA_BANK_MAP     *BankMap
+  );
+
+/**
+ * xPrfGetMcaHarvestSlotSize
+ *
+ * @brief   Return the size of one slot of the MCA harvest slot array, a
+ *          multiple of SIL_MCA_HARVEST_SLOT_ALIGN.
+ */
+uint32_t
+xPrfGetMcaHarvestSlotSize (void);
+
+/**
+ * xPrfMcaHarvestInit
+ *
+ * @brief   Prepare a per processor MCA harvest buffer (see
+ *          SIL_MCA_HARVEST_BUFFER). Called once at init.
+ *
+ * @param   Harvest Harvest buffer with SlotSize, SlotCount, Slots and
+ *                  CoreMcaBankMaps filled by the Host.
+ *
+ * @retval  SilPass             The buffer is ready, Generation is set to 1
+ * @retval  SilInvalidParameter The buffer is NULL, too small or misaligned
+ * @retval  SilOutOfBounds      SlotCount is smaller than the number of CPUs
+ */
+SIL_STATUS
+xPrfMcaHarvestInit (
+  SIL_MCA_HARVEST_BUFFER *Harvest
+  );
+
+/**
+ * xPrfHarvestMcaErrorInfo
+ *
+ * @brief   Collect the MCA errors of the executing thread into its own slot of
+ *          the harvest buffer and publish it with the harvest generation.
+ *
+ * @note    ***This function is executed on all processors by the Host in a
+ *          multi-processor environment. The processors may run concurrently.
+ *
+ * @param   Buffer  Pointer to the SIL_MCA_HARVEST_BUFFER
+ */
+void
+xPrfHarvestMcaErrorInfo (
+  void *Buffer
+  );
+
+/**
+ * xPrfGetMcaHarvestSlot
+ *
+ * @brief   Return the slot of a processor if it was published by the current
+ *          harvest, NULL otherwise.
+ *
+ * @param   Harvest         Harvest buffer
+ * @param   ProcessorNumber Processor number from xPrfCollectCpuMap
+ */
+SIL_MCA_HARVEST_SLOT *
+xPrfGetMcaHarvestSlot (
+  SIL_MCA_HARVEST_BUFFER  *Harvest,
+  uint32_t                ProcessorNumber
+  );
+
 /**
  * xPrfMcaErrorAddrTranslate
  *
@@ -610,6 +895,170 @@ xPrfMcaErrorAddrTranslate (
   SIL_ADDR_DATA           *AddrData
 );
 
+/**
+ * xPrfMcaErrorAddrTranslateBatch
+ *
+ * @brief   Translate an array of UMC normalized addresses into DIMM information
+ *          and system addresses in one call.
+ *
+ * @details The RAS translation services are resolved once for the whole array
+ *          and an address repeated within the array is usually translated only
+ *          once.
+ *
+ * @param   Entries         Array of addresses to translate. On input the Host
+ *                          fills NormalizedAddress, on output DimmInfo,
+ *                          SystemAddress and Translated are populated.
+ * @param   EntryCount      Number of entries in Entries
+ * @param   AddrData        Dimm information map, created by Host call to
+ *                          xPrfCollectDimmMap, used in address translation
+ * @param   TranslatedCount On output, the number of entries with a valid
+ *                          system address
+ *
+ * @return  SIL_STATUS
+ *
+ * @retval  SilPass             All entries were processed
+ * @retval  SilInvalidParameter A required pointer is NULL
+ * @retval  SilNotFound         RAS API was not found in the API list
+ * @retval  SilUnsupported      The SoC does not provide address translation
+ */
+SIL_STATUS
+xPrfMcaErrorAddrTranslateBatch (
+  SIL_ADDR_TRANSLATE_ENTRY  *Entries,
+  uint32_t                  EntryCount,
+  SIL_ADDR_DATA             *AddrData,
+  uint32_t                  *TranslatedCount
+  );
+
+/**
+ * xPrfCeStormInit
+ *
+ * @brief   Initialize the correctable error storm detection of a socket.
+ *
+ * @param   Context   Storm state of the socket, allocated by the Host
+ * @param   Policy    Storm detection policy
+ * @param   RasPolicy Platform RAS policy, gives the normal mode MCA error
+ *                    threshold
+ *
+ * @retval  SilPass             The context is ready
+ * @retval  SilInvalidParameter A pointer is NULL or a policy is not valid
+ */
+SIL_STATUS
+xPrfCeStormInit (
+  SIL_CE_STORM_CONTEXT  *Context,
+  SIL_CE_STORM_POLICY   *Policy,
+  SIL_AMD_RAS_POLICY    *RasPolicy
+  );
+
+/**
+ * xPrfCeStormRecordError
+ *
+ * @brief   Account a correctable DRAM error and switch the reporting MCA bank to
+ *          storm mode when the DIMM or DRAM bank error rate is too high.
+ *
+ * @note    ***This function must be executed on a thread of the socket that
+ *          owns Context.
+ *
+ * @param   Context           Storm state of the socket
+ * @param   NormalizedAddress Normalized address of the error
+ * @param   DimmInfo          DIMM information of the error, from address
+ *                            translation
+ * @param   McaBankNumber     MCA bank that reported the error
+ * @param   TimeMs            Current time in milliseconds, from any monotonic
+ *                            Host clock
+ * @param   StormStatus       On output, the storm state after this error
+ *
+ * @retval  SilPass             The error was accounted
+ * @retval  SilInvalidParameter A pointer is NULL or McaBankNumber is too large
+ */
+SIL_STATUS
+xPrfCeStormRecordError (
+  SIL_CE_STORM_CONTEXT    *Context,
+  SIL_NORMALIZED_ADDRESS  *NormalizedAddress,
+  SIL_DIMM_INFO           *DimmInfo,
+  uint32_t                McaBankNumber,
+  uint64_t                TimeMs,
+  SIL_CE_STORM_STATUS     *StormStatus
+  );
+
+/**
+ * xPrfCeStormPoll
+ *
+ * @brief   Restore normal mode on the MCA banks that were quiet for the policy
+ *          QuietPeriodMs.
+ *
+ * @note    ***This function must be executed on a thread of the socket that
+ *          owns Context.
+ *
+ * @param   Context Storm state of the socket
+ * @param   TimeMs  Current time in milliseconds, same clock as for
+ *                  xPrfCeStormRecordError
+ *
+ * @return  The number of MCA banks still in storm mode
+ */
+uint32_t
+xPrfCeStormPoll (
+  SIL_CE_STORM_CONTEXT  *Context,
+  uint64_t              TimeMs
+  );
+
+/**
+ * xPrfCeStormRearmMcaBank
+ *
+ * @brief   Re-arm the error thresholding counter of an MCA bank after its
+ *          thresholding interrupt.
+ *
+ * @details The Host thresholding interrupt handler must call this service in
+ *          place of presetting MCA_MISC0[ErrCnt] itself, otherwise a bank in
+ *          storm mode loses its StormIntInterval.
+ *
+ * @note    ***This function must be executed on a thread of the socket that
+ *          owns Context.
+ *
+ * @param   Context       Storm state of the socket
+ * @param   McaBankNumber MCA bank that raised the thresholding interrupt
+ *
+ * @retval  SilPass             The counter was re-armed
+ * @retval  SilInvalidParameter Context is NULL or McaBankNumber is too large
+ * @retval  SilUnsupported      The bank has no usable thresholding counter
+ */
+SIL_STATUS
+xPrfCeStormRearmMcaBank (
+  SIL_CE_STORM_CONTEXT  *Context,
+  uint32_t              McaBankNumber
+  );
+
+/**
+ * xPrfBuildCperRecord
+ *
+ * @brief   Build a UEFI CPER record for the MCA banks collected on one thread.
+ *
+ * @details Every bank with an error gets a processor generic section, UMC banks
+ *          with an address also get a platform memory error section with the
+ *          decoded node, card, module, bank, row and column. The record is
+ *          written directly into the Host buffer; the Host fills TimeStamp,
+ *          PlatformId, PartitionId, CreatorId and RecordId.
+ *
+ * @param   ErrorInfo   MCA banks from xPrfCollectMcaErrorInfo
+ * @param   AddrData    Dimm information map from xPrfCollectDimmMap, or NULL
+ * @param   Record      Host buffer for the record, may be NULL to query the size
+ * @param   RecordSize  On input, the size of the Record buffer.
+ *                      On output, the size of the record.
+ *
+ * @return  SIL_STATUS
+ *
+ * @retval  SilPass             The record was built
+ * @retval  SilInvalidParameter ErrorInfo or RecordSize is NULL
+ * @retval  SilNotFound         ErrorInfo holds no MCA bank
+ * @retval  SilOutOfBounds      The Record buffer is too small, RecordSize holds the size needed
+ */
+SIL_STATUS
+xPrfBuildCperRecord (
+  SIL_RAS_MCA_ERROR_INFO_V2 *ErrorInfo,
+  SIL_ADDR_DATA             *AddrData,
+  void                      *Record,
+  uint32_t                  *RecordSize
+  );
+
 /**
  * xPrfTranslateSysAddrToCS
  *
@@ -663,6 +1112,7 @@ xPrfTranslateSysAddrToDpa (
  * @brief Program the Core MCA_IPID MSR Instance ID values for the CPU specified in RasCpuInfo.
  *
  * @param   RasCpuInfo  The CPU info structure for the core to program (RasClass-api.h)
+ * @param   BankMap     Bank map of the executing core from xPrfBuildCoreMcaBankMap, or NULL
  *
  * @return  SIL_STATUS
  * @retval  SilPass     If the function completed normally
@@ -670,7 +1120,8 @@ xPrfTranslateSysAddrToDpa (
  */
 SIL_STATUS
 xPrfMcaIpIdInstanceIdInit (
-  SIL_CPU_INFO  *RasCpuInfo
+  SIL_CPU_INFO          *RasCpuInfo,
+  SIL_CORE_MCA_BANK_MAP *BankMap
   );
 
 /**
@@ -704,6 +1155,7 @@ xPrfProgramCoreMcaConfigUmc (
  *                        appropriate IP structure with valid policy information. Currently supported IP structures:
  *
  *                        - SIL_NBIO_RAS_POLICY
+ * @param BankMap         Bank map of the executing core from xPrfBuildCoreMcaBankMap, or NULL
  *
  * @returns SIL_STATUS
  * @retval  SilNotFound   If RAS API was not found in the API list
@@ -712,9 +1164,10 @@ xPrfProgramCoreMcaConfigUmc (
  */
 SIL_STATUS
 xPrfSetIpMcaCtlMask (
-  uint16_t          HardwareId,
-  uint16_t          McaType,
-  SIL_IP_RAS_POLICY *IpMcaPolicyCfg
+  uint16_t              HardwareId,
+  uint16_t              McaType,
+  SIL_IP_RAS_POLICY     *IpMcaPolicyCfg,
+  SIL_CORE_MCA_BANK_MAP *BankMap
   );
 
 /**
@@ -783,6 +1236,75 @@ xPrfGetSmbiosMemInfo(
   SIL_DMI_INFO *DmiInfoTable
   );
 
+/**
+ * xPrfBuildSmbiosMemTables
+ *
+ * @brief   Write the packed SMBIOS Type 16, 17, 19 and 20 structures,
+ *          including their string sets, directly into a Host buffer.
+ *
+ * @details Handles are assigned from FirstHandle in this order: Type 16, one
+ *          Type 17 per physical DIMM, Type 19, one Type 20 per logical DIMM.
+ *          Call with a NULL Buffer to get the required size.
+ *
+ * @param   Buffer      Host buffer for the structures, may be NULL
+ * @param   BufferSize  On input, the size of Buffer.
+ *                      On output, the size of the structures.
+ * @param   FirstHandle Handle of the Type 16 structure
+ *
+ * @retval  SilPass             The structures were written
+ * @retval  SilOutOfBounds      Buffer is too small, BufferSize holds the size needed
+ * @retval  SilInvalidParameter BufferSize is NULL
+ * @retval  SilNotFound         The APOB DMI records were not found
+ */
+SIL_STATUS
+xPrfBuildSmbiosMemTables (
+  void      *Buffer,
+  uint32_t  *BufferSize,
+  uint16_t  FirstHandle
+  );
+
+/**
+ * xPrfSetSpdCache
+ *
+ * @brief   Register the per boot SPD cache.
+ *
+ * @details The SPD of every DIMM is read once, from APOB or else from the
+ *          SMBus, into the cache. Later SPD users, such as xPrfGetSmbiosMemInfo
+ *          and xPrfGetDimmSpd, read the cache. The Host fills SmbusBase and
+ *          SmbusAddress before the call; ValidMap is cleared.
+ *
+ * @param   SpdCache  Host buffer for the cache, NULL to stop caching.
+ *
+ * @retval  SilPass   The cache is registered
+ */
+SIL_STATUS
+xPrfSetSpdCache (
+  SIL_SPD_CACHE *SpdCache
+  );
+
+/**
+ * xPrfGetDimmSpd
+ *
+ * @brief   Get the SPD of a DIMM from the SPD cache, reading it on first use.
+ *
+ * @param   Socket    Socket of the DIMM
+ * @param   Channel   SMBIOS (translated) channel of the DIMM
+ * @param   Dimm      DIMM on the channel
+ * @param   Spd       On output, the SIL_SPD_SIZE bytes of SPD in the cache
+ *
+ * @retval  SilPass             Spd points to the SPD of the DIMM
+ * @retval  SilInvalidParameter Spd is NULL or the DIMM is out of range
+ * @retval  SilUnsupported      No SPD cache is registered
+ * @retval  SilNotFound         The SPD is neither in APOB nor on the SMBus
+ */
+SIL_STATUS
+xPrfGetDimmSpd (
+  uint8_t Socket,
+  uint8_t Channel,
+  uint8_t Dimm,
+  uint8_t **Spd
+  );
+
 /**
  * xPrfGetMemInfo
  *
@@ -960,3 +1482,29 @@ xPrfCratCacheEntry (
   uint8_t   *CratCacheEntry,
   uint32_t  CratCacheEntrySize
   );
+
+/**
+ * xPrfGetTphSteeringTagTable
+ *
+ * @brief   Build the TPH steering tag table used for SDCI cache injection
+ *
+ * @details The table holds one steering tag per L3 cache, taken from the CCX topology,
+ *          and the default steering tag of every PCIe root port, taken from the SDCI
+ *          input block. See SIL_TPH_ST_TABLE for the layout.
+ *
+ * @param   Table       Host buffer for the SIL_TPH_ST_TABLE, may be NULL to query the size.
+ * @param   TableSize   On input, the size of the Table buffer.
+ *                      On output, the size the table needs.
+ *
+ * @return  SIL_STATUS
+ *
+ * @retval  SilPass         The table was built.
+ * @retval  SilOutOfBounds  The Table buffer is too small, TableSize holds the size needed.
+ * @retval  SilUnsupported  SDCI is disabled.
+ * @retval  SilNotFound     An IP API or input block was not found.
+ */
+SIL_STATUS
+xPrfGetTphSteeringTagTable (
+  void      *Table,
+  uint32_t  *TableSize
+  );
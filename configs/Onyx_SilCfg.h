@@ -21,6 +21,10 @@
 #define CONFIG_CCX_CSTATE_CC6_ENABLE 1
 #define CONFIG_CCX_CPB_ENABLE 1
 #define CONFIG_CCX_SMEE_ENABLE 0
+#define CONFIG_CCX_SOCKET_PRIMARY_DISPATCH 0
+#define CONFIG_CCX_MP_SERVICES 0
+#define CONFIG_CCX_MP_MAX_APS 383
+#define CONFIG_CCX_AP_PARK_STACK_SIZE 0x2000
 #define CONFIG_HAVE_NBIO_IOD 1
 #define CONFIG_IOAPIC_MMIO_ADDRESS_RESERVED_ENABLE 1
 #define CONFIG_IOAPIC_ID_PREDEFINE_EN 0
@@ -173,5 +177,11 @@
 #define CONFIG_PCIE_LINK_ACTIVE_STATE_PWR_MGMT 0xFF
 #define CONFIG_MCTP_MASTER_PCI_ADDR_SEGMENT 0
 #define CONFIG_MCTP_MASTER_PCI_ADDR 0
+#define CONFIG_CHOICE_PCIE_MPS_MRRS_PROFILE_DISABLED 1
+#define CONFIG_PCIE_MPS_MRRS_PROFILE 0
+#define CONFIG_PCIE_TAG_NEGOTIATION 0
+#define CONFIG_PCIE_ASPM_POLICY 0
+#define CONFIG_PCIE_ASPM_LATENCY_CRITICAL_CLASSES 0x09
 #define CONFIG_HAVE_SDCI 1
 #define CONFIG_SDCI_SMART_DATA_CACHE_INJECTION_ENABLE 0
+#define CONFIG_SDCI_DEFAULT_TARGET_CCX 0
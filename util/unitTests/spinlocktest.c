@@ -0,0 +1,265 @@
+/* Copyright 2023 Advanced Micro Devices, Inc. All rights reserved.    */
+// SPDX-License-Identifier: MIT
+
+/*
+ * Host side stress test of the indexed register accessors.
+ *
+ * meson builds this file together with the real SMN, DF and FCH accessors and
+ * forces XUSL_SMP_LOCKS on. Host threads stand in for cores. The PCI and IO
+ * accessors below simulate the index/data pairs: the data register always
+ * reflects the index latched last, and the backend yields between the index
+ * and the data access so that another thread gets a chance to retarget the
+ * index. A data access that does not match the address the caller asked for
+ * is a torn access. PMIO is plain MMIO, so its window is mapped at the FCH
+ * ACPI MMIO base when the host allows it.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#include <xSIM.h>
+#include <Pci.h>
+#include <xUSL/CommonLib/SpinLock.h>
+#include <xUSL/CommonLib/CpuLib.h>
+#include <xUSL/CommonLib/Io.h>
+#include <xUSL/CommonLib/SmnAccess.h>
+#include <xUSL/DF/Common/FabricRegisterAccCmn.h>
+#include <xUSL/DF/DfX/DfXFabricRegisterAcc.h>
+#include <xUSL/DF/DfX/SilFabricRegistersDfX.h>
+#include <xUSL/FCH/Common/FchHelper.h>
+
+#if !XUSL_SMP_LOCKS
+#error The spin lock test must be built with XUSL_SMP_LOCKS forced on
+#endif
+
+#define TEST_THREADS          4
+#define TEST_ITERATIONS       5000
+#define TEST_YIELD_INTERVAL   16          // backend yields after every Nth index write
+
+#define SIM_DATA_KEY          0x5A5A0000ul
+#define SIM_SMN_BUS           0x20
+#define SIM_DF_SOCKET         0
+#define SIM_DF_INSTANCE       3
+#define SIM_FCH_IO_BASE       0x0C00
+#define SIM_ACPI_MMIO_BASE    0xFED80000ul
+#define SIM_PMIO_REG          0xA0
+
+static volatile uint32_t  mSmnIndex;
+static volatile uint32_t  mDfFicaa;
+static volatile uint8_t   mFchIoIndex;
+static volatile uint32_t  mIndexWrites;
+static volatile uint32_t  mTornAccesses;
+static volatile uint32_t  mAccesses;
+static bool               mPmioMapped;
+
+/*
+ * Simulated hardware
+ */
+
+static void SimIndexWritten (void)
+{
+  if ((__atomic_add_fetch (&mIndexWrites, 1, __ATOMIC_RELAXED) % TEST_YIELD_INTERVAL) == 0) {
+    sched_yield ();
+  }
+}
+
+static void SimDataChecked (uint32_t Value, uint32_t Expected)
+{
+  __atomic_add_fetch (&mAccesses, 1, __ATOMIC_RELAXED);
+  if (Value != Expected) {
+    __atomic_add_fetch (&mTornAccesses, 1, __ATOMIC_RELAXED);
+  }
+}
+
+// Value of the DF register the latched FICAA points at
+static uint32_t SimDfData (uint32_t Ficaa)
+{
+  FABRIC_INDIRECT_CONFIG_ACCESS_ADDRESS_REGISTER FICAA3;
+
+  FICAA3.Value = Ficaa;
+  return SIM_DATA_KEY | (FICAA3.Field.CfgRegInstID << 13) | (FICAA3.Field.IndCfgAccFuncNum << 10) |
+    FICAA3.Field.IndCfgAccRegNum;
+}
+
+static bool SimIsDfPair (PCI_ADDR PciAddr, uint32_t Register)
+{
+  return (PciAddr.Address.Device == DfFabricRegisterAccGetPciDeviceNumberOfDie (SIM_DF_SOCKET)) &&
+    (PciAddr.Address.Function == FABRICINDIRECTCONFIGACCESSADDRESS_3_FUNC) &&
+    (PciAddr.Address.Register == Register);
+}
+
+uint32_t xUSLPciRead32 (uint32_t Address)
+{
+  PCI_ADDR PciAddr;
+
+  PciAddr.AddressValue = Address;
+  if ((PciAddr.Address.Device == 0) && (PciAddr.Address.Register == SIL_RESERVED2_897)) {
+    return mSmnIndex ^ SIM_DATA_KEY;
+  }
+  if (SimIsDfPair (PciAddr, FABRICINDIRECTCONFIGACCESSDATALO_3_REG)) {
+    return SimDfData (mDfFicaa);
+  }
+  return 0xFFFFFFFF;
+}
+
+void xUSLPciWrite32 (uint32_t Address, uint32_t Value)
+{
+  PCI_ADDR PciAddr;
+
+  PciAddr.AddressValue = Address;
+  if ((PciAddr.Address.Device == 0) && (PciAddr.Address.Register == SIL_RESERVED2_896)) {
+    mSmnIndex = Value;
+    SimIndexWritten ();
+  } else if ((PciAddr.Address.Device == 0) && (PciAddr.Address.Register == SIL_RESERVED2_897)) {
+    SimDataChecked (Value, mSmnIndex ^ SIM_DATA_KEY);
+  } else if (SimIsDfPair (PciAddr, FABRICINDIRECTCONFIGACCESSADDRESS_3_REG)) {
+    mDfFicaa = Value;
+    SimIndexWritten ();
+  } else if (SimIsDfPair (PciAddr, FABRICINDIRECTCONFIGACCESSDATALO_3_REG)) {
+    SimDataChecked (Value, SimDfData (mDfFicaa));
+  }
+}
+
+uint8_t xUSLPciRead8 (uint32_t Address)
+{
+  return (uint8_t) (xUSLPciRead32 (Address & ~3u) >> ((Address & 3) * 8));
+}
+
+void xUSLPciWrite8 (uint32_t Address, uint8_t Value)
+{
+}
+
+uint8_t xUSLIoRead8 (uint16_t Port)
+{
+  if (Port == SIM_FCH_IO_BASE + 1) {
+    return (uint8_t) (mFchIoIndex ^ 0x5A);
+  }
+  return 0xFF;
+}
+
+void xUSLIoWrite8 (uint16_t Port, uint8_t Value)
+{
+  if (Port == SIM_FCH_IO_BASE) {
+    mFchIoIndex = Value;
+    SimIndexWritten ();
+  } else if (Port == SIM_FCH_IO_BASE + 1) {
+    SimDataChecked (Value, (uint8_t) (mFchIoIndex ^ 0x5A));
+  }
+}
+
+void xUslCpuPause (void)
+{
+  sched_yield ();
+}
+
+uint32_t xUslInterlockedExchange32 (volatile uint32_t *Value, uint32_t NewValue)
+{
+  return __atomic_exchange_n (Value, NewValue, __ATOMIC_ACQ_REL);
+}
+
+/*
+ * Test threads
+ */
+
+static void TestSmn (uint32_t Id, uint32_t Iteration)
+{
+  uint32_t SmnAddress;
+
+  SmnAddress = (Id << 24) | ((Iteration << 2) & 0xFFFFFC);
+  SimDataChecked (xUSLSmnRead (0, SIM_SMN_BUS, SmnAddress), SmnAddress ^ SIM_DATA_KEY);
+  xUSLSmnWrite (0, SIM_SMN_BUS, SmnAddress, SmnAddress ^ SIM_DATA_KEY);
+}
+
+static void TestDf (uint32_t Id, uint32_t Iteration)
+{
+  uint32_t Function;
+  uint32_t Offset;
+  uint32_t Expected;
+
+  Function = Id % 8;
+  Offset = (Iteration << 2) & 0xFFC;
+  Expected = SIM_DATA_KEY | (SIM_DF_INSTANCE << 13) | (Function << 10) | (Offset >> 2);
+  SimDataChecked (DfXFabricRegisterAccRead (SIM_DF_SOCKET, Function, Offset, SIM_DF_INSTANCE), Expected);
+  DfXFabricRegisterAccWrite (SIM_DF_SOCKET, Function, Offset, SIM_DF_INSTANCE, Expected);
+}
+
+static void TestFchIndexIo (uint32_t Id, uint32_t Iteration)
+{
+  uint8_t Index;
+  uint8_t Value[4];
+  uint8_t Byte;
+
+  Index = (uint8_t) ((Id << 6) | ((Iteration << 2) & 0x3C));
+  LibFchIndirectIoRead (sizeof (Value), SIM_FCH_IO_BASE, Index, Value);
+  for (Byte = 0; Byte < sizeof (Value); Byte++) {
+    SimDataChecked (Value[Byte], (uint8_t) ((Index + Byte) ^ 0x5A));
+  }
+  LibFchIndirectIoWrite (sizeof (Value), SIM_FCH_IO_BASE, Index, Value);
+}
+
+// Each thread owns one bit of a shared PMIO byte, a lost read-modify-write clears another thread's bit
+static void TestPmio (uint32_t Id)
+{
+  uint8_t Bit;
+  uint8_t Value;
+
+  Bit = (uint8_t) (1 << Id);
+  SilFchRwPmio (SIM_PMIO_REG, 1, (uint8_t) ~Bit, Bit);
+  sched_yield ();
+  SilFchReadPmio (SIM_PMIO_REG, 1, &Value);
+  SimDataChecked (Value & Bit, Bit);
+  SilFchRwPmio (SIM_PMIO_REG, 1, (uint8_t) ~Bit, 0);
+}
+
+static void *StressThread (void *Context)
+{
+  uint32_t Id;
+  uint32_t Iteration;
+
+  Id = (uint32_t) (uintptr_t) Context;
+  for (Iteration = 0; Iteration < TEST_ITERATIONS; Iteration++) {
+    TestSmn (Id, Iteration);
+    TestDf (Id, Iteration);
+    TestFchIndexIo (Id, Iteration);
+    if (mPmioMapped) {
+      TestPmio (Id);
+    }
+  }
+  return NULL;
+}
+
+int main (void)
+{
+  pthread_t Thread[TEST_THREADS];
+  uint32_t  Index;
+  void      *Window;
+
+  // The address is only a hint, so nothing already mapped there is replaced
+  Window = mmap ((void *) (uintptr_t) SIM_ACPI_MMIO_BASE, 0x1000, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  mPmioMapped = (Window == (void *) (uintptr_t) SIM_ACPI_MMIO_BASE);
+  if (!mPmioMapped) {
+    if (Window != MAP_FAILED) {
+      munmap (Window, 0x1000);
+    }
+    printf ("spinlock: cannot map the PMIO window, PMIO is not tested\n");
+  }
+
+  for (Index = 0; Index < TEST_THREADS; Index++) {
+    if (pthread_create (&Thread[Index], NULL, StressThread, (void *) (uintptr_t) Index) != 0) {
+      printf ("spinlock: cannot create thread %u\n", Index);
+      return 1;
+    }
+  }
+  for (Index = 0; Index < TEST_THREADS; Index++) {
+    pthread_join (Thread[Index], NULL);
+  }
+
+  printf ("spinlock: %u checked accesses, %u torn\n", mAccesses, mTornAccesses);
+  return ((mTornAccesses != 0) || (mAccesses == 0)) ? 1 : 0;
+}
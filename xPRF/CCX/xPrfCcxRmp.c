@@ -0,0 +1,62 @@
+/**
+ * @file  xPrfCcxRmp.c
+ * @brief Platform Reference Firmware - parallel SNP RMP table clear on the
+ *        parked APs.
+ */
+/* Copyright 2023 Advanced Micro Devices, Inc. All rights reserved.    */
+// SPDX-License-Identifier: MIT
+
+#include <SilCommon.h>
+#include <xPRF-api.h>
+
+/**
+ * xPrfClearSnpRmp
+ *
+ * @brief   Zero the SNP RMP table in parallel on the parked APs
+ *
+ * @details The RMP ranges of the memory range map are already split by the
+ *          domain of the memory holding them, and are cleared with
+ *          xPrfFillMemory.
+ *
+ * @param[out] Stats    Bytes, elapsed TSC ticks and completion per NUMA domain
+ *
+ * @retval SilPass              The RMP is cleared.
+ * @retval SilInvalidParameter  Stats is NULL.
+ * @retval SilNotFound          The RMP is not programmed.
+ * @retval Others               See xPrfFillMemory.
+ **/
+SIL_STATUS
+xPrfClearSnpRmp (
+  SIL_MEMORY_FILL_STATS  *Stats
+  )
+{
+  SIL_MEMORY_FILL_RANGE   RmpRanges[SIL_MEMORY_RANGE_MAX];
+  const SIL_MEMORY_RANGE  *RangeMap;
+  uint32_t                RangeCount;
+  uint32_t                RmpCount;
+  uint32_t                Index;
+  SIL_STATUS              Status;
+
+  if (Stats == NULL) {
+    return SilInvalidParameter;
+  }
+
+  Status = xPrfGetMemoryRangeMap (&RangeMap, &RangeCount);
+  if (Status != SilPass) {
+    return Status;
+  }
+
+  RmpCount = 0;
+  for (Index = 0; Index < RangeCount; Index++) {
+    if (RangeMap[Index].Type == SilMemRangeSnpRmp) {
+      RmpRanges[RmpCount].Base = RangeMap[Index].Base;
+      RmpRanges[RmpCount].Size = RangeMap[Index].Size;
+      RmpCount++;
+    }
+  }
+  if (RmpCount == 0) {
+    return SilNotFound;
+  }
+
+  return xPrfFillMemory (RmpRanges, RmpCount, 0, Stats);
+}
@@ -12,6 +12,10 @@
 #include <string.h>
 #include "xPrfMem.h"
 #include "xPrfMemSpd5.h"
+#include <CommonLib/Io.h>
+
+// Per boot SPD cache registered by the Host, NULL when SPDs are not cached
+static SIL_SPD_CACHE *mSpdCache;
 
 /**
  *  IsNvHybridDimm
@@ -306,11 +310,79 @@ MemSpdDecodeDiesPerPackage (
   return Dies;
 }
 
+/**
+ * SmbusByteData
+ *
+ * @brief  Run one read or write byte data transfer on the FCH SMBus host
+ *         controller.
+ *
+ * @param    SmbusBase   - SMBus controller IO base
+ * @param    Address     - 7-bit device address
+ * @param    Command     - Command (register) byte
+ * @param    Read        - true to read, false to write
+ * @param    Data        - Byte to write, or on output the byte read
+ *
+ * @retval   SilPass         - The transfer completed
+ * @retval   SilDeviceError  - The device did not acknowledge or the bus failed
+ * @retval   SilAborted      - The controller did not complete in time
+ *
+ */
+static
+SIL_STATUS
+SmbusByteData (
+  uint16_t   SmbusBase,
+  uint8_t    Address,
+  uint8_t    Command,
+  bool       Read,
+  uint8_t    *Data
+  )
+{
+  uint32_t   Poll;
+  uint8_t    Status;
+
+  for (Poll = 0; (xUSLIoRead8 (SmbusBase + FCH_SMBUS_STATUS) & FCH_SMBUS_STS_HOST_BUSY) != 0; Poll++) {
+    if (Poll >= FCH_SMBUS_POLL_COUNT) {
+      return SilAborted;
+    }
+  }
+
+  xUSLIoWrite8 (SmbusBase + FCH_SMBUS_STATUS, FCH_SMBUS_STS_ALL);
+  xUSLIoWrite8 (SmbusBase + FCH_SMBUS_ADDRESS, (uint8_t)((Address << 1) | (Read ? 1 : 0)));
+  xUSLIoWrite8 (SmbusBase + FCH_SMBUS_HOST_CMD, Command);
+  if (!Read) {
+    xUSLIoWrite8 (SmbusBase + FCH_SMBUS_DATA0, *Data);
+  }
+  xUSLIoWrite8 (SmbusBase + FCH_SMBUS_CONTROL, FCH_SMBUS_CTL_BYTE_DATA | FCH_SMBUS_CTL_START);
+
+  for (Poll = 0; ; Poll++) {
+    Status = xUSLIoRead8 (SmbusBase + FCH_SMBUS_STATUS);
+    if ((Status & (FCH_SMBUS_STS_DONE | FCH_SMBUS_STS_ERROR)) != 0) {
+      break;
+    }
+    if (Poll >= FCH_SMBUS_POLL_COUNT) {
+      return SilAborted;
+    }
+  }
+  xUSLIoWrite8 (SmbusBase + FCH_SMBUS_STATUS, FCH_SMBUS_STS_ALL);
+
+  if ((Status & FCH_SMBUS_STS_ERROR) != 0) {
+    return SilDeviceError;
+  }
+  if (Read) {
+    *Data = xUSLIoRead8 (SmbusBase + FCH_SMBUS_DATA0);
+  }
+  return SilPass;
+}
+
 /**
  * SilReadSpd
  *
- * @brief  Call the host environment interface, once, to read an
- *         SPD's* content.**
+ * @brief  Read the SPD of a DIMM from its SPD5 hub on the FCH SMBus.
+ *
+ * @details  The hub is used in legacy (1 byte) addressing mode: MR11 selects
+ *           one of the 8 NVM pages, which is then read through offsets
+ *           80h-FFh. MR11 is set back to page 0 afterwards. The SMBus address
+ *           comes from the SPD cache registered by the Host.
  *
  * @param    SocketId              - The socket ID
  * @param    MemChannelId          - The Memory channel ID
@@ -329,16 +401,198 @@ SilReadSpd  (
   uint8_t    *SpdBufPtr
   )
 {
-    if (SpdBufPtr == NULL) {
-      return SilInvalidParameter;
+  SIL_STATUS Status;
+  uint16_t   SmbusBase;
+  uint8_t    Address;
+  uint8_t    Page;
+  uint8_t    Offset;
+
+  if (SpdBufPtr == NULL) {
+    return SilInvalidParameter;
+  }
+  if ((mSpdCache == NULL) || (mSpdCache->SmbusBase == 0) || (SocketId >= SIL_MAX_SOCKETS_SUPPORTED) ||
+      (MemChannelId >= SIL_MAX_CHANNELS_PER_SOCKET) || (DimmId >= SIL_MAX_DIMMS_PER_CHANNEL)) {
+    return SilUnsupported;
+  }
+  SmbusBase = mSpdCache->SmbusBase;
+  Address = mSpdCache->SmbusAddress[SocketId][MemChannelId][DimmId];
+  if (Address == 0) {
+    return SilUnsupported;
+  }
+
+  Status = SilPass;
+  for (Page = 0; (Page < (SPD_BUFFER_SIZE / SPD5_PAGE_SIZE)) && (Status == SilPass); Page++) {
+    Status = SmbusByteData (SmbusBase, Address, SPD5_MR11_PAGE, false, &Page);
+    for (Offset = 0; (Offset < SPD5_PAGE_SIZE) && (Status == SilPass); Offset++) {
+      Status = SmbusByteData (
+        SmbusBase,
+        Address,
+        SPD5_NVM_ACCESS | Offset,
+        true,
+        &SpdBufPtr[Page * SPD5_PAGE_SIZE + Offset]
+        );
     }
-    if ((SocketId == 0) && (MemChannelId == 0) && (DimmId == 1)) {
-    SpdBufPtr = MemSpdDdr4;
-    return SilPass;
-  } else {
-    SpdBufPtr = NULL;
+  }
+  Page = 0;
+  SmbusByteData (SmbusBase, Address, SPD5_MR11_PAGE, false, &Page);
+
+  XPRF_TRACEPOINT (SIL_TRACE_INFO,
+                   "SMBus SPD read Socket %d Channel %d Dimm %d at 0x%x: %d\n",
+                   SocketId,
+                   MemChannelId,
+                   DimmId,
+                   Address,
+                   Status
+                   );
+  return Status;
+}
+
+/**
+ * GetDimmSpd
+ *
+ * @brief  Get the SPD of a DIMM, from the SPD cache when it holds it, else
+ *         from APOB and, as a last resort, from the SMBus.
+ *
+ * @details  When an SPD cache is registered the SPD is read into the cache and
+ *           marked valid, so every DIMM is read once per boot.
+ *
+ * @param    Socket             - The socket ID
+ * @param    Channel            - The APOB channel ID
+ * @param    TranslatedChannel  - The SMBIOS channel ID
+ * @param    Dimm               - The Dimm ID
+ * @param    Buffer             - SPD_BUFFER_SIZE buffer used without a cache
+ * @param    SpdData            - On output, the SPD of the DIMM
+ *
+ * @return   SIL_STATUS
+ *
+ */
+static
+SIL_STATUS
+GetDimmSpd (
+  uint8_t    Socket,
+  uint8_t    Channel,
+  uint8_t    TranslatedChannel,
+  uint8_t    Dimm,
+  uint8_t    *Buffer,
+  uint8_t    **SpdData
+  )
+{
+  SIL_STATUS Status;
+  uint16_t   Instance;
+  uint16_t   DieLoop;
+  uint32_t   ValidBit;
+  uint8_t    *Target;
+
+  ValidBit = 0;
+  Target = Buffer;
+  if ((mSpdCache != NULL) && (Socket < SIL_MAX_SOCKETS_SUPPORTED) &&
+      (TranslatedChannel < SIL_MAX_CHANNELS_PER_SOCKET) && (Dimm < SIL_MAX_DIMMS_PER_CHANNEL)) {
+    ValidBit = SIL_SPD_CACHE_BIT (Socket, TranslatedChannel, Dimm);
+    Target = mSpdCache->Spd[Socket][TranslatedChannel][Dimm];
+    if ((mSpdCache->ValidMap & ValidBit) != 0) {
+      *SpdData = Target;
+      return SilPass;
+    }
+  }
+
+  // Get SPD Data from APOB
+  Status = SilNotFound;
+  for (DieLoop = 0; DieLoop < ABL_APOB_MAX_DIES_PER_SOCKET; DieLoop++) {
+    Instance = DieLoop;
+    Instance |= ((Socket & 0x000000FF) << 8);
+    XPRF_TRACEPOINT (SIL_TRACE_INFO,
+                     "Get Spd Data from APOB for Socket %d, Die %d , Channel %d Instance %d\n",
+                     Socket,
+                     DieLoop,
+                     TranslatedChannel,
+                     Instance
+                     );
+    if (ApobGetDimmSpdData (Instance, Socket, Channel, Dimm, SPD_BUFFER_SIZE, Target) == SilPass) {
+      Status = SilPass;
+      break;
+    }
+  }
+  if (Status != SilPass) {
+    XPRF_TRACEPOINT (SIL_TRACE_INFO, "Get Spd Data from SMBUS\n");
+    Status = SilReadSpd (Socket, TranslatedChannel, Dimm, Target);
+  }
+
+  if (Status == SilPass) {
+    if (ValidBit != 0) {
+      mSpdCache->ValidMap |= ValidBit;
+    }
+    *SpdData = Target;
+  }
+  return Status;
+}
+
+/**
+ * xPrfSetSpdCache
+ *
+ * @brief   Register the per boot SPD cache.
+ *
+ * @param   SpdCache  Host buffer for the cache, NULL to stop caching.
+ *
+ * @retval  SilPass   The cache is registered
+ */
+SIL_STATUS
+xPrfSetSpdCache (
+  SIL_SPD_CACHE *SpdCache
+  )
+{
+  if (SpdCache != NULL) {
+    SpdCache->ValidMap = 0;
+  }
+  mSpdCache = SpdCache;
+  return SilPass;
+}
+
+/**
+ * xPrfGetDimmSpd
+ *
+ * @brief   Get the SPD of a DIMM from the SPD cache, reading it on first use.
+ *
+ * @param   Socket    Socket of the DIMM
+ * @param   Channel   SMBIOS (translated) channel of the DIMM
+ * @param   Dimm      DIMM on the channel
+ * @param   Spd       On output, the SPD of the DIMM in the cache
+ *
+ * @retval  SilPass             Spd points to the SPD of the DIMM
+ * @retval  SilInvalidParameter Spd is NULL or the DIMM is out of range
+ * @retval  SilUnsupported      No SPD cache is registered
+ * @retval  SilNotFound         The SPD is neither in APOB nor on the SMBus
+ */
+SIL_STATUS
+xPrfGetDimmSpd (
+  uint8_t Socket,
+  uint8_t Channel,
+  uint8_t Dimm,
+  uint8_t **Spd
+  )
+{
+  HOST_TO_APCB_CHANNEL_XLAT *XlatTable;
+  SIL_STATUS                Status;
+  uint8_t                   ApobChannel;
+
+  if ((Spd == NULL) || (Socket >= SIL_MAX_SOCKETS_SUPPORTED) || (Channel >= SIL_MAX_CHANNELS_PER_SOCKET) ||
+      (Dimm >= SIL_MAX_DIMMS_PER_CHANNEL)) {
+    return SilInvalidParameter;
+  }
+  if (mSpdCache == NULL) {
     return SilUnsupported;
   }
+
+  // The cache is indexed by the SMBIOS channel, APOB by the requested channel
+  ApobChannel = Channel;
+  for (XlatTable = Sp5ChannelXlatTable; XlatTable->RequestedChannelId != 0xFF; XlatTable++) {
+    if (XlatTable->TranslatedChannelId == Channel) {
+      ApobChannel = XlatTable->RequestedChannelId;
+      break;
+    }
+  }
+
+  Status = GetDimmSpd (Socket, ApobChannel, Channel, Dimm, NULL, Spd);
+  return (Status == SilPass) ? SilPass : SilNotFound;
 }
 
 /**
@@ -367,15 +621,13 @@ GetPhysicalDimmInfoD5 (
   uint8_t                   Channel;
   uint8_t                   Dimm;
   uint8_t                   DimmSpd[SPD_BUFFER_SIZE] = {0,};
+  uint8_t                   *SpdData;
   SIL_STATUS                SilStatus;
   uint8_t                   IoWidth;
   uint16_t                  BusWidth;
   uint16_t                  TckPs;
   uint32_t                  MemorySize;
   uint32_t                  FreqTableIndex;
-  SIL_STATUS                ApobStatus;
-  uint16_t                  Instance;
-  uint16_t                  DieLoop;
   uint8_t                   NumRanks;
   uint8_t                   Rank;
   uint8_t                   SpdCapacity;
@@ -388,6 +640,7 @@ GetPhysicalDimmInfoD5 (
 
 //  uint32_t ManufacturerIdCode;
 
+  SpdData = DimmSpd;
   Socket  = PhysicalDimm->Socket;
   Channel = PhysicalDimm->Channel;
   Dimm    = PhysicalDimm->Dimm;
@@ -419,34 +672,11 @@ GetPhysicalDimmInfoD5 (
 
   if (PhysicalDimm->DimmPresent) {
     XPRF_TRACEPOINT (SIL_TRACE_INFO, "SPD Socket %d Channel %d Dimm %d: %08x\n", Socket, Channel, Dimm, DimmSpd);
-    // Get SPD Data from APOB
-    DieLoop = 0;
-    SilStatus = SilUnsupported;
-    for (DieLoop = 0; DieLoop < ABL_APOB_MAX_DIES_PER_SOCKET; DieLoop++) {
-      Instance = DieLoop;
-      Instance |= ((Socket & 0x000000FF) << 8);
-      XPRF_TRACEPOINT (SIL_TRACE_INFO,
-                       "Get Spd Data from APOB for Socket %d, Die %d , Channel %d Instance %d\n",
-                       Socket,
-                       DieLoop,
-                       TranslatedChannel,
-                       Instance
-                       );
-      ApobStatus = ApobGetDimmSpdData (Instance, Socket, Channel, Dimm, SPD_BUFFER_SIZE, DimmSpd);
-      if (ApobStatus == SilPass) {
-        SilStatus = SilPass;
-        break;
-      }
-    }
-    if (SilStatus != SilPass) {
-      XPRF_TRACEPOINT (SIL_TRACE_INFO, "Get Spd Data from SMBUS\n");
-      SilStatus = SilReadSpd (Socket, TranslatedChannel, Dimm, (uint8_t *)DimmSpd);
-    }
-
+    SilStatus = GetDimmSpd (Socket, Channel, TranslatedChannel, Dimm, DimmSpd, &SpdData);
     assert (SilPass == SilStatus);
-    BaseConfig0 = (SPD_BASE_CONFIG_0_S*) &(DimmSpd[SpdBlock_BaseConfig_0 * SPD_BLOCK_LEN]);
-    ModuleParms = (SPD_ANNEX_COMMON_S*) &(DimmSpd[SpdBlock_ModuleParms_0 * SPD_BLOCK_LEN]);
-    MfgInfo     = (SPD_MANUFACTURING_INFO_S*) &(DimmSpd[SpdBlock_MfgInfo0 * SPD_BLOCK_LEN]);
+    BaseConfig0 = (SPD_BASE_CONFIG_0_S*) &(SpdData[SpdBlock_BaseConfig_0 * SPD_BLOCK_LEN]);
+    ModuleParms = (SPD_ANNEX_COMMON_S*) &(SpdData[SpdBlock_ModuleParms_0 * SPD_BLOCK_LEN]);
+    MfgInfo     = (SPD_MANUFACTURING_INFO_S*) &(SpdData[SpdBlock_MfgInfo0 * SPD_BLOCK_LEN]);
     MemorySize = 0;
     Asymetric = (ModuleParms->ModuleOrg.Field.RankMix == RankMixAsymmetrical) ? true : false;
     NumRanks = SPD_PACKAGE_RANKS_DECODE(ModuleParms->ModuleOrg.Field.RanksPerChannel);
@@ -566,7 +796,7 @@ GetPhysicalDimmInfoD5 (
     T17->ConfiguredVoltage = 0;
   }
 
-  InitSmbios32Type17 (PhysicalDimm->DimmPresent, DimmSpd, T17);
+  InitSmbios32Type17 (PhysicalDimm->DimmPresent, SpdData, T17);
 
   if (PhysicalDimm->DimmPresent) {
     return true;
@@ -828,6 +1058,371 @@ xPrfGetSmbiosMemInfo (
   return Status;
 }
 
+/**
+ * SmbiosStreamReserve
+ *
+ * @brief   Reserve space for a formatted area in the SMBIOS stream.
+ *
+ * @param   Stream  SMBIOS output stream
+ * @param   Size    Size of the formatted area
+ *
+ * @return  The zeroed area in the Host buffer, or NULL when it does not fit or
+ *          the stream only sizes the tables.
+ */
+static
+void *
+SmbiosStreamReserve (
+  SMBIOS_STREAM  *Stream,
+  uint32_t       Size
+  )
+{
+  void  *Area;
+
+  Area = NULL;
+  if ((Stream->Buffer != NULL) && (Stream->Offset + Size <= Stream->BufferSize)) {
+    Area = Stream->Buffer + Stream->Offset;
+    memset (Area, 0, Size);
+  }
+  Stream->Offset += Size;
+  return Area;
+}
+
+/**
+ * SmbiosStreamAddString
+ *
+ * @brief   Append a string to the string set of the current structure.
+ *
+ * @param   Stream      SMBIOS output stream
+ * @param   String      NUL terminated string
+ * @param   StringCount Strings in the set so far, incremented when String is added
+ *
+ * @return  The string number, 0 when String is empty and was not added.
+ */
+static
+uint8_t
+SmbiosStreamAddString (
+  SMBIOS_STREAM  *Stream,
+  const char     *String,
+  uint8_t        *StringCount
+  )
+{
+  uint32_t  Length;
+  uint8_t   *Area;
+
+  Length = (uint32_t)strlen (String);
+  if (Length == 0) {
+    return 0;
+  }
+  Area = SmbiosStreamReserve (Stream, Length + 1);
+  if (Area != NULL) {
+    memcpy (Area, String, Length);
+  }
+  (*StringCount)++;
+  return *StringCount;
+}
+
+/**
+ * SmbiosStreamEndStrings
+ *
+ * @brief   Terminate the string set of the current structure.
+ *
+ * @param   Stream      SMBIOS output stream
+ * @param   StringCount Strings in the set
+ */
+static
+void
+SmbiosStreamEndStrings (
+  SMBIOS_STREAM  *Stream,
+  uint8_t        StringCount
+  )
+{
+  // A structure without strings ends with two NULs
+  SmbiosStreamReserve (Stream, (StringCount == 0) ? 2 : 1);
+}
+
+/**
+ * SmbiosMemManufacturer
+ *
+ * @brief   Name the module manufacturer of a DIMM.
+ *
+ * @param   ManufacturerId  JEP106 ID from the SPD
+ * @param   Buffer          Five characters, receives the ID in hex when the manufacturer is not known
+ *
+ * @return  The manufacturer name, the ID in hex, or an empty string when there is no ID.
+ */
+static
+const char *
+SmbiosMemManufacturer (
+  uint16_t  ManufacturerId,
+  char      *Buffer
+  )
+{
+  uint32_t  Index;
+
+  Buffer[0] = '\0';
+  if (ManufacturerId == 0) {
+    return Buffer;
+  }
+  for (Index = 0; Index < sizeof (MemManufacturerTable) / sizeof (MemManufacturerTable[0]); Index++) {
+    if (MemManufacturerTable[Index].Id == (ManufacturerId & MEM_MANUFACTURER_ID_PARITY_MASK)) {
+      return MemManufacturerTable[Index].Name;
+    }
+  }
+  // Continuation code byte first, as JEP106 IDs are usually written
+  IntToString (Buffer, (uint8_t *)&ManufacturerId, sizeof (ManufacturerId));
+  return Buffer;
+}
+
+/**
+ * SmbiosStreamType17
+ *
+ * @brief   Write the SMBIOS Type 17 structure of a physical DIMM.
+ *
+ * @param   Stream      SMBIOS output stream
+ * @param   T17         Decoded DIMM information
+ * @param   Handle      Handle of the structure
+ * @param   ArrayHandle Handle of the Type 16 structure
+ */
+static
+void
+SmbiosStreamType17 (
+  SMBIOS_STREAM        *Stream,
+  SIL_TYPE17_DMI_INFO  *T17,
+  uint16_t             Handle,
+  uint16_t             ArrayHandle
+  )
+{
+  SMBIOS_TABLE_TYPE17  *Record;
+  char                 ManufacturerId[2 * sizeof (uint16_t) + 1];
+  uint8_t              StringCount;
+  uint8_t              DeviceLocator;
+  uint8_t              Manufacturer;
+  uint8_t              BankLocator;
+  uint8_t              SerialNumber;
+  uint8_t              PartNumber;
+  uint8_t              FirmwareVersion;
+
+  Record = SmbiosStreamReserve (Stream, sizeof (SMBIOS_TABLE_TYPE17));
+  StringCount = 0;
+  DeviceLocator = SmbiosStreamAddString (Stream, T17->DeviceLocator, &StringCount);
+  BankLocator = SmbiosStreamAddString (Stream, T17->BankLocator, &StringCount);
+  Manufacturer = SmbiosStreamAddString (Stream,
+                   SmbiosMemManufacturer ((uint16_t)T17->ManufacturerIdCode, ManufacturerId), &StringCount);
+  SerialNumber = SmbiosStreamAddString (Stream, T17->SerialNumber, &StringCount);
+  PartNumber = SmbiosStreamAddString (Stream, T17->PartNumber, &StringCount);
+  T17->FirmwareVersion[sizeof (T17->FirmwareVersion) - 1] = '\0';
+  FirmwareVersion = SmbiosStreamAddString (Stream, T17->FirmwareVersion, &StringCount);
+  SmbiosStreamEndStrings (Stream, StringCount);
+
+  if (Record == NULL) {
+    return;
+  }
+  Record->Hdr.Type = SMBIOS_TYPE_MEMORY_DEVICE;
+  Record->Hdr.Length = sizeof (SMBIOS_TABLE_TYPE17);
+  Record->Hdr.Handle = Handle;
+  Record->MemoryArrayHandle = ArrayHandle;
+  Record->MemoryErrorInformationHandle = SMBIOS_HANDLE_NONE;
+  Record->TotalWidth = T17->TotalWidth;
+  Record->DataWidth = T17->DataWidth;
+  Record->Size = T17->MemorySize;
+  Record->FormFactor = (uint8_t)T17->FormFactor;
+  Record->DeviceSet = T17->DeviceSet;
+  Record->DeviceLocator = DeviceLocator;
+  Record->BankLocator = BankLocator;
+  Record->MemoryType = (uint8_t)T17->MemoryType;
+  memcpy (&Record->TypeDetail, &T17->TypeDetail, sizeof (Record->TypeDetail));
+  Record->Speed = T17->Speed;
+  Record->Manufacturer = Manufacturer;
+  Record->SerialNumber = SerialNumber;
+  Record->PartNumber = PartNumber;
+  Record->Attributes = T17->Attributes;
+  Record->ExtendedSize = T17->ExtSize;
+  Record->ConfiguredMemoryClockSpeed = T17->ConfigSpeed;
+  Record->MinimumVoltage = T17->MinimumVoltage;
+  Record->MaximumVoltage = T17->MaximumVoltage;
+  Record->ConfiguredVoltage = T17->ConfiguredVoltage;
+  Record->MemoryTechnology = T17->MemoryTechnology;
+  Record->MemoryOperatingModeCapability = T17->MemoryOperatingModeCapability.AsUint16;
+  Record->FirmwareVersion = FirmwareVersion;
+  Record->ModuleManufacturerId = T17->ModuleManufacturerId;
+  Record->ModuleProductId = T17->ModuleProductId;
+  Record->MemorySubsystemControllerManufacturerId = T17->MemorySubsystemControllerManufacturerId;
+  Record->MemorySubsystemControllerProductId = T17->MemorySubsystemControllerProductId;
+  Record->NonVolatileSize = T17->NonvolatileSize;
+  Record->VolatileSize = T17->VolatileSize;
+  Record->CacheSize = T17->CacheSize;
+  Record->LogicalSize = T17->LogicalSize;
+  Record->ExtendedSpeed = T17->ExtendedSpeed;
+  Record->ExtendedConfiguredMemorySpeed = T17->ExtendedConfiguredMemorySpeed;
+}
+
+/**
+ * xPrfBuildSmbiosMemTables
+ *
+ * @details    This routine writes the SMBIOS Type 16, Type 17, Type 19 and
+ *             Type 20 structures, with their string sets, directly into a Host
+ *             buffer in one pass over the APOB DMI records.
+ *
+ *             Handles are assigned from FirstHandle in this order: Type 16,
+ *             one Type 17 per physical DIMM, Type 19, one Type 20 per logical
+ *             DIMM. A NULL Buffer, or one that is too small, only sizes the
+ *             tables.
+ *
+ * @param      Buffer       Host buffer for the structures, may be NULL
+ * @param      BufferSize   On input, the size of Buffer.
+ *                          On output, the size of the structures.
+ * @param      FirstHandle  Handle of the Type 16 structure
+ *
+ * @retval     SilPass              The structures were written
+ * @retval     SilOutOfBounds       Buffer is too small, BufferSize holds the size needed
+ * @retval     SilInvalidParameter  BufferSize is NULL
+ * @retval     SilNotFound          The APOB DMI records were not found
+ */
+SIL_STATUS
+xPrfBuildSmbiosMemTables (
+  void      *Buffer,
+  uint32_t  *BufferSize,
+  uint16_t  FirstHandle
+  )
+{
+  SIL_STATUS                   Status;
+  SMBIOS_STREAM                Stream;
+  SMBIOS_TABLE_TYPE16          *T16Record;
+  SMBIOS_TABLE_TYPE19          *T19Record;
+  SMBIOS_TABLE_TYPE20          *T20Record;
+  SIL_TYPE17_DMI_INFO          T17;
+  SIL_TYPE20_DMI_INFO          T20;
+  APOB_MEM_DMI_HEADER          *ApobMemDmiHeader;
+  APOB_MEM_DMI_PHYSICAL_DIMM   *FirstPhysicalDimm;
+  APOB_MEM_DMI_PHYSICAL_DIMM   *PhysicalDimm;
+  APOB_MEM_DMI_LOGICAL_DIMM    *LogicalDimm;
+  APOB_TYPE_HEADER             *ApobSmbiosInfo;
+  uint16_t                     DimmIndex;
+  uint16_t                     DeviceIndex;
+  uint16_t                     T19Handle;
+  uint8_t                      MaxPhysicalDimms;
+  uint8_t                      MaxLogicalDimms;
+  uint8_t                      TranslatedChannel;
+  uint8_t                      NumActiveDimms;
+  uint64_t                     TotalMemSize;
+  uint64_t                     EndingAddr;
+
+  if (BufferSize == NULL) {
+    return SilInvalidParameter;
+  }
+
+  Status = AmdGetApobEntryInstance (APOB_SMBIOS, APOB_MEM_SMBIOS_TYPE, 0, 0, &ApobSmbiosInfo);
+  if ((Status != SilPass) || (ApobSmbiosInfo == NULL)) {
+    return SilNotFound;
+  }
+  ApobMemDmiHeader = (APOB_MEM_DMI_HEADER *)ApobSmbiosInfo;
+  MaxPhysicalDimms = ApobMemDmiHeader->MaxPhysicalDimms;
+  MaxLogicalDimms = ApobMemDmiHeader->MaxLogicalDimms;
+  FirstPhysicalDimm = (APOB_MEM_DMI_PHYSICAL_DIMM *)&ApobMemDmiHeader[1];
+  T19Handle = FirstHandle + 1 + MaxPhysicalDimms;
+
+  Stream.Buffer = (uint8_t *)Buffer;
+  Stream.BufferSize = *BufferSize;
+  Stream.Offset = 0;
+
+  // Type 16, the capacity is patched once the DIMMs are sized
+  T16Record = SmbiosStreamReserve (&Stream, sizeof (SMBIOS_TABLE_TYPE16));
+  SmbiosStreamEndStrings (&Stream, 0);
+
+  // Type 17, one per physical DIMM
+  TotalMemSize = 0;
+  NumActiveDimms = 0;
+  PhysicalDimm = FirstPhysicalDimm;
+  for (DimmIndex = 0; DimmIndex < MaxPhysicalDimms; DimmIndex++, PhysicalDimm++) {
+    TranslateChannelInfo (PhysicalDimm->Channel, &TranslatedChannel, Sp5ChannelXlatTable);
+    memset (&T17, 0, sizeof (T17));
+    if (GetPhysicalDimmInfoD5 (&T17, PhysicalDimm, TranslatedChannel)) {
+      NumActiveDimms++;
+    }
+    TotalMemSize += (T17.MemorySize != 0x7FFF) ? T17.MemorySize : T17.ExtSize;
+    SmbiosStreamType17 (&Stream, &T17, FirstHandle + 1 + DimmIndex, FirstHandle);
+  }
+
+  // Type 19, the memory array as a whole
+  T19Record = SmbiosStreamReserve (&Stream, sizeof (SMBIOS_TABLE_TYPE19));
+  SmbiosStreamEndStrings (&Stream, 0);
+  if (T19Record != NULL) {
+    T19Record->Hdr.Type = SMBIOS_TYPE_MEMORY_ARRAY_MAPPED_ADDRESS;
+    T19Record->Hdr.Length = sizeof (SMBIOS_TABLE_TYPE19);
+    T19Record->Hdr.Handle = T19Handle;
+    T19Record->MemoryArrayHandle = FirstHandle;
+    T19Record->PartitionWidth = NumActiveDimms;
+    EndingAddr = (TotalMemSize << 10) - 1;   // In KByte
+    if (EndingAddr >= 0xFFFFFFFF) {
+      T19Record->StartingAddress = 0xFFFFFFFF;
+      T19Record->EndingAddress = 0xFFFFFFFF;
+      T19Record->ExtendedEndingAddress = (EndingAddr << 10) | 0x3FF;
+    } else {
+      T19Record->EndingAddress = (uint32_t)EndingAddr;
+    }
+  }
+
+  // Type 20, one per logical DIMM
+  LogicalDimm = (APOB_MEM_DMI_LOGICAL_DIMM *)PhysicalDimm;
+  for (DimmIndex = 0; DimmIndex < MaxLogicalDimms; DimmIndex++, LogicalDimm++) {
+    T20Record = SmbiosStreamReserve (&Stream, sizeof (SMBIOS_TABLE_TYPE20));
+    SmbiosStreamEndStrings (&Stream, 0);
+    if (T20Record == NULL) {
+      continue;
+    }
+    memset (&T20, 0, sizeof (T20));
+    GetLogicalDimmInfo (&T20, LogicalDimm);
+
+    // Refer to the Type 17 handle of the same DIMM
+    T20Record->MemoryDeviceHandle = SMBIOS_HANDLE_NONE;
+    PhysicalDimm = FirstPhysicalDimm;
+    for (DeviceIndex = 0; DeviceIndex < MaxPhysicalDimms; DeviceIndex++, PhysicalDimm++) {
+      if ((PhysicalDimm->Socket == LogicalDimm->Socket) && (PhysicalDimm->Channel == LogicalDimm->Channel) &&
+          (PhysicalDimm->Dimm == LogicalDimm->Dimm)) {
+        T20Record->MemoryDeviceHandle = FirstHandle + 1 + DeviceIndex;
+        break;
+      }
+    }
+    T20Record->Hdr.Type = SMBIOS_TYPE_MEMORY_DEVICE_MAPPED_ADDRESS;
+    T20Record->Hdr.Length = sizeof (SMBIOS_TABLE_TYPE20);
+    T20Record->Hdr.Handle = T19Handle + 1 + DimmIndex;
+    T20Record->StartingAddress = T20.StartingAddr;
+    T20Record->EndingAddress = T20.EndingAddr;
+    T20Record->MemoryArrayMappedAddressHandle = T19Handle;
+    T20Record->PartitionRowPosition = T20.PartitionRowPosition;
+    T20Record->InterleavePosition = T20.InterleavePosition;
+    T20Record->InterleavedDataDepth = T20.InterleavedDataDepth;
+    T20Record->ExtendedStartingAddress = T20.ExtStartingAddr;
+    T20Record->ExtendedEndingAddress = T20.ExtEndingAddr;
+  }
+
+  if (T16Record != NULL) {
+    T16Record->Hdr.Type = SMBIOS_TYPE_PHYSICAL_MEMORY_ARRAY;
+    T16Record->Hdr.Length = sizeof (SMBIOS_TABLE_TYPE16);
+    T16Record->Hdr.Handle = FirstHandle;
+    T16Record->Location = 0x03;
+    T16Record->Use = 0x03;
+    T16Record->MemoryErrorCorrection = (ApobMemDmiHeader->EccCapable != 0) ?
+                                       Dmi16MultiBitEcc : Dmi16NoneErrCorrection;
+    T16Record->MemoryErrorInformationHandle = SMBIOS_HANDLE_NONE;
+    T16Record->NumberOfMemoryDevices = MaxPhysicalDimms;
+    // TotalMemSize is in MB, MaximumCapacity in KB
+    if ((TotalMemSize << 10) < SMBIOS_T16_CAPACITY_EXTENDED) {
+      T16Record->MaximumCapacity = (uint32_t)(TotalMemSize << 10);
+    } else {
+      T16Record->MaximumCapacity = SMBIOS_T16_CAPACITY_EXTENDED;
+      T16Record->ExtendedMaximumCapacity = TotalMemSize << 20;
+    }
+  }
+
+  if ((Buffer == NULL) || (Stream.Offset > *BufferSize)) {
+    *BufferSize = Stream.Offset;
+    return SilOutOfBounds;
+  }
+  *BufferSize = Stream.Offset;
+  return SilPass;
+}
+
 /**
  * GetDimmPresence
  *
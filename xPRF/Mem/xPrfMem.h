@@ -13,6 +13,26 @@
 
 #define SPD_BUFFER_SIZE        1024
 
+// FCH SMBus host controller registers, offsets from the SMBus IO base
+#define FCH_SMBUS_STATUS            0x00
+#define FCH_SMBUS_CONTROL           0x02
+#define FCH_SMBUS_HOST_CMD          0x03
+#define FCH_SMBUS_ADDRESS           0x04
+#define FCH_SMBUS_DATA0             0x05
+
+#define FCH_SMBUS_STS_HOST_BUSY     0x01
+#define FCH_SMBUS_STS_DONE          0x02
+#define FCH_SMBUS_STS_ERROR         0x1C  ///< Device error, bus collision, failed
+#define FCH_SMBUS_STS_ALL           0x1F
+#define FCH_SMBUS_CTL_BYTE_DATA     0x08  ///< Read/write byte data protocol
+#define FCH_SMBUS_CTL_START         0x40
+#define FCH_SMBUS_POLL_COUNT        100000
+
+// SPD5 hub legacy mode: MR11 selects a 128 byte NVM page, NVM offsets have bit 7 set
+#define SPD5_MR11_PAGE              0x0B
+#define SPD5_NVM_ACCESS             0x80
+#define SPD5_PAGE_SIZE              128
+
 /**
  * @brief Host to APCB Channel Translation structure
  */
@@ -21,6 +41,112 @@ typedef struct _HOST_TO_APCB_CHANNEL_XLAT {
   uint8_t   TranslatedChannelId;  ///< Translated Channel ID
 } HOST_TO_APCB_CHANNEL_XLAT;
 
+/**
+ * @brief Output position of the SMBIOS memory table generator
+ * @details Offset keeps counting past BufferSize so that the required size is known after one pass
+ */
+typedef struct {
+  uint8_t   *Buffer;      ///< Host buffer, NULL to only size the tables
+  uint32_t  BufferSize;   ///< Size of Buffer
+  uint32_t  Offset;       ///< Bytes generated so far
+} SMBIOS_STREAM;
+
+#define SMBIOS_TYPE_PHYSICAL_MEMORY_ARRAY         16
+#define SMBIOS_TYPE_MEMORY_DEVICE                 17
+#define SMBIOS_TYPE_MEMORY_ARRAY_MAPPED_ADDRESS   19
+#define SMBIOS_TYPE_MEMORY_DEVICE_MAPPED_ADDRESS  20
+
+#define SMBIOS_HANDLE_NONE                        0xFFFE  ///< No error information structure
+#define SMBIOS_T16_CAPACITY_EXTENDED              0x80000000
+
+#pragma pack (push, 1)
+
+/// SMBIOS structure header
+typedef struct {
+  uint8_t   Type;
+  uint8_t   Length;     ///< Length of the formatted area
+  uint16_t  Handle;
+} SMBIOS_HEADER;
+
+/// SMBIOS Type 16 - Physical Memory Array, formatted area
+typedef struct {
+  SMBIOS_HEADER Hdr;
+  uint8_t       Location;
+  uint8_t       Use;
+  uint8_t       MemoryErrorCorrection;
+  uint32_t      MaximumCapacity;            ///< KB, SMBIOS_T16_CAPACITY_EXTENDED to use ExtendedMaximumCapacity
+  uint16_t      MemoryErrorInformationHandle;
+  uint16_t      NumberOfMemoryDevices;
+  uint64_t      ExtendedMaximumCapacity;    ///< Bytes
+} SMBIOS_TABLE_TYPE16;
+
+/// SMBIOS Type 17 - Memory Device (SMBIOS 3.3), formatted area
+typedef struct {
+  SMBIOS_HEADER Hdr;
+  uint16_t      MemoryArrayHandle;
+  uint16_t      MemoryErrorInformationHandle;
+  uint16_t      TotalWidth;
+  uint16_t      DataWidth;
+  uint16_t      Size;
+  uint8_t       FormFactor;
+  uint8_t       DeviceSet;
+  uint8_t       DeviceLocator;              ///< String number
+  uint8_t       BankLocator;                ///< String number
+  uint8_t       MemoryType;
+  uint16_t      TypeDetail;
+  uint16_t      Speed;
+  uint8_t       Manufacturer;               ///< String number
+  uint8_t       SerialNumber;               ///< String number
+  uint8_t       AssetTag;                   ///< String number
+  uint8_t       PartNumber;                 ///< String number
+  uint8_t       Attributes;
+  uint32_t      ExtendedSize;
+  uint16_t      ConfiguredMemoryClockSpeed;
+  uint16_t      MinimumVoltage;
+  uint16_t      MaximumVoltage;
+  uint16_t      ConfiguredVoltage;
+  uint8_t       MemoryTechnology;
+  uint16_t      MemoryOperatingModeCapability;
+  uint8_t       FirmwareVersion;            ///< String number
+  uint16_t      ModuleManufacturerId;
+  uint16_t      ModuleProductId;
+  uint16_t      MemorySubsystemControllerManufacturerId;
+  uint16_t      MemorySubsystemControllerProductId;
+  uint64_t      NonVolatileSize;
+  uint64_t      VolatileSize;
+  uint64_t      CacheSize;
+  uint64_t      LogicalSize;
+  uint32_t      ExtendedSpeed;
+  uint32_t      ExtendedConfiguredMemorySpeed;
+} SMBIOS_TABLE_TYPE17;
+
+/// SMBIOS Type 19 - Memory Array Mapped Address, formatted area
+typedef struct {
+  SMBIOS_HEADER Hdr;
+  uint32_t      StartingAddress;
+  uint32_t      EndingAddress;
+  uint16_t      MemoryArrayHandle;
+  uint8_t       PartitionWidth;
+  uint64_t      ExtendedStartingAddress;
+  uint64_t      ExtendedEndingAddress;
+} SMBIOS_TABLE_TYPE19;
+
+/// SMBIOS Type 20 - Memory Device Mapped Address, formatted area
+typedef struct {
+  SMBIOS_HEADER Hdr;
+  uint32_t      StartingAddress;
+  uint32_t      EndingAddress;
+  uint16_t      MemoryDeviceHandle;
+  uint16_t      MemoryArrayMappedAddressHandle;
+  uint8_t       PartitionRowPosition;
+  uint8_t       InterleavePosition;
+  uint8_t       InterleavedDataDepth;
+  uint64_t      ExtendedStartingAddress;
+  uint64_t      ExtendedEndingAddress;
+} SMBIOS_TABLE_TYPE20;
+
+#pragma pack (pop)
+
 /**
  * @brief Structure defining Memory ticks
  * @details This provides the memory clock to tick ps value relationship, to be tabulated for reference
@@ -111,41 +237,6 @@ const MEM_TCK_ENTRY MemFreqToTckTable[] = {
   {4400, 227}
 };
 
-uint8_t MemSpdDdr4[] = {
-  0x23, 0x06, 0x0c, 0x02, 0x84, 0x19, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x09, 0x03, 0x00, 0x00,
-  0x00, 0x00, 0x08, 0x0c, 0xf4, 0x1b, 0x00, 0x00, 0x6c, 0x6c, 0x6c, 0x11, 0x08, 0x74, 0x20, 0x08,
-  0x00, 0x05, 0x70, 0x03, 0x00, 0xa8, 0x1e, 0x2b, 0x2b, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x16, 0x36, 0x16, 0x36,
-  0x16, 0x36, 0x16, 0x36, 0x00, 0x20, 0x2b, 0x0c, 0x2b, 0x0c, 0x2b, 0x0c, 0x2b, 0x0c, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0xec, 0xb5, 0xce, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc2, 0x9e, 0x65,
-  0x11, 0x11, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xde, 0x27,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x80, 0x2c, 0x01, 0x13, 0x24, 0xb1, 0xff, 0x42, 0xc5, 0x31, 0x36, 0x41, 0x54, 0x46, 0x31, 0x47,
-  0x36, 0x34, 0x41, 0x5a, 0x2d, 0x32, 0x47, 0x31, 0x41, 0x59, 0x20, 0x20, 0x20, 0x59, 0x80, 0x2c,
-  0x41, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3c, 0x69,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-};
-
 HOST_TO_APCB_CHANNEL_XLAT Sp5ChannelXlatTable[] = {
   // Requested   Translated
   { 0,          2 },
@@ -162,3 +253,24 @@ HOST_TO_APCB_CHANNEL_XLAT Sp5ChannelXlatTable[] = {
   { 11,         9 },
   { 0xFF,       0xFF},
 };
+
+/**
+ * @brief Structure defining a DIMM module manufacturer
+ * @details JEP106 ID as held in the SPD, continuation code count in the low byte without the parity bit
+ */
+typedef struct _MEM_MANUFACTURER_ENTRY {
+  uint16_t    Id;   ///< JEP106 ID, parity bit masked
+  const char  *Name; ///< Manufacturer name
+} MEM_MANUFACTURER_ENTRY;
+
+#define MEM_MANUFACTURER_ID_PARITY_MASK   0xFF7F    ///< Strips the odd parity bit of the continuation count
+
+const MEM_MANUFACTURER_ENTRY MemManufacturerTable[] = {
+  // Id       Name
+  { 0xCE00,   "Samsung"       },
+  { 0x2C00,   "Micron"        },
+  { 0xAD00,   "SK Hynix"      },
+  { 0x9801,   "Kingston"      },
+  { 0x9401,   "Smart Modular" },
+  { 0x0B03,   "Nanya"         },
+};
@@ -0,0 +1,407 @@
+/**
+ * @file  xPrfMemFill.c
+ * @brief Platform Reference Firmware - NUMA aware parallel memory fill on the
+ *        parked APs.
+ */
+/* Copyright 2023 Advanced Micro Devices, Inc. All rights reserved.    */
+// SPDX-License-Identifier: MIT
+
+#include <SilCommon.h>
+#include <xPRF-api.h>
+#include <MsrReg.h>
+#include <CcxIp2Ip.h>
+#include <DF/DfIp2Ip.h>
+#include <CommonLib/CpuLib.h>
+#include <CommonLib/SpinLock.h>
+#include <string.h>
+
+// Bytes a thread fills between two claims, small enough to balance the threads of a domain
+#define MEM_FILL_CHUNK_SIZE     0x200000ull
+
+// Ranges must be aligned on the 64 bytes written by each xUslFillMemNonTemporal iteration
+#define MEM_FILL_ALIGN_MASK     0x3Full
+
+#define MEM_FILL_MAX_PIECES     SIL_MEMORY_RANGE_MAX
+
+/// Part of a requested range located in the memory of one domain
+typedef struct {
+  uint64_t  Base;
+  uint64_t  Size;
+  uint32_t  Domain;
+  uint32_t  NextChunk;          ///< Next chunk to claim, under the lock of the domain
+} MEM_FILL_PIECE;
+
+/// State shared by all threads filling memory
+typedef struct {
+  MEM_FILL_PIECE          Piece[MEM_FILL_MAX_PIECES];
+  uint32_t                PieceCount;
+  uint32_t                DomainCount;                              ///< Domains, one per socket
+  uint64_t                DomainBytes[SIL_MEMORY_FILL_MAX_DOMAINS]; ///< Bytes to fill per domain
+  uint32_t                DomainAps[SIL_MEMORY_FILL_MAX_DOMAINS];   ///< APs started on each domain
+  XUSL_SPIN_LOCK          Lock[SIL_MEMORY_FILL_MAX_DOMAINS];        ///< Serializes the claims and stats of a domain
+  uint64_t                Pattern;
+  uint64_t                StartTsc;                                 ///< TSC when the fill started
+  SIL_MEMORY_FILL_STATS   *Stats;                                   ///< Statistics reported to the Host
+} MEM_FILL_CONTEXT;
+
+/// Argument of the AP procedure, one per domain
+typedef struct {
+  MEM_FILL_CONTEXT        *Fill;
+  uint32_t                Domain;
+} MEM_FILL_DOMAIN_CONTEXT;
+
+static MEM_FILL_CONTEXT         mMemFill;
+static MEM_FILL_DOMAIN_CONTEXT  mMemFillDomain[SIL_MEMORY_FILL_MAX_DOMAINS];
+
+/*
+ * MemFillAddPiece
+ *
+ * @brief   Add a piece to fill, merging it with the previous one if they are
+ *          adjacent and in the same domain.
+ *
+ * @retval  SilPass             Piece added or merged
+ * @retval  SilOutOfResources   Too many pieces
+ */
+static
+SIL_STATUS
+MemFillAddPiece (
+  MEM_FILL_CONTEXT  *Fill,
+  uint64_t          Base,
+  uint64_t          Size,
+  uint32_t          Domain
+  )
+{
+  MEM_FILL_PIECE  *Piece;
+
+  if (Fill->PieceCount != 0) {
+    Piece = &Fill->Piece[Fill->PieceCount - 1];
+    if ((Piece->Base + Piece->Size == Base) && (Piece->Domain == Domain)) {
+      Piece->Size += Size;
+      Fill->DomainBytes[Domain] += Size;
+      return SilPass;
+    }
+  }
+
+  if (Fill->PieceCount >= MEM_FILL_MAX_PIECES) {
+    return SilOutOfResources;
+  }
+
+  Piece = &Fill->Piece[Fill->PieceCount++];
+  Piece->Base = Base;
+  Piece->Size = Size;
+  Piece->Domain = Domain;
+  Piece->NextChunk = 0;
+  Fill->DomainBytes[Domain] += Size;
+
+  return SilPass;
+}
+
+/*
+ * MemFillPartition
+ *
+ * @brief   Split a requested range by domain along the memory range map.
+ *
+ * @details Ranges without a domain go to domain 0.
+ *
+ * @retval  SilPass             The range is split
+ * @retval  SilInvalidParameter The range is not aligned or not backed by memory
+ * @retval  SilOutOfBounds      The range is not addressable in this build
+ * @retval  SilOutOfResources   Too many pieces
+ */
+static
+SIL_STATUS
+MemFillPartition (
+  MEM_FILL_CONTEXT             *Fill,
+  const SIL_MEMORY_RANGE       *RangeMap,
+  uint32_t                     RangeCount,
+  const SIL_MEMORY_FILL_RANGE  *Range
+  )
+{
+  SIL_STATUS  Status;
+  uint32_t    Index;
+  uint64_t    Base;
+  uint64_t    Limit;
+  uint64_t    MapLimit;
+
+  if (((Range->Base | Range->Size) & MEM_FILL_ALIGN_MASK) != 0) {
+    return SilInvalidParameter;
+  }
+  if (Range->Size == 0) {
+    return SilPass;
+  }
+  Base = Range->Base;
+  Limit = Range->Base + Range->Size;
+  if (Limit < Base) {
+    return SilInvalidParameter;
+  }
+  if ((Limit - 1) > UINTPTR_MAX) {
+    return SilOutOfBounds;
+  }
+
+  for (Index = 0; (Index < RangeCount) && (Base < Limit); Index++) {
+    MapLimit = RangeMap[Index].Base + RangeMap[Index].Size;
+    if (MapLimit <= Base) {
+      continue;
+    }
+    if ((RangeMap[Index].Base > Base) ||
+        (RangeMap[Index].Type == SilMemRangeMmio) ||
+        (RangeMap[Index].Type == SilMemRangePcieConfig)) {
+      return SilInvalidParameter;
+    }
+    if (MapLimit > Limit) {
+      MapLimit = Limit;
+    }
+    Status = MemFillAddPiece (Fill, Base, MapLimit - Base,
+                              (RangeMap[Index].Domain < Fill->DomainCount) ? RangeMap[Index].Domain : 0);
+    if (Status != SilPass) {
+      return Status;
+    }
+    Base = MapLimit;
+  }
+
+  return (Base < Limit) ? SilInvalidParameter : SilPass;
+}
+
+/*
+ * MemFillDomain
+ *
+ * @brief   Claim and fill chunks of the memory of a domain until none is left.
+ *
+ * @param   Fill    Shared state
+ * @param   Domain  Domain whose memory is filled
+ */
+static
+void
+MemFillDomain (
+  MEM_FILL_CONTEXT  *Fill,
+  uint32_t          Domain
+  )
+{
+  MEM_FILL_PIECE                *Piece;
+  SIL_MEMORY_FILL_DOMAIN_STATS  *Stats;
+  uint32_t                      Index;
+  uint32_t                      Chunk;
+  uint32_t                      ChunkCount;
+  uint64_t                      Offset;
+  uint64_t                      Length;
+
+  Stats = &Fill->Stats->Domain[Domain];
+  ChunkCount = 0;
+
+  for (Index = 0; Index < Fill->PieceCount; Index++) {
+    Piece = &Fill->Piece[Index];
+    if (Piece->Domain != Domain) {
+      continue;
+    }
+    for (;;) {
+      xUslAcquireSpinLock (&Fill->Lock[Domain]);
+      Chunk = Piece->NextChunk;
+      Offset = (uint64_t) Chunk * MEM_FILL_CHUNK_SIZE;
+      if (Offset < Piece->Size) {
+        Piece->NextChunk = Chunk + 1;
+      }
+      xUslReleaseSpinLock (&Fill->Lock[Domain]);
+      if (Offset >= Piece->Size) {
+        break;
+      }
+
+      Length = Piece->Size - Offset;
+      if (Length > MEM_FILL_CHUNK_SIZE) {
+        Length = MEM_FILL_CHUNK_SIZE;
+      }
+      xUslFillMemNonTemporal ((void *)(uintptr_t) (Piece->Base + Offset), Length, Fill->Pattern);
+      ChunkCount++;
+
+      xUslAcquireSpinLock (&Fill->Lock[Domain]);
+      Stats->Bytes += Length;
+      if (Stats->Bytes == Fill->DomainBytes[Domain]) {
+        Stats->ElapsedTsc = xUslRdMsr (MSR_TSC) - Fill->StartTsc;
+        Stats->Complete = true;
+      }
+      xUslReleaseSpinLock (&Fill->Lock[Domain]);
+    }
+  }
+
+  if (ChunkCount != 0) {
+    xUslAcquireSpinLock (&Fill->Lock[Domain]);
+    Stats->ThreadCount++;
+    xUslReleaseSpinLock (&Fill->Lock[Domain]);
+  }
+}
+
+/*
+ * MemFillApProcedure
+ *
+ * @brief   CCX_AP_PROCEDURE filling the memory of the domain of the AP.
+ *
+ * @param   Context   MEM_FILL_DOMAIN_CONTEXT of the domain
+ *
+ * @retval  SilPass
+ */
+static
+SIL_STATUS
+MemFillApProcedure (
+  void  *Context
+  )
+{
+  MEM_FILL_DOMAIN_CONTEXT  *DomainContext;
+
+  DomainContext = (MEM_FILL_DOMAIN_CONTEXT *) Context;
+  MemFillDomain (DomainContext->Fill, DomainContext->Domain);
+
+  return SilPass;
+}
+
+/*
+ * MemFillGetApicDomain
+ *
+ * @brief   Domain of a local APIC ID.
+ *
+ * @details Domains follow the sockets. The socket is the top field of the
+ *          APIC ID, so it is the last one whose first APIC ID is not above
+ *          ApicId.
+ */
+static
+uint32_t
+MemFillGetApicDomain (
+  CCX_IP2IP_API  *CcxIp2IpApi,
+  uint32_t       DomainCount,
+  uint32_t       ApicId
+  )
+{
+  uint32_t  Socket;
+
+  for (Socket = DomainCount - 1; Socket > 0; Socket--) {
+    if (ApicId >= CcxIp2IpApi->CalcLocalApic (Socket, 0, 0, 0, 0, 0)) {
+      break;
+    }
+  }
+  return Socket;
+}
+
+/**
+ * xPrfFillMemory
+ *
+ * @brief   Fill physical memory with a pattern in parallel on the parked APs
+ *
+ * @details Each parked AP is started on the memory of its domain; the BSP
+ *          fills the memory of its own domain, then that of the domains no
+ *          AP could be started on.
+ *
+ * @param[in]  Ranges       Physical ranges to fill
+ * @param[in]  RangeCount   Number of ranges
+ * @param[in]  Pattern      64 bit pattern written to every 8 bytes
+ * @param[out] Stats        Bytes, elapsed TSC ticks and completion per NUMA domain
+ *
+ * @retval SilPass              The ranges are filled.
+ * @retval SilInvalidParameter  NULL pointer, a range is not 64 byte aligned or
+ *                              is not backed by memory.
+ * @retval SilOutOfResources    The ranges split in too many pieces.
+ * @retval SilOutOfBounds       A range is not addressable in this build.
+ * @retval Others               Failure to build the memory range map.
+ **/
+SIL_STATUS
+xPrfFillMemory (
+  const SIL_MEMORY_FILL_RANGE  *Ranges,
+  uint32_t                     RangeCount,
+  uint64_t                     Pattern,
+  SIL_MEMORY_FILL_STATS        *Stats
+  )
+{
+  MEM_FILL_CONTEXT        *Fill;
+  CCX_IP2IP_API           *CcxIp2IpApi;
+  DF_IP2IP_API            *DfIp2IpApi;
+  const SIL_MEMORY_RANGE  *RangeMap;
+  uint32_t                MapCount;
+  SIL_STATUS              Status;
+  SIL_STATUS              ApStatus;
+  uint32_t                Index;
+  uint32_t                Domain;
+  uint32_t                ApicId;
+  uint32_t                ApCount;
+  uint32_t                Started;
+  uint32_t                BspDomain;
+
+  if ((Ranges == NULL) || (Stats == NULL)) {
+    return SilInvalidParameter;
+  }
+  if ((SilGetIp2IpApi (SilId_CcxClass, (void **)(&CcxIp2IpApi)) != SilPass) ||
+      (SilGetIp2IpApi (SilId_DfClass, (void **)(&DfIp2IpApi)) != SilPass)) {
+    return SilNotFound;
+  }
+
+  Status = xPrfGetMemoryRangeMap (&RangeMap, &MapCount);
+  if (Status != SilPass) {
+    return Status;
+  }
+
+  Fill = &mMemFill;
+  memset (Fill, 0, sizeof (MEM_FILL_CONTEXT));
+  memset (Stats, 0, sizeof (SIL_MEMORY_FILL_STATS));
+  Fill->Pattern = Pattern;
+  Fill->Stats = Stats;
+
+  DfIp2IpApi->DfGetSystemInfo (&Fill->DomainCount, NULL, NULL, NULL, NULL);
+  if ((Fill->DomainCount == 0) || (Fill->DomainCount > SIL_MEMORY_FILL_MAX_DOMAINS)) {
+    Fill->DomainCount = SIL_MEMORY_FILL_MAX_DOMAINS;
+  }
+
+  // Nothing is written before every range has been checked
+  for (Index = 0; Index < RangeCount; Index++) {
+    Status = MemFillPartition (Fill, RangeMap, MapCount, &Ranges[Index]);
+    if (Status != SilPass) {
+      XPRF_TRACEPOINT (SIL_TRACE_ERROR, "Memory fill range 0x%llx size 0x%llx rejected\n",
+                       Ranges[Index].Base, Ranges[Index].Size);
+      return Status;
+    }
+  }
+
+  for (Domain = 0; Domain < Fill->DomainCount; Domain++) {
+    mMemFillDomain[Domain].Fill = Fill;
+    mMemFillDomain[Domain].Domain = Domain;
+    Stats->Domain[Domain].Complete = (Fill->DomainBytes[Domain] == 0);
+  }
+
+  Fill->StartTsc = xUslRdMsr (MSR_TSC);
+
+  // Start every parked AP on its own domain, none of them is running a procedure yet
+  Started = 0;
+  ApCount = CcxIp2IpApi->MpGetNumberOfAps ();
+  for (Index = 0; Index < ApCount; Index++) {
+    if (CcxIp2IpApi->MpGetApStatus (Index, &ApicId, &ApStatus) != SilPass) {
+      continue;
+    }
+    Domain = MemFillGetApicDomain (CcxIp2IpApi, Fill->DomainCount, ApicId);
+    if (Fill->DomainBytes[Domain] == 0) {
+      continue;
+    }
+    if (CcxIp2IpApi->MpStartupAps (CcxMpTargetApicId, ApicId, MemFillApProcedure,
+                                   &mMemFillDomain[Domain], false) == SilPass) {
+      Fill->DomainAps[Domain]++;
+      Started++;
+    }
+  }
+
+  // BSP share, then the domains without APs. Remote domains with running APs are left to them.
+  BspDomain = MemFillGetApicDomain (CcxIp2IpApi, Fill->DomainCount, xUslGetExtendedApicId ());
+  MemFillDomain (Fill, BspDomain);
+  for (Domain = 0; Domain < Fill->DomainCount; Domain++) {
+    if ((Domain != BspDomain) && (Fill->DomainAps[Domain] == 0)) {
+      MemFillDomain (Fill, Domain);
+    }
+  }
+
+  if (Started != 0) {
+    CcxIp2IpApi->MpWaitForAps (CcxMpTargetAllAps, 0);
+  }
+
+  for (Domain = 0; Domain < Fill->DomainCount; Domain++) {
+    XPRF_TRACEPOINT (SIL_TRACE_INFO, "Memory fill domain %d: 0x%llx bytes, %d threads, %lld TSC ticks\n",
+                     Domain,
+                     Stats->Domain[Domain].Bytes,
+                     Stats->Domain[Domain].ThreadCount,
+                     Stats->Domain[Domain].ElapsedTsc);
+  }
+
+  return SilPass;
+}
@@ -0,0 +1,495 @@
+/**
+ * @file  xPrfMemMap.c
+ * @brief Platform Reference Firmware - sorted and merged system memory
+ *        range map.
+ */
+/* Copyright 2023 Advanced Micro Devices, Inc. All rights reserved.    */
+// SPDX-License-Identifier: MIT
+
+#include <SilCommon.h>
+#include <ApobCmn.h>
+#include <MsrReg.h>
+#include <xPRF-api.h>
+#include <CommonLib/CpuLib.h>
+#include <DF/DfIp2Ip.h>
+#include <DF/Common/SilFabricInfo.h>
+#include <DF/DfX/SilFabricRegistersDfX.h>
+#include <string.h>
+#include "xPRF.h"
+
+// Core::X86::Msr::MmioCfgBaseAddr fields
+#define MEM_MAP_MMIO_CFG_ENABLE         0x1ull
+#define MEM_MAP_MMIO_CFG_BUS_RANGE_SHIFT 2
+#define MEM_MAP_MMIO_CFG_BUS_RANGE_MASK 0xF
+#define MEM_MAP_MMIO_CFG_BASE_MASK      0x0000FFFFFFF00000ull
+#define MEM_MAP_MMIO_CFG_BUS_SIZE       0x100000ull   // 1MB of configuration space per bus
+
+// RMP_BASE and RMP_END hold address bits [51:13]
+#define MEM_MAP_RMP_ADDRESS_SHIFT       13
+
+// DF DRAM base and limit registers hold address bits [55:28]
+#define MEM_MAP_DRAM_ADDRESS_SHIFT      28
+
+// Every DF DRAM region, every APOB hole, MMCFG and the RMP
+#define MEM_MAP_MAX_SOURCES  (DFX_NUMBER_OF_DRAM_REGIONS + MAX_HOLE_DESCRIPTOR + \
+                              MAX_ADDITIONAL_HOLE_DESCRIPTOR + 2)
+
+/// One input range of the map
+typedef struct {
+  uint64_t  Base;
+  uint64_t  Limit;              ///< Exclusive
+  uint32_t  Type;               ///< SIL_MEMORY_RANGE_TYPE
+  uint32_t  Domain;
+} MEM_MAP_SOURCE;
+
+/// Start or end of a MEM_MAP_SOURCE
+typedef struct {
+  uint64_t  Address;
+  uint16_t  Source;             ///< Index in mMemMapSources
+  uint16_t  IsStart;            ///< 0 for the end of the source, so ends sort first
+} MEM_MAP_EVENT;
+
+static MEM_MAP_SOURCE    mMemMapSources[MEM_MAP_MAX_SOURCES];
+static uint32_t          mMemMapSourceCount;
+static MEM_MAP_EVENT     mMemMapEvents[MEM_MAP_MAX_SOURCES * 2];
+
+static SIL_MEMORY_RANGE  mMemoryRangeMap[SIL_MEMORY_RANGE_MAX];
+static uint32_t          mMemoryRangeCount;
+static bool              mMemoryRangeMapValid;
+
+/*
+ * MemMapAddSource
+ *
+ * @brief   Add an input range to the map.
+ *
+ * @param   Base    Base address of the range
+ * @param   Size    Size of the range, empty ranges are ignored
+ * @param   Type    SIL_MEMORY_RANGE_TYPE
+ * @param   Domain  NUMA domain of the range
+ */
+static
+void
+MemMapAddSource (
+  uint64_t  Base,
+  uint64_t  Size,
+  uint32_t  Type,
+  uint32_t  Domain
+  )
+{
+  MEM_MAP_SOURCE  *Source;
+
+  if (Size == 0) {
+    return;
+  }
+  assert (mMemMapSourceCount < MEM_MAP_MAX_SOURCES);
+  if (mMemMapSourceCount >= MEM_MAP_MAX_SOURCES) {
+    return;
+  }
+
+  Source = &mMemMapSources[mMemMapSourceCount];
+  Source->Base = Base;
+  Source->Limit = Base + Size;
+  Source->Type = Type;
+  Source->Domain = Domain;
+
+  mMemMapEvents[mMemMapSourceCount * 2].Address = Source->Base;
+  mMemMapEvents[mMemMapSourceCount * 2].Source = (uint16_t) mMemMapSourceCount;
+  mMemMapEvents[mMemMapSourceCount * 2].IsStart = 1;
+  mMemMapEvents[mMemMapSourceCount * 2 + 1].Address = Source->Limit;
+  mMemMapEvents[mMemMapSourceCount * 2 + 1].Source = (uint16_t) mMemMapSourceCount;
+  mMemMapEvents[mMemMapSourceCount * 2 + 1].IsStart = 0;
+
+  mMemMapSourceCount++;
+}
+
+/*
+ * MemMapEventLess
+ *
+ * @brief   Sort order of the events: by address, ends before starts.
+ *
+ * @retval  true  A sorts before B
+ */
+static
+bool
+MemMapEventLess (
+  const MEM_MAP_EVENT *A,
+  const MEM_MAP_EVENT *B
+  )
+{
+  if (A->Address != B->Address) {
+    return A->Address < B->Address;
+  }
+  return A->IsStart < B->IsStart;
+}
+
+/*
+ * MemMapSiftDown
+ *
+ * @brief   Restore the max-heap property below Root.
+ *
+ * @param   Events  Heap of events
+ * @param   Root    Node to sift down
+ * @param   Count   Number of events in the heap
+ */
+static
+void
+MemMapSiftDown (
+  MEM_MAP_EVENT *Events,
+  uint32_t      Root,
+  uint32_t      Count
+  )
+{
+  uint32_t       Child;
+  MEM_MAP_EVENT  Temp;
+
+  for (Child = 2 * Root + 1; Child < Count; Child = 2 * Root + 1) {
+    if ((Child + 1 < Count) && MemMapEventLess (&Events[Child], &Events[Child + 1])) {
+      Child++;
+    }
+    if (!MemMapEventLess (&Events[Root], &Events[Child])) {
+      break;
+    }
+    Temp = Events[Root];
+    Events[Root] = Events[Child];
+    Events[Child] = Temp;
+    Root = Child;
+  }
+}
+
+/*
+ * MemMapSortEvents
+ *
+ * @brief   In place heap sort of the events, O(n log n) without allocation.
+ *
+ * @param   Events  Events to sort
+ * @param   Count   Number of events
+ */
+static
+void
+MemMapSortEvents (
+  MEM_MAP_EVENT *Events,
+  uint32_t      Count
+  )
+{
+  uint32_t       Index;
+  MEM_MAP_EVENT  Temp;
+
+  for (Index = Count / 2; Index > 0; Index--) {
+    MemMapSiftDown (Events, Index - 1, Count);
+  }
+  for (Index = Count; Index > 1; Index--) {
+    Temp = Events[0];
+    Events[0] = Events[Index - 1];
+    Events[Index - 1] = Temp;
+    MemMapSiftDown (Events, 0, Index - 1);
+  }
+}
+
+/*
+ * MemMapAppendRange
+ *
+ * @brief   Append a range to the map, merging it with the previous one if
+ *          they are adjacent and have the same attribute and domain.
+ *
+ * @retval  SilPass             Range added or merged
+ * @retval  SilOutOfResources   The map is full
+ */
+static
+SIL_STATUS
+MemMapAppendRange (
+  uint64_t  Base,
+  uint64_t  Limit,
+  uint32_t  Type,
+  uint32_t  Domain
+  )
+{
+  SIL_MEMORY_RANGE  *Range;
+
+  if (mMemoryRangeCount != 0) {
+    Range = &mMemoryRangeMap[mMemoryRangeCount - 1];
+    if ((Range->Base + Range->Size == Base) && (Range->Type == Type) && (Range->Domain == Domain)) {
+      Range->Size = Limit - Range->Base;
+      return SilPass;
+    }
+  }
+
+  if (mMemoryRangeCount >= SIL_MEMORY_RANGE_MAX) {
+    return SilOutOfResources;
+  }
+
+  Range = &mMemoryRangeMap[mMemoryRangeCount++];
+  Range->Base = Base;
+  Range->Size = Limit - Base;
+  Range->Type = Type;
+  Range->Domain = Domain;
+
+  return SilPass;
+}
+
+/*
+ * MemMapAddDramRegions
+ *
+ * @brief   Add the valid DF DRAM address maps as DRAM, tagged with the socket
+ *          of their destination.
+ *
+ * @retval  Number of DRAM regions added
+ */
+static
+uint32_t
+MemMapAddDramRegions (void)
+{
+  uint32_t                     Index;
+  uint32_t                     Count;
+  uint64_t                     Base;
+  uint64_t                     Limit;
+  DRAM_ADDRESS_CTL_REGISTER    DramAddressCtl;
+  DRAM_BASE_ADDRESS_REGISTER   DramBaseAddr;
+  DRAM_LIMIT_ADDRESS_REGISTER  DramLimitAddr;
+  DF_IP2IP_API                 *DfIp2IpApi;
+
+  if (SilGetIp2IpApi (SilId_DfClass, (void **)(&DfIp2IpApi)) != SilPass) {
+    return 0;
+  }
+
+  Count = 0;
+  for (Index = 0; Index < DFX_NUMBER_OF_DRAM_REGIONS; Index++) {
+    DramAddressCtl.Value = DfIp2IpApi->DfFabricRegisterAccRead (0, DRAMADDRESSCTL_0_FUNC,
+                             DRAMADDRESSCTL_0_REG + (Index * DFX_DRAM_REGION_REGISTER_OFFSET),
+                             DFX_IOMS2_INSTANCE_ID);
+    if (DramAddressCtl.Field.AddrRngVal == 0) {
+      continue;
+    }
+    DramBaseAddr.Value = DfIp2IpApi->DfFabricRegisterAccRead (0, DRAMBASEADDRESS_0_FUNC,
+                           DRAMBASEADDRESS_0_REG + (Index * DFX_DRAM_REGION_REGISTER_OFFSET),
+                           DFX_IOMS2_INSTANCE_ID);
+    DramLimitAddr.Value = DfIp2IpApi->DfFabricRegisterAccRead (0, DRAMLIMITADDRESS_0_FUNC,
+                            DRAMLIMITADDRESS_0_REG + (Index * DFX_DRAM_REGION_REGISTER_OFFSET),
+                            DFX_IOMS2_INSTANCE_ID);
+
+    Base = (uint64_t) DramBaseAddr.Field.DramBaseAddr << MEM_MAP_DRAM_ADDRESS_SHIFT;
+    Limit = ((uint64_t) DramLimitAddr.Field.DramLimitAddr + 1) << MEM_MAP_DRAM_ADDRESS_SHIFT;
+    if (Limit <= Base) {
+      continue;
+    }
+    MemMapAddSource (Base, Limit - Base, SilMemRangeDram,
+                     (DramAddressCtl.Field.DstFabricID >> DFX_FABRIC_ID_SOCKET_SHIFT) &
+                     DFX_FABRIC_ID_SOCKET_SIZE_MASK);
+    Count++;
+  }
+
+  return Count;
+}
+
+/*
+ * MemMapGetHoleType
+ *
+ * @brief   Attribute of an APOB memory hole.
+ *
+ * @param   HoleType  MEMORY_HOLE_TYPES
+ *
+ * @return  SIL_MEMORY_RANGE_TYPE
+ */
+static
+uint32_t
+MemMapGetHoleType (
+  uint32_t  HoleType
+  )
+{
+  switch (HoleType) {
+  case MMIO:
+    return SilMemRangeMmio;
+  case ReservedCxl:
+    return SilMemRangeCxl;
+  default:
+    return SilMemRangeReserved;
+  }
+}
+
+/*
+ * MemMapBuild
+ *
+ * @brief   Build the system memory range map.
+ *
+ * @details DRAM comes from the DF DRAM address maps, or from the APOB top of
+ *          memory if the DF is not available. The APOB holes, MMCFG and the RMP
+ *          are laid over it; the sources are split in start and end events,
+ *          sorted once, and swept in address order keeping a count of the
+ *          active sources per attribute.
+ *
+ * @retval  SilPass             Map built
+ * @retval  SilNotFound         The APOB memory map is not available
+ * @retval  SilOutOfResources   More ranges than SIL_MEMORY_RANGE_MAX
+ */
+static
+SIL_STATUS
+MemMapBuild (void)
+{
+  SIL_STATUS                          Status;
+  APOB_SYSTEM_MEMORY_MAP_TYPE_STRUCT  *ApobEntry;
+  MEMORY_HOLE_DESCRIPTOR              *Hole;
+  MEM_MAP_SOURCE                      *Source;
+  SECURE_RMPTABLE_BASE                RmpBase;
+  SECURE_RMPTABLE_END                 RmpEnd;
+  uint64_t                            MmioCfgBase;
+  uint32_t                            HoleCount;
+  uint32_t                            Index;
+  uint32_t                            EventCount;
+  uint32_t                            Type;
+  uint32_t                            Domain;
+  uint32_t                            DramDomain;
+  uint32_t                            ActiveCount[SilMemRangeTypeMax];
+
+  Status = AmdGetApobEntryInstance (APOB_FABRIC,
+                                    APOB_SYS_MAP_INFO_TYPE,
+                                    0,
+                                    0,
+                                    (APOB_TYPE_HEADER **) &ApobEntry
+                                    );
+  if (Status != SilPass) {
+    return SilNotFound;
+  }
+
+  mMemMapSourceCount = 0;
+  mMemoryRangeCount = 0;
+
+  if (MemMapAddDramRegions () == 0) {
+    MemMapAddSource (0, ApobEntry->ApobSystemMap.TopOfSystemMemory, SilMemRangeDram,
+                     SIL_MEMORY_RANGE_NO_DOMAIN);
+  }
+
+  // Holes past HoleInfo continue in AdditionalHoleInfo
+  HoleCount = ApobEntry->ApobSystemMap.NumberOfHoles;
+  if (HoleCount > MAX_HOLE_DESCRIPTOR + MAX_ADDITIONAL_HOLE_DESCRIPTOR) {
+    HoleCount = MAX_HOLE_DESCRIPTOR + MAX_ADDITIONAL_HOLE_DESCRIPTOR;
+  }
+  for (Index = 0; Index < HoleCount; Index++) {
+    Hole = (Index < MAX_HOLE_DESCRIPTOR) ? &ApobEntry->ApobSystemMap.HoleInfo[Index] :
+                                           &ApobEntry->AdditionalHoleInfo[Index - MAX_HOLE_DESCRIPTOR];
+    MemMapAddSource (Hole->Base, Hole->Size, MemMapGetHoleType (Hole->Type), SIL_MEMORY_RANGE_NO_DOMAIN);
+  }
+
+  MmioCfgBase = xUslRdMsr (MSR_MMIO_CFG_BASE);
+  if ((MmioCfgBase & MEM_MAP_MMIO_CFG_ENABLE) != 0) {
+    MemMapAddSource (MmioCfgBase & MEM_MAP_MMIO_CFG_BASE_MASK,
+                     MEM_MAP_MMIO_CFG_BUS_SIZE << ((MmioCfgBase >> MEM_MAP_MMIO_CFG_BUS_RANGE_SHIFT) &
+                                                   MEM_MAP_MMIO_CFG_BUS_RANGE_MASK),
+                     SilMemRangePcieConfig,
+                     SIL_MEMORY_RANGE_NO_DOMAIN);
+  }
+
+  RmpBase.Value = xUslRdMsr (MSR_LS_RMP_BASE);
+  RmpEnd.Value = xUslRdMsr (MSR_LS_RMP_END);
+  if ((RmpBase.Field.RmpTableBase != 0) && (RmpEnd.Field.RmpTableEnd >= RmpBase.Field.RmpTableBase)) {
+    MemMapAddSource ((uint64_t) RmpBase.Field.RmpTableBase << MEM_MAP_RMP_ADDRESS_SHIFT,
+                     ((uint64_t) RmpEnd.Field.RmpTableEnd - RmpBase.Field.RmpTableBase + 1) <<
+                     MEM_MAP_RMP_ADDRESS_SHIFT,
+                     SilMemRangeSnpRmp,
+                     SIL_MEMORY_RANGE_NO_DOMAIN);
+  }
+
+  EventCount = mMemMapSourceCount * 2;
+  MemMapSortEvents (mMemMapEvents, EventCount);
+
+  memset (ActiveCount, 0, sizeof (ActiveCount));
+  DramDomain = SIL_MEMORY_RANGE_NO_DOMAIN;
+  for (Index = 0; Index < EventCount; Index++) {
+    Source = &mMemMapSources[mMemMapEvents[Index].Source];
+    if (mMemMapEvents[Index].IsStart != 0) {
+      ActiveCount[Source->Type]++;
+      if (Source->Type == SilMemRangeDram) {
+        DramDomain = Source->Domain;
+      }
+    } else {
+      ActiveCount[Source->Type]--;
+      if ((Source->Type == SilMemRangeDram) && (ActiveCount[SilMemRangeDram] == 0)) {
+        DramDomain = SIL_MEMORY_RANGE_NO_DOMAIN;
+      }
+    }
+
+    // Emit the span up to the next address once all events at this one are applied
+    if ((Index + 1 >= EventCount) || (mMemMapEvents[Index + 1].Address == mMemMapEvents[Index].Address)) {
+      continue;
+    }
+    for (Type = SilMemRangeTypeMax; Type > 0; Type--) {
+      if (ActiveCount[Type - 1] != 0) {
+        break;
+      }
+    }
+    if (Type == 0) {
+      continue;
+    }
+    Type--;
+    Domain = ((Type == SilMemRangeMmio) || (Type == SilMemRangePcieConfig)) ?
+             SIL_MEMORY_RANGE_NO_DOMAIN : DramDomain;
+    Status = MemMapAppendRange (mMemMapEvents[Index].Address, mMemMapEvents[Index + 1].Address, Type, Domain);
+    if (Status != SilPass) {
+      XPRF_TRACEPOINT (SIL_TRACE_ERROR, "Memory range map exceeds %d ranges\n", SIL_MEMORY_RANGE_MAX);
+      return Status;
+    }
+  }
+
+  for (Index = 0; Index < mMemoryRangeCount; Index++) {
+    XPRF_TRACEPOINT (SIL_TRACE_INFO, "Memory range 0x%llx - 0x%llx Type %d Domain 0x%x\n",
+                     mMemoryRangeMap[Index].Base,
+                     mMemoryRangeMap[Index].Base + mMemoryRangeMap[Index].Size - 1,
+                     mMemoryRangeMap[Index].Type,
+                     mMemoryRangeMap[Index].Domain);
+  }
+
+  return SilPass;
+}
+
+/**
+ * xPrfInvalidateMemoryRangeMap
+ *
+ * @brief   Drop the cached memory range map, the next xPrfGetMemoryRangeMap
+ *          rebuilds it.
+ */
+void
+xPrfInvalidateMemoryRangeMap (void)
+{
+  mMemoryRangeMapValid = false;
+}
+
+/**
+ * xPrfGetMemoryRangeMap
+ *
+ * @brief   Get the system memory range map.
+ *
+ * @details The map is a list of non-overlapping ranges sorted by address, with
+ *          adjacent ranges of the same attribute and domain merged. It is built
+ *          on the first call and cached, so every caller reads the same array.
+ *
+ * @param[out] RangeMap     Cached array of SIL_MEMORY_RANGE, owned by xPRF
+ * @param[out] RangeCount   Number of ranges in RangeMap
+ *
+ * @retval SilPass              Map returned.
+ * @retval SilInvalidParameter  NULL pointer.
+ * @retval SilNotFound          The APOB memory map is not available.
+ * @retval SilOutOfResources    More ranges than SIL_MEMORY_RANGE_MAX.
+ **/
+SIL_STATUS
+xPrfGetMemoryRangeMap (
+  const SIL_MEMORY_RANGE  **RangeMap,
+  uint32_t                *RangeCount
+  )
+{
+  SIL_STATUS  Status;
+
+  if ((RangeMap == NULL) || (RangeCount == NULL)) {
+    return SilInvalidParameter;
+  }
+
+  if (!mMemoryRangeMapValid) {
+    Status = MemMapBuild ();
+    if (Status != SilPass) {
+      return Status;
+    }
+    mMemoryRangeMapValid = true;
+  }
+
+  *RangeMap = mMemoryRangeMap;
+  *RangeCount = mMemoryRangeCount;
+
+  return SilPass;
+}
@@ -9,6 +9,24 @@
 #include "xPrfNbio.h"
 #include "xPRF-api.h"
 #include "xSIM.h"
+#include <string.h>
+#include <CoreTopologyService.h>
+#include <ApobCmn.h>
+#include <CcxIp2Ip.h>
+#include <DF/DfIp2Ip.h>
+#include <NBIO/NbioIp2Ip.h>
+#include <Sdci/SdciClass-api.h>
+#include "xPRF.h"
+
+/// Root port walk context for the steering tag table
+typedef struct {
+  SDCICLASS_INPUT_BLK     *SdciData;      ///< SDCI input block
+  NBIO_IP2IP_API          *NbioIp2Ip;     ///< NBIO Ip2Ip API
+  SIL_TPH_ST_L3_ENTRY     *L3;            ///< L3 entries, NULL while sizing
+  uint32_t                L3Count;        ///< Valid L3 entries
+  SIL_TPH_ST_PORT_ENTRY   *Port;          ///< Port entries, NULL while sizing
+  uint32_t                PortCount;      ///< Ports found so far
+} XPRF_TPH_PORT_CONTEXT;
 
 /**
  * xPrfGetNbiotopologyStructure
@@ -20,3 +38,286 @@ void* xPrfGetNbiotopologyStructure(void)
 {
   return ((void *)SilFindStructure(SilId_NorthBridgePcie, 0));
 }
+
+/**
+ * xPrfTphCollectL3
+ *
+ * @brief   Walk the CCX topology and record one steering tag per L3 cache
+ *
+ * @details The steering tag of an L3 is the APIC ID of the first thread of its CCX, so
+ *          data injected with that tag is allocated in the L3 shared by the CCX.
+ *
+ * @param   L3        Output entries, NULL to count only
+ * @param   L3Count   Number of L3 caches found
+ *
+ * @retval  SilPass       Topology walked
+ * @retval  SilNotFound   CCX or DF API not found
+ */
+static
+SIL_STATUS
+xPrfTphCollectL3 (
+  SIL_TPH_ST_L3_ENTRY   *L3,
+  uint32_t              *L3Count
+  )
+{
+  uint32_t              SocketLoop;
+  uint32_t              DieLoop;
+  uint32_t              CcdLoop;
+  uint32_t              ComplexLoop;
+  uint32_t              CoreLoop;
+  uint32_t              NumberOfSockets;
+  uint32_t              NumberOfDies;
+  uint32_t              NumberOfCcds;
+  uint32_t              NumberOfComplexes;
+  uint32_t              NumberOfCores;
+  uint32_t              NumberOfThreads;
+  uint32_t              ApobInstanceId;
+  uint32_t              Domain;
+  uint32_t              ThreadCount;
+  uint32_t              FirstCore;
+  uint8_t               SocketCcx;
+  uint8_t               PhyCcdNum;
+  uint8_t               PhyCcxNum;
+  uint8_t               PhyCoreNum;
+  SIL_TPH_ST_L3_ENTRY   *Entry;
+  CCX_IP2IP_API         *CcxIp2Ip;
+  DF_IP2IP_API          *DfIp2IpApi;
+
+  if (SilGetIp2IpApi (SilId_CcxClass, (void **)(&CcxIp2Ip)) != SilPass) {
+    return SilNotFound;
+  }
+  if (SilGetIp2IpApi (SilId_DfClass, (void **)(&DfIp2IpApi)) != SilPass) {
+    return SilNotFound;
+  }
+
+  *L3Count = 0;
+  DfIp2IpApi->DfGetSystemInfo (&NumberOfSockets, NULL, NULL, NULL, NULL);
+  for (SocketLoop = 0; SocketLoop < NumberOfSockets; SocketLoop++) {
+    if (DfIp2IpApi->DfGetProcessorInfo (SocketLoop, &NumberOfDies, NULL) != SilPass) {
+      continue;
+    }
+    SocketCcx = 0;
+    for (DieLoop = 0; DieLoop < NumberOfDies; DieLoop++) {
+      ApobInstanceId = ((uint32_t) SocketLoop << 8) | (uint32_t) DieLoop;
+      GetCoreTopologyOnDie (SocketLoop, DieLoop, &NumberOfCcds, &NumberOfComplexes,
+                            &NumberOfCores, &NumberOfThreads);
+      for (CcdLoop = 0; CcdLoop < NumberOfCcds; CcdLoop++) {
+        if ((ApobGetPhysCcdNumber (ApobInstanceId, CcdLoop, &PhyCcdNum) != SilPass) ||
+            (PhyCcdNum == CCX_NOT_PRESENT)) {
+          continue;
+        }
+        for (ComplexLoop = 0; ComplexLoop < NumberOfComplexes; ComplexLoop++) {
+          if ((ApobGetPhysComplexNumber (ApobInstanceId, CcdLoop, ComplexLoop, &PhyCcxNum) != SilPass) ||
+              (PhyCcxNum == CCX_NOT_PRESENT)) {
+            continue;
+          }
+          ThreadCount = 0;
+          FirstCore = NumberOfCores;
+          for (CoreLoop = 0; CoreLoop < NumberOfCores; CoreLoop++) {
+            if ((ApobGetPhysCoreNumber (ApobInstanceId, CcdLoop, ComplexLoop, CoreLoop, &PhyCoreNum) != SilPass) ||
+                (PhyCoreNum == CCX_NOT_PRESENT)) {
+              continue;
+            }
+            if (FirstCore == NumberOfCores) {
+              FirstCore = CoreLoop;
+            }
+            ThreadCount += NumberOfThreads;
+          }
+          if (ThreadCount == 0) {
+            continue;
+          }
+
+          if (L3 != NULL) {
+            Entry = &L3[*L3Count];
+            memset (Entry, 0, sizeof (SIL_TPH_ST_L3_ENTRY));
+            if (DfIp2IpApi->DfDomainXlat (SocketLoop, DieLoop, CcdLoop, ComplexLoop, &Domain) == SilPass) {
+              Entry->ProximityDomain = Domain;
+            }
+            Entry->FirstApicId = CcxIp2Ip->CalcLocalApic (SocketLoop, DieLoop, CcdLoop, ComplexLoop, FirstCore, 0);
+            Entry->SteeringTag = (uint16_t) Entry->FirstApicId;
+            Entry->Socket = (uint8_t) SocketLoop;
+            Entry->Die = (uint8_t) DieLoop;
+            Entry->Ccd = (uint8_t) CcdLoop;
+            Entry->Complex = (uint8_t) ComplexLoop;
+            Entry->SocketCcx = SocketCcx;
+            Entry->ThreadCount = (uint8_t) ThreadCount;
+          }
+          SocketCcx++;
+          (*L3Count)++;
+        }
+      }
+    }
+  }
+  return SilPass;
+}
+
+/**
+ * xPrfTphPortCallback
+ *
+ * @brief   Record the default steering tag of one root port
+ *
+ * @details The target CCX is taken from the SdciPortTarget entry of the port, or from
+ *          SdciDefaultTargetCcx. The first CCX of the socket is used when the requested
+ *          CCX does not exist.
+ *
+ * @param   Engine    PCIe engine of the root port
+ * @param   Buffer    XPRF_TPH_PORT_CONTEXT
+ * @param   Pcie      PCIe platform configuration
+ */
+static
+void
+xPrfTphPortCallback (
+  PCIe_ENGINE_CONFIG    *Engine,
+  void                  *Buffer,
+  PCIe_PLATFORM_CONFIG  *Pcie
+  )
+{
+  XPRF_TPH_PORT_CONTEXT   *Context;
+  GNB_HANDLE              *GnbHandle;
+  SIL_TPH_ST_PORT_ENTRY   *PortEntry;
+  uint32_t                Index;
+  uint32_t                Target;
+  uint32_t                Match;
+  uint8_t                 TargetCcx;
+
+  Context = (XPRF_TPH_PORT_CONTEXT *) Buffer;
+  if (Context->Port == NULL) {
+    Context->PortCount++;
+    return;
+  }
+
+  GnbHandle = (GNB_HANDLE *) Context->NbioIp2Ip->PcieConfigGetParent (DESCRIPTOR_SILICON, &(Engine->Header));
+  if (GnbHandle == NULL) {
+    return;
+  }
+
+  TargetCcx = Context->SdciData->SdciDefaultTargetCcx;
+  for (Index = 0; (Index < Context->SdciData->SdciPortTargetCount) && (Index < SDCI_PORT_TARGET_COUNT); Index++) {
+    if (Context->SdciData->SdciPortTarget[Index].PortAddress == Engine->Type.Port.Address.AddressValue) {
+      TargetCcx = Context->SdciData->SdciPortTarget[Index].TargetCcx;
+      break;
+    }
+  }
+
+  Target = Context->L3Count;
+  for (Index = 0; Index < Context->L3Count; Index++) {
+    if (Context->L3[Index].Socket != GnbHandle->SocketId) {
+      continue;
+    }
+    if (Target == Context->L3Count) {
+      Target = Index;
+    }
+    if (Context->L3[Index].SocketCcx == TargetCcx) {
+      Target = Index;
+      break;
+    }
+  }
+  if (Target == Context->L3Count) {
+    XPRF_TRACEPOINT (SIL_TRACE_INFO, "Port %x has no CCX on socket %d\n",
+      Engine->Type.Port.Address.AddressValue, GnbHandle->SocketId);
+    return;
+  }
+
+  Match = Context->PortCount++;
+  PortEntry = &Context->Port[Match];
+  PortEntry->PortAddress = Engine->Type.Port.Address.AddressValue;
+  PortEntry->SteeringTag = Context->L3[Target].SteeringTag;
+  PortEntry->L3Index = (uint16_t) Target;
+}
+
+/**
+ * xPrfGetTphSteeringTagTable
+ *
+ * @brief   Build the TPH steering tag table used for SDCI cache injection
+ *
+ * @details The table holds one steering tag per L3 cache, taken from the CCX topology,
+ *          and the default steering tag of every PCIe root port, taken from the SDCI
+ *          input block. See SIL_TPH_ST_TABLE for the layout.
+ *
+ * @param   Table       Host buffer for the SIL_TPH_ST_TABLE, may be NULL to query the size.
+ * @param   TableSize   On input, the size of the Table buffer.
+ *                      On output, the size the table needs.
+ *
+ * @return  SIL_STATUS
+ *
+ * @retval  SilPass         The table was built.
+ * @retval  SilOutOfBounds  The Table buffer is too small, TableSize holds the size needed.
+ * @retval  SilUnsupported  SDCI is disabled.
+ * @retval  SilNotFound     An IP API or input block was not found.
+ */
+SIL_STATUS
+xPrfGetTphSteeringTagTable (
+  void      *Table,
+  uint32_t  *TableSize
+  )
+{
+  NORTH_BRIDGE_PCIE_SIB   *NbPcieData;
+  XPRF_TPH_PORT_CONTEXT   Context;
+  SIL_TPH_ST_TABLE        *Header;
+  uint32_t                Length;
+  SIL_STATUS              Status;
+
+  if (TableSize == NULL) {
+    return SilInvalidParameter;
+  }
+
+  memset (&Context, 0, sizeof (Context));
+  Context.SdciData = (SDCICLASS_INPUT_BLK *) SilFindStructure (SilId_SdciClass, 0);
+  NbPcieData = (NORTH_BRIDGE_PCIE_SIB *) SilFindStructure (SilId_NorthBridgePcie, 0);
+  if ((Context.SdciData == NULL) || (NbPcieData == NULL)) {
+    return SilNotFound;
+  }
+  if (!Context.SdciData->AmdFabricSdci) {
+    XPRF_TRACEPOINT (SIL_TRACE_INFO, "SDCI is disabled, no steering tag table\n");
+    return SilUnsupported;
+  }
+  if (SilGetIp2IpApi (SilId_NbioClass, (void **)(&Context.NbioIp2Ip)) != SilPass) {
+    return SilNotFound;
+  }
+
+  // Size the table
+  Status = xPrfTphCollectL3 (NULL, &Context.L3Count);
+  if (Status != SilPass) {
+    return Status;
+  }
+  Context.NbioIp2Ip->PcieConfigRunProcForAllEngines (
+                       DESCRIPTOR_ALLOCATED | DESCRIPTOR_PCIE_ENGINE,
+                       xPrfTphPortCallback,
+                       &Context,
+                       &NbPcieData->PciePlatformConfig
+                       );
+  Length = sizeof (SIL_TPH_ST_TABLE) + (Context.L3Count * sizeof (SIL_TPH_ST_L3_ENTRY)) +
+           (Context.PortCount * sizeof (SIL_TPH_ST_PORT_ENTRY));
+  if ((Table == NULL) || (*TableSize < Length)) {
+    *TableSize = Length;
+    return SilOutOfBounds;
+  }
+
+  // Fill it
+  Header = (SIL_TPH_ST_TABLE *) Table;
+  memset (Header, 0, Length);
+  Context.L3 = (SIL_TPH_ST_L3_ENTRY *) (Header + 1);
+  Context.Port = (SIL_TPH_ST_PORT_ENTRY *) (Context.L3 + Context.L3Count);
+  Context.PortCount = 0;
+  Status = xPrfTphCollectL3 (Context.L3, &Context.L3Count);
+  if (Status != SilPass) {
+    return Status;
+  }
+  Context.NbioIp2Ip->PcieConfigRunProcForAllEngines (
+                       DESCRIPTOR_ALLOCATED | DESCRIPTOR_PCIE_ENGINE,
+                       xPrfTphPortCallback,
+                       &Context,
+                       &NbPcieData->PciePlatformConfig
+                       );
+
+  Header->Revision = SIL_TPH_ST_TABLE_REVISION;
+  Header->L3Count = (uint16_t) Context.L3Count;
+  Header->PortCount = (uint16_t) Context.PortCount;
+  Header->Length = (uint32_t) (sizeof (SIL_TPH_ST_TABLE) + (Context.L3Count * sizeof (SIL_TPH_ST_L3_ENTRY)) +
+                               (Context.PortCount * sizeof (SIL_TPH_ST_PORT_ENTRY)));
+  *TableSize = Header->Length;
+
+  XPRF_TRACEPOINT (SIL_TRACE_INFO, "TPH steering tag table: %d L3, %d ports, %d bytes\n",
+    Header->L3Count, Header->PortCount, Header->Length);
+  return SilPass;
+}
@@ -14,6 +14,8 @@
 #include <RAS/RasDefs.h>
 #include <MsrReg.h>
 #include <DF/DfIp2Ip.h>
+#include <CcxIp2Ip.h>
+#include <CommonLib/CpuLib.h>
 
 #include "xPRF-api.h"
 
@@ -128,35 +130,28 @@ xPrfGetMaxCpus (void)
 }
 
 /*
- * xPrfCollectCpuMap
+ * xPrfWalkCpuTopology
  *
- * @brief This function is responsible for building the CPU map used by the host
- *        RAS driver.
+ * @brief   Walk the logical processors in processor number order.
  *
- * @param   RasCpuMap   On input, the pointer to the CPU map structure.  The structure contains a SIL_CPU_INFO for
- *                      every processor (thread) in the system.  It is the responsibility of the host to allocate
- *                      sufficient memory for this structure.
- *                      On output, the buffer is filled with instances of
- *                      SIL_CPU_INFO (defined in RasClass-api.h) for each CPU.
- * @param   CpuMapSize  The size of the buffer RasCpuMap.
- * @param   TotalCpus   Return the total number of CPUs.
+ * @param   RasCpuMap         SIL_CPU_INFO buffer to fill, or NULL
+ * @param   CpuMapSize        The size of the buffer RasCpuMap
+ * @param   ProcessorOfApicId APIC ID to processor number table to fill, or
+ *                            NULL. It holds SIL_MCA_HARVEST_MAX_APIC_ID
+ *                            entries.
+ * @param   TotalCpus         Return the total number of CPUs.
  *
- * @details This function has dependencies on the following openSIL
- *          Services/IPs:
- *
- *          Df->DfGetSystemInfo()
- *          Df->DfGetCoreTopologyOnDie()
- *
- * @retval  SilPass             CPU map created successfully
- * @retval  SilInvalidParameter GetProcessorInfo failed
- * @retval  SilInvalidParameter GetCoreTopologyOnDie failed
- * @retval  SilNotFound         Info for current ccd, complex, or core not found
- * @retval  SilOutOfBounds      The input buffer is not sufficient for all CPUs
+ * @retval  SilPass             The walk completed
+ * @retval  SilInvalidParameter GetProcessorInfo or GetCoreTopologyOnDie failed
+ * @retval  SilNotFound         An IP API was not found
+ * @retval  SilOutOfBounds      RasCpuMap or ProcessorOfApicId is too small
  */
+static
 SIL_STATUS
-xPrfCollectCpuMap (
+xPrfWalkCpuTopology (
   SIL_CPU_INFO *RasCpuMap,
   uint32_t     CpuMapSize,
+  uint16_t     *ProcessorOfApicId,
   uint32_t     *TotalCpus
   )
 {
@@ -170,16 +165,17 @@ xPrfCollectCpuMap (
   uint8_t       CcdLoop;
   uint8_t       ComplexLoop;
   uint8_t       CoreLoop;
+  uint8_t       ThreadLoop;
   uint32_t      NumberOfComplexes;
   uint32_t      NumberOfCores;
   uint32_t      NumberOfThreads;
+  uint32_t      ApicId;
   SIL_CPU_INFO  *SilCpuMap;
   uint32_t      CpuInfoSize;
   uint32_t      MapSizeRemaining;
   APOB_CCD_LOGICAL_TO_PHYSICAL_MAP_TYPE_STRUCT  ApobCcdLogToPhysMap;
-  DF_IP2IP_API* DfIp2IpApi;
-
-  XPRF_TRACEPOINT (SIL_TRACE_ENTRY, "\n");
+  DF_IP2IP_API  *DfIp2IpApi;
+  CCX_IP2IP_API *CcxIp2IpApi;
 
   Status = SilGetIp2IpApi (SilId_DfClass, (void **)&DfIp2IpApi);
   if (Status != SilPass) {
@@ -187,6 +183,15 @@ xPrfCollectCpuMap (
     return Status;
   }
 
+  CcxIp2IpApi = NULL;
+  if (ProcessorOfApicId != NULL) {
+    Status = SilGetIp2IpApi (SilId_CcxClass, (void **)&CcxIp2IpApi);
+    if (Status != SilPass) {
+      XPRF_TRACEPOINT (SIL_TRACE_ERROR, "CCX API not found!\n");
+      return Status;
+    }
+  }
+
   SilCpuMap = RasCpuMap;
   CpuInfoSize = sizeof (SIL_CPU_INFO);
   // MapSizeRemaining is use to track the available space in RasCpuMap
@@ -249,43 +254,34 @@ xPrfCollectCpuMap (
               continue;
             }
 
-            // Core X Thread 0
-            if (MapSizeRemaining < CpuInfoSize) {
-              XPRF_TRACEPOINT (
-                SIL_TRACE_ERROR,
-                "Cpu Map buffer from Host is too small.\n"
-                );
-              assert (CpuMapSize >= CpuInfoSize);
-              return SilOutOfBounds;
-            }
-            SilCpuMap[Index].ProcessorNumber = Index;    //CPU Logic Number
-            SilCpuMap[Index].SocketId = SocketLoop & 0xFF;
-            SilCpuMap[Index].DieId = ApobCcdLogToPhysMap.CcdMap[CcdLoop].PhysCcdNumber;
-            SilCpuMap[Index].CcxId = ApobCcdLogToPhysMap.CcdMap[CcdLoop].ComplexMap[ComplexLoop].PhysComplexNumber;
-            SilCpuMap[Index].CoreId =
-              ApobCcdLogToPhysMap.CcdMap[CcdLoop].ComplexMap[ComplexLoop].CoreInfo[CoreLoop].PhysCoreNumber;
-            SilCpuMap[Index].ThreadID = 0;
-            MapSizeRemaining -= CpuInfoSize;
-            Index++;
-
-            // Core X Thread 1
-            if (NumberOfThreads > 1) {
-              if (MapSizeRemaining < CpuInfoSize) {
-                XPRF_TRACEPOINT (
-                  SIL_TRACE_ERROR,
-                  "Cpu Map buffer from Host is too small.\n"
-                  );
-                assert (CpuMapSize >= CpuInfoSize);
-                return SilOutOfBounds;
+            // Thread 0 and, with SMT, thread 1 of core X
+            for (ThreadLoop = 0; ThreadLoop < NumberOfThreads && ThreadLoop < 2; ThreadLoop++) {
+              if (SilCpuMap != NULL) {
+                if (MapSizeRemaining < CpuInfoSize) {
+                  XPRF_TRACEPOINT (
+                    SIL_TRACE_ERROR,
+                    "Cpu Map buffer from Host is too small.\n"
+                    );
+                  assert (CpuMapSize >= CpuInfoSize);
+                  return SilOutOfBounds;
+                }
+                SilCpuMap[Index].ProcessorNumber = Index;    //CPU Logic Number
+                SilCpuMap[Index].SocketId = SocketLoop & 0xFF;
+                SilCpuMap[Index].DieId = ApobCcdLogToPhysMap.CcdMap[CcdLoop].PhysCcdNumber;
+                SilCpuMap[Index].CcxId = ApobCcdLogToPhysMap.CcdMap[CcdLoop].ComplexMap[ComplexLoop].PhysComplexNumber;
+                SilCpuMap[Index].CoreId =
+                  ApobCcdLogToPhysMap.CcdMap[CcdLoop].ComplexMap[ComplexLoop].CoreInfo[CoreLoop].PhysCoreNumber;
+                SilCpuMap[Index].ThreadID = ThreadLoop;
+                MapSizeRemaining -= CpuInfoSize;
+              }
+              if (ProcessorOfApicId != NULL) {
+                ApicId = CcxIp2IpApi->CalcLocalApic (SocketLoop, DieLoop, CcdLoop, ComplexLoop, CoreLoop, ThreadLoop);
+                if (ApicId >= SIL_MCA_HARVEST_MAX_APIC_ID) {
+                  XPRF_TRACEPOINT (SIL_TRACE_ERROR, "APIC ID 0x%x out of range.\n", ApicId);
+                  return SilOutOfBounds;
+                }
+                ProcessorOfApicId[ApicId] = (uint16_t)Index;
               }
-              SilCpuMap[Index].ProcessorNumber = Index; //CPU Logic Number
-              SilCpuMap[Index].SocketId = SocketLoop & 0xFF;
-              SilCpuMap[Index].DieId = ApobCcdLogToPhysMap.CcdMap[CcdLoop].PhysCcdNumber;
-              SilCpuMap[Index].CcxId = ApobCcdLogToPhysMap.CcdMap[CcdLoop].ComplexMap[ComplexLoop].PhysComplexNumber;
-              SilCpuMap[Index].CoreId =
-                ApobCcdLogToPhysMap.CcdMap[CcdLoop].ComplexMap[ComplexLoop].CoreInfo[CoreLoop].PhysCoreNumber;
-              SilCpuMap[Index].ThreadID = 1;
-              MapSizeRemaining -= CpuInfoSize;
               Index++;
             }
           }
@@ -296,9 +292,51 @@ xPrfCollectCpuMap (
 
   *TotalCpus = Index;
 
+  return SilPass;
+}
+
+/*
+ * xPrfCollectCpuMap
+ *
+ * @brief This function is responsible for building the CPU map used by the host
+ *        RAS driver.
+ *
+ * @param   RasCpuMap   On input, the pointer to the CPU map structure.  The structure contains a SIL_CPU_INFO for
+ *                      every processor (thread) in the system.  It is the responsibility of the host to allocate
+ *                      sufficient memory for this structure.
+ *                      On output, the buffer is filled with instances of
+ *                      SIL_CPU_INFO (defined in RasClass-api.h) for each CPU.
+ * @param   CpuMapSize  The size of the buffer RasCpuMap.
+ * @param   TotalCpus   Return the total number of CPUs.
+ *
+ * @details This function has dependencies on the following openSIL
+ *          Services/IPs:
+ *
+ *          Df->DfGetSystemInfo()
+ *          Df->DfGetCoreTopologyOnDie()
+ *
+ * @retval  SilPass             CPU map created successfully
+ * @retval  SilInvalidParameter GetProcessorInfo failed
+ * @retval  SilInvalidParameter GetCoreTopologyOnDie failed
+ * @retval  SilNotFound         Info for current ccd, complex, or core not found
+ * @retval  SilOutOfBounds      The input buffer is not sufficient for all CPUs
+ */
+SIL_STATUS
+xPrfCollectCpuMap (
+  SIL_CPU_INFO *RasCpuMap,
+  uint32_t     CpuMapSize,
+  uint32_t     *TotalCpus
+  )
+{
+  SIL_STATUS    Status;
+
+  XPRF_TRACEPOINT (SIL_TRACE_ENTRY, "\n");
+
+  Status = xPrfWalkCpuTopology (RasCpuMap, CpuMapSize, NULL, TotalCpus);
+
   XPRF_TRACEPOINT (SIL_TRACE_EXIT, "\n");
 
-  return SilPass;
+  return Status;
 }
 
 /*
@@ -355,6 +393,37 @@ xPrfCollectCoreMcaInfo (
   return;
 }
 
+/*
+ * xPrfBuildCoreMcaBankMap
+ *
+ * @brief   Build the MCA bank descriptor table of the currently executing cpu.
+ *
+ * @details The table lists the populated MCA banks with their IP type and
+ *          optional registers. The Host keeps one table per thread and passes
+ *          it to the MCA services, which then skip the bank discovery.
+ *
+ * @note    ***This function is executed on all processors by the Host in a
+ *          multi-processor environment.
+ *
+ * @param   Buffer  Pointer to the SIL_CORE_MCA_BANK_MAP (defined in
+ *                  RasClass-api.h) of the currently executing processor.
+ */
+void
+xPrfBuildCoreMcaBankMap (
+  void *Buffer
+  )
+{
+  RAS_IP2IP_API *RasApi;
+
+  if (SilGetIp2IpApi (SilId_RasClass, (void **)&RasApi) != SilPass) {
+    XPRF_TRACEPOINT (SIL_TRACE_ERROR, "RAS API not found!\n");
+    ((SIL_CORE_MCA_BANK_MAP *)Buffer)->BankCount = 0;
+    return;
+  }
+
+  RasApi->BuildCoreMcaBankMap ((SIL_CORE_MCA_BANK_MAP *)Buffer);
+}
+
 /*
  * xPrfCollectMcaErrorInfo
  *
@@ -375,116 +444,245 @@ void
 xPrfCollectMcaErrorInfo (
   void *Buffer
   )
+{
+  xPrfCollectMcaErrorInfoWithBankMap ((SIL_RAS_MCA_ERROR_INFO_V2 *)Buffer, NULL);
+}
+
+/*
+ * xPrfCollectMcaErrorInfoWithBankMap
+ *
+ * @brief   Search the MCA banks of the executing thread for errors.
+ *
+ * @details With the bank map of the thread only the populated banks are
+ *          visited and no MCA_IPID is read for banks without an error. The
+ *          map is a separate input so that RasMcaErrorInfo stays output only.
+ *
+ * @param   RasMcaErrorInfo Output, the banks that hold an error
+ * @param   BankMap         Bank map of the executing core from xPrfBuildCoreMcaBankMap, or NULL
+ *                          to discover the banks from MCG_CAP and MCA_IPID
+ */
+void
+xPrfCollectMcaErrorInfoWithBankMap (
+  SIL_RAS_MCA_ERROR_INFO_V2 *RasMcaErrorInfo,
+  SIL_CORE_MCA_BANK_MAP     *BankMap
+  )
 {
   uint32_t                  i;
   uint32_t                  ErrorCount;
-  uint8_t                   BankNum;
+  uint32_t                  McaBankBase;
   SIL_MCA_STATUS_MSR        McaStatusMsr;
-  SIL_MCA_IPID_MSR          McaIpidMsr;
   SIL_MCA_DESTAT_MSR        McaDeStatusMsr;
-  MCG_CAP_STRUCT            McgCap;
-  bool                      DestatExists;
-  SIL_RAS_MCA_ERROR_INFO_V2 *RasMcaErrorInfo;
+  SIL_MCA_BANK_DESC         *BankDesc;
+  SIL_MCA_BANK_ERROR_INFO   *BankErrorInfo;
+  SIL_CORE_MCA_BANK_MAP     LocalBankMap;
 
-  RasMcaErrorInfo = (SIL_RAS_MCA_ERROR_INFO_V2 *)Buffer;
-  McgCap.Value = xUslRdMsr (MSR_MCG_CAP); // MCG_CAP
-  BankNum = (uint8_t)McgCap.Field.Count;
+  if (BankMap == NULL) {
+    xPrfBuildCoreMcaBankMap (&LocalBankMap);
+    BankMap = &LocalBankMap;
+  }
   ErrorCount = 0;
 
-  for (i = 0; i < BankNum; i++) {
-    McaIpidMsr.Value = xUslRdMsr (
-      (MCA_EXTENSION_BASE + ((i * SMCA_REG_PER_BANK) | MCA_IPID_OFFSET))
-      );
-    if (McaIpidMsr.Field.HardwareID == 0) {
-      continue;
-    }
-
-    DestatExists = true;
-    switch (McaIpidMsr.Field.HardwareID) {
-    case MCA_CPU_CORE_ID:
-      switch (McaIpidMsr.Field.McaType) {
-        case IF_MCA_TYPE:
-        case DE_MCA_TYPE:
-        case EX_MCA_TYPE:
-        case FP_MCA_TYPE:
-          DestatExists = false;
-          break;
-      }
-      break;
-    case MCA_PARAMETER_BLOCK_ID:
-    case MCA_PSP_ID:
-    case MCA_SMU_ID:
-      DestatExists = false;
-      break;
-    }
+  for (i = 0; i < BankMap->BankCount; i++) {
+    BankDesc = &BankMap->Bank[i];
+    McaBankBase = MCA_EXTENSION_BASE + (BankDesc->BankNumber * SMCA_REG_PER_BANK);
 
     //Find error log
-    McaStatusMsr.Value = xUslRdMsr (
-      (MCA_EXTENSION_BASE + ((i * SMCA_REG_PER_BANK) | MCA_STATUS_OFFSET))
-      );
+    McaStatusMsr.Value = xUslRdMsr (McaBankBase | MCA_STATUS_OFFSET);
     McaDeStatusMsr.Value = 0;
-    if (DestatExists) {
-      McaDeStatusMsr.Value = xUslRdMsr (
-        (MCA_EXTENSION_BASE + ((i * SMCA_REG_PER_BANK) | MCA_DESTAT_OFFSET))
-        );
+    if ((BankDesc->Flags & SIL_MCA_BANK_DESTAT_VALID) != 0) {
+      McaDeStatusMsr.Value = xUslRdMsr (McaBankBase | MCA_DESTAT_OFFSET);
     }
 
     if (McaStatusMsr.Field.Val || McaDeStatusMsr.Field.Val) {
       //Collect MSR value
-      RasMcaErrorInfo->McaBankErrorInfo[ErrorCount].McaBankNumber = i;
-      RasMcaErrorInfo->McaBankErrorInfo[ErrorCount].McaStatusMsr =
-        McaStatusMsr.Value;
-      RasMcaErrorInfo->McaBankErrorInfo[ErrorCount].McaAddrMsr =
-        xUslRdMsr (
-          (MCA_EXTENSION_BASE + ((i * SMCA_REG_PER_BANK) | MCA_ADDR_OFFSET))
-          );
-      RasMcaErrorInfo->McaBankErrorInfo[ErrorCount].McaConfigMsr =
-        xUslRdMsr (
-          (MCA_EXTENSION_BASE + ((i * SMCA_REG_PER_BANK) | MCA_CONFIG_OFFSET))
-          );
-      RasMcaErrorInfo->McaBankErrorInfo[ErrorCount].McaIpidMsr =
-        McaIpidMsr.Value;
-      RasMcaErrorInfo->McaBankErrorInfo[ErrorCount].McaSyndMsr =
-        xUslRdMsr (
-          (MCA_EXTENSION_BASE + ((i * SMCA_REG_PER_BANK) | MCA_SYND_OFFSET))
-          );
-      RasMcaErrorInfo->McaBankErrorInfo[ErrorCount].McaMisc0Msr =
-        xUslRdMsr (
-          (MCA_EXTENSION_BASE + ((i * SMCA_REG_PER_BANK) | MCA_MISC0_OFFSET))
-          );
-      if (McaIpidMsr.Field.HardwareID == MCA_UMC_ID) {
-        RasMcaErrorInfo->McaBankErrorInfo[ErrorCount].McaMisc1Msr =
-          xUslRdMsr (
-            (MCA_EXTENSION_BASE + ((i * SMCA_REG_PER_BANK) | MCA_MISC1_OFFSET))
-            );
-        RasMcaErrorInfo->McaBankErrorInfo[ErrorCount].McaSynd1Msr =
-          xUslRdMsr (
-            (MCA_EXTENSION_BASE + ((i * SMCA_REG_PER_BANK) | MCA_SYND1_OFFSET))
-            );
-        RasMcaErrorInfo->McaBankErrorInfo[ErrorCount].McaSynd2Msr =
-          xUslRdMsr (
-            (MCA_EXTENSION_BASE + ((i * SMCA_REG_PER_BANK) | MCA_SYND2_OFFSET))
-            );
-      } else {
-        RasMcaErrorInfo->McaBankErrorInfo[ErrorCount].McaMisc1Msr = 0;
-        RasMcaErrorInfo->McaBankErrorInfo[ErrorCount].McaSynd1Msr = 0;
-        RasMcaErrorInfo->McaBankErrorInfo[ErrorCount].McaSynd2Msr = 0;
+      BankErrorInfo = &RasMcaErrorInfo->McaBankErrorInfo[ErrorCount];
+      BankErrorInfo->McaBankNumber = BankDesc->BankNumber;
+      BankErrorInfo->McaStatusMsr = McaStatusMsr.Value;
+      BankErrorInfo->McaAddrMsr = xUslRdMsr (McaBankBase | MCA_ADDR_OFFSET);
+      BankErrorInfo->McaConfigMsr = xUslRdMsr (McaBankBase | MCA_CONFIG_OFFSET);
+      BankErrorInfo->McaIpidMsr = xUslRdMsr (McaBankBase | MCA_IPID_OFFSET);
+      BankErrorInfo->McaSyndMsr = xUslRdMsr (McaBankBase | MCA_SYND_OFFSET);
+      BankErrorInfo->McaMisc0Msr = xUslRdMsr (McaBankBase | MCA_MISC0_OFFSET);
+      BankErrorInfo->McaMisc1Msr = 0;
+      if ((BankDesc->Flags & SIL_MCA_BANK_MISC1_VALID) != 0) {
+        BankErrorInfo->McaMisc1Msr = xUslRdMsr (McaBankBase | MCA_MISC1_OFFSET);
       }
-      if (DestatExists) {
-        RasMcaErrorInfo->McaBankErrorInfo[ErrorCount].McaDeStatMsr =
-          xUslRdMsr (
-            (MCA_EXTENSION_BASE + ((i * SMCA_REG_PER_BANK) | MCA_DESTAT_OFFSET))
-            );
-        RasMcaErrorInfo->McaBankErrorInfo[ErrorCount].McaDeAddrMsr =
-          xUslRdMsr (
-            (MCA_EXTENSION_BASE + ((i * SMCA_REG_PER_BANK) | MCA_DEADDR_OFFSET))
-            );
-      } else {
-        RasMcaErrorInfo->McaBankErrorInfo[ErrorCount].McaDeStatMsr = 0;
-        RasMcaErrorInfo->McaBankErrorInfo[ErrorCount].McaDeAddrMsr = 0;
+      BankErrorInfo->McaSynd1Msr = 0;
+      BankErrorInfo->McaSynd2Msr = 0;
+      if ((BankDesc->Flags & SIL_MCA_BANK_SYND12_VALID) != 0) {
+        BankErrorInfo->McaSynd1Msr = xUslRdMsr (McaBankBase | MCA_SYND1_OFFSET);
+        BankErrorInfo->McaSynd2Msr = xUslRdMsr (McaBankBase | MCA_SYND2_OFFSET);
+      }
+      BankErrorInfo->McaDeStatMsr = 0;
+      BankErrorInfo->McaDeAddrMsr = 0;
+      if ((BankDesc->Flags & SIL_MCA_BANK_DESTAT_VALID) != 0) {
+        BankErrorInfo->McaDeStatMsr = McaDeStatusMsr.Value;
+        BankErrorInfo->McaDeAddrMsr = xUslRdMsr (McaBankBase | MCA_DEADDR_OFFSET);
       }
       ErrorCount++;
     }
-  }  //for (i = 0; i < BankNum; i++)
+  }  //for (i = 0; i < BankMap->BankCount; i++)
   RasMcaErrorInfo->McaBankCount = ErrorCount;
 }
+
+/*
+ * xPrfGetMcaHarvestSlotSize
+ *
+ * @brief   Return the stride of the MCA harvest slots.
+ *
+ * @details The slot size is rounded up to a cache line so that no two
+ *          processors write to the same line while harvesting.
+ *
+ * @return  Size in bytes of one SIL_MCA_HARVEST_SLOT in the slot array.
+ */
+uint32_t
+xPrfGetMcaHarvestSlotSize (void)
+{
+  return (uint32_t)((sizeof (SIL_MCA_HARVEST_SLOT) + SIL_MCA_HARVEST_SLOT_ALIGN - 1) &
+    ~((size_t)SIL_MCA_HARVEST_SLOT_ALIGN - 1));
+}
+
+/*
+ * xPrfMcaHarvestInit
+ *
+ * @brief   Prepare a per processor MCA harvest buffer.
+ *
+ * @details Builds the APIC ID to processor number table with the processor
+ *          numbering of xPrfCollectCpuMap and clears the slots. This walks
+ *          the CPU topology and must be called once at init, not from the
+ *          error handler.
+ *
+ * @param   Harvest Harvest buffer. On input the Host fills SlotSize,
+ *                  SlotCount, Slots and CoreMcaBankMaps.
+ *
+ * @retval  SilPass             The buffer is ready, Generation is set to 1
+ * @retval  SilInvalidParameter Harvest or Slots is NULL, or SlotSize or the
+ *                              slot alignment is not valid
+ * @retval  SilOutOfBounds      SlotCount is smaller than the number of CPUs
+ */
+SIL_STATUS
+xPrfMcaHarvestInit (
+  SIL_MCA_HARVEST_BUFFER *Harvest
+  )
+{
+  SIL_STATUS            Status;
+  uint32_t              Index;
+  uint32_t              TotalCpus;
+  SIL_MCA_HARVEST_SLOT  *Slot;
+
+  if ((Harvest == NULL) || (Harvest->Slots == NULL) ||
+    (Harvest->SlotSize < xPrfGetMcaHarvestSlotSize ()) ||
+    ((Harvest->SlotSize % SIL_MCA_HARVEST_SLOT_ALIGN) != 0) ||
+    (((size_t)Harvest->Slots % SIL_MCA_HARVEST_SLOT_ALIGN) != 0)) {
+    XPRF_TRACEPOINT (SIL_TRACE_ERROR, "Invalid MCA harvest buffer.\n");
+    return SilInvalidParameter;
+  }
+
+  for (Index = 0; Index < SIL_MCA_HARVEST_MAX_APIC_ID; Index++) {
+    Harvest->ProcessorOfApicId[Index] = SIL_MCA_HARVEST_NO_PROCESSOR;
+  }
+
+  Status = xPrfWalkCpuTopology (NULL, 0, Harvest->ProcessorOfApicId, &TotalCpus);
+  if (Status != SilPass) {
+    return Status;
+  }
+
+  if (Harvest->SlotCount < TotalCpus) {
+    XPRF_TRACEPOINT (
+      SIL_TRACE_ERROR,
+      "MCA harvest has %d slots for %d CPUs.\n",
+      Harvest->SlotCount,
+      TotalCpus
+      );
+    return SilOutOfBounds;
+  }
+
+  for (Index = 0; Index < Harvest->SlotCount; Index++) {
+    Slot = (SIL_MCA_HARVEST_SLOT *)((uint8_t *)Harvest->Slots + (size_t)Index * Harvest->SlotSize);
+    Slot->Generation = 0;
+    Slot->ApicId = 0;
+    Slot->ErrorInfo.McaBankCount = 0;
+  }
+  Harvest->Generation = 1;
+
+  return SilPass;
+}
+
+/*
+ * xPrfHarvestMcaErrorInfo
+ *
+ * @brief   Collect the MCA errors of the executing thread into its own slot.
+ *
+ * @details Every thread writes only to the slot of its processor number, so
+ *          all threads may run at the same time without a lock. The slot is
+ *          published by writing Harvest->Generation to Slot->Generation with a
+ *          locked exchange once ErrorInfo is complete. CpuInfo of the slot is
+ *          not filled, the Host has it from xPrfCollectCpuMap.
+ *
+ * @note    ***This function is executed on all processors by the Host in a
+ *          multi-processor environment.
+ *
+ * @param   Buffer  Pointer to the SIL_MCA_HARVEST_BUFFER prepared by
+ *                  xPrfMcaHarvestInit.
+ */
+void
+xPrfHarvestMcaErrorInfo (
+  void *Buffer
+  )
+{
+  uint32_t                ApicId;
+  uint16_t                ProcessorNumber;
+  SIL_MCA_HARVEST_BUFFER  *Harvest;
+  SIL_MCA_HARVEST_SLOT    *Slot;
+
+  Harvest = (SIL_MCA_HARVEST_BUFFER *)Buffer;
+  ApicId = xUslGetExtendedApicId ();
+  if (ApicId >= SIL_MCA_HARVEST_MAX_APIC_ID) {
+    return;
+  }
+  ProcessorNumber = Harvest->ProcessorOfApicId[ApicId];
+  if ((ProcessorNumber == SIL_MCA_HARVEST_NO_PROCESSOR) || (ProcessorNumber >= Harvest->SlotCount)) {
+    return;
+  }
+
+  Slot = (SIL_MCA_HARVEST_SLOT *)((uint8_t *)Harvest->Slots + (size_t)ProcessorNumber * Harvest->SlotSize);
+  Slot->ApicId = ApicId;
+  xPrfCollectMcaErrorInfoWithBankMap (
+    &Slot->ErrorInfo,
+    (Harvest->CoreMcaBankMaps != NULL) ? &Harvest->CoreMcaBankMaps[ProcessorNumber] : NULL
+    );
+
+  // Locked exchange orders the ErrorInfo stores before the publish
+  xUslInterlockedExchange32 (&Slot->Generation, Harvest->Generation);
+}
+
+/*
+ * xPrfGetMcaHarvestSlot
+ *
+ * @brief   Return the slot of a processor if it was published by the current
+ *          harvest.
+ *
+ * @param   Harvest         Harvest buffer
+ * @param   ProcessorNumber Processor number from xPrfCollectCpuMap
+ *
+ * @return  The slot, or NULL if the processor has not published it yet.
+ */
+SIL_MCA_HARVEST_SLOT *
+xPrfGetMcaHarvestSlot (
+  SIL_MCA_HARVEST_BUFFER  *Harvest,
+  uint32_t                ProcessorNumber
+  )
+{
+  SIL_MCA_HARVEST_SLOT  *Slot;
+
+  if (ProcessorNumber >= Harvest->SlotCount) {
+    return NULL;
+  }
+
+  Slot = (SIL_MCA_HARVEST_SLOT *)((uint8_t *)Harvest->Slots + (size_t)ProcessorNumber * Harvest->SlotSize);
+  if (Slot->Generation != Harvest->Generation) {
+    return NULL;
+  }
+
+  return Slot;
+}
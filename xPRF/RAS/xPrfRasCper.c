@@ -0,0 +1,410 @@
+/**
+ * @file  xPrfRasCper.c
+ * @brief Platform Reference Firmware - builds UEFI Common Platform Error
+ *        Records (CPER) from collected MCA banks for RAS.
+ */
+/* Copyright 2023 Advanced Micro Devices, Inc. All rights reserved.    */
+// SPDX-License-Identifier: MIT
+
+#include <SilCommon.h>
+#include <xPRF-api.h>
+#include <RAS/Common/RasClass-api.h>
+#include <RAS/Common/RasReg.h>
+#include <RAS/RasDefs.h>
+#include <MsrReg.h>
+#include <string.h>
+
+// UMC channel number in MCA_IPID[InstanceId] of a UMC bank, see UMCx_MCA_INS_ID
+#define CPER_UMC_INSTANCE_CHANNEL_SHIFT   20
+#define CPER_UMC_INSTANCE_CHANNEL_MASK    0xF
+
+// Chip selects per DIMM, used to split the chip select in module and rank
+#define CPER_CS_PER_DIMM                  2
+
+static const SIL_CPER_GUID mCperProcGenericSectionGuid =
+  {0x9876CCAD, 0x47B4, 0x4BDB, {0xB6, 0x5E, 0x16, 0xF1, 0x93, 0xC4, 0xF3, 0xDB}};
+static const SIL_CPER_GUID mCperMemoryErrorSectionGuid =
+  {0xA5BC1114, 0x6F64, 0x4EDE, {0xB8, 0x63, 0x3E, 0x83, 0xED, 0x7C, 0x83, 0xB1}};
+static const SIL_CPER_GUID mCperNotifyMceGuid =
+  {0xE8F56FFE, 0x919C, 0x4CC5, {0xBA, 0x88, 0x65, 0xAB, 0xE1, 0x49, 0x13, 0xBB}};
+static const SIL_CPER_GUID mCperNotifyCmcGuid =
+  {0x2DCE8BB1, 0xBDD7, 0x450E, {0xB9, 0xAD, 0x9C, 0xF4, 0xEB, 0xD4, 0xF8, 0x90}};
+
+/*
+ * xPrfCperIsUmcAddressError
+ *
+ * @brief   Check if a bank dump reports a DRAM address.
+ *
+ * @param   BankErrorInfo MCA registers of the bank
+ *
+ * @retval  true  The bank is a UMC bank with a valid MCA_ADDR
+ * @retval  false Otherwise
+ */
+static
+bool
+xPrfCperIsUmcAddressError (
+  SIL_MCA_BANK_ERROR_INFO *BankErrorInfo
+  )
+{
+  SIL_MCA_STATUS_MSR  McaStatus;
+  SIL_MCA_IPID_MSR    McaIpid;
+
+  McaStatus.Value = BankErrorInfo->McaStatusMsr;
+  McaIpid.Value = BankErrorInfo->McaIpidMsr;
+
+  return (McaIpid.Field.HardwareID == MCA_UMC_ID) && (McaIpid.Field.McaType == UMC_MCA_TYPE) &&
+    (McaStatus.Field.AddrV != 0);
+}
+
+/*
+ * xPrfCperGetSeverity
+ *
+ * @brief   CPER severity of an MCA bank error.
+ *
+ * @param   McaStatus MCA_STATUS of the bank
+ *
+ * @return  SIL_CPER_SEVERITY_xxx
+ */
+static
+uint32_t
+xPrfCperGetSeverity (
+  SIL_MCA_STATUS_MSR  McaStatus
+  )
+{
+  if (McaStatus.Field.UC != 0) {
+    return (McaStatus.Field.PCC != 0) ? SIL_CPER_SEVERITY_FATAL : SIL_CPER_SEVERITY_RECOVERABLE;
+  }
+  if (McaStatus.Field.Deferred != 0) {
+    return SIL_CPER_SEVERITY_RECOVERABLE;
+  }
+  return SIL_CPER_SEVERITY_CORRECTED;
+}
+
+/*
+ * xPrfCperSeverityRank
+ *
+ * @brief   Order the CPER severities, the record takes the highest one.
+ *
+ * @param   Severity  SIL_CPER_SEVERITY_xxx
+ *
+ * @return  0 for informational up to 3 for fatal
+ */
+static
+uint32_t
+xPrfCperSeverityRank (
+  uint32_t  Severity
+  )
+{
+  switch (Severity) {
+    case SIL_CPER_SEVERITY_FATAL:
+      return 3;
+    case SIL_CPER_SEVERITY_RECOVERABLE:
+      return 2;
+    case SIL_CPER_SEVERITY_CORRECTED:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+/*
+ * xPrfCperFillProcSection
+ *
+ * @brief   Decode an MCA bank into a processor generic error section.
+ *
+ * @details The error type, cache level and operation come from the
+ *          architectural error code classes of MCA_STATUS[ErrorCode].
+ *
+ * @param   BankErrorInfo MCA registers of the bank
+ * @param   Section       Section to fill, in the Host buffer
+ */
+static
+void
+xPrfCperFillProcSection (
+  SIL_MCA_BANK_ERROR_INFO       *BankErrorInfo,
+  SIL_CPER_PROC_GENERIC_SECTION *Section
+  )
+{
+  SIL_MCA_STATUS_MSR  McaStatus;
+  uint32_t            ErrorCode;
+
+  McaStatus.Value = BankErrorInfo->McaStatusMsr;
+  ErrorCode = (uint32_t)McaStatus.Field.ErrorCode;
+
+  memset (Section, 0, sizeof (SIL_CPER_PROC_GENERIC_SECTION));
+  Section->ValidationBits = SIL_CPER_PROC_VALID_TYPE | SIL_CPER_PROC_VALID_ISA |
+    SIL_CPER_PROC_VALID_ERROR_TYPE | SIL_CPER_PROC_VALID_FLAGS;
+  Section->ProcessorType = SIL_CPER_PROC_TYPE_IA32_X64;
+  Section->ProcessorIsa = SIL_CPER_PROC_ISA_X64;
+
+  if ((ErrorCode & 0xFFF0) == 0x0010) {
+    // TLB error: 0000 0000 0001 TTLL
+    Section->ErrorType = SIL_CPER_PROC_ERROR_TLB;
+    Section->Level = (uint8_t)(ErrorCode & 0x3);
+    Section->ValidationBits |= SIL_CPER_PROC_VALID_LEVEL;
+  } else if ((ErrorCode & 0xFF00) == 0x0100) {
+    // Memory hierarchy error: 0000 0001 RRRR TTLL
+    Section->ErrorType = SIL_CPER_PROC_ERROR_CACHE;
+    Section->Level = (uint8_t)(ErrorCode & 0x3);
+    switch ((ErrorCode >> 4) & 0xF) {
+      case 1:
+      case 3:
+        Section->Operation = SIL_CPER_PROC_OP_DATA_READ;
+        break;
+      case 2:
+      case 4:
+        Section->Operation = SIL_CPER_PROC_OP_DATA_WRITE;
+        break;
+      case 5:
+        Section->Operation = SIL_CPER_PROC_OP_INSTRUCTION;
+        break;
+      default:
+        Section->Operation = SIL_CPER_PROC_OP_GENERIC;
+        break;
+    }
+    Section->ValidationBits |= SIL_CPER_PROC_VALID_LEVEL | SIL_CPER_PROC_VALID_OPERATION;
+  } else if ((ErrorCode & 0xF800) == 0x0800) {
+    // Bus error: 0000 1PPT RRRR IILL
+    Section->ErrorType = SIL_CPER_PROC_ERROR_BUS;
+    Section->Level = (uint8_t)(ErrorCode & 0x3);
+    Section->ValidationBits |= SIL_CPER_PROC_VALID_LEVEL;
+  } else if (ErrorCode != 0) {
+    Section->ErrorType = SIL_CPER_PROC_ERROR_MICRO_ARCH;
+  } else {
+    Section->ErrorType = SIL_CPER_PROC_ERROR_UNKNOWN;
+  }
+
+  if (McaStatus.Field.PCC == 0) {
+    Section->Flags |= SIL_CPER_PROC_FLAG_RESTARTABLE;
+  }
+  if (McaStatus.Field.Overflow != 0) {
+    Section->Flags |= SIL_CPER_PROC_FLAG_OVERFLOW;
+  }
+  if (McaStatus.Field.UC == 0) {
+    Section->Flags |= SIL_CPER_PROC_FLAG_CORRECTED;
+  }
+
+  if (McaStatus.Field.AddrV != 0) {
+    Section->TargetAddress = BankErrorInfo->McaAddrMsr;
+    Section->ValidationBits |= SIL_CPER_PROC_VALID_TARGET_ADDR;
+  }
+}
+
+/*
+ * xPrfCperFillMemorySection
+ *
+ * @brief   Decode a UMC bank into a platform memory error section.
+ *
+ * @details The normalized address is taken from MCA_ADDR and translated with
+ *          xPrfMcaErrorAddrTranslate. Node and card are always valid, the
+ *          DRAM location and physical address only when the SoC provides the
+ *          translation.
+ *
+ * @param   BankErrorInfo MCA registers of a UMC bank with a valid MCA_ADDR
+ * @param   AddrData      Dimm information map from xPrfCollectDimmMap
+ * @param   Section       Section to fill, in the Host buffer
+ */
+static
+void
+xPrfCperFillMemorySection (
+  SIL_MCA_BANK_ERROR_INFO       *BankErrorInfo,
+  SIL_ADDR_DATA                 *AddrData,
+  SIL_CPER_MEMORY_ERROR_SECTION *Section
+  )
+{
+  SIL_STATUS              Status;
+  SIL_MCA_STATUS_MSR      McaStatus;
+  SIL_MCA_ADDR_MSR        McaAddr;
+  SIL_MCA_IPID_MSR        McaIpid;
+  SIL_NORMALIZED_ADDRESS  NormalizedAddress;
+  SIL_DIMM_INFO           DimmInfo;
+  uint64_t                SystemAddress;
+  uint64_t                AddrMask;
+
+  McaStatus.Value = BankErrorInfo->McaStatusMsr;
+  McaAddr.Value = BankErrorInfo->McaAddrMsr;
+  McaIpid.Value = BankErrorInfo->McaIpidMsr;
+  AddrMask = ~((1ull << McaStatus.Field.AddrLsb) - 1);
+
+  memset (Section, 0, sizeof (SIL_CPER_MEMORY_ERROR_SECTION));
+  Section->ValidationBits = SIL_CPER_MEM_VALID_NODE | SIL_CPER_MEM_VALID_CARD | SIL_CPER_MEM_VALID_ERROR_TYPE;
+  Section->Node = (uint16_t)McaIpid.Field.InstanceIdHi;
+  Section->Card = (uint16_t)((McaIpid.Field.InstanceId >> CPER_UMC_INSTANCE_CHANNEL_SHIFT) &
+    CPER_UMC_INSTANCE_CHANNEL_MASK);
+  if (McaStatus.Field.UECC != 0) {
+    Section->ErrorType = SIL_CPER_MEM_ERROR_MULTI_BIT_ECC;
+  } else if (McaStatus.Field.CECC != 0) {
+    Section->ErrorType = SIL_CPER_MEM_ERROR_SINGLE_BIT_ECC;
+  } else {
+    Section->ErrorType = SIL_CPER_MEM_ERROR_UNKNOWN;
+  }
+
+  if (AddrData == NULL) {
+    return;
+  }
+
+  NormalizedAddress.NormalizedAddr = McaAddr.Field.ErrorAddr & AddrMask;
+  NormalizedAddress.NormalizedSocketId = (uint8_t)Section->Node;
+  NormalizedAddress.NormalizedDieId = 0;
+  NormalizedAddress.NormalizedChannelId = (uint8_t)Section->Card;
+  NormalizedAddress.Reserved = 0;
+  Status = xPrfMcaErrorAddrTranslate (&SystemAddress, &NormalizedAddress, &DimmInfo, AddrData);
+  if ((Status != SilPass) && (Status != SilInvalidParameter)) {
+    // The SoC does not translate addresses, DimmInfo was not written
+    return;
+  }
+
+  Section->Module = DimmInfo.ChipSelect / CPER_CS_PER_DIMM;
+  Section->RankNumber = DimmInfo.ChipSelect % CPER_CS_PER_DIMM;
+  Section->Bank = DimmInfo.Bank;
+  Section->Row = (uint16_t)DimmInfo.Row;
+  Section->Extended = (uint8_t)((DimmInfo.Row >> 16) & 0x3);
+  Section->Column = DimmInfo.Column;
+  Section->ValidationBits |= SIL_CPER_MEM_VALID_MODULE | SIL_CPER_MEM_VALID_RANK | SIL_CPER_MEM_VALID_BANK |
+    SIL_CPER_MEM_VALID_ROW | SIL_CPER_MEM_VALID_EXTENDED_ROW | SIL_CPER_MEM_VALID_COLUMN;
+
+  if (Status == SilPass) {
+    Section->PhysicalAddress = SystemAddress & AddrMask;
+    Section->PhysicalAddressMask = AddrMask;
+    Section->ValidationBits |= SIL_CPER_MEM_VALID_PA | SIL_CPER_MEM_VALID_PA_MASK;
+  }
+}
+
+/*
+ * xPrfBuildCperRecord
+ *
+ * @brief   Build a CPER record for the MCA banks collected on one thread.
+ *
+ * @details Every bank with an error gets a processor generic section. UMC
+ *          banks with an address get a platform memory error section as well.
+ *          The header, descriptors and sections are written in place into the
+ *          Host buffer. TimeStamp, PlatformId, PartitionId, CreatorId and
+ *          RecordId are left zero for the Host to fill.
+ *
+ * @param   ErrorInfo   MCA banks from xPrfCollectMcaErrorInfo
+ * @param   AddrData    Dimm information map from xPrfCollectDimmMap, or NULL to
+ *                      skip the DRAM location decode
+ * @param   Record      Host buffer for the record, may be NULL to query the size
+ * @param   RecordSize  On input, the size of the Record buffer.
+ *                      On output, the size of the record.
+ *
+ * @retval  SilPass             The record was built
+ * @retval  SilInvalidParameter ErrorInfo or RecordSize is NULL
+ * @retval  SilNotFound         ErrorInfo holds no MCA bank
+ * @retval  SilOutOfBounds      The Record buffer is too small, RecordSize holds
+ *                              the size needed
+ */
+SIL_STATUS
+xPrfBuildCperRecord (
+  SIL_RAS_MCA_ERROR_INFO_V2 *ErrorInfo,
+  SIL_ADDR_DATA             *AddrData,
+  void                      *Record,
+  uint32_t                  *RecordSize
+  )
+{
+  uint32_t                    Index;
+  uint32_t                    BankCount;
+  uint32_t                    SectionCount;
+  uint32_t                    SectionIndex;
+  uint32_t                    DataOffset;
+  uint32_t                    Size;
+  uint32_t                    Severity;
+  SIL_MCA_STATUS_MSR          McaStatus;
+  SIL_MCA_BANK_ERROR_INFO     *BankErrorInfo;
+  SIL_CPER_RECORD_HEADER      *Header;
+  SIL_CPER_SECTION_DESCRIPTOR *Descriptor;
+  bool                        MachineCheck;
+
+  if ((ErrorInfo == NULL) || (RecordSize == NULL)) {
+    return SilInvalidParameter;
+  }
+
+  BankCount = (uint32_t)ErrorInfo->McaBankCount;
+  if (BankCount > XMCA_MAX_BANK_COUNT) {
+    BankCount = XMCA_MAX_BANK_COUNT;
+  }
+  if (BankCount == 0) {
+    return SilNotFound;
+  }
+
+  // Size the record before writing anything
+  SectionCount = BankCount;
+  Size = BankCount * sizeof (SIL_CPER_PROC_GENERIC_SECTION);
+  for (Index = 0; Index < BankCount; Index++) {
+    if (xPrfCperIsUmcAddressError (&ErrorInfo->McaBankErrorInfo[Index])) {
+      SectionCount++;
+      Size += sizeof (SIL_CPER_MEMORY_ERROR_SECTION);
+    }
+  }
+  DataOffset = sizeof (SIL_CPER_RECORD_HEADER) + SectionCount * sizeof (SIL_CPER_SECTION_DESCRIPTOR);
+  Size += DataOffset;
+
+  if ((Record == NULL) || (*RecordSize < Size)) {
+    *RecordSize = Size;
+    return SilOutOfBounds;
+  }
+  *RecordSize = Size;
+
+  Header = (SIL_CPER_RECORD_HEADER *)Record;
+  Descriptor = (SIL_CPER_SECTION_DESCRIPTOR *)(Header + 1);
+  memset (Header, 0, DataOffset);
+
+  Severity = SIL_CPER_SEVERITY_INFO;
+  MachineCheck = false;
+  SectionIndex = 0;
+  for (Index = 0; Index < BankCount; Index++) {
+    BankErrorInfo = &ErrorInfo->McaBankErrorInfo[Index];
+    McaStatus.Value = BankErrorInfo->McaStatusMsr;
+    if (McaStatus.Field.UC != 0) {
+      MachineCheck = true;
+    }
+
+    Descriptor[SectionIndex].SectionOffset = DataOffset;
+    Descriptor[SectionIndex].SectionLength = sizeof (SIL_CPER_PROC_GENERIC_SECTION);
+    Descriptor[SectionIndex].Revision = SIL_CPER_SECTION_REVISION;
+    Descriptor[SectionIndex].SectionType = mCperProcGenericSectionGuid;
+    Descriptor[SectionIndex].SectionSeverity = xPrfCperGetSeverity (McaStatus);
+    xPrfCperFillProcSection (
+      BankErrorInfo,
+      (SIL_CPER_PROC_GENERIC_SECTION *)((uint8_t *)Record + DataOffset)
+      );
+    if (xPrfCperSeverityRank (Descriptor[SectionIndex].SectionSeverity) > xPrfCperSeverityRank (Severity)) {
+      Severity = Descriptor[SectionIndex].SectionSeverity;
+    }
+    DataOffset += sizeof (SIL_CPER_PROC_GENERIC_SECTION);
+    SectionIndex++;
+
+    if (xPrfCperIsUmcAddressError (BankErrorInfo)) {
+      Descriptor[SectionIndex].SectionOffset = DataOffset;
+      Descriptor[SectionIndex].SectionLength = sizeof (SIL_CPER_MEMORY_ERROR_SECTION);
+      Descriptor[SectionIndex].Revision = SIL_CPER_SECTION_REVISION;
+      Descriptor[SectionIndex].SectionType = mCperMemoryErrorSectionGuid;
+      Descriptor[SectionIndex].SectionSeverity = Descriptor[SectionIndex - 1].SectionSeverity;
+      xPrfCperFillMemorySection (
+        BankErrorInfo,
+        AddrData,
+        (SIL_CPER_MEMORY_ERROR_SECTION *)((uint8_t *)Record + DataOffset)
+        );
+      DataOffset += sizeof (SIL_CPER_MEMORY_ERROR_SECTION);
+      SectionIndex++;
+    }
+  }
+
+  // The first section of the highest severity is the primary one
+  for (Index = 0; Index < SectionCount; Index++) {
+    if (Descriptor[Index].SectionSeverity == Severity) {
+      Descriptor[Index].Flags |= SIL_CPER_SECTION_FLAG_PRIMARY;
+      break;
+    }
+  }
+
+  Header->SignatureStart = SIL_CPER_SIGNATURE;
+  Header->Revision = SIL_CPER_REVISION;
+  Header->SignatureEnd = SIL_CPER_SIGNATURE_END;
+  Header->SectionCount = (uint16_t)SectionCount;
+  Header->ErrorSeverity = Severity;
+  Header->RecordLength = Size;
+  Header->NotificationType = MachineCheck ? mCperNotifyMceGuid : mCperNotifyCmcGuid;
+
+  return SilPass;
+}
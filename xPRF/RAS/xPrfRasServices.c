@@ -16,6 +16,48 @@
 #include <string.h>
 #include <DF/DfIp2Ip.h>
 
+// Translations kept during one xPrfMcaErrorAddrTranslateBatch call, must be a power of 2
+#define XPRF_ADDR_TRANSLATE_CACHE_SIZE  16
+
+/*
+ * xPrfGetRasTranslationApi
+ *
+ * @brief   Get the RAS Ip2Ip API and check that it provides the address
+ *          translation services of one direction.
+ *
+ * @param   RasApi    On output, the RAS Ip2Ip API
+ * @param   FromSys   true to translate from a system address (CalcNormAddr),
+ *                    false from a normalized address (CalcSysAddr). Both need
+ *                    TranslateNormToDramAddr.
+ *
+ * @retval  SilPass         The API provides the translation services
+ * @retval  SilNotFound     The RAS API was not found in the API list
+ * @retval  SilUnsupported  The SoC does not provide the translation services
+ */
+static
+SIL_STATUS
+xPrfGetRasTranslationApi (
+  RAS_IP2IP_API **RasApi,
+  bool          FromSys
+  )
+{
+  SIL_STATUS    Status;
+
+  Status = SilGetIp2IpApi (SilId_RasClass, (void **)RasApi);
+  if (Status != SilPass) {
+    XPRF_TRACEPOINT (SIL_TRACE_ERROR, "RAS API not found!\n");
+    return Status;
+  }
+
+  if (((*RasApi)->TranslateNormToDramAddr == NULL) ||
+      (FromSys ? ((*RasApi)->CalcNormAddr == NULL) : ((*RasApi)->CalcSysAddr == NULL))) {
+    XPRF_TRACEPOINT (SIL_TRACE_ERROR, "RAS address translation not supported!\n");
+    return SilUnsupported;
+  }
+
+  return SilPass;
+}
+
 /*
  * xPrfMcaErrorAddrTranslate
  *
@@ -47,9 +89,8 @@ xPrfMcaErrorAddrTranslate (
   SIL_STATUS    Status;
   RAS_IP2IP_API *RasApi;
 
-  Status = SilGetIp2IpApi (SilId_RasClass, (void **)&RasApi);
+  Status = xPrfGetRasTranslationApi (&RasApi, false);
   if (Status != SilPass) {
-    XPRF_TRACEPOINT (SIL_TRACE_ERROR, "RAS API not found!\n");
     return Status;
   }
 
@@ -84,6 +125,114 @@ xPrfMcaErrorAddrTranslate (
   return SilPass;
 }
 
+/*
+ * xPrfMcaErrorAddrTranslateBatch
+ *
+ * @brief   Translate an array of UMC normalized addresses into DIMM information
+ *          and system addresses in one call.
+ *
+ * @details The RAS translation services are resolved once for the whole array.
+ *          Correctable error storms report the same few addresses many times,
+ *          so while the array is processed its translations are kept in a small
+ *          table indexed by address and channel, and an address repeated within
+ *          the array is copied from it instead of walking the UMC and DF decode
+ *          again. The table does not outlive the call.
+ *
+ * @param   Entries         Array of addresses to translate. On input the Host
+ *                          fills NormalizedAddress, on output DimmInfo,
+ *                          SystemAddress and Translated are populated.
+ * @param   EntryCount      Number of entries in Entries
+ * @param   AddrData        Dimm information map, created by Host call to
+ *                          xPrfCollectDimmMap, used in address translation
+ * @param   TranslatedCount On output, the number of entries with a valid
+ *                          system address
+ *
+ * @return  SIL_STATUS
+ *
+ * @retval  SilPass             All entries were processed
+ * @retval  SilInvalidParameter A required pointer is NULL
+ * @retval  SilNotFound         RAS API was not found in the API list
+ * @retval  SilUnsupported      The SoC does not provide address translation
+ */
+SIL_STATUS
+xPrfMcaErrorAddrTranslateBatch (
+  SIL_ADDR_TRANSLATE_ENTRY  *Entries,
+  uint32_t                  EntryCount,
+  SIL_ADDR_DATA             *AddrData,
+  uint32_t                  *TranslatedCount
+  )
+{
+  SIL_STATUS                Status;
+  RAS_IP2IP_API             *RasApi;
+  SIL_ADDR_TRANSLATE_ENTRY  *Entry;
+  SIL_NORMALIZED_ADDRESS    *Address;
+  SIL_ADDR_TRANSLATE_ENTRY  *Cached;
+  SIL_ADDR_TRANSLATE_ENTRY  Cache[XPRF_ADDR_TRANSLATE_CACHE_SIZE];
+  uint32_t                  Index;
+  uint32_t                  Slot;
+
+  if ((Entries == NULL) || (AddrData == NULL) || (TranslatedCount == NULL)) {
+    return SilInvalidParameter;
+  }
+
+  *TranslatedCount = 0;
+  Status = xPrfGetRasTranslationApi (&RasApi, false);
+  if (Status != SilPass) {
+    return Status;
+  }
+
+  // An all ones address never comes out of the UMC, so it marks a free slot
+  memset (Cache, 0xFF, sizeof (Cache));
+
+  for (Index = 0; Index < EntryCount; Index++) {
+    Entry = &Entries[Index];
+    Address = &Entry->NormalizedAddress;
+
+    Slot = (uint32_t)((Address->NormalizedAddr >> 6) ^ Address->NormalizedChannelId ^
+      ((uint32_t)Address->NormalizedDieId << 2) ^ ((uint32_t)Address->NormalizedSocketId << 3)) &
+      (XPRF_ADDR_TRANSLATE_CACHE_SIZE - 1);
+    Cached = &Cache[Slot];
+
+    if ((Cached->NormalizedAddress.NormalizedAddr == Address->NormalizedAddr) &&
+        (Cached->NormalizedAddress.NormalizedSocketId == Address->NormalizedSocketId) &&
+        (Cached->NormalizedAddress.NormalizedDieId == Address->NormalizedDieId) &&
+        (Cached->NormalizedAddress.NormalizedChannelId == Address->NormalizedChannelId)) {
+      Entry->DimmInfo = Cached->DimmInfo;
+      Entry->SystemAddress = Cached->SystemAddress;
+      Entry->Translated = Cached->Translated;
+    } else {
+      memset (&Entry->DimmInfo, 0, sizeof (SIL_DIMM_INFO));
+      RasApi->TranslateNormToDramAddr (
+        Address->NormalizedAddr,
+        Address->NormalizedSocketId,
+        Address->NormalizedDieId,
+        Address->NormalizedChannelId,
+        0,
+        &Entry->DimmInfo.ChipSelect,
+        &Entry->DimmInfo.Bank,
+        &Entry->DimmInfo.Row,
+        &Entry->DimmInfo.Column,
+        &Entry->DimmInfo.Rankmul,
+        &Entry->DimmInfo.SubChan,
+        AddrData
+        );
+      Entry->SystemAddress = RasApi->CalcSysAddr (
+        Address->NormalizedAddr,
+        Address->NormalizedSocketId,
+        Address->NormalizedChannelId
+        );
+      Entry->Translated = (Entry->SystemAddress != 0xffffffffffffffff);
+      *Cached = *Entry;
+    }
+
+    if (Entry->Translated) {
+      (*TranslatedCount)++;
+    }
+  }
+
+  return SilPass;
+}
+
 /*
  * xPrfTranslateSysAddrToCS
  *
@@ -109,9 +258,8 @@ xPrfTranslateSysAddrToCS (
   SIL_STATUS    Status;
   RAS_IP2IP_API *RasApi;
 
-  Status = SilGetIp2IpApi (SilId_RasClass, (void **)&RasApi);
+  Status = xPrfGetRasTranslationApi (&RasApi, true);
   if (Status != SilPass) {
-    XPRF_TRACEPOINT (SIL_TRACE_ERROR, "RAS API not found!\n");
     return Status;
   }
 
@@ -146,6 +294,7 @@ xPrfTranslateSysAddrToCS (
  * @brief Program the Core MCA_IPID MSR Instance ID values for the CPU specified in RasCpuInfo.
  *
  * @param   RasCpuInfo  The CPU info structure for the core to program (RasClass-api.h)
+ * @param   BankMap     Bank map of the executing core from xPrfBuildCoreMcaBankMap, or NULL
  *
  * @return  SIL_STATUS
  * @retval  SilPass     If the function completed normally
@@ -153,7 +302,8 @@ xPrfTranslateSysAddrToCS (
  */
 SIL_STATUS
 xPrfMcaIpIdInstanceIdInit (
-  SIL_CPU_INFO  *RasCpuInfo
+  SIL_CPU_INFO          *RasCpuInfo,
+  SIL_CORE_MCA_BANK_MAP *BankMap
   )
 {
   SIL_STATUS            Status;
@@ -165,7 +315,7 @@ xPrfMcaIpIdInstanceIdInit (
     return Status;
   }
 
-  RasApi->ProgramCoreMcaIpIdInstanceId (RasCpuInfo);
+  RasApi->ProgramCoreMcaIpIdInstanceId (RasCpuInfo, BankMap);
 
   return SilPass;
 }
@@ -216,6 +366,7 @@ xPrfProgramCoreMcaConfigUmc (
  *                        appropriate IP structure with valid policy information. Currently supported IP structures:
  *
  *                        - SIL_NBIO_RAS_POLICY
+ * @param BankMap         Bank map of the executing core from xPrfBuildCoreMcaBankMap, or NULL
  *
  * @returns SIL_STATUS
  * @retval  SilNotFound   If RAS API was not found in the API list
@@ -224,9 +375,10 @@ xPrfProgramCoreMcaConfigUmc (
  */
 SIL_STATUS
 xPrfSetIpMcaCtlMask (
-  uint16_t          HardwareId,
-  uint16_t          McaType,
-  SIL_IP_RAS_POLICY *IpMcaPolicyCfg
+  uint16_t              HardwareId,
+  uint16_t              McaType,
+  SIL_IP_RAS_POLICY     *IpMcaPolicyCfg,
+  SIL_CORE_MCA_BANK_MAP *BankMap
   )
 {
   SIL_STATUS            Status;
@@ -240,7 +392,8 @@ xPrfSetIpMcaCtlMask (
 
   RasApi->SetIpMcaCtlMask (HardwareId,
                            McaType,
-                           IpMcaPolicyCfg
+                           IpMcaPolicyCfg,
+                           BankMap
                            );
 
   return SilPass;
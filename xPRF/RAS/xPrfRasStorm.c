@@ -0,0 +1,470 @@
+/**
+ * @file  xPrfRasStorm.c
+ * @brief Platform Reference Firmware - correctable error storm detection
+ *        service for RAS.
+ */
+/* Copyright 2023 Advanced Micro Devices, Inc. All rights reserved.    */
+// SPDX-License-Identifier: MIT
+
+#include <SilCommon.h>
+#include <xPRF-api.h>
+#include <RAS/Common/RasClass-api.h>
+#include <RAS/Common/RasReg.h>
+#include <RAS/RasDefs.h>
+#include <MsrReg.h>
+#include <CommonLib/CpuLib.h>
+#include <string.h>
+
+#define CE_STORM_MCA_ERR_CNT_MAX    0xFFF   ///< MCA_MISC0[ErrCnt] value that overflows on the next error
+#define CE_STORM_NO_DIMM            0xFF
+
+/*
+ * xPrfCeStormLeak
+ *
+ * @brief   Leak the errors accumulated since the last leak out of a bucket.
+ *
+ * @param   Bucket        Leaky bucket to update
+ * @param   LeakPeriodMs  One error leaks out per period
+ * @param   TimeMs        Current time
+ */
+static
+void
+xPrfCeStormLeak (
+  SIL_CE_LEAKY_BUCKET *Bucket,
+  uint32_t            LeakPeriodMs,
+  uint64_t            TimeMs
+  )
+{
+  uint64_t  Leaked;
+
+  if (TimeMs <= Bucket->LastLeakMs) {
+    return;
+  }
+
+  Leaked = (TimeMs - Bucket->LastLeakMs) / LeakPeriodMs;
+  if (Leaked >= Bucket->Level) {
+    Bucket->Level = 0;
+    Bucket->LastLeakMs = TimeMs;
+  } else {
+    Bucket->Level -= (uint32_t)Leaked;
+    // Keep the part of the period that has not leaked an error yet
+    Bucket->LastLeakMs += Leaked * LeakPeriodMs;
+  }
+}
+
+/*
+ * xPrfCeStormFindDimm
+ *
+ * @brief   Find the counters of a DIMM, allocating them on its first error.
+ *
+ * @param   Context Storm state of the socket
+ * @param   Die     Die of the DIMM
+ * @param   Channel Channel of the DIMM
+ * @param   Module  Module of the DIMM in the channel
+ * @param   TimeMs  Current time
+ *
+ * @return  Index of the DIMM in Context->Dimm, CE_STORM_NO_DIMM if the table is
+ *          full
+ */
+static
+uint8_t
+xPrfCeStormFindDimm (
+  SIL_CE_STORM_CONTEXT  *Context,
+  uint8_t               Die,
+  uint8_t               Channel,
+  uint8_t               Module,
+  uint64_t              TimeMs
+  )
+{
+  SIL_CE_STORM_DIMM *Dimm;
+  uint8_t           Free;
+  uint8_t           Index;
+
+  Free = CE_STORM_NO_DIMM;
+  for (Index = 0; Index < SIL_CE_STORM_MAX_DIMMS; Index++) {
+    Dimm = &Context->Dimm[Index];
+    if (!Dimm->Valid) {
+      if (Free == CE_STORM_NO_DIMM) {
+        Free = Index;
+      }
+      continue;
+    }
+    if ((Dimm->Die == Die) && (Dimm->Channel == Channel) && (Dimm->Module == Module)) {
+      return Index;
+    }
+  }
+
+  if (Free != CE_STORM_NO_DIMM) {
+    Dimm = &Context->Dimm[Free];
+    Dimm->Valid = true;
+    Dimm->Die = Die;
+    Dimm->Channel = Channel;
+    Dimm->Module = Module;
+    Dimm->Bucket.Level = 0;
+    Dimm->Bucket.LastLeakMs = TimeMs;
+  }
+
+  return Free;
+}
+
+/*
+ * xPrfCeStormFindBank
+ *
+ * @brief   Find the counters of a DRAM bank. On its first error the bank takes a
+ *          free entry, or the entry of the bank that was hit least recently.
+ *
+ * @param   Context   Storm state of the socket
+ * @param   DimmIndex Index of the DIMM of the bank
+ * @param   DimmInfo  DRAM address of the error
+ * @param   TimeMs    Current time
+ *
+ * @return  The bank counters
+ */
+static
+SIL_CE_STORM_BANK *
+xPrfCeStormFindBank (
+  SIL_CE_STORM_CONTEXT  *Context,
+  uint8_t               DimmIndex,
+  SIL_DIMM_INFO         *DimmInfo,
+  uint64_t              TimeMs
+  )
+{
+  SIL_CE_STORM_BANK *Bank;
+  SIL_CE_STORM_BANK *Victim;
+  uint32_t          Index;
+
+  Victim = &Context->Bank[0];
+  for (Index = 0; Index < SIL_CE_STORM_MAX_BANKS; Index++) {
+    Bank = &Context->Bank[Index];
+    if (!Bank->Valid) {
+      if (Victim->Valid) {
+        Victim = Bank;
+      }
+      continue;
+    }
+    if ((Bank->DimmIndex == DimmIndex) && (Bank->ChipSelect == DimmInfo->ChipSelect) &&
+        (Bank->SubChan == DimmInfo->SubChan) && (Bank->Bank == DimmInfo->Bank)) {
+      return Bank;
+    }
+    if (Victim->Valid && (Bank->Bucket.LastLeakMs < Victim->Bucket.LastLeakMs)) {
+      Victim = Bank;
+    }
+  }
+
+  Victim->Valid = true;
+  Victim->DimmIndex = DimmIndex;
+  Victim->ChipSelect = DimmInfo->ChipSelect;
+  Victim->SubChan = DimmInfo->SubChan;
+  Victim->Bank = DimmInfo->Bank;
+  Victim->Bucket.Level = 0;
+  Victim->Bucket.LastLeakMs = TimeMs;
+
+  return Victim;
+}
+
+/*
+ * xPrfCeStormPresetErrCnt
+ *
+ * @brief   Preset MCA_MISC0[ErrCnt] for the current mode of an MCA bank.
+ *
+ * @details In storm mode the counter overflows after StormIntInterval errors.
+ *          In normal mode it overflows after the SIL_AMD_RAS_POLICY
+ *          McaErrThreshCount errors; when thresholding is disabled by that
+ *          policy the counter is left as is.
+ *
+ * @param   Context   Storm state of the socket
+ * @param   InStorm   true if the bank runs in storm mode
+ * @param   McaMisc0  MCA_MISC0 value to update
+ */
+static
+void
+xPrfCeStormPresetErrCnt (
+  SIL_CE_STORM_CONTEXT  *Context,
+  bool                  InStorm,
+  SIL_MCA_MISC0_MSR     *McaMisc0
+  )
+{
+  if (InStorm) {
+    if (Context->Policy.StormIntInterval != 0) {
+      McaMisc0->Field.ErrCnt = CE_STORM_MCA_ERR_CNT_MAX - Context->Policy.StormIntInterval;
+    }
+  } else if (Context->McaErrThreshEn) {
+    McaMisc0->Field.ErrCnt = CE_STORM_MCA_ERR_CNT_MAX - Context->McaErrThreshCount;
+  }
+}
+
+/*
+ * xPrfCeStormSetMcaBankMode
+ *
+ * @brief   Move an MCA bank in or out of storm mode through its MCA_MISC0 error
+ *          thresholding controls.
+ *
+ * @details In storm mode the thresholding interrupt is either disabled, the
+ *          Host then polls the bank, or raised only once every
+ *          StormIntInterval errors. Leaving storm mode restores the interrupt
+ *          type saved on entry and presets the counter from the
+ *          SIL_AMD_RAS_POLICY threshold.
+ *
+ * @param   Context       Storm state of the socket
+ * @param   McaBankNumber MCA bank to switch
+ * @param   Storm         true to enter storm mode, false to restore normal mode
+ *
+ * @retval  true          The bank mode was switched
+ * @retval  false         The bank has no usable thresholding counter
+ */
+static
+bool
+xPrfCeStormSetMcaBankMode (
+  SIL_CE_STORM_CONTEXT  *Context,
+  uint32_t              McaBankNumber,
+  bool                  Storm
+  )
+{
+  SIL_CE_STORM_MCA_BANK *McaBank;
+  SIL_MCA_MISC0_MSR     McaMisc0;
+  SIL_MCA_MISC0_MSR     SavedMisc0;
+  uint32_t              Misc0Address;
+
+  McaBank = &Context->McaBank[McaBankNumber];
+  Misc0Address = (MCA_EXTENSION_BASE + (McaBankNumber * SMCA_REG_PER_BANK)) | MCA_MISC0_OFFSET;
+
+  McaMisc0.Value = xUslRdMsr (Misc0Address);
+  if ((McaMisc0.Field.Valid == 0) || (McaMisc0.Field.CntP == 0) || (McaMisc0.Field.Locked == 1)) {
+    return false;
+  }
+
+  if (Storm) {
+    McaBank->SavedMisc0 = McaMisc0.Value;
+    if (Context->Policy.StormIntInterval == 0) {
+      McaMisc0.Field.ThresholdIntType = 0;
+    }
+  } else {
+    SavedMisc0.Value = McaBank->SavedMisc0;
+    McaMisc0.Field.ThresholdIntType = SavedMisc0.Field.ThresholdIntType;
+  }
+  xPrfCeStormPresetErrCnt (Context, Storm, &McaMisc0);
+  McaMisc0.Field.Ovrflw = 0;
+  xUslWrMsr (Misc0Address, McaMisc0.Value);
+
+  return true;
+}
+
+/*
+ * xPrfCeStormInit
+ *
+ * @brief   Initialize the correctable error storm detection of a socket.
+ *
+ * @param   Context   Storm state of the socket, allocated by the Host
+ * @param   Policy    Storm detection policy
+ * @param   RasPolicy Platform RAS policy, gives the normal mode MCA error
+ *                    threshold
+ *
+ * @retval  SilPass             The context is ready
+ * @retval  SilInvalidParameter A pointer is NULL or a policy is not valid
+ */
+SIL_STATUS
+xPrfCeStormInit (
+  SIL_CE_STORM_CONTEXT  *Context,
+  SIL_CE_STORM_POLICY   *Policy,
+  SIL_AMD_RAS_POLICY    *RasPolicy
+  )
+{
+  if ((Context == NULL) || (Policy == NULL) || (RasPolicy == NULL)) {
+    return SilInvalidParameter;
+  }
+
+  if ((Policy->LeakPeriodMs == 0) || (Policy->DimmThreshold == 0) || (Policy->BankThreshold == 0) ||
+      (Policy->StormIntInterval > CE_STORM_MCA_ERR_CNT_MAX) ||
+      (RasPolicy->McaErrThreshCount > CE_STORM_MCA_ERR_CNT_MAX)) {
+    XPRF_TRACEPOINT (SIL_TRACE_ERROR, "Invalid CE storm policy!\n");
+    return SilInvalidParameter;
+  }
+
+  memset (Context, 0, sizeof (SIL_CE_STORM_CONTEXT));
+  Context->Policy = *Policy;
+  Context->McaErrThreshEn = RasPolicy->McaErrThreshEn;
+  Context->McaErrThreshCount = RasPolicy->McaErrThreshCount;
+
+  return SilPass;
+}
+
+/*
+ * xPrfCeStormRecordError
+ *
+ * @brief   Account a correctable DRAM error and switch the reporting MCA bank to
+ *          storm mode when the DIMM or DRAM bank error rate is too high.
+ *
+ * @note    ***This function must be executed on a thread of the socket that
+ *          owns Context.
+ *
+ * @param   Context           Storm state of the socket
+ * @param   NormalizedAddress Normalized address of the error
+ * @param   DimmInfo          DIMM information of the error, from address
+ *                            translation
+ * @param   McaBankNumber     MCA bank that reported the error
+ * @param   TimeMs            Current time in milliseconds, from any monotonic
+ *                            Host clock
+ * @param   StormStatus       On output, the storm state after this error
+ *
+ * @retval  SilPass             The error was accounted
+ * @retval  SilInvalidParameter A pointer is NULL or McaBankNumber is too large
+ */
+SIL_STATUS
+xPrfCeStormRecordError (
+  SIL_CE_STORM_CONTEXT    *Context,
+  SIL_NORMALIZED_ADDRESS  *NormalizedAddress,
+  SIL_DIMM_INFO           *DimmInfo,
+  uint32_t                McaBankNumber,
+  uint64_t                TimeMs,
+  SIL_CE_STORM_STATUS     *StormStatus
+  )
+{
+  SIL_CE_STORM_POLICY   *Policy;
+  SIL_CE_STORM_DIMM     *Dimm;
+  SIL_CE_STORM_BANK     *Bank;
+  SIL_CE_STORM_MCA_BANK *McaBank;
+  uint8_t               DimmIndex;
+
+  if ((Context == NULL) || (NormalizedAddress == NULL) || (DimmInfo == NULL) || (StormStatus == NULL) ||
+      (McaBankNumber >= XMCA_MAX_BANK_COUNT)) {
+    return SilInvalidParameter;
+  }
+
+  Policy = &Context->Policy;
+  memset (StormStatus, 0, sizeof (SIL_CE_STORM_STATUS));
+
+  DimmIndex = xPrfCeStormFindDimm (
+    Context,
+    NormalizedAddress->NormalizedDieId,
+    NormalizedAddress->NormalizedChannelId,
+    DimmInfo->ChipSelect >> 1,
+    TimeMs
+    );
+  if (DimmIndex != CE_STORM_NO_DIMM) {
+    Dimm = &Context->Dimm[DimmIndex];
+    xPrfCeStormLeak (&Dimm->Bucket, Policy->LeakPeriodMs, TimeMs);
+    Dimm->Bucket.Level++;
+    StormStatus->DimmLevel = Dimm->Bucket.Level;
+    StormStatus->DimmStorm = (Dimm->Bucket.Level >= Policy->DimmThreshold);
+
+    Bank = xPrfCeStormFindBank (Context, DimmIndex, DimmInfo, TimeMs);
+    xPrfCeStormLeak (&Bank->Bucket, Policy->LeakPeriodMs, TimeMs);
+    Bank->Bucket.Level++;
+    StormStatus->BankLevel = Bank->Bucket.Level;
+    StormStatus->BankStorm = (Bank->Bucket.Level >= Policy->BankThreshold);
+  } else {
+    XPRF_TRACEPOINT (SIL_TRACE_WARNING, "CE storm DIMM table full\n");
+  }
+
+  McaBank = &Context->McaBank[McaBankNumber];
+  McaBank->LastErrorMs = TimeMs;
+  if (!McaBank->InStorm && (StormStatus->DimmStorm || StormStatus->BankStorm)) {
+    if (xPrfCeStormSetMcaBankMode (Context, McaBankNumber, true)) {
+      McaBank->InStorm = true;
+      Context->ActiveStorms++;
+      StormStatus->StormEntered = true;
+      XPRF_TRACEPOINT (
+        SIL_TRACE_WARNING,
+        "CE storm on MCA bank %d, die %d channel %d chip select %d bank %d\n",
+        McaBankNumber,
+        NormalizedAddress->NormalizedDieId,
+        NormalizedAddress->NormalizedChannelId,
+        DimmInfo->ChipSelect,
+        DimmInfo->Bank
+        );
+    }
+  }
+  StormStatus->McaBankInStorm = McaBank->InStorm;
+
+  return SilPass;
+}
+
+/*
+ * xPrfCeStormPoll
+ *
+ * @brief   Restore normal mode on the MCA banks that were quiet for the policy
+ *          QuietPeriodMs.
+ *
+ * @note    ***This function must be executed on a thread of the socket that
+ *          owns Context.
+ *
+ * @param   Context Storm state of the socket
+ * @param   TimeMs  Current time in milliseconds, same clock as for
+ *                  xPrfCeStormRecordError
+ *
+ * @return  The number of MCA banks still in storm mode
+ */
+uint32_t
+xPrfCeStormPoll (
+  SIL_CE_STORM_CONTEXT  *Context,
+  uint64_t              TimeMs
+  )
+{
+  SIL_CE_STORM_MCA_BANK *McaBank;
+  uint32_t              McaBankNumber;
+
+  if (Context == NULL) {
+    return 0;
+  }
+
+  for (McaBankNumber = 0; (McaBankNumber < XMCA_MAX_BANK_COUNT) && (Context->ActiveStorms != 0); McaBankNumber++) {
+    McaBank = &Context->McaBank[McaBankNumber];
+    if (!McaBank->InStorm || ((TimeMs - McaBank->LastErrorMs) < Context->Policy.QuietPeriodMs)) {
+      continue;
+    }
+
+    xPrfCeStormSetMcaBankMode (Context, McaBankNumber, false);
+    McaBank->InStorm = false;
+    Context->ActiveStorms--;
+    XPRF_TRACEPOINT (SIL_TRACE_INFO, "CE storm on MCA bank %d ended\n", McaBankNumber);
+  }
+
+  return Context->ActiveStorms;
+}
+
+/*
+ * xPrfCeStormRearmMcaBank
+ *
+ * @brief   Re-arm the error thresholding counter of an MCA bank after its
+ *          thresholding interrupt.
+ *
+ * @details The Host thresholding interrupt handler calls this service in place
+ *          of presetting MCA_MISC0[ErrCnt] itself, so that a bank in storm mode
+ *          keeps its StormIntInterval and a bank in normal mode gets the
+ *          SIL_AMD_RAS_POLICY threshold back.
+ *
+ * @note    ***This function must be executed on a thread of the socket that
+ *          owns Context.
+ *
+ * @param   Context       Storm state of the socket
+ * @param   McaBankNumber MCA bank that raised the thresholding interrupt
+ *
+ * @retval  SilPass             The counter was re-armed
+ * @retval  SilInvalidParameter Context is NULL or McaBankNumber is too large
+ * @retval  SilUnsupported      The bank has no usable thresholding counter
+ */
+SIL_STATUS
+xPrfCeStormRearmMcaBank (
+  SIL_CE_STORM_CONTEXT  *Context,
+  uint32_t              McaBankNumber
+  )
+{
+  SIL_MCA_MISC0_MSR     McaMisc0;
+  uint32_t              Misc0Address;
+
+  if ((Context == NULL) || (McaBankNumber >= XMCA_MAX_BANK_COUNT)) {
+    return SilInvalidParameter;
+  }
+
+  Misc0Address = (MCA_EXTENSION_BASE + (McaBankNumber * SMCA_REG_PER_BANK)) | MCA_MISC0_OFFSET;
+  McaMisc0.Value = xUslRdMsr (Misc0Address);
+  if ((McaMisc0.Field.Valid == 0) || (McaMisc0.Field.CntP == 0) || (McaMisc0.Field.Locked == 1)) {
+    return SilUnsupported;
+  }
+
+  xPrfCeStormPresetErrCnt (Context, Context->McaBank[McaBankNumber].InStorm, &McaMisc0);
+  McaMisc0.Field.Ovrflw = 0;
+  xUslWrMsr (Misc0Address, McaMisc0.Value);
+
+  return SilPass;
+}
@@ -68,4 +68,6 @@ xPrfSetSnpRmp (
   xUslWrMsr (MSR_LS_RMP_END, SecureRMPTableEnd.Value);
   XPRF_TRACEPOINT (SIL_TRACE_INFO, "MSR RMP END Get updated 0x%x\n", SecureRMPTableEnd.Field.RmpTableEnd);
 
+  // The RMP is part of the memory range map
+  xPrfInvalidateMemoryRangeMap ();
 }
@@ -22,3 +22,11 @@
 #pragma once
 
 #include <xPRF-api.h>
+
+/**
+ * xPrfInvalidateMemoryRangeMap
+ *
+ * @brief   Drop the cached memory range map after one of its sources changed.
+ */
+void
+xPrfInvalidateMemoryRangeMap (void);
@@ -9,6 +9,7 @@
 typedef SIL_STATUS (*FCN_SET_INPUT) (void);
 typedef SIL_STATUS (*FCN_IP_INIT) (void);
 typedef SIL_STATUS (*SIL_API_INIT) (void);
+typedef SIL_STATUS (*FCN_IP_SOCKET_INIT) (uint32_t Socket);
 
 /* *********************************************************************************************************************
  * Declare common variables here
@@ -26,6 +27,9 @@ typedef struct {
   FCN_IP_INIT        Initialize;     ///< pointer to IP function to initialize silicon
   SIL_API_INIT       ApiInit;        ///< pointer to the IP function to initialize internal IP API and the Ip-to-Ip
                                      ///< API structure pointer.
+  FCN_IP_SOCKET_INIT InitializeSocket; ///< optional pointer to IP function to initialize the silicon of one
+                                       ///< socket. Run for every socket, on the socket primary core when
+                                       ///< possible, before Initialize.
 } IP_RECORD;
 
 /**
@@ -169,7 +169,8 @@ const SOC_IP_TABLE SocIpTblF19M10Tp1 = {
       sizeof(SDCICLASS_INPUT_BLK),
       SdciClassSetInputBlock,
       InitializeSdciTp1,
-      SetSdciApi
+      SetSdciApi,
+      InitializeSdciSocketTp1
     },
     {
       SilId_CxlClass,
@@ -15,8 +15,16 @@
 #include <SilCommon.h>
 #include <string.h>
 #include <xSIM.h>
+#include <DF/DfIp2Ip.h>
+#include <CCX/CcxIp2Ip.h>
 #include "IpHandler.h"
 
+/// Argument for a per-socket IP entry point run on a socket primary core
+typedef struct {
+  FCN_IP_SOCKET_INIT  InitializeSocket;   ///< IP per-socket entry point
+  uint32_t            Socket;             ///< Socket to initialize
+} XSIM_SOCKET_INIT_CONTEXT;
+
 /**
  * Global API table.  This table contains an entry for every IP defined by
  * SIL_DATA_BLOCK_ID.  This structure is populated during xSIM init.
@@ -570,6 +578,117 @@ SetDeferredResetType (
   }
 }
 
+/**
+ * xSimSocketInitProcedure
+ *
+ * @brief  Run an IP per-socket entry point on the socket primary core.
+ *
+ * @param  Context  Pointer to the XSIM_SOCKET_INIT_CONTEXT of the socket.
+ *
+ * @return SIL_STATUS returned by the IP.
+ */
+static
+SIL_STATUS
+xSimSocketInitProcedure (
+  void *Context
+  )
+{
+  XSIM_SOCKET_INIT_CONTEXT *SocketContext;
+
+  SocketContext = (XSIM_SOCKET_INIT_CONTEXT *)Context;
+  return SocketContext->InitializeSocket (SocketContext->Socket);
+}
+
+/**
+ * xSimInitializeIpSockets
+ *
+ * @brief  Run the per-socket entry point of an IP for every socket.
+ *
+ * @details Each remote socket is started on its parked primary core, when CCX
+ *          provides one, then the BSP runs socket 0 and any socket that could
+ *          not be dispatched. All sockets are joined before returning.
+ *
+ * @param  LclIpRecord Input pointer to the IP record.
+ *
+ * @return SIL_STATUS of the first socket that failed, else SilPass.
+ */
+static
+SIL_STATUS
+xSimInitializeIpSockets (
+  const IP_RECORD *LclIpRecord
+  )
+{
+  XSIM_SOCKET_INIT_CONTEXT  SocketContext[MAX_SOCKETS_SUPPORTED];
+  bool                      Dispatched[MAX_SOCKETS_SUPPORTED];
+  DF_IP2IP_API              *DfApi;
+  CCX_IP2IP_API             *CcxApi;
+  uint32_t                  NumberOfSockets;
+  uint32_t                  Socket;
+  SIL_STATUS                SocketStatus;
+  SIL_STATUS                LclStatus;
+
+  NumberOfSockets = 1;
+  if (SilGetIp2IpApi (SilId_DfClass, (void **)&DfApi) == SilPass) {
+    DfApi->DfGetSystemInfo (&NumberOfSockets, NULL, NULL, NULL, NULL);
+  }
+  if (NumberOfSockets > MAX_SOCKETS_SUPPORTED) {
+    NumberOfSockets = MAX_SOCKETS_SUPPORTED;
+  }
+  if ((SilGetIp2IpApi (SilId_CcxClass, (void **)&CcxApi) != SilPass) ||
+      (CcxApi->RunOnSocketPrimary == NULL)) {
+    CcxApi = NULL;
+  }
+
+  for (Socket = 0; Socket < NumberOfSockets; Socket++) {
+    SocketContext[Socket].InitializeSocket = LclIpRecord->InitializeSocket;
+    SocketContext[Socket].Socket = Socket;
+    Dispatched[Socket] = false;
+    if ((Socket != 0) && (CcxApi != NULL)) {
+      Dispatched[Socket] = (CcxApi->RunOnSocketPrimary (Socket, xSimSocketInitProcedure,
+        &SocketContext[Socket]) == SilPass);
+    }
+    XSIM_TRACEPOINT(SIL_TRACE_INFO, "openSIL Init:IpRcd %x socket %d on %s\n",
+      LclIpRecord, Socket, Dispatched[Socket] ? "socket primary" : "BSP");
+  }
+
+  LclStatus = SilPass;
+  for (Socket = 0; Socket < NumberOfSockets; Socket++) {
+    if (!Dispatched[Socket]) {
+      SocketStatus = LclIpRecord->InitializeSocket (Socket);
+      if (LclStatus == SilPass) {
+        LclStatus = SocketStatus;
+      }
+    }
+  }
+  for (Socket = 0; Socket < NumberOfSockets; Socket++) {
+    if (Dispatched[Socket]) {
+      SocketStatus = CcxApi->WaitForSocketPrimary (Socket);
+      if (LclStatus == SilPass) {
+        LclStatus = SocketStatus;
+      }
+    }
+  }
+
+  return LclStatus;
+}
+
+/**
+ * xSimHaltParkedAps
+ *
+ * @brief  Release any parked APs before openSIL code leaves the Host's control.
+ */
+static
+void
+xSimHaltParkedAps (void)
+{
+  CCX_IP2IP_API *CcxApi;
+
+  if ((SilGetIp2IpApi (SilId_CcxClass, (void **)&CcxApi) == SilPass) &&
+      (CcxApi->HaltParkedAps != NULL)) {
+    CcxApi->HaltParkedAps ();
+  }
+}
+
 /**
  * xSimInitializeIps
  *
@@ -594,8 +713,12 @@ xSimInitializeIps (
     XSIM_TRACEPOINT(SIL_TRACE_INFO, "openSIL Init:IpRcd %x: %x, %x, %x, %x\n",
       LclIpRecord, LclIpRecord->IpID, LclIpRecord->BlkRequestSize,
       LclIpRecord->SetInput, LclIpRecord->Initialize);
-    LclStatus = (LclIpRecord->Initialize == NULL)? SilPass :
-      LclIpRecord->Initialize ();
+    LclStatus = (LclIpRecord->InitializeSocket == NULL)? SilPass :
+      xSimInitializeIpSockets (LclIpRecord);
+    if (LclStatus == SilPass) {
+      LclStatus = (LclIpRecord->Initialize == NULL)? SilPass :
+        LclIpRecord->Initialize ();
+    }
 
     if (LclStatus != SilPass) {
       if ((LclStatus == SilResetRequestColdDef) ||
@@ -641,6 +764,12 @@ InitializeSiTp1 (void)
 
   LclStatus = xSimInitializeIps (LclIpRecord);
 
+  // Parked cores run from openSIL code. With MP services the Host keeps openSIL
+  // resident until timepoint 3, otherwise it owns that memory after this returns.
+  if (CONFIG_CCX_MP_SERVICES == 0) {
+    xSimHaltParkedAps ();
+  }
+
   XSIM_TRACEPOINT(SIL_TRACE_EXIT, "Status: %x\n", LclStatus);
   return LclStatus;
 }
@@ -697,6 +826,9 @@ InitializeSiTp3 (void)
 
   LclStatus = xSimInitializeIps (LclIpRecord);
 
+  // Last timepoint, the parked APs must not outlive openSIL
+  xSimHaltParkedAps ();
+
   XSIM_TRACEPOINT(SIL_TRACE_EXIT, "Status: %x\n", LclStatus);
   return LclStatus;
 }
@@ -141,6 +141,8 @@ typedef struct {
   uint8_t  AmdReserved3;
   uint8_t  AmdCpuPauseDelay;   ///< control number of cycles a thread will be idle
                                ///< after PAUSE instruction.
+  uint8_t  AmdSocketPrimaryDispatch; ///< Park the socket primary cores after AP launch so xSIM can run
+                                     ///< per-socket IP work on them. 0 - Disabled, 1 - Enabled
 
   // Mark the start of the revision specific data section
   CcxRevisions  CcxIpRev;     ///< IP revision, Overlay the rev data
@@ -7,6 +7,8 @@
 /* Copyright 2023 Advanced Micro Devices, Inc. All rights reserved.    */
 // SPDX-License-Identifier: MIT
 
+#pragma once
+
 #include <SilCommon.h>
 
 // Common function type definitions for functions in CCX's Ip2Ip API
@@ -20,8 +22,60 @@ typedef uint32_t (*CCX_CALC_LOCAL_APIC) (
   uint32_t Thread
   );
 
+/// Procedure run by a parked AP. Returns the status collected by the caller.
+typedef SIL_STATUS (*CCX_AP_PROCEDURE) (
+  void *Context
+  );
+
+typedef SIL_STATUS (*CCX_RUN_ON_SOCKET_PRIMARY) (
+  uint32_t          Socket,
+  CCX_AP_PROCEDURE  Procedure,
+  void              *Context
+  );
+
+typedef SIL_STATUS (*CCX_WAIT_FOR_SOCKET_PRIMARY) (
+  uint32_t Socket
+  );
+
+typedef void (*CCX_HALT_PARKED_APS) (void);
+
+/// APs selected by the MP services
+typedef enum {
+  CcxMpTargetAllAps = 0,        ///< Every parked AP
+  CcxMpTargetSocketPrimary,     ///< Parked socket primary cores only
+  CcxMpTargetApicId             ///< The parked AP with the given local APIC ID
+} CCX_MP_TARGET;
+
+typedef SIL_STATUS (*CCX_MP_STARTUP_APS) (
+  CCX_MP_TARGET     Target,
+  uint32_t          ApicId,
+  CCX_AP_PROCEDURE  Procedure,
+  void              *Context,
+  bool              Blocking
+  );
+
+typedef SIL_STATUS (*CCX_MP_WAIT_FOR_APS) (
+  CCX_MP_TARGET     Target,
+  uint32_t          ApicId
+  );
+
+typedef uint32_t (*CCX_MP_GET_NUMBER_OF_APS) (void);
+
+typedef SIL_STATUS (*CCX_MP_GET_AP_STATUS) (
+  uint32_t          ApIndex,
+  uint32_t          *ApicId,
+  SIL_STATUS        *ApStatus
+  );
+
 // Define the Ip2Ip API as a struct containing pointers to these functions
 
 typedef struct {
-  CCX_CALC_LOCAL_APIC   CalcLocalApic;  ///< The Info function
+  CCX_CALC_LOCAL_APIC          CalcLocalApic;        ///< The Info function
+  CCX_RUN_ON_SOCKET_PRIMARY    RunOnSocketPrimary;   ///< Start a procedure on a parked socket primary core
+  CCX_WAIT_FOR_SOCKET_PRIMARY  WaitForSocketPrimary; ///< Wait for the socket primary procedure to complete
+  CCX_HALT_PARKED_APS          HaltParkedAps;        ///< Release all parked APs to the halt loop
+  CCX_MP_STARTUP_APS           MpStartupAps;         ///< Run a procedure on the selected parked APs
+  CCX_MP_WAIT_FOR_APS          MpWaitForAps;         ///< Wait for the selected APs, return the first failure
+  CCX_MP_GET_NUMBER_OF_APS     MpGetNumberOfAps;     ///< Number of parked APs
+  CCX_MP_GET_AP_STATUS         MpGetApStatus;        ///< APIC ID and last procedure status of a parked AP
 } CCX_IP2IP_API;
@@ -92,6 +92,7 @@ static const CCXCLASS_DATA_BLK gCcxConfigData = {
     .AmdSplitRmpTable               = 0x0,
     .AmdReserved3                   = 0xFF,
     .AmdCpuPauseDelay               = 0xFF,
+    .AmdSocketPrimaryDispatch       = CONFIG_CCX_SOCKET_PRIMARY_DISPATCH,
   },
   .CcxOutputBlock = {
     .AmdApicMode                    = 0xFF,
@@ -425,6 +426,8 @@ InitializeCcxAndLaunchAps (
 
     ApSyncFlag = (volatile uint16_t *)(uintptr_t) mApLaunchGlobalData.AllowToLaunchNextThreadLocation;
 
+    CcxInitApMailboxes ();
+
     CCX_TRACEPOINT (SIL_TRACE_INFO, "Launching APs\n");
 
     for (Socket = 0; Socket < NumberOfSockets; Socket++) {
@@ -450,6 +453,17 @@ InitializeCcxAndLaunchAps (
                       Ccx,
                       Core,
                       Thread);
+                  CcxSetApParkRequest (
+                    &mApLaunchGlobalData,
+                    CcxConfigData->CcxInputBlock.AmdSocketPrimaryDispatch != 0,
+                    CcxXfer->CalcLocalApic (Socket, Die, Ccd, Ccx, Core, Thread),
+                    Socket,
+                    Die,
+                    Ccd,
+                    Ccx,
+                    Core,
+                    Thread
+                    );
                   ApNumBfLaunch++;
                   SmuApi->SmuLaunchThread (
                     Socket,
@@ -9,6 +9,7 @@
 
 #pragma once
 #include <SMU/SmuIp2Ip.h>
+#include <CCX/CcxIp2Ip.h>
 #pragma pack (push, 1)
 
 #include <CCX/CcxClass-api.h>
@@ -83,6 +84,15 @@
 
 #define CPU_LIST_TERMINAL       0xFFFFFFFFul
 
+// Parked APs: private stack of each AP and number of mailboxes
+#define  CCX_AP_PARK_STACK_SIZE CONFIG_CCX_AP_PARK_STACK_SIZE
+#if CONFIG_CCX_MP_SERVICES
+#define  CCX_AP_MAILBOX_COUNT   CONFIG_CCX_MP_MAX_APS
+#else
+#define  CCX_AP_MAILBOX_COUNT   MAX_SOCKETS_SUPPORTED   // Socket primary cores only
+#endif
+#define  CCX_AP_MAILBOX_SIZE    64                      // One cache line per mailbox
+
 #define CCX_TRACEPOINT(MsgLevel, Message, ...)        \
   do {                \
     if (DEBUG_FILTER_CCX & SIL_DEBUG_MODULE_FILTER) {    \
@@ -127,6 +137,12 @@ typedef struct {
                                                               // as offset to this element is used in ApAsm nasm file.
   CCX_GDT_DESCRIPTOR         ApGdtDescriptor;                 ///< Do NOT change the offset of this variable
                                                               // as offset to this element is used in ApAsm nasm file.
+  uint64_t                   ApParkEntry;                     ///< Do NOT change the offset of this variable
+                                                              // as offset to this element is used in ApAsm nasm file.
+  uint64_t                   ApParkStack;                     ///< Do NOT change the offset of this variable
+                                                              // as offset to this element is used in ApAsm nasm file.
+  uint64_t                   ApParkContext;                   ///< Do NOT change the offset of this variable
+                                                              // as offset to this element is used in ApAsm nasm file.
   uint8_t                    SleepType;
   uint32_t                   SizeOfApMtrr;
   volatile AP_MTRR_SETTINGS  *ApMtrrSyncList;
@@ -138,6 +154,33 @@ typedef struct {
   const REGISTER_TABLE_AT_GIVEN_TP *CcxRegTableListAtGivenTP;
 } AMD_CCX_AP_LAUNCH_GLOBAL_DATA;
 
+/// State of a parked AP, written by the AP
+typedef enum {
+  CcxApMailboxNone = 0,     ///< No AP was asked to park
+  CcxApMailboxLaunched,     ///< The AP was asked to park and is on its way
+  CcxApMailboxParked,       ///< The AP is polling its mailbox
+  CcxApMailboxHalted        ///< The AP left the mailbox loop and is halted
+} CCX_AP_MAILBOX_STATE;
+
+/// Command for a parked AP, written by the BSP and cleared by the AP
+typedef enum {
+  CcxApCommandNone = 0,     ///< Idle, or the last procedure completed
+  CcxApCommandRun,          ///< Run Procedure (Context)
+  CcxApCommandHalt          ///< Leave the mailbox loop
+} CCX_AP_MAILBOX_COMMAND;
+
+/// Mailbox shared between the BSP and a parked AP. Each AP polls only its own mailbox.
+typedef struct {
+  volatile uint32_t          State;          ///< CCX_AP_MAILBOX_STATE
+  volatile uint32_t          Command;        ///< CCX_AP_MAILBOX_COMMAND
+  volatile CCX_AP_PROCEDURE  Procedure;      ///< Procedure to run
+  void * volatile            Context;        ///< Argument for Procedure
+  volatile SIL_STATUS        Status;         ///< Status returned by Procedure
+  uint32_t                   ApicId;         ///< Local APIC ID of the parked AP
+  uint32_t                   Socket;         ///< Socket of the parked AP
+  bool                       SocketPrimary;  ///< The parked AP is the primary core of its socket
+} CCX_AP_MAILBOX;
+
 /******************************************************************************
  * Declare Function prototypes
  *
@@ -169,6 +212,45 @@ SIL_STATUS CcxGetCacWeights (uint64_t *CacWeights);
 void CcxSetCacWeights (uint64_t *CacWeights);
 void CcxInitializeCpb (uint8_t AmdCpbMode);
 
+void CcxInitApMailboxes (void);
+void
+CcxSetApParkRequest (
+  volatile AMD_CCX_AP_LAUNCH_GLOBAL_DATA *ApLaunchGlobalData,
+  bool                                   SocketPrimaryDispatch,
+  uint32_t                               ApicId,
+  uint32_t                               Socket,
+  uint32_t                               Die,
+  uint32_t                               Ccd,
+  uint32_t                               Complex,
+  uint32_t                               Core,
+  uint32_t                               Thread
+  );
+void CcxApParkLoop (CCX_AP_MAILBOX *Mailbox);
+SIL_STATUS CcxRunOnSocketPrimary (
+  uint32_t          Socket,
+  CCX_AP_PROCEDURE  Procedure,
+  void              *Context
+  );
+SIL_STATUS CcxWaitForSocketPrimary (uint32_t Socket);
+void CcxHaltParkedAps (void);
+SIL_STATUS CcxMpStartupAps (
+  CCX_MP_TARGET     Target,
+  uint32_t          ApicId,
+  CCX_AP_PROCEDURE  Procedure,
+  void              *Context,
+  bool              Blocking
+  );
+SIL_STATUS CcxMpWaitForAps (
+  CCX_MP_TARGET     Target,
+  uint32_t          ApicId
+  );
+uint32_t CcxMpGetNumberOfAps (void);
+SIL_STATUS CcxMpGetApStatus (
+  uint32_t          ApIndex,
+  uint32_t          *ApicId,
+  SIL_STATUS        *ApStatus
+  );
+
 void
 SetupApStartupRegion (
   volatile AMD_CCX_AP_LAUNCH_GLOBAL_DATA *ApLaunchGlobalData,
@@ -0,0 +1,556 @@
+/**
+ * @file  CcxApMailbox.c
+ * @brief AP parking and MP services
+ *
+ * @details openSIL normally halts every AP as soon as it has been launched.
+ *          APs may instead be parked, each one polling its own mailbox on its
+ *          own cache line, so that IP code can be run on them:
+ *          - With socket primary dispatch, the first thread of each remote
+ *            socket is parked, for the per-socket IP entry points of xSIM.
+ *          - With MP services (CONFIG_CCX_MP_SERVICES), every AP is parked.
+ *          The BSP never runs the procedures itself; callers do their own
+ *          share of the work while the APs run.
+ */
+
+/* Copyright 2023 Advanced Micro Devices, Inc. All rights reserved.    */
+// SPDX-License-Identifier: MIT
+
+#include <SilCommon.h>
+#include <xSIM.h>
+#include <CommonLib/CpuLib.h>
+
+#include "Ccx.h"
+
+/// Mailbox padded to its own cache line, so that APs do not share a spin location
+typedef union {
+  CCX_AP_MAILBOX  Mailbox;
+  uint8_t         CacheLine[CCX_AP_MAILBOX_SIZE];
+} CCX_AP_MAILBOX_SLOT;
+
+static CCX_AP_MAILBOX_SLOT  mCcxApMailbox[CCX_AP_MAILBOX_COUNT];
+static uint8_t              mCcxApParkStack[CCX_AP_MAILBOX_COUNT][CCX_AP_PARK_STACK_SIZE];
+static uint32_t             mCcxApMailboxCount = 0;
+
+/**
+ * CcxApMailboxPost
+ *
+ * @brief   Give a procedure to a parked AP
+ *
+ * @param   Mailbox     Mailbox of the AP
+ * @param   Procedure   Procedure to run
+ * @param   Context     Argument for Procedure
+ */
+static
+void
+CcxApMailboxPost (
+  CCX_AP_MAILBOX    *Mailbox,
+  CCX_AP_PROCEDURE  Procedure,
+  void              *Context
+  )
+{
+  Mailbox->Procedure = Procedure;
+  Mailbox->Context   = Context;
+  Mailbox->Status    = SilPass;
+  Mailbox->Command   = CcxApCommandRun;
+}
+
+/**
+ * CcxApMailboxIsReady
+ *
+ * @brief   Check whether an AP is parked and idle
+ *
+ * @details A launched AP has already released the BSP and is about to enter
+ *          its mailbox loop, so it is waited for.
+ *
+ * @param   Mailbox   Mailbox of the AP
+ *
+ * @retval  SilPass     The AP can take a procedure
+ * @retval  SilNotFound The AP is not parked
+ * @retval  SilAborted  The previous procedure has not completed
+ */
+static
+SIL_STATUS
+CcxApMailboxIsReady (
+  CCX_AP_MAILBOX    *Mailbox
+  )
+{
+  while (Mailbox->State == CcxApMailboxLaunched) {
+    xUslCpuPause ();
+  }
+
+  if (Mailbox->State != CcxApMailboxParked) {
+    return SilNotFound;
+  }
+  if (Mailbox->Command != CcxApCommandNone) {
+    return SilAborted;
+  }
+  return SilPass;
+}
+
+/**
+ * CcxApMailboxWait
+ *
+ * @brief   Wait for the procedure running on a parked AP
+ *
+ * @param   Mailbox   Mailbox of the AP
+ *
+ * @return  Status returned by the procedure
+ */
+static
+SIL_STATUS
+CcxApMailboxWait (
+  CCX_AP_MAILBOX    *Mailbox
+  )
+{
+  while (Mailbox->Command != CcxApCommandNone) {
+    xUslCpuPause ();
+  }
+  return Mailbox->Status;
+}
+
+/**
+ * CcxApMailboxIsTarget
+ *
+ * @brief   Check whether an AP is selected by an MP services target
+ *
+ * @param   Mailbox   Mailbox of the AP
+ * @param   Target    APs to select
+ * @param   ApicId    Local APIC ID, for CcxMpTargetApicId
+ *
+ * @retval  true      The AP is selected
+ * @retval  false     The AP is not selected
+ */
+static
+bool
+CcxApMailboxIsTarget (
+  CCX_AP_MAILBOX    *Mailbox,
+  CCX_MP_TARGET     Target,
+  uint32_t          ApicId
+  )
+{
+  switch (Target) {
+    case CcxMpTargetAllAps:
+      return true;
+    case CcxMpTargetSocketPrimary:
+      return Mailbox->SocketPrimary;
+    case CcxMpTargetApicId:
+      return (Mailbox->ApicId == ApicId);
+    default:
+      return false;
+  }
+}
+
+/**
+ * CcxInitApMailboxes
+ *
+ * @brief   Clear all AP mailboxes before the APs are launched
+ */
+void
+CcxInitApMailboxes (void)
+{
+  uint32_t  Index;
+
+  for (Index = 0; Index < CCX_AP_MAILBOX_COUNT; Index++) {
+    mCcxApMailbox[Index].Mailbox.State   = CcxApMailboxNone;
+    mCcxApMailbox[Index].Mailbox.Command = CcxApCommandNone;
+  }
+  mCcxApMailboxCount = 0;
+}
+
+/**
+ * CcxSetApParkRequest
+ *
+ * @brief   Set up the park request for the next thread to be launched
+ *
+ * @details Called by the BSP before each thread is launched. The AP latches the
+ *          request before it allows the next thread to launch, so the request
+ *          only applies to this thread. With MP services every AP is parked,
+ *          otherwise only the first thread of each remote socket is parked when
+ *          socket primary dispatch is enabled. Socket 0 is served by the BSP.
+ *
+ * @param   ApLaunchGlobalData     AP launch data shared with ApAsmCode
+ * @param   SocketPrimaryDispatch  Socket primary dispatch is enabled
+ * @param   ApicId                 Local APIC ID of the thread to be launched
+ * @param   Socket                 Socket of the thread to be launched
+ * @param   Die                    Die of the thread to be launched
+ * @param   Ccd                    CCD of the thread to be launched
+ * @param   Complex                Complex of the thread to be launched
+ * @param   Core                   Core of the thread to be launched
+ * @param   Thread                 Thread to be launched
+ */
+void
+CcxSetApParkRequest (
+  volatile AMD_CCX_AP_LAUNCH_GLOBAL_DATA *ApLaunchGlobalData,
+  bool                                   SocketPrimaryDispatch,
+  uint32_t                               ApicId,
+  uint32_t                               Socket,
+  uint32_t                               Die,
+  uint32_t                               Ccd,
+  uint32_t                               Complex,
+  uint32_t                               Core,
+  uint32_t                               Thread
+  )
+{
+  CCX_AP_MAILBOX  *Mailbox;
+  bool            SocketPrimary;
+  uint32_t        Index;
+
+  ApLaunchGlobalData->ApParkEntry   = 0;
+  ApLaunchGlobalData->ApParkStack   = 0;
+  ApLaunchGlobalData->ApParkContext = 0;
+
+  SocketPrimary = ((Die | Ccd | Complex | Core | Thread) == 0);
+  if ((CONFIG_CCX_MP_SERVICES == 0) && !(SocketPrimaryDispatch && SocketPrimary)) {
+    return;
+  }
+  if (mCcxApMailboxCount >= CCX_AP_MAILBOX_COUNT) {
+    CCX_TRACEPOINT (SIL_TRACE_WARNING, "No mailbox left for APIC ID 0x%x, it will be halted\n", ApicId);
+    return;
+  }
+
+  Index = mCcxApMailboxCount++;
+  Mailbox = &mCcxApMailbox[Index].Mailbox;
+  Mailbox->Command       = CcxApCommandNone;
+  Mailbox->Procedure     = NULL;
+  Mailbox->Context       = NULL;
+  Mailbox->Status        = SilPass;
+  Mailbox->ApicId        = ApicId;
+  Mailbox->Socket        = Socket;
+  Mailbox->SocketPrimary = SocketPrimary;
+  Mailbox->State         = CcxApMailboxLaunched;
+
+  ApLaunchGlobalData->ApParkEntry   = (uintptr_t) CcxApParkLoop;
+  ApLaunchGlobalData->ApParkStack   = ((uintptr_t) &mCcxApParkStack[Index][CCX_AP_PARK_STACK_SIZE]) & ~((uintptr_t) 0xF);
+  ApLaunchGlobalData->ApParkContext = (uintptr_t) Mailbox;
+}
+
+/**
+ * CcxApParkLoop
+ *
+ * @brief   Mailbox loop of a parked AP
+ *
+ * @details Called from ApAsmCode on the AP private stack. The AP runs each
+ *          procedure posted by the BSP and returns to the halt loop when told
+ *          to. Nothing here may call the Host debug service unless the Host
+ *          has made it safe for concurrent use.
+ *
+ * @param   Mailbox   Mailbox of this AP
+ */
+void
+CcxApParkLoop (
+  CCX_AP_MAILBOX *Mailbox
+  )
+{
+  CCX_AP_PROCEDURE  Procedure;
+
+  Mailbox->State = CcxApMailboxParked;
+
+  for (;;) {
+    switch (Mailbox->Command) {
+      case CcxApCommandRun:
+        Procedure = Mailbox->Procedure;
+        Mailbox->Status = Procedure (Mailbox->Context);
+        Mailbox->Command = CcxApCommandNone;
+        break;
+      case CcxApCommandHalt:
+        Mailbox->State = CcxApMailboxHalted;
+        return;
+      default:
+        xUslCpuPause ();
+        break;
+    }
+  }
+}
+
+/**
+ * CcxMpStartupAps
+ *
+ * @brief   Run a procedure on the selected parked APs
+ *
+ * @details All selected APs must be idle, otherwise no AP is started. A
+ *          non-blocking call returns as soon as the APs have been started; use
+ *          CcxMpWaitForAps, or CcxMpGetApStatus for each AP, to collect the
+ *          status.
+ *
+ * @param   Target      APs to run the procedure on
+ * @param   ApicId      Local APIC ID, for CcxMpTargetApicId
+ * @param   Procedure   Procedure to run
+ * @param   Context     Argument for Procedure, shared by all APs
+ * @param   Blocking    Wait for all APs to complete
+ *
+ * @retval  SilPass             The procedure was started, or completed on all APs
+ * @retval  SilInvalidParameter Procedure is not valid
+ * @retval  SilNotFound         No parked AP is selected
+ * @retval  SilAborted          A selected AP has not completed its previous procedure
+ * @retval  Others              First failure returned by the procedure, if Blocking
+ */
+SIL_STATUS
+CcxMpStartupAps (
+  CCX_MP_TARGET     Target,
+  uint32_t          ApicId,
+  CCX_AP_PROCEDURE  Procedure,
+  void              *Context,
+  bool              Blocking
+  )
+{
+  CCX_AP_MAILBOX  *Mailbox;
+  SIL_STATUS      Status;
+  uint32_t        Index;
+  uint32_t        Selected;
+
+  if (Procedure == NULL) {
+    return SilInvalidParameter;
+  }
+
+  Selected = 0;
+  for (Index = 0; Index < mCcxApMailboxCount; Index++) {
+    Mailbox = &mCcxApMailbox[Index].Mailbox;
+    if (!CcxApMailboxIsTarget (Mailbox, Target, ApicId)) {
+      continue;
+    }
+    Status = CcxApMailboxIsReady (Mailbox);
+    if (Status == SilAborted) {
+      return Status;
+    }
+    if (Status == SilPass) {
+      Selected++;
+    }
+  }
+  if (Selected == 0) {
+    return SilNotFound;
+  }
+
+  for (Index = 0; Index < mCcxApMailboxCount; Index++) {
+    Mailbox = &mCcxApMailbox[Index].Mailbox;
+    if ((Mailbox->State == CcxApMailboxParked) && CcxApMailboxIsTarget (Mailbox, Target, ApicId)) {
+      CcxApMailboxPost (Mailbox, Procedure, Context);
+    }
+  }
+
+  return Blocking ? CcxMpWaitForAps (Target, ApicId) : SilPass;
+}
+
+/**
+ * CcxMpWaitForAps
+ *
+ * @brief   Wait for the procedures running on the selected parked APs
+ *
+ * @param   Target    APs to wait for
+ * @param   ApicId    Local APIC ID, for CcxMpTargetApicId
+ *
+ * @retval  SilPass   The last procedure passed on all selected APs
+ * @retval  Others    First failure returned by the procedure
+ */
+SIL_STATUS
+CcxMpWaitForAps (
+  CCX_MP_TARGET     Target,
+  uint32_t          ApicId
+  )
+{
+  CCX_AP_MAILBOX  *Mailbox;
+  SIL_STATUS      ApStatus;
+  SIL_STATUS      Status;
+  uint32_t        Index;
+
+  Status = SilPass;
+  for (Index = 0; Index < mCcxApMailboxCount; Index++) {
+    Mailbox = &mCcxApMailbox[Index].Mailbox;
+    if ((Mailbox->State != CcxApMailboxParked) || !CcxApMailboxIsTarget (Mailbox, Target, ApicId)) {
+      continue;
+    }
+    ApStatus = CcxApMailboxWait (Mailbox);
+    if (Status == SilPass) {
+      Status = ApStatus;
+    }
+  }
+  return Status;
+}
+
+/**
+ * CcxMpGetNumberOfAps
+ *
+ * @brief   Number of parked APs, including any on their way to the mailbox loop
+ *
+ * @return  Number of APs, indexed from 0 by CcxMpGetApStatus
+ */
+uint32_t
+CcxMpGetNumberOfAps (void)
+{
+  return mCcxApMailboxCount;
+}
+
+/**
+ * CcxMpGetApStatus
+ *
+ * @brief   Collect the status of the last procedure run on a parked AP
+ *
+ * @details Waits for the procedure to complete.
+ *
+ * @param   ApIndex   Index of the AP, below CcxMpGetNumberOfAps
+ * @param   ApicId    Local APIC ID of the AP, optional
+ * @param   ApStatus  Status returned by the last procedure
+ *
+ * @retval  SilPass             ApStatus is valid
+ * @retval  SilInvalidParameter ApIndex or ApStatus is not valid
+ * @retval  SilNotFound         The AP is not parked
+ */
+SIL_STATUS
+CcxMpGetApStatus (
+  uint32_t          ApIndex,
+  uint32_t          *ApicId,
+  SIL_STATUS        *ApStatus
+  )
+{
+  CCX_AP_MAILBOX  *Mailbox;
+
+  if ((ApIndex >= mCcxApMailboxCount) || (ApStatus == NULL)) {
+    return SilInvalidParameter;
+  }
+
+  Mailbox = &mCcxApMailbox[ApIndex].Mailbox;
+  if (ApicId != NULL) {
+    *ApicId = Mailbox->ApicId;
+  }
+  while (Mailbox->State == CcxApMailboxLaunched) {
+    xUslCpuPause ();
+  }
+  if (Mailbox->State != CcxApMailboxParked) {
+    return SilNotFound;
+  }
+
+  *ApStatus = CcxApMailboxWait (Mailbox);
+  return SilPass;
+}
+
+/**
+ * CcxGetSocketPrimaryMailbox
+ *
+ * @brief   Locate the mailbox of the parked primary core of a socket
+ *
+ * @param   Socket   Socket to look for
+ *
+ * @return  Mailbox, or NULL if the primary core of the socket is not parked
+ */
+static
+CCX_AP_MAILBOX *
+CcxGetSocketPrimaryMailbox (
+  uint32_t Socket
+  )
+{
+  CCX_AP_MAILBOX  *Mailbox;
+  uint32_t        Index;
+
+  for (Index = 0; Index < mCcxApMailboxCount; Index++) {
+    Mailbox = &mCcxApMailbox[Index].Mailbox;
+    if (Mailbox->SocketPrimary && (Mailbox->Socket == Socket)) {
+      return Mailbox;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * CcxRunOnSocketPrimary
+ *
+ * @brief   Start a procedure on the parked primary core of a socket
+ *
+ * @details Returns as soon as the AP has been given the procedure. Use
+ *          CcxWaitForSocketPrimary to collect its status.
+ *
+ * @param   Socket      Socket to run the procedure on
+ * @param   Procedure   Procedure to run
+ * @param   Context     Argument for Procedure
+ *
+ * @retval  SilPass             The procedure was started
+ * @retval  SilInvalidParameter Procedure is not valid
+ * @retval  SilNotFound         There is no parked core on this socket
+ * @retval  SilAborted          The previous procedure has not completed
+ */
+SIL_STATUS
+CcxRunOnSocketPrimary (
+  uint32_t          Socket,
+  CCX_AP_PROCEDURE  Procedure,
+  void              *Context
+  )
+{
+  CCX_AP_MAILBOX  *Mailbox;
+  SIL_STATUS      Status;
+
+  if (Procedure == NULL) {
+    return SilInvalidParameter;
+  }
+
+  Mailbox = CcxGetSocketPrimaryMailbox (Socket);
+  if (Mailbox == NULL) {
+    return SilNotFound;
+  }
+
+  Status = CcxApMailboxIsReady (Mailbox);
+  if (Status == SilPass) {
+    CcxApMailboxPost (Mailbox, Procedure, Context);
+  }
+  return Status;
+}
+
+/**
+ * CcxWaitForSocketPrimary
+ *
+ * @brief   Wait for the procedure running on a socket primary core
+ *
+ * @param   Socket   Socket the procedure was started on
+ *
+ * @retval  SilNotFound         There is no parked core on this socket
+ * @retval  Others              Status returned by the procedure
+ */
+SIL_STATUS
+CcxWaitForSocketPrimary (
+  uint32_t Socket
+  )
+{
+  CCX_AP_MAILBOX  *Mailbox;
+
+  Mailbox = CcxGetSocketPrimaryMailbox (Socket);
+  if ((Mailbox == NULL) || (Mailbox->State != CcxApMailboxParked)) {
+    return SilNotFound;
+  }
+
+  return CcxApMailboxWait (Mailbox);
+}
+
+/**
+ * CcxHaltParkedAps
+ *
+ * @brief   Release all parked APs to the halt loop
+ *
+ * @details Any procedure still running is allowed to complete first. Must be
+ *          called before openSIL returns to the Host for the last time, since
+ *          the parked APs execute openSIL code.
+ */
+void
+CcxHaltParkedAps (void)
+{
+  CCX_AP_MAILBOX  *Mailbox;
+  uint32_t        Index;
+
+  for (Index = 0; Index < mCcxApMailboxCount; Index++) {
+    Mailbox = &mCcxApMailbox[Index].Mailbox;
+    while (Mailbox->State == CcxApMailboxLaunched) {
+      xUslCpuPause ();
+    }
+    if (Mailbox->State == CcxApMailboxParked) {
+      CcxApMailboxWait (Mailbox);
+      Mailbox->Command = CcxApCommandHalt;
+    }
+  }
+
+  for (Index = 0; Index < mCcxApMailboxCount; Index++) {
+    Mailbox = &mCcxApMailbox[Index].Mailbox;
+    if (Mailbox->Command == CcxApCommandHalt) {
+      while (Mailbox->State != CcxApMailboxHalted) {
+        xUslCpuPause ();
+      }
+    }
+  }
+
+  CCX_TRACEPOINT (SIL_TRACE_INFO, "%d parked APs halted\n", mCcxApMailboxCount);
+}
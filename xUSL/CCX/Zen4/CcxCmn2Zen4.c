@@ -80,7 +80,14 @@ CCX_XFER_TABLE CcxXferZen4 = {
  * @details This is the Ip2Ip Table for Zen4
  */
 CCX_IP2IP_API CcxIp2IpZen4 = {
-    .CalcLocalApic    = Zen4CalcLocalApic
+    .CalcLocalApic        = Zen4CalcLocalApic,
+    .RunOnSocketPrimary   = CcxRunOnSocketPrimary,
+    .WaitForSocketPrimary = CcxWaitForSocketPrimary,
+    .HaltParkedAps        = CcxHaltParkedAps,
+    .MpStartupAps         = CcxMpStartupAps,
+    .MpWaitForAps         = CcxMpWaitForAps,
+    .MpGetNumberOfAps     = CcxMpGetNumberOfAps,
+    .MpGetApStatus        = CcxMpGetApStatus
 };
 
 /*********** Functions used in the Common-2-Rev transfer table *************/
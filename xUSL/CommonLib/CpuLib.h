@@ -185,9 +185,13 @@ typedef enum {
 #define REMOTE_DELIVERY_DONE                   0x00020000ul
 
 void xUslCpuSleep (void);
+void xUslCpuPause (void);
+uint32_t xUslInterlockedExchange32 (volatile uint32_t *Value, uint32_t NewValue);
+void xUslFillMemNonTemporal (void *Buffer, uint64_t Length, uint64_t Pattern);
 uint8_t xUslGetThreadsPerCore (void);
 uint32_t xUslGetPackageType (void);
 uint32_t xUslGetInitialApicId (void);
+uint32_t xUslGetExtendedApicId (void);
 void xUslWrMsr (uint32_t MsrAddress, uint64_t MsrValue);
 uint64_t xUslRdMsr (uint32_t MsrAddress);
 uint8_t xUslGetPhysAddrSize (void);
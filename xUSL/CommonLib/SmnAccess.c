@@ -7,8 +7,36 @@
 
 #include <SilCommon.h>
 #include "SmnAccess.h"
+#include "SpinLock.h"
 #include "Pci.h"
 
+// One lock per IOHC index/data pair. Root bridges get at least 32 buses each, so within a
+// segment the IOHC bus >> 5 tells the IOHCs apart.
+#define SMN_INDEX_LOCK_SEGMENTS     8
+#define SMN_INDEX_LOCK_BUS_SHIFT    5
+#define SMN_INDEX_LOCKS_PER_SEGMENT (256 >> SMN_INDEX_LOCK_BUS_SHIFT)
+
+static XUSL_SPIN_LOCK mSmnIndexLock[SMN_INDEX_LOCK_SEGMENTS][SMN_INDEX_LOCKS_PER_SEGMENT];
+
+/**
+ * SmnGetIndexLock - Lock of the IOHC index/data pair
+ *
+ * @param[in] SegmentNumber     - IOHC (Node) Segment number
+ * @param[in] IohcBus           - IOHC (Node) bus number
+ * @retval    Lock serializing the index/data pair of this IOHC
+ *
+ */
+static
+XUSL_SPIN_LOCK *
+SmnGetIndexLock (
+  uint32_t SegmentNumber,
+  uint32_t IohcBus
+  )
+{
+  return &mSmnIndexLock[SegmentNumber % SMN_INDEX_LOCK_SEGMENTS]
+                       [(IohcBus & 0xFF) >> SMN_INDEX_LOCK_BUS_SHIFT];
+}
+
 /**
  * xUSLSmnRead - Read SMN register
  *
@@ -26,6 +54,7 @@ xUSLSmnRead (
   )
 {
   uint32_t RegIndex;
+  uint32_t Value;
   PCI_ADDR PciAddress;
 
   RegIndex = SmnAddress;
@@ -35,9 +64,13 @@ xUSLSmnRead (
   PciAddress.Address.Segment= SegmentNumber;
   PciAddress.Address.Register = SIL_RESERVED2_896;
 
+  xUslAcquireSpinLock (SmnGetIndexLock (SegmentNumber, IohcBus));
   xUSLPciWrite32 (PciAddress.AddressValue, RegIndex);
   PciAddress.Address.Register = SIL_RESERVED2_897;
-  return xUSLPciRead32 (PciAddress.AddressValue);
+  Value = xUSLPciRead32 (PciAddress.AddressValue);
+  xUslReleaseSpinLock (SmnGetIndexLock (SegmentNumber, IohcBus));
+
+  return Value;
 }
 
 /**
@@ -67,9 +100,11 @@ xUSLSmnWrite (
   PciAddress.Address.Segment= SegmentNumber;
   PciAddress.Address.Register = SIL_RESERVED2_896;
 
+  xUslAcquireSpinLock (SmnGetIndexLock (SegmentNumber, IohcBus));
   xUSLPciWrite32 (PciAddress.AddressValue, RegIndex);
   PciAddress.Address.Register = SIL_RESERVED2_897;
   xUSLPciWrite32 (PciAddress.AddressValue, Value);
+  xUslReleaseSpinLock (SmnGetIndexLock (SegmentNumber, IohcBus));
 }
 
 /**
@@ -92,11 +127,22 @@ xUSLSmnReadModifyWrite (
   )
 {
   uint32_t RegValue;
+  PCI_ADDR PciAddress;
 
-  RegValue = xUSLSmnRead (SegmentNumber, IohcBus, SmnAddress);
+  PciAddress.AddressValue = 0;
+  PciAddress.Address.Bus = IohcBus;
+  PciAddress.Address.Segment= SegmentNumber;
+  PciAddress.Address.Register = SIL_RESERVED2_896;
+
+  // Hold the index across the read and the write so no other core can retarget it
+  xUslAcquireSpinLock (SmnGetIndexLock (SegmentNumber, IohcBus));
+  xUSLPciWrite32 (PciAddress.AddressValue, SmnAddress);
+  PciAddress.Address.Register = SIL_RESERVED2_897;
+  RegValue = xUSLPciRead32 (PciAddress.AddressValue);
   RegValue &= AndMask;
   RegValue |= OrMask;
-  xUSLSmnWrite (SegmentNumber, IohcBus, SmnAddress, RegValue);
+  xUSLPciWrite32 (PciAddress.AddressValue, RegValue);
+  xUslReleaseSpinLock (SmnGetIndexLock (SegmentNumber, IohcBus));
 }
 
 /**
@@ -116,6 +162,7 @@ xUSLSmnRead8 (
   )
 {
   uint32_t    RegIndex;
+  uint8_t     Value8;
   PCI_ADDR    PciAddress;
 
   RegIndex = SmnAddress & 0xFFFFFFFC;
@@ -125,9 +172,13 @@ xUSLSmnRead8 (
   PciAddress.Address.Segment= SegmentNumber;
   PciAddress.Address.Register = SIL_RESERVED2_896;
 
+  xUslAcquireSpinLock (SmnGetIndexLock (SegmentNumber, IohcBus));
   xUSLPciWrite32 (PciAddress.AddressValue, RegIndex);
   PciAddress.Address.Register = SIL_RESERVED2_897;
-  return xUSLPciRead8 (PciAddress.AddressValue + (SmnAddress & 0x3));
+  Value8 = xUSLPciRead8 (PciAddress.AddressValue + (SmnAddress & 0x3));
+  xUslReleaseSpinLock (SmnGetIndexLock (SegmentNumber, IohcBus));
+
+  return Value8;
 }
 
 /**
@@ -157,9 +208,11 @@ xUSLSmnWrite8 (
   PciAddress.Address.Segment= SegmentNumber;
   PciAddress.Address.Register = SIL_RESERVED2_896;
 
+  xUslAcquireSpinLock (SmnGetIndexLock (SegmentNumber, IohcBus));
   xUSLPciWrite32 (PciAddress.AddressValue, RegIndex);
   PciAddress.Address.Register = SIL_RESERVED2_897;
   xUSLPciWrite8 (PciAddress.AddressValue + (SmnAddress & 0x3), Value8);
+  xUslReleaseSpinLock (SmnGetIndexLock (SegmentNumber, IohcBus));
 }
 
 /**
@@ -182,9 +235,20 @@ xUSLSmnReadModifyWrite8 (
   )
 {
   uint8_t  RegValue;
+  PCI_ADDR PciAddress;
 
-  RegValue = xUSLSmnRead8 (SegmentNumber, IohcBus, SmnAddress);
+  PciAddress.AddressValue = 0;
+  PciAddress.Address.Bus = IohcBus;
+  PciAddress.Address.Segment= SegmentNumber;
+  PciAddress.Address.Register = SIL_RESERVED2_896;
+
+  // Hold the index across the read and the write so no other core can retarget it
+  xUslAcquireSpinLock (SmnGetIndexLock (SegmentNumber, IohcBus));
+  xUSLPciWrite32 (PciAddress.AddressValue, SmnAddress & 0xFFFFFFFC);
+  PciAddress.Address.Register = SIL_RESERVED2_897;
+  RegValue = xUSLPciRead8 (PciAddress.AddressValue + (SmnAddress & 0x3));
   RegValue &= AndMask;
   RegValue |= OrMask;
-  xUSLSmnWrite8 (SegmentNumber, IohcBus, SmnAddress, RegValue);
+  xUSLPciWrite8 (PciAddress.AddressValue + (SmnAddress & 0x3), RegValue);
+  xUslReleaseSpinLock (SmnGetIndexLock (SegmentNumber, IohcBus));
 }
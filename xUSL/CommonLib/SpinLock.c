@@ -0,0 +1,52 @@
+/**
+ * @file  SpinLock.c
+ * @brief OpenSIL spin locks for shared index/data register pairs
+ */
+/* Copyright 2023 Advanced Micro Devices, Inc. All rights reserved.    */
+// SPDX-License-Identifier: MIT
+
+#include <SilCommon.h>
+#include "CpuLib.h"
+#include "SpinLock.h"
+
+#if XUSL_SMP_LOCKS
+
+/**
+ * xUslAcquireSpinLock
+ *
+ * @brief Acquire a spin lock, waiting for it to be released if needed.
+ *
+ * @details The lock is only polled with plain reads while it is held, so
+ *          waiting cores do not keep pulling the cache line in exclusive state.
+ *          The locks are not recursive.
+ *
+ * @param[in] Lock  The lock to acquire
+ */
+void
+xUslAcquireSpinLock (
+  XUSL_SPIN_LOCK *Lock
+  )
+{
+  while (xUslInterlockedExchange32 (Lock, XUSL_SPIN_LOCK_ACQUIRED) != XUSL_SPIN_LOCK_RELEASED) {
+    while (*Lock != XUSL_SPIN_LOCK_RELEASED) {
+      xUslCpuPause ();
+    }
+  }
+}
+
+/**
+ * xUslReleaseSpinLock
+ *
+ * @brief Release a spin lock acquired by xUslAcquireSpinLock.
+ *
+ * @param[in] Lock  The lock to release
+ */
+void
+xUslReleaseSpinLock (
+  XUSL_SPIN_LOCK *Lock
+  )
+{
+  *Lock = XUSL_SPIN_LOCK_RELEASED;
+}
+
+#endif
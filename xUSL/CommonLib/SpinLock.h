@@ -0,0 +1,38 @@
+/**
+ * @file  SpinLock.h
+ * @brief OpenSIL spin locks for shared index/data register pairs
+ *
+ * @details Indexed register accesses (SMN, DF FICAA/FICAD, FCH legacy IO and
+ *          PMIO) use a shared index register, so two cores must never interleave
+ *          accesses to the same pair. The locks are only needed when APs run
+ *          openSIL code, and are compiled away otherwise.
+ */
+/* Copyright 2023 Advanced Micro Devices, Inc. All rights reserved.    */
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdint.h>
+
+/// APs may run openSIL code concurrently with the BSP in this build. The host unit test forces it on.
+#ifndef XUSL_SMP_LOCKS
+#define XUSL_SMP_LOCKS              ((CONFIG_CCX_MP_SERVICES != 0) || (CONFIG_CCX_SOCKET_PRIMARY_DISPATCH != 0))
+#endif
+
+#define XUSL_SPIN_LOCK_RELEASED     0
+#define XUSL_SPIN_LOCK_ACQUIRED     1
+
+typedef volatile uint32_t XUSL_SPIN_LOCK;
+
+/**********************************************************************************************************************
+ * @brief Function prototypes
+ *
+ */
+
+#if XUSL_SMP_LOCKS
+void xUslAcquireSpinLock (XUSL_SPIN_LOCK *Lock);
+void xUslReleaseSpinLock (XUSL_SPIN_LOCK *Lock);
+#else
+#define xUslAcquireSpinLock(Lock)   ((void) (Lock))
+#define xUslReleaseSpinLock(Lock)   ((void) (Lock))
+#endif
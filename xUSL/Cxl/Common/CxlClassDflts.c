@@ -18,9 +18,12 @@ const CXLCLASS_DATA_BLK CxlClassDflts = {
         .AmdCxlProtocolErrorReporting = 0,
         .AmdPcieAerReportMechanism = 1,
         .CxlCamemRxOptimization = false,
-        .CxlTxOptimizeDirectOutEn = false
+        .CxlTxOptimizeDirectOutEn = false,
+        .CxlMemInterleaveWays = 0,
+        .CxlMemInterleaveGranularity = CxlInterleave4KB
     },
     .CxlOutputBlock = {
-        .AmdPcieAerReportMechanism = 1
+        .AmdPcieAerReportMechanism = 1,
+        .CxlInterleaveSetCount = 0
     }
 };
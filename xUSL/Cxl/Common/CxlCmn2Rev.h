@@ -15,9 +15,8 @@
 #include <Cxl/Common/CxlInit.h>
 
 typedef void (*CXL_ASSIGN_RESOURCES) (
-  PCIe_ENGINE_CONFIG    *Engine,
-  void                  *Buffer,
-  PCIe_PLATFORM_CONFIG  *Pcie
+  CXL_PORT_LIST         *PortList,
+  CXL_BUS_LIMITS        *Resources
   );
 
 typedef void (*CXL_FIND_PORTS) (
@@ -28,7 +27,12 @@ typedef void (*CXL_FIND_PORTS) (
 
 typedef void (*CXL_DEV_LIST_GENERATE) (
   PCIe_PLATFORM_CONFIG  *Pcie,
-  CXL_INFO_LIST     *CxlInfo
+  CXL_PORT_LIST         *PortList,
+  CXL_INFO_LIST         *CxlInfo
+  );
+
+typedef void (*CXL_CONFIGURE_INTERLEAVE) (
+  CXL_PORT_LIST         *PortList
   );
 
 // Internal Common-2-Rev Transfer Block for CXL
@@ -36,4 +40,5 @@ typedef struct {
   CXL_ASSIGN_RESOURCES     CxlAssignResources;
   CXL_FIND_PORTS           CxlFindPorts;
   CXL_DEV_LIST_GENERATE    CxlDevListGenerate;
+  CXL_CONFIGURE_INTERLEAVE CxlConfigureInterleave;
 } CXL_COMMON_2_REV_XFER_BLOCK;
@@ -10,7 +10,6 @@
 #include <string.h>
 #include <Mpio/MpioIp2Ip.h>
 #include <RcMgr/RcMgrIp2Ip.h>
-#include <FCH/Common/FchCommonCfg.h>
 #include "CxlInit.h"
 #include "CxlCmn2Rev.h"
 #include "CxlClass-api.h"
@@ -20,196 +19,6 @@
 #define CXLCLASS_MINOR_REV   1
 #define CXLCLASS_INSTANCE    0
 
-/**--------------------------------------------------------------------
- * GnbLibPciIsDevicePresent
- *
- * @brief Check if device present
- *
- * @details tbd
- *
- * @param[in] Address         PCI address (as described in PCI_ADDR)
- * @param[in] StdHeader       Standard configuration header
- *
- * @returns Device is or is not present
- * @retval boolean value
- */
-static
-bool
-GnbLibPciIsDevicePresent (
-  uint32_t              Address,
-  void   *StdHeader
-  )
-{
-  uint32_t  DeviceId;
-  xUSLPciRead (Address, AccessWidth32, &DeviceId);
-  if (DeviceId == 0xffffffff) {
-    return false;
-  } else {
-    return true;
-  }
-}
-
-/**--------------------------------------------------------------------
- * GnbLibFindPciCapability
- *
- * @brief Find PCI capability pointer
- *
- * @details tbd
- *
- * @param[in] Address         PCI address (as described in PCI_ADDR)
- * @param[in] CapabilityId    PCI capability ID
- * @param[in] StdHeader       Standard configuration header
- *
- * @returns Register address of capability pointer
- * @retval 8-bit value
- */
-static
-uint8_t
-GnbLibFindPciCapability (
-  uint32_t              Address,
-  uint8_t               CapabilityId,
-  void   *StdHeader
-  )
-{
-  uint8_t     CapabilityPtr;
-  uint8_t     CurrentCapabilityId;
-  CapabilityPtr = 0x34;
-  if (!GnbLibPciIsDevicePresent (Address, StdHeader)) {
-    return  0;
-  }
-  while (CapabilityPtr != 0) {
-    xUSLPciRead (Address | CapabilityPtr, AccessWidth8 , &CapabilityPtr);
-    if (CapabilityPtr != 0) {
-      xUSLPciRead (Address | CapabilityPtr , AccessWidth8 , &CurrentCapabilityId);
-      if (CurrentCapabilityId == CapabilityId) {
-        break;
-      }
-      CapabilityPtr++;
-    }
-  }
-  return  CapabilityPtr;
-}
-
-/**--------------------------------------------------------------------
- * GnbLibPciIsPcieDevice
- *
- * @brief Check if device is PCIe device
- *
- * @details tbd
- *
- * @param[in] Address         PCI address (as described in PCI_ADDR)
- * @param[in] StdHeader       Standard configuration header
- *
- * @returns Device is or is not a PCIe device
- * @retval boolean value
- */
-static
-bool
-GnbLibPciIsPcieDevice (
-  uint32_t              Address,
-  void   *StdHeader
-  )
-{
-  if (GnbLibFindPciCapability (Address, PCIE_CAP_ID, StdHeader) != 0 ) {
-    return true;
-  } else {
-    return false;
-  }
-}
-
-/**--------------------------------------------------------------------
- * GnbLibFindPcieExtendedCapability
- *
- * @brief Find PCIe extended capability pointer
- *
- * @details tbd
- *
- * @param[in] Address               PCI address (as described in PCI_ADDR)
- * @param[in] ExtendedCapabilityId  Extended PCIe capability ID
- * @param[in] StdHeader             Standard configuration header
- *
- * @returns Register address of extended capability pointer
- * @retval 16-bit value
- */
-static
-uint16_t
-GnbLibFindPcieExtendedCapability (
-  uint32_t              Address,
-  uint16_t              ExtendedCapabilityId,
-  void   *StdHeader
-  )
-{
-  uint16_t  CapabilityPtr;
-  uint32_t  ExtendedCapabilityIdBlock;
-  if (GnbLibPciIsPcieDevice (Address, StdHeader)) {
-    CapabilityPtr = 0x100;
-    xUSLPciRead (Address | CapabilityPtr , AccessWidth32 , &ExtendedCapabilityIdBlock);
-    if ((ExtendedCapabilityIdBlock != 0) && ((uint16_t)ExtendedCapabilityIdBlock != 0xffff)) {
-      do {
-        xUSLPciRead (Address | CapabilityPtr , AccessWidth32 , &ExtendedCapabilityIdBlock);
-    CXL_TRACEPOINT (
-      SIL_TRACE_INFO,
-      "   - Capability at 0x%x with type 0x%x\n",
-      CapabilityPtr,
-      (uint16_t)ExtendedCapabilityIdBlock
-      );
-        if ((uint16_t)ExtendedCapabilityIdBlock == ExtendedCapabilityId) {
-          return  CapabilityPtr;
-        }
-        CapabilityPtr = (uint16_t) ((ExtendedCapabilityIdBlock >> 20) & 0xfff);
-      } while (CapabilityPtr !=  0);
-    }
-  }
-  return  0;
-}
-
-/**--------------------------------------------------------------------
- * GnbLibFindNextPcieExtendedCapability
- *
- * @brief Find the next PCIe extended capability pointer
- *
- * @details tbd
- *
- * @param[in] Address               PCI address (as described in PCI_ADDR)
- * @param[in] StartCapabilityPtr    Starting register address of extended capability pointer
- * @param[in] ExtendedCapabilityId  Extended PCIe capability ID
- * @param[in] StdHeader             Standard configuration header
- *
- * @returns Register address of extended capability pointer
- * @retval 16-bit value
- */
-static
-uint16_t
-GnbLibFindNextPcieExtendedCapability (
-  uint32_t              Address,
-  uint16_t              StartCapabilityPtr,
-  uint16_t              ExtendedCapabilityId,
-  void   *StdHeader
-  )
-{
-  uint16_t  NextCapabilityPtr = 0;
-  uint32_t  ExtendedCapabilityIdBlock = 0;
-  if (GnbLibPciIsPcieDevice (Address, StdHeader)) {
-    xUSLPciRead (Address | StartCapabilityPtr , AccessWidth32 , &ExtendedCapabilityIdBlock);
-    if ((ExtendedCapabilityIdBlock != 0) && ((uint16_t)ExtendedCapabilityIdBlock != 0xffff)) {
-      NextCapabilityPtr = (uint16_t) ((ExtendedCapabilityIdBlock >> 20) & 0xfff);
-      if(NextCapabilityPtr != 0) {
-        xUSLPciRead (Address | NextCapabilityPtr , AccessWidth32 , &ExtendedCapabilityIdBlock);
-        CXL_TRACEPOINT (
-          SIL_TRACE_INFO,
-          "   - Next Capability at 0x%x with type 0x%x\n",
-          NextCapabilityPtr,
-          (uint16_t)ExtendedCapabilityIdBlock
-          );
-        if ((uint16_t)ExtendedCapabilityIdBlock == ExtendedCapabilityId) {
-          return NextCapabilityPtr;
-        }
-      }
-    }
-  }
-  return 0;
-}
-
 /**--------------------------------------------------------------------
  * CxlRegisterRead
  *
@@ -241,10 +50,10 @@ CxlRegisterRead (
  *
  * @brief Get CXL DVSEC
  *
- * @details tbd
+ * @details Looked up in the NBIO per-BDF capability map, so repeated lookups on the same
+ *          function do not walk its extended capability chain again.
  *
  * @param [in] Address        PCI address
- * @param [in] CapabilityPtr  Starting register address to the PCI extended capability
  * @param [in] DvsecVendorId  The DVSEC Vendor ID to find
  * @param [in] DvsecVendorId2 Alternative DVSEC Vendor ID to find
  * @param [in] DvsecId        The DVSEC ID to find
@@ -261,30 +70,18 @@ CxlGetDvsec (
   uint16_t  DvsecId
   )
 {
-  uint32_t DvsecValue;
-  uint16_t DvsecPtr = GnbLibFindPcieExtendedCapability (Address, DVSEC_CAP, NULL);
-
-  while (DvsecPtr != 0) {
-    xUSLPciRead (
-        Address | (DvsecPtr + SIL_RESERVED_21),
-        AccessWidth32,
-        &DvsecValue
-        );
-
-    if (((uint16_t) DvsecValue == DvsecVendorId) || ((uint16_t) DvsecValue == DvsecVendorId2)) {
-      xUSLPciRead (
-        Address | (DvsecPtr + DVSEC_ID_OFFSET),
-        AccessWidth16,
-        &DvsecValue
-        );
-
-      if ((uint16_t) DvsecValue == DvsecId) {
-        return DvsecPtr;
-      }
-    }
-    DvsecPtr = GnbLibFindNextPcieExtendedCapability(Address, DvsecPtr, DVSEC_CAP, NULL);
+  NBIO_IP2IP_API  *NbioIp2Ip;
+  uint16_t        DvsecPtr;
+
+  if (SilGetIp2IpApi (SilId_NbioClass, (void **)(&NbioIp2Ip)) != SilPass) {
+    return 0;
+  }
+
+  DvsecPtr = NbioIp2Ip->PcieFindDvsec (Address, DvsecVendorId, DvsecId);
+  if ((DvsecPtr == 0) && (DvsecVendorId2 != DvsecVendorId)) {
+    DvsecPtr = NbioIp2Ip->PcieFindDvsec (Address, DvsecVendorId2, DvsecId);
   }
-  return 0;
+  return DvsecPtr;
 }
 
 /**--------------------------------------------------------------------
@@ -409,164 +206,131 @@ CxlMmioAlloc (
 }
 
 /**--------------------------------------------------------------------
- * GetMem32BarSize
+ * CxlSizeEndpointBars
  *
- * @brief Calculate size of 32-bit BAR
+ * @brief Size the Cxl.io BARs of every CXL device and record the MMIO required
  *
- * @details tbd
+ * @details The sizing probes for all devices are issued as one batch: every BAR of every device
+ *          is saved, then written with all ones, then read back, then restored, one sweep each.
+ *          The aggregated sizes are stored in each engine for the MMIO allocation pass.
  *
- * @param[in]       EndpointBar       Pointer to engine config descriptor
- *
- * @returns Size
- * @retval 32-bit value
- */
-static
-uint32_t
-GetMem32BarSize (
-  uint32_t     EndpointBar
-  )
-{
-  uint32_t        OriginalValue;
-  uint32_t        Value;
-
-  xUSLPciRead (EndpointBar, AccessWidth32, &OriginalValue);
-  Value = 0xFFFFFFFF;
-  xUSLPciWrite (EndpointBar, AccessS3SaveWidth32, &Value);
-  xUSLPciRead (EndpointBar, AccessWidth32, &Value);
-  xUSLPciWrite (EndpointBar, AccessS3SaveWidth32, &OriginalValue);
-  Value &= 0xFFFFFFF0;
-  Value = (~Value) + 1;
-  return (Value);
-}
-
-/**--------------------------------------------------------------------
- * GetMem64BarSize
- *
- * @brief Calculate size of 32-bit BAR
- *
- * @details tbd
- *
- * @param[in]       EndpointBar       Pointer to engine config descriptord
- *
- * @returns Size
- * @retval 64-bit value
- */
-static
-uint64_t
-GetMem64BarSize (
-  uint32_t     EndpointBar
-  )
-{
-  uint32_t        NextBar;
-  uint32_t        OrgValue;
-  uint32_t        OrgValue2;
-  uint32_t        Value;
-  uint64_t        Value64;
-
-  NextBar = EndpointBar + 4;
-  xUSLPciRead (EndpointBar, AccessWidth32, &OrgValue);
-  xUSLPciRead (NextBar, AccessWidth32, &OrgValue2);
-
-  Value = 0xFFFFFFFF;
-  xUSLPciWrite (EndpointBar, AccessWidth32, &Value);
-  xUSLPciWrite (NextBar, AccessWidth32, &Value);
-  xUSLPciRead (EndpointBar, AccessWidth32, &Value);
-  if ((Value & 0xFFFFFFF0) == 0) {
-    /*
-	 * BAR size is greater than 32-bits.. check high bar
-	 */
-    Value = 0xFFFFFFFF;
-    xUSLPciWrite (NextBar, AccessWidth32, &Value);
-    xUSLPciRead (NextBar, AccessWidth32, &Value);
-    Value = (~Value) + 1;
-    Value64 = ((uint64_t) Value) << 32;
-  } else {
-    xUSLPciRead (EndpointBar, AccessWidth32, &Value);
-    xUSLPciWrite (EndpointBar, AccessWidth32, &OrgValue);
-    Value64 = 0xFFFFFFFF00000000 + (Value & 0xFFFFFFF0);
-    Value64 = (~Value64) + 1;
-  }
-  xUSLPciWrite (NextBar, AccessWidth32, &OrgValue2);
-  xUSLPciWrite (EndpointBar, AccessWidth32, &OrgValue);
-  return (Value64);
-}
-
-/**--------------------------------------------------------------------
- * AllocateForCxlIo
- *
- * @brief Allocate MMIO space for Cxl.io
- *
- * @details tbd
- *
- * @param[in]       EndpointBar       Pointer to engine config descriptor
+ * @param[in, out]  PortList          CXL ports found by the discovery pass
  *
  * @returns Nothing
  * @retval Nothing
  */
 void
-AllocateForCxlIo (
-  PCIe_ENGINE_CONFIG   *Engine,
-  uint32_t             DeviceAddr
+CxlSizeEndpointBars (
+  CXL_PORT_LIST        *PortList
   )
 {
-  PCI_ADDR            EndPointAddress;
+  CXL_PORT_ENTRY      *Port;
+  uint32_t            PortIndex;
   uint32_t            Index;
   PCIE_BAR_STRUCT     Bar32;
   uint32_t            Value;
   uint64_t            Value64;
-  uint32_t            Mem32Size = 0;
-  uint32_t            Mem32Granularity = GRANULARITY_32BIT;
-  uint64_t            MemP64Size = 0;
-  uint64_t            MemP64Granularity = GRANULARITY_64BIT;
+  uint32_t            Mem32Size;
+  uint32_t            Mem32Granularity;
+  uint64_t            MemP64Size;
+  uint64_t            MemP64Granularity;
 
   CXL_TRACEPOINT (SIL_TRACE_ENTRY, "\n");
 
   /*
    * Need to support multi-function devices - i.e. allocate for functions other than 0
    */
-  EndPointAddress.AddressValue = DeviceAddr;
-  /*
-   * Read RCiEP BARs and aggregate requests
-   */
-  for (Index = 0x10; Index <= 0x24; Index += 4) {
-    EndPointAddress.Address.Register = Index;
-    xUSLPciRead (EndPointAddress.AddressValue, AccessWidth32, &Bar32.Value);
-    if (Bar32.Field.MemIo == 0) {
-      if (Bar32.Field.MemSize == MEM_32_BAR) {
-        Value = GetMem32BarSize (EndPointAddress.AddressValue);
-        if (Value > Mem32Granularity) {
-          Mem32Granularity = Value;
-        }
-        CXL_TRACEPOINT (SIL_TRACE_INFO, " 32 bit bar at 0x%x with size 0x%llX\n", Index, Value);
-        Mem32Size += Value;
-      } else if (Bar32.Field.MemSize == MEM_64_BAR) {
-        Value64 = GetMem64BarSize (EndPointAddress.AddressValue);
-        if (Value64 > MemP64Granularity) {
-          MemP64Granularity = Value64;
-        }
-        CXL_TRACEPOINT (SIL_TRACE_INFO, " 64 bit bar at 0x%x with size 0x%llX\n", Index, Value64);
-        MemP64Size += Value64;
-        Index += 4;
+  for (PortIndex = 0; PortIndex < PortList->Count; PortIndex++) {
+    Port = &PortList->Port[PortIndex];
+    if (Port->EndpointPresent) {
+      for (Index = 0; Index < CXL_ENDPOINT_BARS; Index++) {
+        Port->BarOriginal[Index] = xUSLPciRead32 (Port->EndpointAddress | (PCICFG_SPACE_BAR0_OFFSET + Index * 4));
+      }
+    }
+  }
+  for (PortIndex = 0; PortIndex < PortList->Count; PortIndex++) {
+    Port = &PortList->Port[PortIndex];
+    if (Port->EndpointPresent) {
+      for (Index = 0; Index < CXL_ENDPOINT_BARS; Index++) {
+        xUSLPciWrite32 (Port->EndpointAddress | (PCICFG_SPACE_BAR0_OFFSET + Index * 4), 0xFFFFFFFF);
+      }
+    }
+  }
+  for (PortIndex = 0; PortIndex < PortList->Count; PortIndex++) {
+    Port = &PortList->Port[PortIndex];
+    if (Port->EndpointPresent) {
+      for (Index = 0; Index < CXL_ENDPOINT_BARS; Index++) {
+        Port->BarProbe[Index] = xUSLPciRead32 (Port->EndpointAddress | (PCICFG_SPACE_BAR0_OFFSET + Index * 4));
+      }
+    }
+  }
+  for (PortIndex = 0; PortIndex < PortList->Count; PortIndex++) {
+    Port = &PortList->Port[PortIndex];
+    if (Port->EndpointPresent) {
+      for (Index = 0; Index < CXL_ENDPOINT_BARS; Index++) {
+        xUSLPciWrite32 (Port->EndpointAddress | (PCICFG_SPACE_BAR0_OFFSET + Index * 4), Port->BarOriginal[Index]);
       }
     }
   }
 
   /*
-   * Round sizes up to allow for alignment and ACPI space
+   * Aggregate the requests of each RCiEP
    */
-  Mem32Size += (Mem32Granularity - 1);
-  Mem32Size &= ~(Mem32Granularity - 1);
-  if (Mem32Size == 0) {
-    Mem32Size = GRANULARITY_32BIT;
-  }
-  CXL_TRACEPOINT (SIL_TRACE_INFO, " Mem32 Size = 0x%x\n", Mem32Size);
-  Engine->Type.Cxl.Mmio32Size = Mem32Size;
-  Engine->Type.Cxl.Mmio32Gran = Mem32Granularity;
+  for (PortIndex = 0; PortIndex < PortList->Count; PortIndex++) {
+    Port = &PortList->Port[PortIndex];
+    if (!Port->EndpointPresent) {
+      continue;
+    }
+    Mem32Size = 0;
+    Mem32Granularity = GRANULARITY_32BIT;
+    MemP64Size = 0;
+    MemP64Granularity = GRANULARITY_64BIT;
+    for (Index = 0; Index < CXL_ENDPOINT_BARS; Index++) {
+      Bar32.Value = Port->BarOriginal[Index];
+      if (Bar32.Field.MemIo == 0) {
+        if (Bar32.Field.MemSize == MEM_32_BAR) {
+          Value = (~(Port->BarProbe[Index] & 0xFFFFFFF0)) + 1;
+          if (Value > Mem32Granularity) {
+            Mem32Granularity = Value;
+          }
+          CXL_TRACEPOINT (SIL_TRACE_INFO, " 32 bit bar at 0x%x with size 0x%llX\n",
+            PCICFG_SPACE_BAR0_OFFSET + Index * 4,
+            Value
+            );
+          Mem32Size += Value;
+        } else if ((Bar32.Field.MemSize == MEM_64_BAR) && (Index + 1 < CXL_ENDPOINT_BARS)) {
+          Value64 = (((uint64_t) Port->BarProbe[Index + 1]) << 32) | (Port->BarProbe[Index] & 0xFFFFFFF0);
+          Value64 = (~Value64) + 1;
+          if (Value64 > MemP64Granularity) {
+            MemP64Granularity = Value64;
+          }
+          CXL_TRACEPOINT (SIL_TRACE_INFO, " 64 bit bar at 0x%x with size 0x%llX\n",
+            PCICFG_SPACE_BAR0_OFFSET + Index * 4,
+            Value64
+            );
+          MemP64Size += Value64;
+          Index++;
+        }
+      }
+    }
 
-  MemP64Size += (MemP64Granularity - 1);
-  MemP64Size &= ~(MemP64Granularity - 1);
-  CXL_TRACEPOINT (SIL_TRACE_INFO, " Mem64PSize = 0x%lX\n", MemP64Size);
-  Engine->Type.Cxl.Mmio64Size = MemP64Size;
+    /*
+     * Round sizes up to allow for alignment and ACPI space
+     */
+    Mem32Size += (Mem32Granularity - 1);
+    Mem32Size &= ~(Mem32Granularity - 1);
+    if (Mem32Size == 0) {
+      Mem32Size = GRANULARITY_32BIT;
+    }
+    CXL_TRACEPOINT (SIL_TRACE_INFO, " Bus 0x%x Mem32 Size = 0x%x\n", Port->Bus, Mem32Size);
+    Port->Engine->Type.Cxl.Mmio32Size = Mem32Size;
+    Port->Engine->Type.Cxl.Mmio32Gran = Mem32Granularity;
+
+    MemP64Size += (MemP64Granularity - 1);
+    MemP64Size &= ~(MemP64Granularity - 1);
+    CXL_TRACEPOINT (SIL_TRACE_INFO, " Bus 0x%x Mem64PSize = 0x%lX\n", Port->Bus, MemP64Size);
+    Port->Engine->Type.Cxl.Mmio64Size = MemP64Size;
+  }
 
   CXL_TRACEPOINT (SIL_TRACE_EXIT, "\n");
 }
@@ -593,7 +357,9 @@ CxlPortInit (
   CXL_BUS_LIMITS                Resources;
   GNB_HANDLE                    *GnbHandle;
   CXL_INFO_LIST                 CxlInfo;
+  CXL_PORT_LIST                 PortList;
   NBIO_IP2IP_API                *NbioIp2Ip;
+  MPIO_IP2IP_API                *MpioApi;
   CXL_COMMON_2_REV_XFER_BLOCK   *CxlXferTable;
 
   CXL_TRACEPOINT (SIL_TRACE_ENTRY, "\n");
@@ -603,6 +369,11 @@ CxlPortInit (
     return;
   }
 
+  if (SilGetIp2IpApi (SilId_MpioClass, (void **)(&MpioApi)) != SilPass) {
+    CXL_TRACEPOINT (SIL_TRACE_ERROR, " MPIO API is not found.\n");
+    return;
+  }
+
   /*
    * Get CXL Cmn2Rev transfer table
    */
@@ -610,18 +381,26 @@ CxlPortInit (
     return;
   }
 
+  /*
+   * Discovery pass: build the list of CXL ports on all sockets
+   */
+  PortList.Count = 0;
   NbioIp2Ip->PcieConfigRunProcForAllEngines(
                DESCRIPTOR_ALLOCATED | DESCRIPTOR_PCIE_ENGINE,
                CxlXferTable->CxlFindPorts,
-               NULL,
+               &PortList,
                Pcie
                );
+  // CXL ports are no longer PCIe engines; drop them from the active PCIe engine list
+  NbioIp2Ip->PcieConfigUpdateActiveEngineIndex (Pcie);
 
   memset (&Resources, 0, sizeof(CXL_BUS_LIMITS));
 
   GnbHandle = NbioIp2Ip->NbioGetHandle (Pcie);
   while (GnbHandle != NULL) {
     Resources.BusLimits[GnbHandle->InstanceId] = (uint8_t) GnbHandle->BusNumberLimit;
+    // Send the DPC strap updates queued by the discovery pass
+    MpioApi->MpioFlushPcieStraps (GnbHandle);
 
     CXL_TRACEPOINT (SIL_TRACE_INFO, "  inst/bus/limit/rbidx/lrbidx: %d/%02x/%02x/%02x/%02x\n",
           GnbHandle->InstanceId,
@@ -637,16 +416,14 @@ CxlPortInit (
   /*
    * Are resources available? (Details TBD)
    */
-  CXL_TRACEPOINT (SIL_TRACE_INFO, "Assign Resources\n");
+  CXL_TRACEPOINT (SIL_TRACE_INFO, "Assign Resources for %d CXL ports\n", PortList.Count);
 
-  NbioIp2Ip->PcieConfigRunProcForAllEngines(
-    DESCRIPTOR_CXL_ENGINE,
-    CxlXferTable->CxlAssignResources,
-    &Resources,
-    Pcie
-    );
+  if (PortList.Count != 0) {
+    CxlXferTable->CxlAssignResources (&PortList, &Resources);
+    CxlXferTable->CxlConfigureInterleave (&PortList);
+  }
 
-  CxlXferTable->CxlDevListGenerate(Pcie, &CxlInfo);
+  CxlXferTable->CxlDevListGenerate(Pcie, &PortList, &CxlInfo);
 
   CXL_TRACEPOINT (SIL_TRACE_EXIT, "\n");
 }
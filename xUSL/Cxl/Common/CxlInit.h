@@ -68,6 +68,8 @@
 #define     GRANULARITY_32BIT   0x100000
 #define     GRANULARITY_64BIT   0x1000000
 #define     MEM_BAR0_SIZE       0x10000
+#define     CXL_RCRB_SIZE       (8 * 1024)
+#define     CXL_ENDPOINT_BARS   6
 
 #define     DVSEC_CAP            0x23
 #define     DVSEC_VID            0x8086
@@ -78,6 +80,10 @@
 #define     SIL_RESERVED_21      0x04
 #define     DVSEC_ID_OFFSET      0x08
 #define     DVSEC_CXL_CAP_OFFSET 0x0A
+#define     DVSEC_CXL_RANGE1_SIZE_HIGH_OFFSET  0x18
+#define     DVSEC_CXL_RANGE1_SIZE_LOW_OFFSET   0x1C
+#define     DVSEC_CXL_MEM_INFO_VALID           0x1
+#define     DVSEC_CXL_MEM_SIZE_LOW_MASK        0xF0000000
 
 #define     SIL_RESERVED_14      (4 * 1024)
 
@@ -142,6 +148,27 @@ typedef struct {
   uint8_t           CxlPortCountS1;
 } CXL_INFO_LIST;
 
+/// Cxl Port Entry - A CXL root port found by the discovery pass
+typedef struct {
+  PCIe_ENGINE_CONFIG  *Engine;                          ///< CXL engine descriptor
+  GNB_HANDLE          *GnbHandle;                       ///< Root bridge owning the port
+  PCIe_WRAPPER_CONFIG *Wrapper;                         ///< Wrapper owning the port
+  uint32_t            *DsRcrb;                          ///< Downstream Port RCRB, NULL if not assigned
+  uint32_t            *UsRcrb;                          ///< Upstream Port RCRB
+  uint32_t            Bus;                              ///< Secondary bus assigned to the port
+  uint32_t            EndpointAddress;                  ///< PCI address of the CXL device
+  uint16_t            DvsecCapPtr;                      ///< CXL DVSEC of the device
+  bool                EndpointPresent;                  ///< A CXL device was found behind the port
+  uint32_t            BarOriginal[CXL_ENDPOINT_BARS];   ///< Endpoint BAR values before sizing
+  uint32_t            BarProbe[CXL_ENDPOINT_BARS];      ///< Endpoint BAR values read back after writing all ones
+} CXL_PORT_ENTRY;
+
+/// Cxl Port List - All CXL root ports on all sockets
+typedef struct {
+  uint32_t            Count;                            ///< Valid entries in Port[]
+  CXL_PORT_ENTRY      Port[MAX_CXL_PORTS * 2];          ///< Discovered ports
+} CXL_PORT_LIST;
+
 typedef union {
   struct {
     uint32_t             MemIo:1;
@@ -185,9 +212,8 @@ CxlMmioAlloc (
   );
 
 void
-AllocateForCxlIo (
-  PCIe_ENGINE_CONFIG   *Engine,
-  uint32_t             DeviceAddr
+CxlSizeEndpointBars (
+  CXL_PORT_LIST        *PortList
   );
 
 void
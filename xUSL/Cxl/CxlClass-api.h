@@ -34,6 +34,33 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#define CXL_MAX_INTERLEAVE_WAYS   8   ///< Maximum Type-3 expanders in one interleave set
+#define CXL_MAX_INTERLEAVE_SETS   8   ///< One set per CXL memory region routed in the DF
+
+/// CXL memory interleave granularity (HDM decoder IG encoding)
+typedef enum {
+  CxlInterleave256B = 0,          ///< 256 byte granularity
+  CxlInterleave4KB  = 4,          ///< 4 KB granularity
+} CXL_INTERLEAVE_GRANULARITY;
+
+/**
+ * CXL Type-3 interleave set
+ *
+ * Expanders of matching capacity interleaved across one CXL memory region. openSIL programs the
+ * DF side of the set; once the expanders' component register BARs are assigned the Host commits
+ * HDM decoder 0 of each target with Base, Size, IW = log2(Ways), IG = Granularity and the target's
+ * position in TargetBus[]. The set is reported as a single proximity domain.
+ */
+typedef struct {
+  uint64_t Base;                                ///< Host physical base of the set
+  uint64_t Size;                                ///< Ways * expander capacity
+  uint8_t  Socket;                              ///< Socket the set is attached to
+  uint8_t  PhysNbioMap;                         ///< Bit n set when NBIO n hosts a target
+  uint8_t  Ways;                                ///< Number of targets: 2, 4 or 8
+  uint8_t  Granularity;                         ///< CXL_INTERLEAVE_GRANULARITY
+  uint8_t  TargetBus[CXL_MAX_INTERLEAVE_WAYS];  ///< Secondary bus of each target, in position order
+} CXL_INTERLEAVE_SET;
+
 ///  CXL openSIL Input Block
 typedef struct {
   bool ReportErrorsToRcec;
@@ -44,11 +71,15 @@ typedef struct {
   uint8_t AmdPcieAerReportMechanism;
   bool CxlCamemRxOptimization;
   bool CxlTxOptimizeDirectOutEn;
+  uint8_t CxlMemInterleaveWays;         ///< Max Type-3 expanders per interleave set: 0 (disabled), 2, 4 or 8
+  uint8_t CxlMemInterleaveGranularity;  ///< CXL_INTERLEAVE_GRANULARITY
 } CXLCLASS_INPUT_BLK;
 
 ///  CXL openSIL Output Block
 typedef struct {
   uint8_t AmdPcieAerReportMechanism;
+  uint8_t CxlInterleaveSetCount;                                ///< Valid entries in CxlInterleaveSet[]
+  CXL_INTERLEAVE_SET CxlInterleaveSet[CXL_MAX_INTERLEAVE_SETS]; ///< Configured Type-3 interleave sets
 } CXLCLASS_OUTPUT_BLK;
 
 typedef struct {
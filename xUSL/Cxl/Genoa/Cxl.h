@@ -19,3 +19,8 @@ extern SIL_STATUS CxlClassSetInputBlock (void);
 
 SIL_STATUS
 SetCxlApi (void);
+
+void
+CxlConfigureInterleave (
+  CXL_PORT_LIST         *PortList
+  );
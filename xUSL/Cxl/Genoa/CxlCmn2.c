@@ -23,6 +23,7 @@
 #include <Cxl/Common/CxlInit.h>
 #include <Cxl/CxlClass-api.h>
 #include "CxlCmn2Rev.h"
+#include "Cxl.h"
 
 
 #define CXLCLASS_MAJOR_REV   0
@@ -40,9 +41,8 @@ typedef enum {
  */
 void
 CxlAssignResources (
-  PCIe_ENGINE_CONFIG    *Engine,
-  void                  *Buffer,
-  PCIe_PLATFORM_CONFIG  *Pcie
+  CXL_PORT_LIST         *PortList,
+  CXL_BUS_LIMITS        *Resources
   );
 
 void
@@ -55,16 +55,18 @@ CxlFindPorts (
 void
 CxlDevListGenerate (
   PCIe_PLATFORM_CONFIG  *Pcie,
-  CXL_INFO_LIST     *CxlInfo
+  CXL_PORT_LIST         *PortList,
+  CXL_INFO_LIST         *CxlInfo
   );
 
 /** ---------------------------- Table ---------------------------------
  * @details This is the internal common-2-Rev transfer table for SDCI Genoa
  */
 CXL_COMMON_2_REV_XFER_BLOCK CxlXfer = {
-  .CxlAssignResources    = CxlAssignResources,
-  .CxlFindPorts          = CxlFindPorts,
-  .CxlDevListGenerate    = CxlDevListGenerate
+  .CxlAssignResources     = CxlAssignResources,
+  .CxlFindPorts           = CxlFindPorts,
+  .CxlDevListGenerate     = CxlDevListGenerate,
+  .CxlConfigureInterleave = CxlConfigureInterleave
 };
 
 /**--------------------------------------------------------------------
@@ -142,13 +144,12 @@ CxlAssignBus (
 /**--------------------------------------------------------------------
  * CxlReportToMpio
  *
- * @brief Generate a list of CXL devices to report to MPIO
+ * @brief Add a CXL port to the list of CXL devices to report to MPIO
  *
  * @details tbd
  *
- * @param[in]       Engine          Pointer to engine config descriptor
- * @param[in, out]  Buffer          CXL_INFO_LIST pointer
- * @param[in]       Pcie            Pointer to global PCIe configuration
+ * @param[in]       Port            CXL port entry from the discovery pass
+ * @param[in, out]  CxlInfoList     CXL_INFO_LIST pointer
  *
  * @returns Nothing
  * @retval Nothing
@@ -156,175 +157,263 @@ CxlAssignBus (
 static
 void
 CxlReportToMpio (
-  PCIe_ENGINE_CONFIG    *Engine,
-  void                  *Buffer,
-  PCIe_PLATFORM_CONFIG  *Pcie
+  CXL_PORT_ENTRY        *Port,
+  CXL_INFO_LIST         *CxlInfoList
   )
 {
-  CXL_INFO_LIST         *CxlInfoList;
   CXL_DEVICE_INFO       *ThisDevice;
-  GNB_HANDLE            *GnbHandle;
-  NBIO_IP2IP_API        *NbioIp2Ip;
-
-  if (SilGetIp2IpApi (SilId_NbioClass, (void **)(&NbioIp2Ip)) != SilPass) {
-
-    return;
-  }
-  GnbHandle = (GNB_HANDLE *) (NbioIp2Ip->PcieConfigGetParent (DESCRIPTOR_SILICON, &(Engine->Header)));
-  CxlInfoList = (CXL_INFO_LIST *) Buffer;
+  PCIe_ENGINE_CONFIG    *Engine;
 
-  if (GnbHandle->SocketId == 0) {
+  Engine = Port->Engine;
+  if (Port->GnbHandle->SocketId == 0) {
+    if (CxlInfoList->CxlPortCountS0 >= MAX_CXL_PORTS) {
+      return;
+    }
     ThisDevice = &(CxlInfoList->CxlInfoS0[CxlInfoList->CxlPortCountS0]);
     CxlInfoList->CxlPortCountS0++;
   } else {
+    if (CxlInfoList->CxlPortCountS1 >= MAX_CXL_PORTS) {
+      return;
+    }
     ThisDevice = &(CxlInfoList->CxlInfoS1[CxlInfoList->CxlPortCountS1]);
     CxlInfoList->CxlPortCountS1++;
   }
   ThisDevice->function = Engine->Type.Cxl.Address.Address.Function;
   ThisDevice->device = Engine->Type.Cxl.Address.Address.Device;
   ThisDevice->bus = Engine->Type.Cxl.Address.Address.Bus;
-  ThisDevice->iohc_id = GnbHandle->RBIndex;
+  ThisDevice->iohc_id = Port->GnbHandle->RBIndex;
   ThisDevice->pcie_port = Engine->Type.Cxl.PortId;
   ThisDevice->cxl_type = Engine->Type.Cxl.CxlDeviceType;
   ThisDevice->unused = 0;
   return;
 }
 
+/**--------------------------------------------------------------------
+ * CxlAllocatePerRootBridge
+ *
+ * @brief Reserve MMIO for a group of CXL ports with one request per root bridge
+ *
+ * @details The ports sharing a root bridge get consecutive Size byte windows carved out of a
+ *          single reservation, so the number of Resource Manager requests scales with root
+ *          bridges rather than with CXL devices.
+ *
+ * @param[in, out]  PortList        CXL ports found by the discovery pass
+ * @param[in]       Size            Bytes required per port
+ * @param[in]       Above4G         If MMIO above the 4G boundary should be allocated
+ * @param[in]       EndpointOnly    Only allocate for ports with a CXL device behind them
+ * @param[out]      Base            Base address assigned to each port, 0 if allocation failed
+ *
+ * @returns Nothing
+ * @retval Nothing
+ */
+static
+void
+CxlAllocatePerRootBridge (
+  CXL_PORT_LIST         *PortList,
+  uint64_t              Size,
+  bool                  Above4G,
+  bool                  EndpointOnly,
+  uint64_t              *Base
+  )
+{
+  uint32_t              Index;
+  uint32_t              Peer;
+  uint32_t              Count;
+  uint32_t              BarLow;
+  uint32_t              BarHigh;
+  uint64_t              Next;
+  SIL_STATUS            Status;
+
+  for (Index = 0; Index < PortList->Count; Index++) {
+    Base[Index] = 0;
+  }
+
+  for (Index = 0; Index < PortList->Count; Index++) {
+    if (EndpointOnly && !PortList->Port[Index].EndpointPresent) {
+      continue;
+    }
+    /*
+     * Skip root bridges already handled with an earlier port
+     */
+    for (Peer = 0; Peer < Index; Peer++) {
+      if ((PortList->Port[Peer].GnbHandle == PortList->Port[Index].GnbHandle) &&
+          (!EndpointOnly || PortList->Port[Peer].EndpointPresent)) {
+        break;
+      }
+    }
+    if (Peer != Index) {
+      continue;
+    }
+
+    Count = 0;
+    for (Peer = Index; Peer < PortList->Count; Peer++) {
+      if ((PortList->Port[Peer].GnbHandle == PortList->Port[Index].GnbHandle) &&
+          (!EndpointOnly || PortList->Port[Peer].EndpointPresent)) {
+        Count++;
+      }
+    }
+
+    Status = CxlMmioAlloc (PortList->Port[Index].GnbHandle, &BarLow, &BarHigh, Size * Count, Above4G);
+    if (Status != SilPass) {
+      continue;
+    }
+
+    Next = ((uint64_t) BarHigh << 32) | BarLow;
+    for (Peer = Index; Peer < PortList->Count; Peer++) {
+      if ((PortList->Port[Peer].GnbHandle == PortList->Port[Index].GnbHandle) &&
+          (!EndpointOnly || PortList->Port[Peer].EndpointPresent)) {
+        Base[Peer] = Next;
+        Next += Size;
+      }
+    }
+  }
+}
+
 /**--------------------------------------------------------------------
  * CxlAssignResources
  *
  * @brief Assign CXL resources
  *
- * @details tbd
+ * @details Single allocation pass over every CXL port found by the discovery pass.
+ *          RCRBs and MEMBAR0s are reserved with one request per root bridge, all ports
+ *          get their secondary bus before any device is probed, and the Cxl.io BARs of
+ *          all devices are sized in one batch.
  *
- * @param[in]       Engine          Pointer to engine config descriptor
- * @param[in, out]  Buffer          CXL_BUS_LIMITS pointer
- * @param[in]       Pcie            Pointer to global PCIe configuration
+ * @param[in, out]  PortList        CXL ports found by the discovery pass
+ * @param[in, out]  Resources       CXL_BUS_LIMITS pointer
  *
  * @returns Nothing
  * @retval Nothing
  */
 void
 CxlAssignResources (
-  PCIe_ENGINE_CONFIG    *Engine,
-  void                  *Buffer,
-  PCIe_PLATFORM_CONFIG  *Pcie
+  CXL_PORT_LIST         *PortList,
+  CXL_BUS_LIMITS        *Resources
   )
 {
-  PCIe_WRAPPER_CONFIG                          *Wrapper;
+  CXL_PORT_ENTRY                               *Port;
+  PCIe_ENGINE_CONFIG                           *Engine;
   GNB_HANDLE                                   *GnbHandle;
   uint32_t                                     Value;
   NB_PCIE0_PORTA_CXL_RCRB_BASE_ADDR_LO_STRUCT  BarLow;
   NB_PCIE0_PORTA_CXL_RCRB_BASE_ADDR_HI_STRUCT  BarHigh;
-  uint32_t                                     *UsRcrb;
-  uint32_t                                     *DsRcrb;
-  CXL_BUS_LIMITS                               *Resources;
-  uint32_t                                     WhichBus;
-  size_t                                       Status;
+  uint64_t                                     Base[MAX_CXL_PORTS * 2];
+  uint32_t                                     Index;
   uint16_t                                     DvsecCapPtr;
   uint16_t                                     DvsecRegLocPtr;
   uint16_t                                     Value16;
-  bool                                         Cxl2p0Mapping = false;
-  MPIO_IP2IP_API                               *MpioApi;
+  bool                                         Cxl2p0Mapping;
   NBIO_IP2IP_API                               *NbioIp2Ip;
 
-
-
   if (SilGetIp2IpApi (SilId_NbioClass, (void **)(&NbioIp2Ip)) != SilPass) {
 
     return;
   }
-  GnbHandle = (GNB_HANDLE *) (NbioIp2Ip->PcieConfigGetParent (DESCRIPTOR_SILICON, &(Engine->Header)));
-  Wrapper = (PCIe_WRAPPER_CONFIG *) NbioIp2Ip->PcieConfigGetParent (DESCRIPTOR_ALL_WRAPPERS, &(Engine->Header));
-
-  if (SilGetIp2IpApi (SilId_MpioClass, (void **)&MpioApi) != SilPass) {
-    return;
-  }
 
-  CXL_TRACEPOINT (SIL_TRACE_INFO, " RB %d, Wrapper %d Port %d\n",
-    GnbHandle->RBIndex,
-    Wrapper->WrapId,
-    Engine->Type.Port.PortId
-    );
+  /*
+   * RCRB for every port
+   */
+  CxlAllocatePerRootBridge (PortList, CXL_RCRB_SIZE, BELOW_4GIG, false, Base);
+
+  for (Index = 0; Index < PortList->Count; Index++) {
+    Port = &PortList->Port[Index];
+    Engine = Port->Engine;
+    GnbHandle = Port->GnbHandle;
+    if (Base[Index] == 0) {
+      continue;
+    }
 
-  Resources = (CXL_BUS_LIMITS *) Buffer;
+    CXL_TRACEPOINT (SIL_TRACE_INFO, " RB %d, Wrapper %d Port %d\n",
+      GnbHandle->RBIndex,
+      Port->Wrapper->WrapId,
+      Engine->Type.Port.PortId
+      );
 
-  Status = CxlMmioAlloc (GnbHandle, &BarLow.Value, &BarHigh.Value, 8 * 1024, BELOW_4GIG);
-  if (Status != SilPass) {
-    return;
-  }
+    BarLow.Value = (uint32_t) Base[Index];
+    BarHigh.Value = (uint32_t) (Base[Index] >> 32);
+    Port->DsRcrb = (uint32_t *) ((uintptr_t)(BarLow.Value));
+    Port->UsRcrb = (uint32_t *) ((uintptr_t)(BarLow.Value + SIL_RESERVED_14));
 
-  DsRcrb = (uint32_t *) ((uintptr_t)(BarLow.Value));
-  UsRcrb = (uint32_t *) ((uintptr_t)(BarLow.Value + SIL_RESERVED_14));
+    Engine->Type.Cxl.DsRcrb = (uint32_t) ((uintptr_t)Port->DsRcrb);
+    Engine->Type.Cxl.UsRcrb = (uint32_t) ((uintptr_t)Port->UsRcrb);
 
-  Engine->Type.Cxl.DsRcrb = (uint32_t) ((uintptr_t)DsRcrb);
-  Engine->Type.Cxl.UsRcrb = (uint32_t) ((uintptr_t)UsRcrb);
+    xUSLSmnWrite (
+      GnbHandle->Address.Address.Segment,
+      GnbHandle->Address.Address.Bus,
+      NBIO_SPACE (GnbHandle,
+        (SMN_IOHUB0NBIO0_NB_PCIE0_PORTA_CXL_RCRB_BASE_ADDR_HI_ADDRESS) + (Engine->Type.Port.PortId * 8)),
+      BarHigh.Value
+      );
 
-  xUSLSmnWrite (
-    GnbHandle->Address.Address.Segment,
-    GnbHandle->Address.Address.Bus,
-    NBIO_SPACE (GnbHandle,
-      (SMN_IOHUB0NBIO0_NB_PCIE0_PORTA_CXL_RCRB_BASE_ADDR_HI_ADDRESS) + (Engine->Type.Port.PortId * 8)),
-    ((uint32_t)((uintptr_t)(&BarHigh)))
-    );
+    BarLow.Field.PCIE0_PORTA_CXL_RCRB_ENABLE = 1;
+    xUSLSmnWrite (
+      GnbHandle->Address.Address.Segment,
+      GnbHandle->Address.Address.Bus,
+      NBIO_SPACE (GnbHandle,
+        (SMN_IOHUB0NBIO0_NB_PCIE0_PORTA_CXL_RCRB_BASE_ADDR_LO_ADDRESS) + (Engine->Type.Port.PortId * 8)),
+      BarLow.Value
+      );
 
-  BarLow.Field.PCIE0_PORTA_CXL_RCRB_ENABLE = 1;
-  xUSLSmnWrite (
-    GnbHandle->Address.Address.Segment,
-    GnbHandle->Address.Address.Bus,
-    NBIO_SPACE (GnbHandle,
-      (SMN_IOHUB0NBIO0_NB_PCIE0_PORTA_CXL_RCRB_BASE_ADDR_LO_ADDRESS) + (Engine->Type.Port.PortId * 8)),
-    ((uint32_t)((uintptr_t)(&BarLow)))
-    );
+    /*
+     * MEM enable and BME
+     */
+    CxlRegisterWrite (Port->DsRcrb, PCICFG_SPACE_COMMAND_OFFSET, 0x6);
 
-  /*
-   * MEM enable and BME
-   */
-  CxlRegisterWrite (DsRcrb, PCICFG_SPACE_COMMAND_OFFSET, 0x6);
+    /*
+     * Assign secondary bus for CXL.io
+     */
+    Port->Bus = CxlAssignBus (Port->DsRcrb, Resources, GnbHandle);
+    NbioIp2Ip->PcieCapabilityInvalidateBus (Port->Bus << 20);
+  }
 
   /*
-   * Assign secondary bus for CXL.io
+   * Probe the CXL device behind every port
    */
-  WhichBus = CxlAssignBus (DsRcrb, Resources, GnbHandle);
+  for (Index = 0; Index < PortList->Count; Index++) {
+    Port = &PortList->Port[Index];
+    Engine = Port->Engine;
+    GnbHandle = Port->GnbHandle;
+    if (Port->DsRcrb == NULL) {
+      continue;
+    }
 
-  /*
-   * Get PCIe DVSEC for CXL device
-   */
-  DvsecCapPtr = CxlGetDvsec ((WhichBus << 20), DVSEC_VID, DVSEC_VID2, DVSEC_ID);
+    /*
+     * Get PCIe DVSEC for CXL device
+     */
+    DvsecCapPtr = CxlGetDvsec ((Port->Bus << 20), DVSEC_VID, DVSEC_VID2, DVSEC_ID);
+    if (DvsecCapPtr == 0) {
+      continue;
+    }
 
-  if(DvsecCapPtr != 0) {
     /*
-	 * Read Upstream Port Capability Register (offset 0) (latches address)
-	 */
-    Value = CxlRegisterRead (UsRcrb, 0);
+     * Read Upstream Port Capability Register (offset 0) (latches address)
+     */
+    Cxl2p0Mapping = false;
+    Value = CxlRegisterRead (Port->UsRcrb, 0);
 
     /*
-	 * If the data is 0xFFFFFFFF, check if this is a 2.0 device
-	 */
+     * If the data is 0xFFFFFFFF, check if this is a 2.0 device
+     */
     if (Value == 0xFFFFFFFF) {
       /*
-	   * Get DVSEC Locator
-	   */
-      DvsecRegLocPtr = CxlGetDvsec((WhichBus << 20), DVSEC_VID2, DVSEC_VID2, DVSEC_ID_REG_LOCATOR);
-      if(DvsecRegLocPtr != 0) {
+       * Get DVSEC Locator
+       */
+      DvsecRegLocPtr = CxlGetDvsec ((Port->Bus << 20), DVSEC_VID2, DVSEC_VID2, DVSEC_ID_REG_LOCATOR);
+      if (DvsecRegLocPtr != 0) {
         Cxl2p0Mapping = true;
         Engine->Type.Cxl.UsRcrb = 0;
-
       }
     }
 
     if ((Value != 0xFFFFFFFF) || Cxl2p0Mapping) {
       Engine->Type.Cxl.Address.AddressValue = 0;
-      Engine->Type.Cxl.Address.Address.Bus = WhichBus;
+      Engine->Type.Cxl.Address.Address.Bus = Port->Bus;
 
-      xUSLPciRead (MAKE_SBDFO (GnbHandle->Address.Address.Segment, WhichBus, 0, 0, (
-        DvsecCapPtr + DVSEC_CXL_CAP_OFFSET)),
-        AccessWidth16,
-        &Value16
-        );
+      Port->EndpointAddress = MAKE_SBDFO (GnbHandle->Address.Address.Segment, Port->Bus, 0, 0, 0);
+      Value16 = xUSLPciRead16 (Port->EndpointAddress | (DvsecCapPtr + DVSEC_CXL_CAP_OFFSET));
       /*
-	   * Type 2 not supproted
-	   */
+       * Type 2 not supproted
+       */
       assert ((Value16 & 0x5) != 0x5);
       if ((Value16 & 0x1) != 0) {
         Engine->Type.Cxl.CxlDeviceType = 1;
@@ -332,25 +421,29 @@ CxlAssignResources (
       if ((Value16 & 0x4) != 0) {
         Engine->Type.Cxl.CxlDeviceType = 3;
       }
+      Port->DvsecCapPtr = DvsecCapPtr;
+      Port->EndpointPresent = true;
+    }
+  }
 
-      /*
-	   * Allocate and assign BARs for downstream allocations
-	   */
-      AllocateForCxlIo (Engine, MAKE_SBDFO (GnbHandle->Address.Address.Segment, WhichBus, 0, 0, 0));
+  /*
+   * Size BARs for downstream allocations of all devices in one batch
+   */
+  CxlSizeEndpointBars (PortList);
 
-      /*
-	   * Assign MEMBAR0 in DS Port
-	   */
-      Status = CxlMmioAlloc (GnbHandle, &BarLow.Value, &BarHigh.Value, MEM_BAR0_SIZE, ABOVE_4GIG);
-      if (Status != SilPass) {
-        return;
-      }
-      CxlRegisterWrite (DsRcrb, PCICFG_SPACE_BAR0_OFFSET, BarLow.Value);
-      CxlRegisterWrite (DsRcrb, PCICFG_SPACE_BAR0_OFFSET + 4, BarHigh.Value);
+  /*
+   * Assign MEMBAR0 in DS Ports
+   */
+  CxlAllocatePerRootBridge (PortList, MEM_BAR0_SIZE, ABOVE_4GIG, true, Base);
+
+  for (Index = 0; Index < PortList->Count; Index++) {
+    Port = &PortList->Port[Index];
+    if (Port->EndpointPresent && (Base[Index] != 0)) {
+      CxlRegisterWrite (Port->DsRcrb, PCICFG_SPACE_BAR0_OFFSET, (uint32_t) Base[Index]);
+      CxlRegisterWrite (Port->DsRcrb, PCICFG_SPACE_BAR0_OFFSET + 4, (uint32_t) (Base[Index] >> 32));
     }
   }
 
-
   return;
 }
 
@@ -359,10 +452,11 @@ CxlAssignResources (
  *
  * @brief Determine if a port has a CXL connection
  *
- * @details tbd
+ * @details Discovery pass callback. Ports that negotiated CXL are appended to the
+ *          CXL_PORT_LIST in Buffer for the allocation pass.
  *
  * @param [in] Engine Pointer to engine descriptor
- * @param [in] Buffer Unused buffer pointer
+ * @param [in] Buffer CXL_PORT_LIST pointer
  * @param [in] Pcie   Pointer to platform descriptor
  *
  * @returns Nothing
@@ -385,6 +479,7 @@ CxlFindPorts (
   SOC_LOGICAL_ID                               LogicalId;
   MPIO_IP2IP_API                               *MpioApi;
   NBIO_IP2IP_API                               *NbioIp2Ip;
+  CXL_PORT_LIST                                *PortList;
 
 
 
@@ -593,6 +688,15 @@ CxlFindPorts (
         0,
         Wrapper->WrapId
       );
+
+      PortList = (CXL_PORT_LIST *) Buffer;
+      if ((PortList != NULL) && (PortList->Count < (MAX_CXL_PORTS * 2))) {
+        memset (&PortList->Port[PortList->Count], 0, sizeof (CXL_PORT_ENTRY));
+        PortList->Port[PortList->Count].Engine = Engine;
+        PortList->Port[PortList->Count].GnbHandle = GnbHandle;
+        PortList->Port[PortList->Count].Wrapper = Wrapper;
+        PortList->Count++;
+      }
     }
 
   }
@@ -607,8 +711,9 @@ CxlFindPorts (
  *
  * @details tbd
  *
- * @param[in]  GnbHandle           Pointer to the Silicon Descriptor for this node
- * @param[in]  PortDevMap          Pointer to PortDevMap
+ * @param[in]  Pcie                Pointer to global PCIe configuration
+ * @param[in]  PortList            CXL ports found by the discovery pass
+ * @param[out] CxlInfo             List of CXL devices reported to MPIO firmware
  *
  * @returns Nothing
  * @retval Nothing
@@ -616,10 +721,12 @@ CxlFindPorts (
 void
 CxlDevListGenerate (
   PCIe_PLATFORM_CONFIG  *Pcie,
-  CXL_INFO_LIST     *CxlInfo
+  CXL_PORT_LIST         *PortList,
+  CXL_INFO_LIST         *CxlInfo
   )
 {
   GNB_HANDLE        *GnbHandle;
+  uint32_t          Index;
   uint32_t          MpioArg[6];
   SIL_STATUS        Status;
   MPIO_IP2IP_API    *MpioApi;
@@ -644,12 +751,9 @@ CxlDevListGenerate (
   CxlInfo->CxlPortCountS1 = 0;
 
 
-  NbioIp2Ip->PcieConfigRunProcForAllEngines(
-               DESCRIPTOR_CXL_ENGINE,
-               CxlReportToMpio,
-               &CxlInfo,
-               Pcie
-               );
+  for (Index = 0; Index < PortList->Count; Index++) {
+    CxlReportToMpio (&PortList->Port[Index], CxlInfo);
+  }
 
   GnbHandle = NbioIp2Ip->NbioGetHandle (Pcie);
   if (CxlInfo->CxlPortCountS0 != 0) {
@@ -0,0 +1,446 @@
+/* Copyright 2023 Advanced Micro Devices, Inc. All rights reserved.    */
+// SPDX-License-Identifier: MIT
+
+/**
+ *  @file CxlInterleave.c
+ *  @brief Genoa CXL Type-3 memory interleave configuration
+ *
+ *  @details The ABL routes each CXL memory region in the DF address map and reports it in the
+ *           APOB. This file groups the Type-3 expanders behind a region into 2, 4 or 8-way
+ *           interleave sets of matching capacity, programs the DF sub-link interleave for the
+ *           region and publishes the set so the Host can commit the expanders' HDM decoders.
+ */
+
+#include <SilCommon.h>
+#include <string.h>
+#include <ApobCmn.h>
+#include <DF/DfIp2Ip.h>
+#include <DF/Common/SilFabricInfo.h>
+#include <DF/DfX/SilFabricRegistersDfX.h>
+#include <Cxl/Common/CxlInit.h>
+#include <Cxl/CxlClass-api.h>
+#include "CxlCmn2Rev.h"
+#include "Cxl.h"
+
+#define CXL_DF_MEM_RANGES           4     ///< CXL memory ranges per CS_CMP
+#define CXL_DF_MEM_RANGE_STRIDE     (CXLMEMORYBASEADDRESS_1_REG - CXLMEMORYBASEADDRESS_0_REG)
+#define CXL_DF_MEM_ADDR_SHIFT       28    ///< CXL memory base/limit registers hold address[51:28]
+#define CXL_NBIOS_PER_SOCKET        4
+#define CXL_SUB_LINKS_PER_NBIO      4
+
+/**--------------------------------------------------------------------
+ * CxlGetExpanderCapacity
+ *
+ * @brief Read the capacity a Type-3 expander reports in its CXL DVSEC
+ *
+ * @param[in]  Port            CXL port entry with a Type-3 device behind it
+ *
+ * @returns Capacity in bytes
+ * @retval 0 if the device has not reported valid memory information
+ */
+static
+uint64_t
+CxlGetExpanderCapacity (
+  CXL_PORT_ENTRY        *Port
+  )
+{
+  uint32_t  SizeHigh;
+  uint32_t  SizeLow;
+
+  SizeLow = xUSLPciRead32 (Port->EndpointAddress | (Port->DvsecCapPtr + DVSEC_CXL_RANGE1_SIZE_LOW_OFFSET));
+  if ((SizeLow & DVSEC_CXL_MEM_INFO_VALID) == 0) {
+    return 0;
+  }
+  SizeHigh = xUSLPciRead32 (Port->EndpointAddress | (Port->DvsecCapPtr + DVSEC_CXL_RANGE1_SIZE_HIGH_OFFSET));
+  return ((uint64_t) SizeHigh << 32) | (SizeLow & DVSEC_CXL_MEM_SIZE_LOW_MASK);
+}
+
+/**--------------------------------------------------------------------
+ * CxlGetIntLvAddrSel
+ *
+ * @brief Translate the interleave granularity to the DF sub-link interleave address select
+ *
+ * @param[in]  Granularity     CXL_INTERLEAVE_GRANULARITY
+ * @param[out] AddrSel         CXL_MEM_ADDRESS_INTLV0_REGISTER IntLvAddrSel
+ *
+ * @retval true     The DF supports the granularity
+ * @retval false    The DF only interleaves sub-links at 256B or 4KB
+ */
+static
+bool
+CxlGetIntLvAddrSel (
+  uint8_t               Granularity,
+  uint32_t              *AddrSel
+  )
+{
+  switch (Granularity) {
+  case CxlInterleave256B:
+    *AddrSel = 0;
+    return true;
+  case CxlInterleave4KB:
+    *AddrSel = 1;
+    return true;
+  default:
+    return false;
+  }
+}
+
+/**--------------------------------------------------------------------
+ * CxlFindExpander
+ *
+ * @brief Find the Type-3 expander on a sub-link of an NBIO
+ *
+ * @param[in]  PortList        CXL ports found by the discovery pass
+ * @param[in]  Socket          Socket of the NBIO
+ * @param[in]  Nbio            Physical NBIO on the socket
+ * @param[in]  SubLink         Sub-link of the NBIO
+ *
+ * @returns Index of the port in PortList
+ * @retval PortList->Count if no Type-3 expander is on the sub-link
+ */
+static
+uint32_t
+CxlFindExpander (
+  CXL_PORT_LIST         *PortList,
+  uint32_t              Socket,
+  uint32_t              Nbio,
+  uint32_t              SubLink
+  )
+{
+  CXL_PORT_ENTRY  *Port;
+  uint32_t        Index;
+
+  for (Index = 0; Index < PortList->Count; Index++) {
+    Port = &PortList->Port[Index];
+    if (Port->EndpointPresent && (Port->Engine->Type.Cxl.CxlDeviceType == 3) &&
+        (Port->GnbHandle->SocketId == Socket) && (Port->GnbHandle->RBIndex == Nbio) &&
+        ((Port->Engine->Type.Cxl.PortId % CXL_SUB_LINKS_PER_NBIO) == SubLink)) {
+      break;
+    }
+  }
+  return Index;
+}
+
+/**--------------------------------------------------------------------
+ * CxlGetSubLinkGroup
+ *
+ * @brief Find a naturally aligned group of sub-links of an NBIO
+ *
+ * @param[in]  Available       Sub-links with a usable expander
+ * @param[in]  Links           Sub-links in the group: 1, 2 or 4
+ *
+ * @returns IntLvLinkEn of the lowest aligned group within Available
+ * @retval 0 if Available holds no such group
+ */
+static
+uint8_t
+CxlGetSubLinkGroup (
+  uint8_t               Available,
+  uint32_t              Links
+  )
+{
+  uint32_t  Shift;
+  uint8_t   Group;
+
+  for (Shift = 0; Shift < CXL_SUB_LINKS_PER_NBIO; Shift += Links) {
+    Group = (uint8_t) (((1u << Links) - 1) << Shift);
+    if ((Available & Group) == Group) {
+      return Group;
+    }
+  }
+  return 0;
+}
+
+/**--------------------------------------------------------------------
+ * CxlProgramDfInterleave
+ *
+ * @brief Program the DF sub-link interleave of a CXL memory region on one NBIO
+ *
+ * @details The DF range routing the region is located by its base address on the CS_CMP
+ *          serving the NBIO. The base and limit are left as routed by the ABL.
+ *
+ * @param[in]  DfIp2Ip         DF Ip2Ip API
+ * @param[in]  Socket          Socket of the region
+ * @param[in]  Nbio            Physical NBIO on the socket
+ * @param[in]  Base            Host physical base of the region
+ * @param[in]  SubLinkMap      Sub-links interleaved on this NBIO
+ * @param[in]  AddrSel         IntLvAddrSel from CxlGetIntLvAddrSel
+ * @param[out] Range           DF range that was programmed
+ * @param[out] Previous        Interleave register value before programming
+ *
+ * @returns SIL_STATUS
+ * @retval SilPass      The interleave was programmed
+ * @retval SilNotFound  No DF range on the NBIO routes the region
+ */
+static
+SIL_STATUS
+CxlProgramDfInterleave (
+  DF_IP2IP_API          *DfIp2Ip,
+  uint32_t              Socket,
+  uint32_t              Nbio,
+  uint64_t              Base,
+  uint8_t               SubLinkMap,
+  uint32_t              AddrSel,
+  uint32_t              *Range,
+  uint32_t              *Previous
+  )
+{
+  CXL_MEMORY_BASE_ADDRESS_REGISTER  MemBase;
+  CXL_MEM_ADDRESS_INTLV0_REGISTER   MemIntlv;
+  uint32_t                          Instance;
+
+  Instance = DFX_CSCMP0_INSTANCE_ID + Nbio;
+  for (*Range = 0; *Range < CXL_DF_MEM_RANGES; (*Range)++) {
+    MemBase.Value = DfIp2Ip->DfFabricRegisterAccRead (
+      Socket,
+      CXLMEMORYBASEADDRESS_0_FUNC,
+      CXLMEMORYBASEADDRESS_0_REG + (*Range * CXL_DF_MEM_RANGE_STRIDE),
+      Instance
+      );
+    if ((MemBase.Field.AddrRngVal != 0) &&
+        ((uint64_t) MemBase.Field.CxlMemBaseAddr == (Base >> CXL_DF_MEM_ADDR_SHIFT))) {
+      MemIntlv.Value = DfIp2Ip->DfFabricRegisterAccRead (
+        Socket,
+        CXLMEMADDRESSINTLV0_FUNC,
+        CXLMEMADDRESSINTLV0_REG + (*Range * CXL_DF_MEM_RANGE_STRIDE),
+        Instance
+        );
+      *Previous = MemIntlv.Value;
+      MemIntlv.Field.IntLvLinkEn = SubLinkMap;
+      MemIntlv.Field.IntLvAddrSel = AddrSel;
+      DfIp2Ip->DfFabricRegisterAccWrite (
+        Socket,
+        CXLMEMADDRESSINTLV0_FUNC,
+        CXLMEMADDRESSINTLV0_REG + (*Range * CXL_DF_MEM_RANGE_STRIDE),
+        Instance,
+        MemIntlv.Value
+        );
+      CXL_TRACEPOINT (SIL_TRACE_INFO, "  Socket %d NBIO %d DF range %d sub-links 0x%x\n",
+        Socket,
+        Nbio,
+        *Range,
+        SubLinkMap
+        );
+      return SilPass;
+    }
+  }
+  return SilNotFound;
+}
+
+/**--------------------------------------------------------------------
+ * CxlConfigureInterleave
+ *
+ * @brief Build and program the CXL Type-3 memory interleave sets
+ *
+ * @details For every CXL memory region routed by the ABL, the sub-links the APOB lists in
+ *          SubIntlvMap for each NBIO of PhysNbioMap are searched for Type-3 expanders whose
+ *          capacity matches the first one found. Every NBIO of the region must contribute the
+ *          same naturally aligned group of 1, 2 or 4 sub-links, so the DF interleave stays
+ *          balanced and no NBIO of the region is left without a target. The set uses the
+ *          largest such group that the expanders, the region size and CxlMemInterleaveWays
+ *          allow, ordered by NBIO and then sub-link. A region spread over several NBIOs is
+ *          only interleaved if the APOB IntlvSize matches the requested granularity.
+ *
+ *          A region that cannot be interleaved this way keeps the routing of the ABL; if the
+ *          DF programming fails part way, the NBIOs already programmed are restored.
+ *
+ * @param[in]  PortList        CXL ports found by the discovery pass
+ *
+ * @returns Nothing
+ * @retval Nothing
+ */
+void
+CxlConfigureInterleave (
+  CXL_PORT_LIST         *PortList
+  )
+{
+  CXLCLASS_DATA_BLK                  *SilData;
+  APOB_SYSTEM_CXL_INFO_TYPE_STRUCT   *CxlMap;
+  CXL_ADDR_MAP_INFO                  *Region;
+  CXL_INTERLEAVE_SET                 *Set;
+  CXL_PORT_ENTRY                     *Port;
+  DF_IP2IP_API                       *DfIp2Ip;
+  uint32_t                           RegionIndex;
+  uint32_t                           Index;
+  uint32_t                           Nbio;
+  uint32_t                           SubLink;
+  uint32_t                           NbioCount;
+  uint32_t                           Links;
+  uint32_t                           Ways;
+  uint32_t                           AddrSel;
+  uint64_t                           Capacity;
+  uint64_t                           ExpanderCapacity;
+  uint8_t                            Granularity;
+  uint32_t                           Expander[CXL_NBIOS_PER_SOCKET][CXL_SUB_LINKS_PER_NBIO];
+  uint8_t                            Available[CXL_NBIOS_PER_SOCKET];
+  uint8_t                            SubLinkMap[CXL_NBIOS_PER_SOCKET];
+  uint32_t                           Range[CXL_NBIOS_PER_SOCKET];
+  uint32_t                           Previous[CXL_NBIOS_PER_SOCKET];
+
+  SilData = (CXLCLASS_DATA_BLK *)SilFindStructure (SilId_CxlClass, 0);
+  if (SilData == NULL) {
+    return;
+  }
+  SilData->CxlOutputBlock.CxlInterleaveSetCount = 0;
+  if (SilData->CxlInputBlock.CxlMemInterleaveWays < 2) {
+    return;
+  }
+  Granularity = SilData->CxlInputBlock.CxlMemInterleaveGranularity;
+  if (!CxlGetIntLvAddrSel (Granularity, &AddrSel)) {
+    CXL_TRACEPOINT (SIL_TRACE_ERROR, " CXL interleave granularity %d is not supported\n", Granularity);
+    return;
+  }
+  if (SilGetIp2IpApi (SilId_DfClass, (void **)&DfIp2Ip) != SilPass) {
+    return;
+  }
+  if (AmdGetApobEntryInstance (APOB_FABRIC, APOB_SYS_CXL_INFO_TYPE, 0, 0,
+      (APOB_TYPE_HEADER **)(void*) &CxlMap) != SilPass) {
+    return;
+  }
+
+  for (RegionIndex = 0; RegionIndex < (sizeof (CxlMap->CxlInfo) / sizeof (CxlMap->CxlInfo[0])); RegionIndex++) {
+    Region = &CxlMap->CxlInfo[RegionIndex];
+    if ((Region->Size == 0) || (Region->Status != CXL_ADDR_SUCCESS) ||
+        (SilData->CxlOutputBlock.CxlInterleaveSetCount >= CXL_MAX_INTERLEAVE_SETS)) {
+      continue;
+    }
+    Set = &SilData->CxlOutputBlock.CxlInterleaveSet[SilData->CxlOutputBlock.CxlInterleaveSetCount];
+    memset (Set, 0, sizeof (CXL_INTERLEAVE_SET));
+
+    NbioCount = 0;
+    for (Nbio = 0; Nbio < CXL_NBIOS_PER_SOCKET; Nbio++) {
+      if ((Region->PhysNbioMap & (1 << Nbio)) != 0) {
+        NbioCount++;
+      }
+    }
+    if ((NbioCount == 0) || ((NbioCount & (NbioCount - 1)) != 0)) {
+      CXL_TRACEPOINT (SIL_TRACE_INFO, " Region 0x%llx spans %d NBIOs, not interleaved\n", Region->Base, NbioCount);
+      continue;
+    }
+    // DF_MEM_INTLV_SIZE encodes 256B << n, like the HDM decoder IG
+    if ((NbioCount > 1) && (Region->IntlvSize != Granularity)) {
+      CXL_TRACEPOINT (SIL_TRACE_INFO, " Region 0x%llx NBIO interleave size %d does not match, not interleaved\n",
+        Region->Base,
+        Region->IntlvSize
+        );
+      continue;
+    }
+
+    /*
+     * Collect the matching expanders on the sub-links the ABL routed into the region
+     */
+    Capacity = 0;
+    memset (Available, 0, sizeof (Available));
+    for (Nbio = 0; Nbio < CXL_NBIOS_PER_SOCKET; Nbio++) {
+      if ((Region->PhysNbioMap & (1 << Nbio)) == 0) {
+        continue;
+      }
+      for (SubLink = 0; SubLink < CXL_SUB_LINKS_PER_NBIO; SubLink++) {
+        if ((Region->SubIntlvMap[Nbio] & (1 << SubLink)) == 0) {
+          continue;
+        }
+        Index = CxlFindExpander (PortList, Region->Socket, Nbio, SubLink);
+        if (Index == PortList->Count) {
+          continue;
+        }
+        ExpanderCapacity = CxlGetExpanderCapacity (&PortList->Port[Index]);
+        if (ExpanderCapacity == 0) {
+          continue;
+        }
+        if (Capacity == 0) {
+          Capacity = ExpanderCapacity;
+        } else if (ExpanderCapacity != Capacity) {
+          CXL_TRACEPOINT (SIL_TRACE_INFO, " Bus 0x%x capacity does not match, not interleaved\n",
+            PortList->Port[Index].Bus);
+          continue;
+        }
+        Expander[Nbio][SubLink] = Index;
+        Available[Nbio] |= (uint8_t) (1 << SubLink);
+      }
+    }
+
+    /*
+     * Largest balanced set: the same aligned group of sub-links on every NBIO of the region
+     */
+    Ways = 0;
+    for (Links = CXL_SUB_LINKS_PER_NBIO; Links > 0; Links /= 2) {
+      Ways = NbioCount * Links;
+      if ((Ways < 2) || (Ways > CXL_MAX_INTERLEAVE_WAYS) ||
+          (Ways > SilData->CxlInputBlock.CxlMemInterleaveWays) || ((Ways * Capacity) > Region->Size)) {
+        continue;
+      }
+      for (Nbio = 0; Nbio < CXL_NBIOS_PER_SOCKET; Nbio++) {
+        SubLinkMap[Nbio] = 0;
+        if ((Region->PhysNbioMap & (1 << Nbio)) == 0) {
+          continue;
+        }
+        SubLinkMap[Nbio] = CxlGetSubLinkGroup (Available[Nbio], Links);
+        if (SubLinkMap[Nbio] == 0) {
+          break;
+        }
+      }
+      if (Nbio == CXL_NBIOS_PER_SOCKET) {
+        break;
+      }
+    }
+    if ((Links == 0) || (Capacity == 0)) {
+      CXL_TRACEPOINT (SIL_TRACE_INFO, " Region 0x%llx has no balanced interleave set\n", Region->Base);
+      continue;
+    }
+
+    Index = 0;
+    for (Nbio = 0; Nbio < CXL_NBIOS_PER_SOCKET; Nbio++) {
+      for (SubLink = 0; SubLink < CXL_SUB_LINKS_PER_NBIO; SubLink++) {
+        if ((SubLinkMap[Nbio] & (1 << SubLink)) != 0) {
+          Port = &PortList->Port[Expander[Nbio][SubLink]];
+          Set->TargetBus[Index] = (uint8_t) Port->Bus;
+          Index++;
+        }
+      }
+    }
+
+    /*
+     * Program the DF sub-link interleave on each NBIO, restoring them all if one fails
+     */
+    for (Nbio = 0; Nbio < CXL_NBIOS_PER_SOCKET; Nbio++) {
+      if (SubLinkMap[Nbio] == 0) {
+        continue;
+      }
+      if (CxlProgramDfInterleave (DfIp2Ip, Region->Socket, Nbio, Region->Base, SubLinkMap[Nbio], AddrSel,
+          &Range[Nbio], &Previous[Nbio]) != SilPass) {
+        CXL_TRACEPOINT (SIL_TRACE_ERROR, " No DF range for region 0x%llx on NBIO %d\n", Region->Base, Nbio);
+        break;
+      }
+      Set->PhysNbioMap |= (uint8_t) (1 << Nbio);
+    }
+    if (Nbio != CXL_NBIOS_PER_SOCKET) {
+      while (Nbio-- > 0) {
+        if ((Set->PhysNbioMap & (1 << Nbio)) != 0) {
+          DfIp2Ip->DfFabricRegisterAccWrite (
+            Region->Socket,
+            CXLMEMADDRESSINTLV0_FUNC,
+            CXLMEMADDRESSINTLV0_REG + (Range[Nbio] * CXL_DF_MEM_RANGE_STRIDE),
+            DFX_CSCMP0_INSTANCE_ID + Nbio,
+            Previous[Nbio]
+            );
+        }
+      }
+      memset (Set, 0, sizeof (CXL_INTERLEAVE_SET));
+      continue;
+    }
+
+    Set->Base = Region->Base;
+    Set->Size = Ways * Capacity;
+    Set->Socket = Region->Socket;
+    Set->Ways = (uint8_t) Ways;
+    Set->Granularity = Granularity;
+    SilData->CxlOutputBlock.CxlInterleaveSetCount++;
+
+    CXL_TRACEPOINT (SIL_TRACE_INFO, " CXL interleave set: socket %d, %d-way, base 0x%llx, size 0x%llx\n",
+      Set->Socket,
+      Set->Ways,
+      Set->Base,
+      Set->Size
+      );
+  }
+}
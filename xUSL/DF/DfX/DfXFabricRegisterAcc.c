@@ -8,10 +8,15 @@
 
 #include <xSIM.h>
 #include <Pci.h>
+#include <Apob.h>
+#include <CommonLib/SpinLock.h>
 #include <DF/Common/FabricRegisterAccCmn.h>
 #include "DfXFabricRegisterAcc.h"
 #include "SilFabricRegistersDfX.h"
 
+// FICAA3/FICAD3 is a single index/data pair per socket
+static XUSL_SPIN_LOCK mDfFicaaLock[MAX_SOCKETS_SUPPORTED];
+
 /**
   * DfXFabricRegisterAccRead
   *
@@ -49,11 +54,13 @@ uint32_t DfXFabricRegisterAccRead(uint32_t Socket, uint32_t Function, uint32_t O
     FICAA3.Field.IndCfgAccRegNum = ((uint32_t) Offset) >> 2;
     FICAA3.Field.IndCfgAccFuncNum = (uint32_t) Function;
     FICAA3.Field.CfgRegInstID = (uint32_t) Instance;
+    xUslAcquireSpinLock (&mDfFicaaLock[Socket]);
     xUSLPciWrite32 (PciAddr.AddressValue, FICAA3.Value);
 
     PciAddr.Address.Function = FABRICINDIRECTCONFIGACCESSDATALO_3_FUNC;
     PciAddr.Address.Register = FABRICINDIRECTCONFIGACCESSDATALO_3_REG;
     RegisterValue = xUSLPciRead32 (PciAddr.AddressValue);
+    xUslReleaseSpinLock (&mDfFicaaLock[Socket]);
   }
   return RegisterValue;
 }
@@ -105,6 +112,7 @@ void DfXFabricRegisterAccWrite(
     FICAA3.Field.IndCfgAccRegNum = ((uint32_t) Offset) >> 2;
     FICAA3.Field.IndCfgAccFuncNum = (uint32_t) Function;
     FICAA3.Field.CfgRegInstID = (uint32_t) Instance;
+    xUslAcquireSpinLock (&mDfFicaaLock[Socket]);
     xUSLPciWrite32 (PciAddr.AddressValue, FICAA3.Value);
 //      if (LogForS3) {
 //        AmdS3SaveScriptPciWrite (AccessWidth32, PciAddr.AddressValue, &FICAA3.Value);
@@ -113,6 +121,7 @@ void DfXFabricRegisterAccWrite(
     PciAddr.Address.Function = FABRICINDIRECTCONFIGACCESSDATALO_3_FUNC;
     PciAddr.Address.Register = FABRICINDIRECTCONFIGACCESSDATALO_3_REG;
     xUSLPciWrite32 (PciAddr.AddressValue, RegisterValue);
+    xUslReleaseSpinLock (&mDfFicaaLock[Socket]);
 //      if (LogForS3) {
 //        AmdS3SaveScriptPciWrite (AccessWidth32, PciAddr.AddressValue, &RegisterValue);
 //      }
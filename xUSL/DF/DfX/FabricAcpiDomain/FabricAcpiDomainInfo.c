@@ -17,6 +17,7 @@
 #include <DF/DfX/DfXFabricRegisterAcc.h>
 #include <DF/DfX/FabricAcpiDomain/FabricAcpiDomainInfo.h>
 #include <RcMgr/DfX/RcManager4-api.h>
+#include <Cxl/CxlClass-api.h>
 #include <string.h>
 
 uint32_t   NumberOfPhysicalDomains  = 0;
@@ -143,9 +144,18 @@ BuildCcdInfo (
 /**
  * BuildCxlInfo
  *
- * @brief This function gathers data about CCMs to be used by the protocol procedures
+ * @brief This function gathers data about CXL memory regions to be used by the protocol procedures
  *
- * @retval   uint32_t   Number of Cxls populated with memory
+ * @details By default each socket with CXL memory reports one physical domain covering all its
+ *          CS_CMP blocks. When CXL memory interleaving is enabled (CxlMemInterleaveWays >= 2), each
+ *          successfully mapped APOB CXL region becomes its own physical domain whose CS map covers
+ *          only the CS_CMP blocks (NBIOs) the ABL routed it to. The domains follow the APOB routing;
+ *          the interleave sets built by the CXL IP are not reported here, because no HDM decoder
+ *          is programmed for them.
+ *
+ * @param[in] Index      Index of the first physical domain available for CXL
+ *
+ * @retval   uint32_t   Number of CXL domains populated with memory
  */
 static uint32_t
 BuildCxlInfo (
@@ -155,21 +165,42 @@ BuildCxlInfo (
   uint32_t                               i;
   uint32_t                               ActiveCxlCount;
   APOB_SYSTEM_CXL_INFO_TYPE_STRUCT      *CxlMap;
+  CXL_ADDR_MAP_INFO                     *Region;
+  CXLCLASS_DATA_BLK                     *CxlData;
+  bool                                  PerRegion;
   bool                                  CxlDeviceAttached[MAX_SOCKETS_SUPPORTED];
 
   ActiveCxlCount = 0;
-    for (i = 0; i < MAX_SOCKETS_SUPPORTED; i++) {
+  for (i = 0; i < MAX_SOCKETS_SUPPORTED; i++) {
     CxlDeviceAttached[i] = false;
   }
+  CxlData = (CXLCLASS_DATA_BLK *) SilFindStructure (SilId_CxlClass, 0);
+  PerRegion = (CxlData != NULL) && (CxlData->CxlInputBlock.CxlMemInterleaveWays >= 2);
 
   if ((AmdGetApobEntryInstance (APOB_FABRIC, APOB_SYS_CXL_INFO_TYPE, 0, 0,
       (APOB_TYPE_HEADER **)(void*) &CxlMap)) == SilPass) {
     for (i = 0; i < (sizeof (CxlMap->CxlInfo) / sizeof(CxlMap->CxlInfo[0])); i++) {
-      if(CxlMap->CxlInfo[i].Size != 0 && CxlMap->CxlInfo[i].Status == CXL_ADDR_SUCCESS) {
-        if (CxlMap->CxlInfo[i].Socket < MAX_SOCKETS_SUPPORTED) {
-          CxlDeviceAttached[CxlMap->CxlInfo[i].Socket] = true;
-        }
+      Region = &CxlMap->CxlInfo[i];
+      if ((Region->Size == 0) || (Region->Status != CXL_ADDR_SUCCESS) ||
+          (Region->Socket >= MAX_SOCKETS_SUPPORTED)) {
+        continue;
+      }
+      if (!PerRegion) {
+        CxlDeviceAttached[Region->Socket] = true;
+        continue;
       }
+      if ((Region->PhysNbioMap & ((1 << DFX_NUM_CS_CMP_BLOCKS) - 1)) == 0) {
+        continue;
+      }
+      if ((Index + ActiveCxlCount) >= MAX_PHYSICAL_DOMAINS) {
+        DF_TRACEPOINT(SIL_TRACE_ERROR, "BuildCxlInfo out of physical domains at region %d\n", i);
+        break;
+      }
+      // Build the CS map from the CS_CMP blocks that back this region
+      FabricRcMgrData->DFXRcmgrOutputBlock.PhysicalDomainInfo[(Index + ActiveCxlCount)].NormalizedCsMap
+        = ((uint32_t) (Region->PhysNbioMap & ((1 << DFX_NUM_CS_CMP_BLOCKS) - 1)) << DFX_NUM_CS_UMC_BLOCKS)
+          << ((uint32_t) Region->Socket * NORMALIZED_SOCKET_SHIFT);
+      ActiveCxlCount++;
     }
   }
   for (i = 0; i < MAX_SOCKETS_SUPPORTED; i++) {
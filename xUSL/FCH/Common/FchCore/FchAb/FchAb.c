@@ -148,20 +148,22 @@ AbCfgTbl (
 
   FCH_TRACEPOINT(SIL_TRACE_ENTRY, "\n");
 
+  // AXINDC/AXINDP entries nest a second index/data pair behind the Alink one
+  xUslAcquireSpinLock (&mFchIndexIoLock);
   while ( (ABTbl->RegType) != 0xFF ) {
     if ( ABTbl->RegType == AXINDC ) {
       AbValue = 0x30 | (ABTbl->RegType << 29);
-      WriteAlink (AbValue, (ABTbl->RegIndex & 0x00FFFFFF));
+      FchAlinkWriteUnlocked (AbValue, (ABTbl->RegIndex & 0x00FFFFFF));
       AbValue = 0x34 | (ABTbl->RegType << 29);
-      WriteAlink (AbValue, ((ReadAlink (AbValue)) & (0xFFFFFFFF^ (ABTbl->RegMask))) | ABTbl->RegData);
+      FchAlinkWriteUnlocked (AbValue, ((FchAlinkReadUnlocked (AbValue)) & (0xFFFFFFFF^ (ABTbl->RegMask))) | ABTbl->RegData);
     } else if ( ABTbl->RegType == AXINDP ) {
       AbValue = 0x38 | (ABTbl->RegType << 29);
-      WriteAlink (AbValue, (ABTbl->RegIndex & 0x00FFFFFF));
+      FchAlinkWriteUnlocked (AbValue, (ABTbl->RegIndex & 0x00FFFFFF));
       AbValue = 0x3C | (ABTbl->RegType << 29);
-      WriteAlink (AbValue, ((ReadAlink (AbValue)) & (0xFFFFFFFF^ (ABTbl->RegMask))) | ABTbl->RegData);
+      FchAlinkWriteUnlocked (AbValue, ((FchAlinkReadUnlocked (AbValue)) & (0xFFFFFFFF^ (ABTbl->RegMask))) | ABTbl->RegData);
     } else {
       AbValue = ABTbl->RegIndex | (ABTbl->RegType << 29);
-      WriteAlink (AbValue, ((ReadAlink (AbValue)) & (0xFFFFFFFF^ (ABTbl->RegMask))) | ABTbl->RegData);
+      FchAlinkWriteUnlocked (AbValue, ((FchAlinkReadUnlocked (AbValue)) & (0xFFFFFFFF^ (ABTbl->RegMask))) | ABTbl->RegData);
     }
 
     ++ABTbl;
@@ -172,6 +174,7 @@ AbCfgTbl (
   //
   AbValue = 0;
   xUSLIoWrite32 (ALINK_ACCESS_INDEX, AbValue);
+  xUslReleaseSpinLock (&mFchIndexIoLock);
 
   FCH_TRACEPOINT(SIL_TRACE_EXIT, "\n");
 }
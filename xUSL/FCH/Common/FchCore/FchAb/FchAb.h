@@ -17,6 +17,8 @@
 uint32_t ReadAlink (uint32_t Index);
 void WriteAlink (uint32_t Index, uint32_t Data);
 void RwAlink (uint32_t Index, uint32_t AndMask, uint32_t OrMask);
+uint32_t FchAlinkReadUnlocked (uint32_t Index);
+void FchAlinkWriteUnlocked (uint32_t Index, uint32_t Data);
 void FchAbPrePcieInit(FCHAB_INPUT_BLK *LclInpFchAbBlk);
 SIL_STATUS FchAbSetInputBlk (void);
 SIL_STATUS InitializeFchAbTp1 (void);
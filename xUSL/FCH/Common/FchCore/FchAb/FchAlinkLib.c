@@ -8,10 +8,11 @@
 #include "FchAbReg.h"
 #include "FchAb.h"
 #include <FCH/Common/FchCommonCfg.h>
+#include <FCH/Common/FchHelper.h>
 #include <CommonLib/Io.h>
 
 /**
- * ReadAlink - Read the Alink Registers
+ * FchAlinkReadUnlocked - Read an Alink register, caller holds mFchIndexIoLock
  *
  *
  * @param[in] Index - The index of the Alink register
@@ -19,7 +20,7 @@
  *
  */
 uint32_t
-ReadAlink (
+FchAlinkReadUnlocked (
   uint32_t Index
   )
 {
@@ -33,7 +34,7 @@ ReadAlink (
 }
 
 /**
- * WriteAlink - Write the Alink Registers
+ * FchAlinkWriteUnlocked - Write an Alink register, caller holds mFchIndexIoLock
  *
  *
  * @param[in] Index - The index of the Alink register
@@ -42,7 +43,7 @@ ReadAlink (
  *
  */
 void
-WriteAlink (
+FchAlinkWriteUnlocked (
   uint32_t Index,
   uint32_t Data
   )
@@ -54,6 +55,47 @@ WriteAlink (
   xUSLIoWrite32 (ALINK_ACCESS_INDEX, Index);
 }
 
+/**
+ * ReadAlink - Read the Alink Registers
+ *
+ *
+ * @param[in] Index - The index of the Alink register
+ *
+ *
+ */
+uint32_t
+ReadAlink (
+  uint32_t Index
+  )
+{
+  uint32_t Data;
+
+  xUslAcquireSpinLock (&mFchIndexIoLock);
+  Data = FchAlinkReadUnlocked (Index);
+  xUslReleaseSpinLock (&mFchIndexIoLock);
+  return Data;
+}
+
+/**
+ * WriteAlink - Write the Alink Registers
+ *
+ *
+ * @param[in] Index - The index of the Alink register
+ * @param[in] Data - The Data of the Alink register
+ *
+ *
+ */
+void
+WriteAlink (
+  uint32_t Index,
+  uint32_t Data
+  )
+{
+  xUslAcquireSpinLock (&mFchIndexIoLock);
+  FchAlinkWriteUnlocked (Index, Data);
+  xUslReleaseSpinLock (&mFchIndexIoLock);
+}
+
 /**
  * RwAlink - Modify the Alink Registers
  *
@@ -71,5 +113,7 @@ RwAlink (
   uint32_t OrMask
   )
 {
-  WriteAlink (Index, (ReadAlink (Index) & AndMask) | OrMask);
+  xUslAcquireSpinLock (&mFchIndexIoLock);
+  FchAlinkWriteUnlocked (Index, (FchAlinkReadUnlocked (Index) & AndMask) | OrMask);
+  xUslReleaseSpinLock (&mFchIndexIoLock);
 }
@@ -830,10 +830,12 @@ FchInternalDeviceIrqInit (
 
   FchModifyDeviceIrq(FchDataPtr);
 
+  xUslAcquireSpinLock (&mFchIndexIoLock);
   for (i = 0; i < NUM_OF_DEVICE_FOR_APICIRQ; i++) {
     xUSLIoWrite8 ( FCH_IOMAP_REGC00, FchInternalDeviceIrqForApicMode[i].PciIrqIndex);
     xUSLIoWrite8 ( FCH_IOMAP_REGC01, FchInternalDeviceIrqForApicMode[i].PciIrqData);
   }
+  xUslReleaseSpinLock (&mFchIndexIoLock);
 }
 
 /*----------------------------------------------------------------------------------------*/
@@ -933,6 +935,7 @@ static void GcpuRelatedSetting (void *FchDataPtr) {
   FchGcpuMsgCMultiCore = (uint8_t) LocalCfgPtr->Gcpu.GcpuMsgCMultiCore;
   FchGcpuMsgCStage = (uint8_t) LocalCfgPtr->Gcpu.GcpuMsgCStage;
 
+  xUslAcquireSpinLock (&mFchPmioLock);
   Value = xUSLMemRead32 ((void*)(size_t)(ACPI_MMIO_BASE + PMIO_BASE + FCH_PMIOA_REGA0));
   Value = Value & 0xC07F00A0;
 
@@ -965,6 +968,7 @@ static void GcpuRelatedSetting (void *FchDataPtr) {
   }
 
   xUSLMemWrite32 ((void*)(size_t)(ACPI_MMIO_BASE + PMIO_BASE + FCH_PMIOA_REGA0), Value);
+  xUslReleaseSpinLock (&mFchPmioLock);
 }
 
 /**
@@ -1099,26 +1103,33 @@ static void FchInitHwAcpiWaFeature (FCHCLASS_INPUT_BLK *FchDataPtr)
 
   SmbusBase = FchDataPtr->FchBldCfg.CfgSmbus0BaseAddress;
   SmbusBase &= 0xFF00;
+  // The RTC (70/71) and PCI IRQ routing (C00/C01) sequences below use shared index/data ports.
+  // mFchPmioLock is taken inside it for the PMIO 5E/5F pair.
+  xUslAcquireSpinLock (&mFchIndexIoLock);
   //
   // RTC Workaround for Daylight saving time enable bit
   //
+  xUslAcquireSpinLock (&mFchPmioLock);
   xUSLMemReadModifyWrite8 ((void *)(size_t)(ACPI_MMIO_BASE + PMIO_BASE + FCH_PMIOA_REG5E), 0, 0);
   xUSLMemReadModifyWrite8 (
     (void *)(size_t)(ACPI_MMIO_BASE + PMIO_BASE + FCH_PMIOA_REG5F),
     0xFE,
     BIT_32(0)
     );   // Enable DltSavEnable
+  xUslReleaseSpinLock (&mFchPmioLock);
   Value = 0x0B;
   xUSLIoWrite8 (FCH_IOMAP_REG70, Value);
   Value = xUSLIoRead8(FCH_IOMAP_REG71);
   Value &= 0xFE;
   xUSLIoWrite8 (FCH_IOMAP_REG71, Value);
+  xUslAcquireSpinLock (&mFchPmioLock);
   xUSLMemReadModifyWrite8 ((void *)(size_t)(ACPI_MMIO_BASE + PMIO_BASE + FCH_PMIOA_REG5E), 0, 0);
   xUSLMemReadModifyWrite8 (
     (void *)(size_t)(ACPI_MMIO_BASE + PMIO_BASE + FCH_PMIOA_REG5F),
     0xFE,
     0
     );   // Enable DltSavEnable
+  xUslReleaseSpinLock (&mFchPmioLock);
   //
   // Prevent RTC error
   //
@@ -1205,6 +1216,7 @@ static void FchInitHwAcpiWaFeature (FCHCLASS_INPUT_BLK *FchDataPtr)
   Value = Value & 0x9F;
   Value = Value | BIT_32(4);
   xUSLIoWrite8 (FCH_IOMAP_REGC01, Value);
+  xUslReleaseSpinLock (&mFchIndexIoLock);
 
   if (FchDataPtr->FchOscout1ClkContinous) {
     xUSLMemReadModifyWrite8 ((void *)(size_t)(ACPI_MMIO_BASE + PMIO_BASE + FCH_PMIOA_REG54), 0xBF, 0);
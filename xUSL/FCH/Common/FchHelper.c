@@ -23,6 +23,9 @@
 #define ACPI_MMIO_BASE 0xFED80000ul
 #define PMIO_BASE 0x300
 
+XUSL_SPIN_LOCK mFchIndexIoLock;
+XUSL_SPIN_LOCK mFchPmioLock;
+
 /*----------------------------------------------------------------------------------------*/
 /**
  * FchGetAcpiPmBase
@@ -136,9 +139,11 @@ void SilFchRwPmio(uint8_t Address, uint8_t AccessWidth, uint32_t AndMask, uint32
 {
   uint64_t Result = 0;
 
+  xUslAcquireSpinLock (&mFchPmioLock);
   SilFchReadPmio (Address, AccessWidth, (uint8_t*)&Result);
   Result = (Result & AndMask) | OrMask;
   SilFchWritePmio (Address, AccessWidth, (uint8_t*)&Result);
+  xUslReleaseSpinLock (&mFchPmioLock);
 }
 
 /*----------------------------------------------------------------------------------------*/
@@ -150,10 +155,12 @@ void SilFchRwPmio(uint8_t Address, uint8_t AccessWidth, uint32_t AndMask, uint32
 /*----------------------------------------------------------------------------------------*/
 void LibFchIndirectIoRead (uint8_t AccessWidth, uint16_t IoBase, uint8_t IndexAddress, uint8_t *Value)
 {
+  xUslAcquireSpinLock (&mFchIndexIoLock);
   for (int i = 0; i < AccessWidth; i++, IndexAddress++) {
     xUSLIoWrite8 (IoBase, IndexAddress);
     Value[i] = xUSLIoRead8 (IoBase + 1);
   }
+  xUslReleaseSpinLock (&mFchIndexIoLock);
 }
 
 /*----------------------------------------------------------------------------------------*/
@@ -165,10 +172,12 @@ void LibFchIndirectIoRead (uint8_t AccessWidth, uint16_t IoBase, uint8_t IndexAd
 /*----------------------------------------------------------------------------------------*/
 void LibFchIndirectIoWrite (uint8_t AccessWidth, uint16_t IoBase, uint8_t IndexAddress, uint8_t *Value)
 {
+  xUslAcquireSpinLock (&mFchIndexIoLock);
   for (int i = 0; i < AccessWidth; i++, IndexAddress++) {
     xUSLIoWrite8 (IoBase, IndexAddress);
     xUSLIoWrite8 (IoBase + 1, Value[i]);
   }
+  xUslReleaseSpinLock (&mFchIndexIoLock);
 }
 
 /**-----------------------------------------------------------------------------
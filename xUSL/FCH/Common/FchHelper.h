@@ -9,12 +9,18 @@
 #pragma once
 
 #include <xSIM.h>
+#include <CommonLib/SpinLock.h>
 
 /**********************************************************************************************************************
  * @brief Declare common variables here
  *
  */
 
+/// Serializes the FCH legacy IO index/data pairs (C00/C01, 70/71, CD8/CDC), which are system wide
+extern XUSL_SPIN_LOCK mFchIndexIoLock;
+/// Serializes PMIO read-modify-write sequences and the PMIO 5E/5F index/data pair
+extern XUSL_SPIN_LOCK mFchPmioLock;
+
 
 /***********************************************************************************************************************
  * @brief Declare function prototypes here
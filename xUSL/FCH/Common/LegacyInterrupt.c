@@ -101,10 +101,12 @@ InitializelLegacyInterrupt (void)
   //
   // Initialize PCI IRQ routing registers for INTA#-INTH#
   //
+  xUslAcquireSpinLock (&mFchIndexIoLock);
   for (Index = 0; Index < MAX_NUMBER_PIRQS; Index++) {
     BValue = Index | FCH_IRQ_IOAPIC;    // Select IRQ routing to APIC
     xUSLIoWrite8 (FCH_IOMAP_REGC00, BValue);
     BValue = Index | BIT_32(4);
     xUSLIoWrite8 (FCH_IOMAP_REGC01, BValue);
   }
+  xUslReleaseSpinLock (&mFchIndexIoLock);
 }
@@ -302,6 +302,7 @@ typedef union {
                                                        ///< number of error reporting
                                                        ///< banks visible
 #define MCA_BANK_SIZE                       0x10       ///< Size of each MCA Bank
+#define MSR_TSC                             0x00000010ul    ///< Time Stamp Counter
 #define MSR_APIC_BAR                        0x0000001Bul
 #define MSR_SPEC_CTRL                       0x00000048ul
 #define MSR_PATCH_LEVEL                     0x0000008Bul
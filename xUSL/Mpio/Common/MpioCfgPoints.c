@@ -140,6 +140,7 @@ MpioCfgBeforeReconfig (
     }
     LocalHandle = GnbGetNextHandle (LocalHandle);
   }
+  MpioXferTable->MpioFlushPcieStraps (GnbHandle);
   MPIO_TRACEPOINT (SIL_TRACE_EXIT, "\n");
 }
 
@@ -197,6 +198,7 @@ MpioCfgAfterReconfig (
     }
     LocalHandle = GnbGetNextHandle (LocalHandle);
   }
+  MpioXferTable->MpioFlushPcieStraps (GnbHandle);
   MPIO_TRACEPOINT (SIL_TRACE_EXIT, "\n");
 }
 
@@ -299,6 +301,8 @@ MpioCfgAfterDxioInit (
   MPIOCLASS_INPUT_BLK                *SilData;
   MPIO_COMMON_2_REV_XFER_BLOCK       *MpioXferTable;
   NBIO_IP2IP_API                     *NbioIp2Ip;
+  MPIO_STRAP_WRITE_STATS             Total;
+  uint32_t                           Socket;
 
   /*
    * Get IP block data
@@ -342,6 +346,26 @@ MpioCfgAfterDxioInit (
     MpioXferTable->InitBusRangesAndAri (GnbHandle, Pcie, SilData->CfgPcieAriSupport);
     GnbHandle = GnbGetNextHandle (GnbHandle);
   }
+
+  /*
+   * Send the straps accumulated by this configuration point, once per MPIO instance
+   */
+  GnbHandle = NbioIp2Ip->NbioGetHandle (Pcie);
+  while (GnbHandle != NULL) {
+    MpioXferTable->MpioFlushPcieStraps (GnbHandle);
+    GnbHandle = GnbGetNextHandle (GnbHandle);
+  }
+
+  // Each socket counts its own strap writes, they are only summed for the report
+  memset (&Total, 0, sizeof (Total));
+  for (Socket = 0; Socket < MAX_SOCKETS_SUPPORTED; Socket++) {
+    Total.Requested += SilData->StrapWriteStats[Socket].Requested;
+    Total.Coalesced += SilData->StrapWriteStats[Socket].Coalesced;
+    Total.Issued += SilData->StrapWriteStats[Socket].Issued;
+    Total.Flushes += SilData->StrapWriteStats[Socket].Flushes;
+  }
+  MPIO_TRACEPOINT (SIL_TRACE_INFO, "Strap writes: requested %d, coalesced %d, issued %d in %d flushes\n",
+    Total.Requested, Total.Coalesced, Total.Issued, Total.Flushes);
 }
 
  /**-------------------------------------------------------------------
@@ -79,5 +79,9 @@ const MPIOCLASS_INPUT_BLK mMpioClassDflts = {
     .AmdPciePresetMask32GtAllPort       = CONFIG_GEN5_PCIE_PRESET_MASK,
     .PcieLinkAspmAllPort                = CONFIG_PCIE_LINK_ACTIVE_STATE_PWR_MGMT,
     .AmdMCTPMasterSeg                   = CONFIG_MCTP_MASTER_PCI_ADDR_SEGMENT,
-    .AmdMCTPMasterID                    = CONFIG_MCTP_MASTER_PCI_ADDR
+    .AmdMCTPMasterID                    = CONFIG_MCTP_MASTER_PCI_ADDR,
+    .PcieMpsMrrsProfile                 = CONFIG_PCIE_MPS_MRRS_PROFILE,
+    .PcieTagNegotiation                 = CONFIG_PCIE_TAG_NEGOTIATION,
+    .PcieAspmPolicy                     = CONFIG_PCIE_ASPM_POLICY,
+    .PcieAspmLatencyCritical            = CONFIG_PCIE_ASPM_LATENCY_CRITICAL_CLASSES
 };
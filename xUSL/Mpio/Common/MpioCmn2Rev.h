@@ -112,6 +112,10 @@ typedef bool (*MPIO_ISEVER_TRIED_TRAINING) (
   PCIe_ENGINE_CONFIG        *Engine
   );
 
+typedef void (*MPIO_FLUSH_PCIE_STRAPS_LIST) (
+  GNB_HANDLE                *GnbHandle
+  );
+
 // Define the Cmn2Rev xfer table containing pointers to these functions
 
 typedef struct {
@@ -133,4 +137,5 @@ typedef struct {
   PCIE_COMMON_ENGINE_CONFIGURATION  PcieCommonEngineConfiguration;
   INIT_BUS_RANGES_AND_ARI           InitBusRangesAndAri;
   MPIO_ISEVER_TRIED_TRAINING        MpioIsEverTriedTraining;
+  MPIO_FLUSH_PCIE_STRAPS_LIST       MpioFlushPcieStraps;
 } MPIO_COMMON_2_REV_XFER_BLOCK;
@@ -12,6 +12,7 @@
 #include "MpioLibLocal.h"
 #include "MpioLib.h"
 #include "MpioPcie.h"
+#include "MpioPcieHierarchy.h"
 #include <NBIO/NbioIp2Ip.h>
 
 #define MPIOCLASS_MAJOR_REV   0
@@ -193,6 +194,8 @@ NbioInitializeDxio (
   }
 
   MpioCfgAfterDxioInit (Pcie);
+  MpioPcieHierarchyTune (Pcie, SilData);
+  NbioIp2Ip->PcieP2pInit (Pcie);
   PcieConfigureHotplugPorts (Pcie);
   MpioVisibilityControl ();
 
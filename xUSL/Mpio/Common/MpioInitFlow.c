@@ -521,6 +521,7 @@ MpioEarlyInitV1 (
   uint16_t                      ResetDelay;
   SIL_STATUS                    Status;
   FCH_IP2IP_API                 *FchApi;
+  NBIO_IP2IP_API                *NbioIp2Ip;
   MPIO_COMMON_2_REV_XFER_BLOCK  *MpioXferTable;
 
   MPIO_TRACEPOINT (SIL_TRACE_ENTRY, "\n");
@@ -531,6 +532,12 @@ MpioEarlyInitV1 (
     return Status;
   }
 
+  Status = SilGetIp2IpApi (SilId_NbioClass, (void **)&NbioIp2Ip);
+  if (Status != SilPass) {
+    MPIO_TRACEPOINT (SIL_TRACE_ERROR, "NBIO API not found!\n");
+    return Status;
+  }
+
   if (SilGetCommon2RevXferTable (SilId_MpioClass, (void **)(&MpioXferTable)) != SilPass) {
     return SilNotFound;
   }
@@ -786,6 +793,11 @@ MpioEarlyInitV1 (
     } while ((GnbHandle != NULL) && (InstanceId == (GnbHandle->SocketId << 6) + GnbHandle->MP_Instance));
   }
 
+  /*
+   * Training results are final; refresh the active PCIe engine list
+   */
+  NbioIp2Ip->PcieConfigUpdateActiveEngineIndex (Pcie);
+
   MPIO_TRACEPOINT (SIL_TRACE_EXIT, "\n");
   return  SilPass;
 }
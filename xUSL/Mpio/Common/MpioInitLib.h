@@ -20,6 +20,11 @@
 
 #define MAX_NUMBER_DPCSTATUS      128
 
+#define MPIO_STRAP_LIST_ENTRIES       256   ///< Pending strap writes held per MPIO instance
+#define MPIO_STRAP_CORE_INSTANCES     10    ///< PCIe core instances addressed by the strap service
+#define MPIO_STRAP_PORTS_PER_CORE     9     ///< Ports per PCIe core tracked by the strap counters
+#define MPIO_STRAP_CORE_LEVEL         0xFF  ///< Strap is not owned by a single port
+
 #pragma pack(push, 1)
 
 /// PCIE_DPC_STATUS
@@ -39,6 +44,48 @@ typedef struct {
   PCIe_DPC_STATUS_RECORD            DpcStatusArray[MAX_NUMBER_DPCSTATUS]; ///< PCIe DPC status Array
 } PCIe_DPC_STATUS_DATA;
 
+/// PCIe Max_Payload_Size / Max_Read_Request_Size tuning profile
+typedef enum {
+  MpioPcieTuningDisabled = 0,       ///< Leave MPS and MRRS to the host
+  MpioPcieTuningBandwidth,          ///< Largest common MPS, largest MRRS
+  MpioPcieTuningLatency             ///< Largest common MPS, MRRS limited to MPS for fairness
+} MPIO_PCIE_TUNING_PROFILE;
+
+/// Latency-critical device classes for the PCIe ASPM policy
+#define MPIO_ASPM_CRITICAL_NETWORK          0x01    ///< Class 02h, network controllers
+#define MPIO_ASPM_CRITICAL_DISPLAY          0x02    ///< Class 03h, display controllers and GPUs
+#define MPIO_ASPM_CRITICAL_PROCESSOR        0x04    ///< Class 0Bh, co-processors
+#define MPIO_ASPM_CRITICAL_ACCELERATOR      0x08    ///< Class 12h, processing accelerators
+#define MPIO_ASPM_CRITICAL_STORAGE          0x10    ///< Class 01h, mass storage controllers
+
+/// Pending PCIe strap write
+typedef struct {
+  uint16_t                          StrapIndex;                     ///< Strap index as sent to MPIO firmware
+  uint8_t                           Instance;                       ///< PCIe core instance
+  uint8_t                           Port;                           ///< Owning port or MPIO_STRAP_CORE_LEVEL
+  uint32_t                          Value;                          ///< Strap value
+} MPIO_STRAP_LIST_ENTRY;
+
+/// Strap writes accumulated for one MPIO instance between config points
+typedef struct {
+  PCI_ADDR                          Address;                        ///< MPIO service address for the flush
+  uint16_t                          Count;                          ///< Number of pending entries
+  uint16_t                          Reserved;                       ///< Reserved
+  MPIO_STRAP_LIST_ENTRY             Entry[MPIO_STRAP_LIST_ENTRIES]; ///< Pending entries
+} MPIO_STRAP_LIST;
+
+/// PCIe strap write instrumentation of one socket, only updated by the core running that socket
+typedef struct {
+  uint32_t                          Requested;                      ///< Strap writes requested by callers
+  uint32_t                          Coalesced;                      ///< Requests folded into a pending write
+  uint32_t                          Issued;                         ///< Strap writes sent to MPIO firmware
+  uint32_t                          Flushes;                        ///< Non-empty strap list flushes
+  uint16_t                          CoreWrites[MPIO_STRAP_CORE_INSTANCES];
+                                                                    ///< Core-level strap writes issued
+  uint16_t                          PortWrites[MPIO_STRAP_CORE_INSTANCES][MPIO_STRAP_PORTS_PER_CORE];
+                                                                    ///< Per-port strap writes issued
+} MPIO_STRAP_WRITE_STATS;
+
 #pragma pack(pop)
 
 /**--------------------------------------------------------------------
@@ -250,6 +250,7 @@ MpioInitEngineStruct (
   Engine->Type.Port.AlwaysExpose = TopologyEntry->Port.AlwaysExpose;
   Engine->Type.Port.I2CMuxInfo = TopologyEntry->Port.I2CMuxInfo;
   Engine->Type.Port.IsBmcLocation = TopologyEntry->Port.IsBmcLocation;
+  Engine->Type.Port.TenBitTagDisable = TopologyEntry->Port.TenBitTagDisable;
 
   SrisPlatformConfig (SilData, TopologyEntry, Engine, AskEntry);
 
@@ -0,0 +1,821 @@
+/**
+ *  @file MpioPcieHierarchy.c
+ *  @brief Post-training PCIe hierarchy scan and link tuning
+ *
+ *  @details After training, every trained root port is scanned with temporary bus numbers so
+ *  that the endpoints and switches below it can be configured as one hierarchy. The bus numbers
+ *  are removed again before the host enumerates PCI.
+ */
+
+/* Copyright 2023 Advanced Micro Devices, Inc. All rights reserved.    */
+// SPDX-License-Identifier: MIT
+
+#include <string.h>
+#include <NBIO/NbioIp2Ip.h>
+#include <NBIO/NbioPcieCapability.h>
+#include "MpioInitLib.h"
+#include "MpioLibLocal.h"
+#include "MpioPcieHierarchy.h"
+
+#define PCI_INVALID_VENDOR_ID     0xFFFF
+#define PCI_CRS_VENDOR_ID         0x0001
+#define PCI_HEADER_TYPE_MASK      0x7F
+#define PCI_HEADER_TYPE_BRIDGE    0x01
+
+/// Device class to MPIO_ASPM_CRITICAL_* mapping
+typedef struct {
+  uint8_t   BaseClass;          ///< PCI base class code
+  uint8_t   CriticalMask;       ///< MPIO_ASPM_CRITICAL_* bit
+} MPIO_ASPM_CRITICAL_CLASS;
+
+static const MPIO_ASPM_CRITICAL_CLASS AspmCriticalClass[] = {
+  {0x01, MPIO_ASPM_CRITICAL_STORAGE},
+  {0x02, MPIO_ASPM_CRITICAL_NETWORK},
+  {0x03, MPIO_ASPM_CRITICAL_DISPLAY},
+  {0x0B, MPIO_ASPM_CRITICAL_PROCESSOR},
+  {0x12, MPIO_ASPM_CRITICAL_ACCELERATOR}
+};
+
+/**
+ * MpioPcieIsBridge
+ *
+ * @brief Check whether a node forwards configuration requests to a secondary bus
+ *
+ * @param[in] Node  Hierarchy node
+ *
+ * @retval true     Node is a root port, switch port or PCIe-to-PCI bridge
+ */
+static
+bool
+MpioPcieIsBridge (
+  MPIO_PCIE_NODE  *Node
+  )
+{
+  uint8_t   HeaderType;
+
+  HeaderType = xUSLPciRead8 (Node->Address.AddressValue | PCI_HEADER_TYPE_REG);
+  return ((HeaderType & PCI_HEADER_TYPE_MASK) == PCI_HEADER_TYPE_BRIDGE);
+}
+
+/**
+ * MpioPcieAddNode
+ *
+ * @brief Record a function found during the scan
+ *
+ * @param[in,out] Hierarchy   Hierarchy being built
+ * @param[in]     Address     PCI address of the function
+ * @param[in]     Parent      Index of the upstream bridge node
+ * @param[in]     NbioIp2Ip   NBIO Ip2Ip API
+ *
+ * @retval        Index of the new node, MPIO_PCIE_NO_PARENT when the node table is full
+ */
+static
+uint8_t
+MpioPcieAddNode (
+  MPIO_PCIE_HIERARCHY   *Hierarchy,
+  PCI_ADDR              Address,
+  uint8_t               Parent,
+  NBIO_IP2IP_API        *NbioIp2Ip
+  )
+{
+  MPIO_PCIE_NODE  *Node;
+  uint8_t         Index;
+
+  if (Hierarchy->NodeCount >= MPIO_PCIE_HIERARCHY_MAX_NODES) {
+    Hierarchy->Truncated = true;
+    return MPIO_PCIE_NO_PARENT;
+  }
+
+  Index = Hierarchy->NodeCount++;
+  Node = &Hierarchy->Node[Index];
+  memset (Node, 0, sizeof (MPIO_PCIE_NODE));
+  Node->Address = Address;
+  Node->Parent = Parent;
+  Node->ClassCode = xUSLPciRead32 (Address.AddressValue | PCI_REVISION_ID_REG) >> 8;
+  Node->PcieCapPtr = NbioIp2Ip->PcieFindCapability (Address.AddressValue, PCIE_CAP_ID_EXPRESS);
+  if (Node->PcieCapPtr != 0) {
+    Node->PortType = (uint8_t) ((xUSLPciRead16 (Address.AddressValue | (Node->PcieCapPtr + PCIE_CAP_REG)) &
+                                 PCIE_CAP_PORT_TYPE_MASK) >> PCIE_CAP_PORT_TYPE_OFFSET);
+    Node->DeviceCap = xUSLPciRead32 (Address.AddressValue | (Node->PcieCapPtr + PCIE_DEVICE_CAP_REG));
+    Node->LinkCap = xUSLPciRead32 (Address.AddressValue | (Node->PcieCapPtr + PCIE_LINK_CAP_REG));
+    Node->DeviceCap2 = xUSLPciRead32 (Address.AddressValue | (Node->PcieCapPtr + PCIE_DEVICE_CAP2_REG));
+  }
+  return Index;
+}
+
+/**
+ * MpioPcieScanBridge
+ *
+ * @brief Give a bridge a temporary secondary bus and scan the functions behind it
+ *
+ * @details Bridges are scanned depth first so that each subordinate bus number can be
+ *          narrowed to the buses actually used below it before its siblings are numbered.
+ *
+ * @param[in,out] Hierarchy   Hierarchy being built
+ * @param[in]     BridgeIndex Index of the bridge node
+ * @param[in]     Depth       Bridge level below the root port
+ * @param[in]     NbioIp2Ip   NBIO Ip2Ip API
+ */
+static
+void
+MpioPcieScanBridge (
+  MPIO_PCIE_HIERARCHY   *Hierarchy,
+  uint8_t               BridgeIndex,
+  uint32_t              Depth,
+  NBIO_IP2IP_API        *NbioIp2Ip
+  )
+{
+  MPIO_PCIE_NODE  *Bridge;
+  PCI_ADDR        Address;
+  uint32_t        Device;
+  uint32_t        MaxDevice;
+  uint32_t        Function;
+  uint32_t        MaxFunction;
+  uint16_t        VendorId;
+  uint8_t         Secondary;
+  uint8_t         Child;
+
+  Bridge = &Hierarchy->Node[BridgeIndex];
+  // NextBus is wider than a bus number so it cannot wrap back to bus 0
+  if ((Depth > MPIO_PCIE_HIERARCHY_MAX_DEPTH) || (Hierarchy->NextBus > Hierarchy->BusLimit) ||
+      (Hierarchy->NextBus > 0xFF)) {
+    Hierarchy->Truncated = true;
+    return;
+  }
+
+  Secondary = (uint8_t) Hierarchy->NextBus++;
+  Bridge->BusNumbers = xUSLPciRead32 (Bridge->Address.AddressValue | PCI_BRIDGE_BUS_NUMBER_REG);
+  Bridge->SecondaryBus = Secondary;
+  xUSLPciRMW (Bridge->Address.AddressValue | PCI_BRIDGE_BUS_NUMBER_REG, AccessWidth32, 0xFF000000,
+    (uint32_t) Bridge->Address.Address.Bus | ((uint32_t) Secondary << 8) | ((uint32_t) Hierarchy->BusLimit << 16));
+  NbioIp2Ip->PcieCapabilityInvalidateBus (MAKE_SBDFO (Bridge->Address.Address.Segment, Secondary, 0, 0, 0));
+
+  // Only device 0 can sit below a root port or switch downstream port
+  MaxDevice = ((Bridge->PortType == PCIE_PORT_TYPE_ROOT_PORT) ||
+               (Bridge->PortType == PCIE_PORT_TYPE_DOWNSTREAM_PORT)) ? 1 : 32;
+
+  for (Device = 0; Device < MaxDevice; Device++) {
+    MaxFunction = 1;
+    for (Function = 0; Function < MaxFunction; Function++) {
+      Address.AddressValue = MAKE_SBDFO (Bridge->Address.Address.Segment, Secondary, Device, Function, 0);
+      VendorId = xUSLPciRead16 (Address.AddressValue);
+      if ((VendorId == PCI_INVALID_VENDOR_ID) || (VendorId == PCI_CRS_VENDOR_ID)) {
+        continue;
+      }
+      if ((Function == 0) &&
+          ((xUSLPciRead8 (Address.AddressValue | PCI_HEADER_TYPE_REG) & MULTI_FUNC_DEVICE_MASK) != 0)) {
+        MaxFunction = 8;
+      }
+      Child = MpioPcieAddNode (Hierarchy, Address, BridgeIndex, NbioIp2Ip);
+      if (Child == MPIO_PCIE_NO_PARENT) {
+        break;
+      }
+      if (MpioPcieIsBridge (&Hierarchy->Node[Child])) {
+        MpioPcieScanBridge (Hierarchy, Child, Depth + 1, NbioIp2Ip);
+      }
+    }
+  }
+
+  // Narrow the subordinate bus to what was used below this bridge
+  xUSLPciRMW (Bridge->Address.AddressValue | PCI_BRIDGE_BUS_NUMBER_REG, AccessWidth32, 0xFF00FFFF,
+    ((uint32_t) (Hierarchy->NextBus - 1) & 0xFF) << 16);
+}
+
+/**
+ * MpioPcieHierarchyScan
+ *
+ * @brief Scan the functions below a trained root port
+ *
+ * @details Temporary bus numbers are taken from the buses of the root complex above the
+ *          root port bus. They stay programmed until MpioPcieHierarchyRelease is called.
+ *
+ * @param[in]  Engine      Root port engine
+ * @param[in]  GnbHandle   Root complex of the root port
+ * @param[out] Hierarchy   Functions found below the root port
+ *
+ * @retval SilPass         Hierarchy is valid
+ * @retval SilNotFound     NBIO API is not available
+ */
+SIL_STATUS
+MpioPcieHierarchyScan (
+  PCIe_ENGINE_CONFIG        *Engine,
+  GNB_HANDLE                *GnbHandle,
+  MPIO_PCIE_HIERARCHY       *Hierarchy
+  )
+{
+  NBIO_IP2IP_API  *NbioIp2Ip;
+
+  if (SilGetIp2IpApi (SilId_NbioClass, (void **)(&NbioIp2Ip)) != SilPass) {
+    MPIO_TRACEPOINT (SIL_TRACE_ERROR, " NBIO API is not found.\n");
+    return SilNotFound;
+  }
+
+  Hierarchy->Engine = Engine;
+  Hierarchy->GnbHandle = GnbHandle;
+  Hierarchy->NodeCount = 0;
+  Hierarchy->Truncated = false;
+  Hierarchy->NextBus = (uint16_t) (Engine->Type.Port.Address.Address.Bus + 1);
+  Hierarchy->BusLimit = (uint8_t) GnbHandle->BusNumberLimit;
+
+  MpioPcieAddNode (Hierarchy, Engine->Type.Port.Address, MPIO_PCIE_NO_PARENT, NbioIp2Ip);
+  MpioPcieScanBridge (Hierarchy, 0, 0, NbioIp2Ip);
+
+  if (Hierarchy->Truncated) {
+    MPIO_TRACEPOINT (SIL_TRACE_INFO, "  Port %x hierarchy truncated at %d functions\n",
+      Engine->Type.Port.Address.AddressValue, Hierarchy->NodeCount);
+  }
+  return SilPass;
+}
+
+/**
+ * MpioPcieHierarchyRelease
+ *
+ * @brief Restore the bus number registers changed by MpioPcieHierarchyScan
+ *
+ * @param[in] Hierarchy   Hierarchy returned by MpioPcieHierarchyScan
+ */
+void
+MpioPcieHierarchyRelease (
+  MPIO_PCIE_HIERARCHY       *Hierarchy
+  )
+{
+  MPIO_PCIE_NODE  *Node;
+  NBIO_IP2IP_API  *NbioIp2Ip;
+  uint32_t        Index;
+
+  if (SilGetIp2IpApi (SilId_NbioClass, (void **)(&NbioIp2Ip)) != SilPass) {
+    NbioIp2Ip = NULL;
+  }
+
+  // Deepest bridges were numbered last; undo in reverse order
+  for (Index = Hierarchy->NodeCount; Index > 0; Index--) {
+    Node = &Hierarchy->Node[Index - 1];
+    if (Node->SecondaryBus == 0) {
+      continue;
+    }
+    if (NbioIp2Ip != NULL) {
+      NbioIp2Ip->PcieCapabilityInvalidateBus (MAKE_SBDFO (Node->Address.Address.Segment, Node->SecondaryBus, 0, 0, 0));
+    }
+    xUSLPciWrite32 (Node->Address.AddressValue | PCI_BRIDGE_BUS_NUMBER_REG, Node->BusNumbers);
+    Node->SecondaryBus = 0;
+  }
+}
+
+/**
+ * MpioPcieConfigureMpsMrrs
+ *
+ * @brief Program the largest Max_Payload_Size safe for the whole hierarchy and the MRRS policy
+ *
+ * @details Every function must use the same MPS, so the smallest MPS supported anywhere below
+ *          the root port wins. The bandwidth profile allows the largest read requests; the
+ *          latency profile limits read requests to one payload so a single requester cannot
+ *          hold the link with long completions. Functions past a truncated scan keep the 128B
+ *          reset default, so a truncated hierarchy is clamped to 128B.
+ *
+ * @param[in] Hierarchy   Scanned hierarchy
+ * @param[in] Profile     MPIO_PCIE_TUNING_PROFILE
+ */
+static
+void
+MpioPcieConfigureMpsMrrs (
+  MPIO_PCIE_HIERARCHY       *Hierarchy,
+  uint8_t                   Profile
+  )
+{
+  MPIO_PCIE_NODE  *Node;
+  uint32_t        Index;
+  uint32_t        Mps;
+  uint32_t        Mrrs;
+  uint16_t        DeviceControl;
+  PCI_ADDR        ControlAddress;
+
+  Mps = PCIE_MAX_PAYLOAD_4096;
+  if (Hierarchy->Engine->Type.Port.MaxPayloadSize < Mps) {
+    Mps = Hierarchy->Engine->Type.Port.MaxPayloadSize;
+  }
+  for (Index = 0; Index < Hierarchy->NodeCount; Index++) {
+    Node = &Hierarchy->Node[Index];
+    if ((Node->PcieCapPtr != 0) && ((Node->DeviceCap & PCIE_DEVICE_CAP_MPS_MASK) < Mps)) {
+      Mps = Node->DeviceCap & PCIE_DEVICE_CAP_MPS_MASK;
+    }
+  }
+  if (Hierarchy->Truncated) {
+    Mps = PCIE_MAX_PAYLOAD_128;
+  }
+  Mrrs = (Profile == MpioPcieTuningLatency) ? Mps : PCIE_MAX_PAYLOAD_4096;
+
+  for (Index = 0; Index < Hierarchy->NodeCount; Index++) {
+    Node = &Hierarchy->Node[Index];
+    if (Node->PcieCapPtr == 0) {
+      continue;
+    }
+    ControlAddress.AddressValue = Node->Address.AddressValue | (Node->PcieCapPtr + PCIE_DEVICE_CTRL_REG);
+    DeviceControl = xUSLPciRead16 (ControlAddress.AddressValue);
+    DeviceControl &= (uint16_t) ~(PCIE_DEVICE_CTRL_MPS_MASK | PCIE_DEVICE_CTRL_MRRS_MASK);
+    DeviceControl |= (uint16_t) ((Mps << PCIE_DEVICE_CTRL_MPS_OFFSET) | (Mrrs << PCIE_DEVICE_CTRL_MRRS_OFFSET));
+    xUSLPciWrite16 (ControlAddress.AddressValue, DeviceControl);
+  }
+
+  MPIO_TRACEPOINT (SIL_TRACE_INFO, "  Port %x: %d functions, MPS %d bytes, MRRS %d bytes\n",
+    Hierarchy->Engine->Type.Port.Address.AddressValue, Hierarchy->NodeCount, 128 << Mps, 128 << Mrrs);
+}
+
+/**
+ * MpioPcieTenBitCompleterPath
+ *
+ * @brief Check whether every bridge between a function and the root complex completes 10-bit tags
+ *
+ * @param[in] Hierarchy   Scanned hierarchy
+ * @param[in] Index       Index of the requesting function
+ *
+ * @retval true           Root port and all switch ports on the path are 10-bit tag completers
+ */
+static
+bool
+MpioPcieTenBitCompleterPath (
+  MPIO_PCIE_HIERARCHY       *Hierarchy,
+  uint8_t                   Index
+  )
+{
+  MPIO_PCIE_NODE  *Node;
+
+  Index = Hierarchy->Node[Index].Parent;
+  while (Index != MPIO_PCIE_NO_PARENT) {
+    Node = &Hierarchy->Node[Index];
+    if ((Node->PcieCapPtr == 0) || ((Node->DeviceCap2 & PCIE_DEVICE_CAP2_10BIT_COMPLETER) == 0)) {
+      return false;
+    }
+    Index = Node->Parent;
+  }
+  return true;
+}
+
+/**
+ * MpioPcieConfigureTags
+ *
+ * @brief Enable extended and 10-bit tags where both ends of each request path support them
+ *
+ * @details Extended 8-bit tags are enabled on every function that supports them. A function
+ *          below the root port may issue 10-bit tags only when the root port and every switch
+ *          port on its path complete them. The root port may issue 10-bit tags only when every
+ *          function below it completes them, which requires the whole hierarchy to be known.
+ *          A port opted out in the platform descriptor keeps 10-bit tags disabled throughout.
+ *
+ * @param[in] Hierarchy   Scanned hierarchy
+ */
+static
+void
+MpioPcieConfigureTags (
+  MPIO_PCIE_HIERARCHY       *Hierarchy
+  )
+{
+  PCIe_ENGINE_CONFIG  *Engine;
+  MPIO_PCIE_NODE      *Node;
+  uint32_t            Index;
+  uint32_t            Address;
+  bool                RootRequester;
+  bool                Requester;
+
+  Engine = Hierarchy->Engine;
+  Engine->Type.Port.TagNegotiation = PCIE_TAG_NEGOTIATION_DONE;
+  Engine->Type.Port.TenBitTagRequesters = 0;
+  if (Hierarchy->Truncated) {
+    Engine->Type.Port.TagNegotiation |= PCIE_TAG_NEGOTIATION_TRUNCATED;
+  }
+  if (Engine->Type.Port.TenBitTagDisable != 0) {
+    Engine->Type.Port.TagNegotiation |= PCIE_TAG_NEGOTIATION_OPT_OUT;
+  }
+
+  RootRequester = (Engine->Type.Port.TenBitTagDisable == 0) && !Hierarchy->Truncated;
+  for (Index = 1; Index < Hierarchy->NodeCount; Index++) {
+    Node = &Hierarchy->Node[Index];
+    if ((Node->PcieCapPtr == 0) || ((Node->DeviceCap2 & PCIE_DEVICE_CAP2_10BIT_COMPLETER) == 0)) {
+      RootRequester = false;
+      break;
+    }
+  }
+
+  for (Index = 0; Index < Hierarchy->NodeCount; Index++) {
+    Node = &Hierarchy->Node[Index];
+    if (Node->PcieCapPtr == 0) {
+      continue;
+    }
+
+    Address = Node->Address.AddressValue | (Node->PcieCapPtr + PCIE_DEVICE_CTRL_REG);
+    if ((Node->DeviceCap & PCIE_DEVICE_CAP_EXTENDED_TAG) != 0) {
+      xUSLPciRMW (Address, AccessWidth16, 0xFFFFFFFF, PCIE_DEVICE_CTRL_EXTENDED_TAG);
+      if (Index == 0) {
+        Engine->Type.Port.TagNegotiation |= PCIE_TAG_NEGOTIATION_EXTENDED;
+      }
+    }
+
+    if (Index == 0) {
+      Requester = RootRequester;
+    } else {
+      Requester = (Engine->Type.Port.TenBitTagDisable == 0) &&
+                  MpioPcieTenBitCompleterPath (Hierarchy, (uint8_t) Index);
+    }
+    Requester = Requester && ((Node->DeviceCap2 & PCIE_DEVICE_CAP2_10BIT_REQUESTER) != 0);
+
+    Address = Node->Address.AddressValue | (Node->PcieCapPtr + PCIE_DEVICE_CTRL2_REG);
+    xUSLPciRMW (Address, AccessWidth16, (uint32_t) ~PCIE_DEVICE_CTRL2_10BIT_REQUESTER,
+      Requester ? PCIE_DEVICE_CTRL2_10BIT_REQUESTER : 0);
+    if (Requester) {
+      if (Index == 0) {
+        Engine->Type.Port.TagNegotiation |= PCIE_TAG_NEGOTIATION_10BIT_ROOT;
+      } else {
+        Engine->Type.Port.TagNegotiation |= PCIE_TAG_NEGOTIATION_10BIT_ENDPOINT;
+        Engine->Type.Port.TenBitTagRequesters++;
+      }
+    }
+  }
+
+  MPIO_TRACEPOINT (SIL_TRACE_INFO, "  Port %x: tag negotiation 0x%x, %d 10-bit requesters below\n",
+    Engine->Type.Port.Address.AddressValue, Engine->Type.Port.TagNegotiation,
+    Engine->Type.Port.TenBitTagRequesters);
+}
+
+/**
+ * MpioPcieOwnsLink
+ *
+ * @brief Check whether a node is the upstream end of a link
+ *
+ * @param[in] Node  Hierarchy node
+ *
+ * @retval true     Node is a root port or switch downstream port
+ */
+static
+bool
+MpioPcieOwnsLink (
+  MPIO_PCIE_NODE  *Node
+  )
+{
+  return (Node->PcieCapPtr != 0) &&
+         ((Node->PortType == PCIE_PORT_TYPE_ROOT_PORT) || (Node->PortType == PCIE_PORT_TYPE_DOWNSTREAM_PORT));
+}
+
+/**
+ * MpioPcieLinkAspmSupport
+ *
+ * @brief ASPM states supported by one end of a link
+ *
+ * @param[in] Node  Hierarchy node
+ *
+ * @retval          PCIE_ASPM_TYPE supported by the node
+ */
+static
+uint8_t
+MpioPcieLinkAspmSupport (
+  MPIO_PCIE_NODE  *Node
+  )
+{
+  if (Node->PcieCapPtr == 0) {
+    return AspmDisabled;
+  }
+  return (uint8_t) ((Node->LinkCap & PCIE_LINK_CAP_ASPM_MASK) >> PCIE_LINK_CAP_ASPM_OFFSET);
+}
+
+/**
+ * MpioPcieLinkExitLatency
+ *
+ * @brief Worst L0s and L1 exit latency of a link
+ *
+ * @param[in]  Upstream    Root port or downstream port of the link
+ * @param[in]  Downstream  Function below the link
+ * @param[out] Latency     L0s exit latency in 64 ns units, L1 exit latency in us
+ */
+static
+void
+MpioPcieLinkExitLatency (
+  MPIO_PCIE_NODE            *Upstream,
+  MPIO_PCIE_NODE            *Downstream,
+  PCIe_ASPM_LATENCY_INFO    *Latency
+  )
+{
+  uint32_t  L0s;
+  uint32_t  L1;
+
+  L0s = (Upstream->LinkCap & PCIE_LINK_CAP_L0S_EXIT_MASK) >> PCIE_LINK_CAP_L0S_EXIT_OFFSET;
+  if (((Downstream->LinkCap & PCIE_LINK_CAP_L0S_EXIT_MASK) >> PCIE_LINK_CAP_L0S_EXIT_OFFSET) > L0s) {
+    L0s = (Downstream->LinkCap & PCIE_LINK_CAP_L0S_EXIT_MASK) >> PCIE_LINK_CAP_L0S_EXIT_OFFSET;
+  }
+  L1 = (Upstream->LinkCap & PCIE_LINK_CAP_L1_EXIT_MASK) >> PCIE_LINK_CAP_L1_EXIT_OFFSET;
+  if (((Downstream->LinkCap & PCIE_LINK_CAP_L1_EXIT_MASK) >> PCIE_LINK_CAP_L1_EXIT_OFFSET) > L1) {
+    L1 = (Downstream->LinkCap & PCIE_LINK_CAP_L1_EXIT_MASK) >> PCIE_LINK_CAP_L1_EXIT_OFFSET;
+  }
+
+  // Each encoding is the upper bound of a doubling range; the largest means "more than"
+  Latency->MaxL0sExitLatency = (uint8_t) (1 << L0s);
+  Latency->MaxL1ExitLatency = (uint8_t) (1 << L1);
+}
+
+/**
+ * MpioPcieAcceptableLatency
+ *
+ * @brief L0s and L1 exit latency an endpoint can tolerate
+ *
+ * @param[in]  Node      Endpoint
+ * @param[out] Latency   L0s latency in 64 ns units, L1 latency in us, 0xFF for no limit
+ */
+static
+void
+MpioPcieAcceptableLatency (
+  MPIO_PCIE_NODE            *Node,
+  PCIe_ASPM_LATENCY_INFO    *Latency
+  )
+{
+  uint32_t  L0s;
+  uint32_t  L1;
+
+  L0s = (Node->DeviceCap & PCIE_DEVICE_CAP_L0S_LATENCY_MASK) >> PCIE_DEVICE_CAP_L0S_LATENCY_OFFSET;
+  L1 = (Node->DeviceCap & PCIE_DEVICE_CAP_L1_LATENCY_MASK) >> PCIE_DEVICE_CAP_L1_LATENCY_OFFSET;
+  Latency->MaxL0sExitLatency = (L0s == PCIE_DEVICE_CAP_NO_LATENCY_LIMIT) ? 0xFF : (uint8_t) (1 << L0s);
+  Latency->MaxL1ExitLatency = (L1 == PCIE_DEVICE_CAP_NO_LATENCY_LIMIT) ? 0xFF : (uint8_t) (1 << L1);
+}
+
+/**
+ * MpioPcieIsAspmCritical
+ *
+ * @brief Check whether a function belongs to a latency-critical device class
+ *
+ * @param[in] Node          Hierarchy node
+ * @param[in] CriticalMask  MPIO_ASPM_CRITICAL_* classes selected by the platform
+ *
+ * @retval true             ASPM must stay disabled on the path to this function
+ */
+static
+bool
+MpioPcieIsAspmCritical (
+  MPIO_PCIE_NODE  *Node,
+  uint8_t         CriticalMask
+  )
+{
+  uint32_t  Index;
+
+  for (Index = 0; Index < (sizeof (AspmCriticalClass) / sizeof (AspmCriticalClass[0])); Index++) {
+    if (AspmCriticalClass[Index].BaseClass == (uint8_t) (Node->ClassCode >> 16)) {
+      return ((AspmCriticalClass[Index].CriticalMask & CriticalMask) != 0);
+    }
+  }
+  return false;
+}
+
+/**
+ * MpioPcieLinkAspmTarget
+ *
+ * @brief ASPM Control value of a function given the per-link policy
+ *
+ * @param[in]  Hierarchy  Scanned hierarchy
+ * @param[in]  Index      Index of the function
+ * @param[in]  LinkAspm   Policy per link, indexed by the upstream end of the link
+ * @param[in]  HasLink    Link owner has a device below it
+ * @param[out] Target     PCIE_ASPM_TYPE to program
+ *
+ * @retval true           Function is an end of a link in the hierarchy
+ */
+static
+bool
+MpioPcieLinkAspmTarget (
+  MPIO_PCIE_HIERARCHY       *Hierarchy,
+  uint32_t                  Index,
+  uint8_t                   *LinkAspm,
+  bool                      *HasLink,
+  uint8_t                   *Target
+  )
+{
+  MPIO_PCIE_NODE  *Node;
+
+  Node = &Hierarchy->Node[Index];
+  if (Node->PcieCapPtr == 0) {
+    return false;
+  }
+  if (MpioPcieOwnsLink (Node)) {
+    *Target = LinkAspm[Index];
+    return HasLink[Index];
+  }
+  if ((Node->Parent != MPIO_PCIE_NO_PARENT) && MpioPcieOwnsLink (&Hierarchy->Node[Node->Parent])) {
+    *Target = LinkAspm[Node->Parent];
+    return true;
+  }
+  return false;
+}
+
+/**
+ * MpioPcieConfigureAspm
+ *
+ * @brief Program ASPM on every link so that no endpoint sees more exit latency than it tolerates
+ *
+ * @details The port's LinkAspm setting is the upper bound for every link below the port. Each
+ *          endpoint then removes L0s from links whose L0s exit latency exceeds its acceptable
+ *          L0s latency, and L1 from links whose L1 exit latency plus 1 us for each link closer
+ *          to the endpoint exceeds its acceptable L1 latency. Endpoints of a latency-critical
+ *          class remove both states from every link up to the root port.
+ *
+ *          ASPM is disabled downstream end first and enabled upstream end first. ASPM L1 PM
+ *          substates are disabled together with L1; they are never enabled here.
+ *
+ *          A truncated hierarchy is left untouched, since the latency tolerance of the
+ *          functions past the truncation is unknown.
+ *
+ * @param[in] Hierarchy     Scanned hierarchy
+ * @param[in] CriticalMask  MPIO_ASPM_CRITICAL_* classes that never use L0s or L1
+ * @param[in] NbioIp2Ip     NBIO Ip2Ip API
+ */
+static
+void
+MpioPcieConfigureAspm (
+  MPIO_PCIE_HIERARCHY       *Hierarchy,
+  uint8_t                   CriticalMask,
+  NBIO_IP2IP_API            *NbioIp2Ip
+  )
+{
+  uint8_t                 LinkAspm[MPIO_PCIE_HIERARCHY_MAX_NODES];
+  bool                    HasLink[MPIO_PCIE_HIERARCHY_MAX_NODES];
+  PCIe_ASPM_LATENCY_INFO  Acceptable;
+  PCIe_ASPM_LATENCY_INFO  Exit;
+  MPIO_PCIE_NODE          *Node;
+  uint32_t                Index;
+  uint32_t                Address;
+  uint32_t                LinksBelow;
+  uint32_t                CriticalCount;
+  uint16_t                L1ssPtr;
+  uint8_t                 Child;
+  uint8_t                 Parent;
+  uint8_t                 Requested;
+  uint8_t                 Current;
+  uint8_t                 Target;
+  bool                    Critical;
+
+  if (Hierarchy->Truncated) {
+    MPIO_TRACEPOINT (SIL_TRACE_INFO, "  Port %x: hierarchy truncated, ASPM left unchanged\n",
+      Hierarchy->Engine->Type.Port.Address.AddressValue);
+    return;
+  }
+
+  Requested = Hierarchy->Engine->Type.Port.PortData.LinkAspm & PCIE_LINK_CTRL_ASPM_MASK;
+  for (Index = 0; Index < Hierarchy->NodeCount; Index++) {
+    Node = &Hierarchy->Node[Index];
+    HasLink[Index] = false;
+    LinkAspm[Index] = MpioPcieOwnsLink (Node) ? (Requested & MpioPcieLinkAspmSupport (Node)) : AspmDisabled;
+    if ((Node->Parent != MPIO_PCIE_NO_PARENT) && MpioPcieOwnsLink (&Hierarchy->Node[Node->Parent])) {
+      LinkAspm[Node->Parent] &= MpioPcieLinkAspmSupport (Node);
+      HasLink[Node->Parent] = true;
+    }
+  }
+
+  CriticalCount = 0;
+  for (Index = 1; Index < Hierarchy->NodeCount; Index++) {
+    Node = &Hierarchy->Node[Index];
+    if ((Node->PcieCapPtr == 0) ||
+        ((Node->PortType != PCIE_PORT_TYPE_ENDPOINT) && (Node->PortType != PCIE_PORT_TYPE_LEGACY_ENDPOINT))) {
+      continue;
+    }
+    Critical = MpioPcieIsAspmCritical (Node, CriticalMask);
+    if (Critical) {
+      CriticalCount++;
+    }
+    MpioPcieAcceptableLatency (Node, &Acceptable);
+
+    LinksBelow = 0;
+    Child = (uint8_t) Index;
+    Parent = Node->Parent;
+    while (Parent != MPIO_PCIE_NO_PARENT) {
+      if (MpioPcieOwnsLink (&Hierarchy->Node[Parent])) {
+        if (Critical) {
+          LinkAspm[Parent] = AspmDisabled;
+        } else {
+          MpioPcieLinkExitLatency (&Hierarchy->Node[Parent], &Hierarchy->Node[Child], &Exit);
+          if (Exit.MaxL0sExitLatency > Acceptable.MaxL0sExitLatency) {
+            LinkAspm[Parent] &= (uint8_t) ~AspmL0s;
+          }
+          if (((uint32_t) Exit.MaxL1ExitLatency + LinksBelow) > Acceptable.MaxL1ExitLatency) {
+            LinkAspm[Parent] &= (uint8_t) ~AspmL1;
+          }
+        }
+        LinksBelow++;
+      }
+      Child = Parent;
+      Parent = Hierarchy->Node[Parent].Parent;
+    }
+  }
+
+  // Disable first, downstream end of each link before the upstream end
+  for (Index = Hierarchy->NodeCount; Index > 0; Index--) {
+    Node = &Hierarchy->Node[Index - 1];
+    if (!MpioPcieLinkAspmTarget (Hierarchy, Index - 1, LinkAspm, HasLink, &Target)) {
+      continue;
+    }
+    Address = Node->Address.AddressValue | (Node->PcieCapPtr + PCIE_LINK_CTRL_REG);
+    Current = xUSLPciRead16 (Address) & PCIE_LINK_CTRL_ASPM_MASK;
+    if ((Current & ~Target) == 0) {
+      continue;
+    }
+    if ((Target & AspmL1) == 0) {
+      L1ssPtr = NbioIp2Ip->PcieFindExtendedCapability (Node->Address.AddressValue, PCIE_EXT_CAP_ID_L1SS);
+      if (L1ssPtr != 0) {
+        xUSLPciRMW (Node->Address.AddressValue | (L1ssPtr + PCIE_L1SS_CTRL1_REG), AccessWidth32,
+          (uint32_t) ~PCIE_L1SS_CTRL1_ASPM_MASK, 0);
+      }
+    }
+    xUSLPciRMW (Address, AccessWidth16, (uint32_t) ~PCIE_LINK_CTRL_ASPM_MASK, Current & Target);
+  }
+
+  // Then enable, upstream end of each link before the downstream end
+  for (Index = 0; Index < Hierarchy->NodeCount; Index++) {
+    Node = &Hierarchy->Node[Index];
+    if (!MpioPcieLinkAspmTarget (Hierarchy, Index, LinkAspm, HasLink, &Target)) {
+      continue;
+    }
+    Address = Node->Address.AddressValue | (Node->PcieCapPtr + PCIE_LINK_CTRL_REG);
+    xUSLPciRMW (Address, AccessWidth16, (uint32_t) ~PCIE_LINK_CTRL_ASPM_MASK, Target);
+  }
+
+  MPIO_TRACEPOINT (SIL_TRACE_INFO, "  Port %x: ASPM 0x%x on root link, %d latency-critical endpoints\n",
+    Hierarchy->Engine->Type.Port.Address.AddressValue, LinkAspm[0], CriticalCount);
+}
+
+/**
+ * MpioPcieHierarchyTuneCallback
+ *
+ * @brief Per-engine hierarchy tuning
+ *
+ * @param[in] Engine    Engine configuration info
+ * @param[in] Buffer    MPIO input block
+ * @param[in] Pcie      PCIe configuration info
+ */
+static
+void
+MpioPcieHierarchyTuneCallback (
+  PCIe_ENGINE_CONFIG        *Engine,
+  void                      *Buffer,
+  PCIe_PLATFORM_CONFIG      *Pcie
+  )
+{
+  MPIOCLASS_INPUT_BLK       *SilData;
+  MPIO_PCIE_HIERARCHY       Hierarchy;
+  GNB_HANDLE                *GnbHandle;
+  NBIO_IP2IP_API            *NbioIp2Ip;
+
+  SilData = (MPIOCLASS_INPUT_BLK *) Buffer;
+
+  if (SilGetIp2IpApi (SilId_NbioClass, (void **)(&NbioIp2Ip)) != SilPass) {
+    MPIO_TRACEPOINT (SIL_TRACE_ERROR, " NBIO API is not found.\n");
+    return;
+  }
+  if (!NbioIp2Ip->PcieConfigCheckPortStatus (Engine, INIT_STATUS_PCIE_TRAINING_SUCCESS)) {
+    return;
+  }
+  GnbHandle = (GNB_HANDLE *) NbioIp2Ip->PcieConfigGetParent (DESCRIPTOR_SILICON, &(Engine->Header));
+  if (GnbHandle == NULL) {
+    return;
+  }
+
+  if (MpioPcieHierarchyScan (Engine, GnbHandle, &Hierarchy) != SilPass) {
+    return;
+  }
+  if (SilData->PcieMpsMrrsProfile != MpioPcieTuningDisabled) {
+    MpioPcieConfigureMpsMrrs (&Hierarchy, SilData->PcieMpsMrrsProfile);
+  }
+  if (SilData->PcieTagNegotiation) {
+    MpioPcieConfigureTags (&Hierarchy);
+  }
+  if (SilData->PcieAspmPolicy) {
+    MpioPcieConfigureAspm (&Hierarchy, SilData->PcieAspmLatencyCritical, NbioIp2Ip);
+  }
+  MpioPcieHierarchyRelease (&Hierarchy);
+}
+
+/**
+ * MpioPcieHierarchyTune
+ *
+ * @brief Post-training configuration of every trained PCIe hierarchy
+ *
+ * @param[in] Pcie      PCIe configuration info
+ * @param[in] SilData   MPIO input block
+ */
+void
+MpioPcieHierarchyTune (
+  PCIe_PLATFORM_CONFIG      *Pcie,
+  MPIOCLASS_INPUT_BLK       *SilData
+  )
+{
+  NBIO_IP2IP_API  *NbioIp2Ip;
+
+  if ((SilData->PcieMpsMrrsProfile == MpioPcieTuningDisabled) && !SilData->PcieTagNegotiation &&
+      !SilData->PcieAspmPolicy) {
+    return;
+  }
+  if (SilGetIp2IpApi (SilId_NbioClass, (void **)(&NbioIp2Ip)) != SilPass) {
+    MPIO_TRACEPOINT (SIL_TRACE_ERROR, " NBIO API is not found.\n");
+    return;
+  }
+
+  MPIO_TRACEPOINT (SIL_TRACE_ENTRY, "\n");
+  NbioIp2Ip->PcieConfigRunProcForAllEngines (
+               DESCRIPTOR_ALLOCATED | DESCRIPTOR_PCIE_ENGINE,
+               MpioPcieHierarchyTuneCallback,
+               SilData,
+               Pcie
+               );
+  MPIO_TRACEPOINT (SIL_TRACE_EXIT, "\n");
+}
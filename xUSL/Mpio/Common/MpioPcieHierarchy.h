@@ -0,0 +1,126 @@
+/**
+ *  @file MpioPcieHierarchy.h
+ *  @brief Post-training PCIe hierarchy scan and link tuning
+ */
+
+/* Copyright 2023 Advanced Micro Devices, Inc. All rights reserved.    */
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <xSIM.h>
+#include "MpioClass-api.h"
+
+#define MPIO_PCIE_HIERARCHY_MAX_NODES       32    ///< Functions tracked below one root port
+#define MPIO_PCIE_HIERARCHY_MAX_DEPTH       4     ///< Bridge levels scanned below the root port
+#define MPIO_PCIE_NO_PARENT                 0xFF  ///< Parent index of the root port node
+
+// Type 1 header
+#define PCI_BRIDGE_BUS_NUMBER_REG           0x18
+
+// PCI Express capability structure offsets
+#define PCIE_CAP_REG                        0x02
+#define PCIE_DEVICE_CAP_REG                 0x04
+#define PCIE_DEVICE_CTRL_REG                0x08
+#define PCIE_LINK_CAP_REG                   0x0C
+#define PCIE_LINK_CTRL_REG                  0x10
+#define PCIE_DEVICE_CAP2_REG                0x24
+#define PCIE_DEVICE_CTRL2_REG               0x28
+
+// PCI Express capabilities register
+#define PCIE_CAP_PORT_TYPE_OFFSET           4
+#define PCIE_CAP_PORT_TYPE_MASK             0x000000F0
+
+// Device/Port type
+#define PCIE_PORT_TYPE_ENDPOINT             0x0
+#define PCIE_PORT_TYPE_LEGACY_ENDPOINT      0x1
+#define PCIE_PORT_TYPE_ROOT_PORT            0x4
+#define PCIE_PORT_TYPE_UPSTREAM_PORT        0x5
+#define PCIE_PORT_TYPE_DOWNSTREAM_PORT      0x6
+#define PCIE_PORT_TYPE_PCIE_TO_PCI_BRIDGE   0x7
+
+// Device capabilities register
+#define PCIE_DEVICE_CAP_MPS_MASK            0x00000007
+#define PCIE_DEVICE_CAP_EXTENDED_TAG        0x00000020
+#define PCIE_DEVICE_CAP_L0S_LATENCY_OFFSET  6
+#define PCIE_DEVICE_CAP_L0S_LATENCY_MASK    0x000001C0
+#define PCIE_DEVICE_CAP_L1_LATENCY_OFFSET   9
+#define PCIE_DEVICE_CAP_L1_LATENCY_MASK     0x00000E00
+#define PCIE_DEVICE_CAP_NO_LATENCY_LIMIT    7
+
+// Device control register
+#define PCIE_DEVICE_CTRL_MPS_OFFSET         5
+#define PCIE_DEVICE_CTRL_MPS_MASK           0x00E0
+#define PCIE_DEVICE_CTRL_EXTENDED_TAG       0x0100
+#define PCIE_DEVICE_CTRL_MRRS_OFFSET        12
+#define PCIE_DEVICE_CTRL_MRRS_MASK          0x7000
+
+// Link capabilities register
+#define PCIE_LINK_CAP_ASPM_OFFSET           10
+#define PCIE_LINK_CAP_ASPM_MASK             0x00000C00
+#define PCIE_LINK_CAP_L0S_EXIT_OFFSET       12
+#define PCIE_LINK_CAP_L0S_EXIT_MASK         0x00007000
+#define PCIE_LINK_CAP_L1_EXIT_OFFSET        15
+#define PCIE_LINK_CAP_L1_EXIT_MASK          0x00038000
+
+// Link control register, ASPM Control uses the PCIE_ASPM_TYPE encoding
+#define PCIE_LINK_CTRL_ASPM_MASK            0x0003
+
+// L1 PM Substates extended capability
+#define PCIE_EXT_CAP_ID_L1SS                0x1E
+#define PCIE_L1SS_CTRL1_REG                 0x08
+#define PCIE_L1SS_CTRL1_ASPM_MASK           0x0000000C
+
+// Device capabilities 2 register
+#define PCIE_DEVICE_CAP2_10BIT_COMPLETER    0x00010000
+#define PCIE_DEVICE_CAP2_10BIT_REQUESTER    0x00020000
+
+// Device control 2 register
+#define PCIE_DEVICE_CTRL2_10BIT_REQUESTER   0x1000
+
+// Max_Payload_Size / Max_Read_Request_Size encodings
+#define PCIE_MAX_PAYLOAD_128                0
+#define PCIE_MAX_PAYLOAD_4096               5
+
+/// Function found below a root port
+typedef struct {
+  PCI_ADDR                  Address;                ///< PCI address of the function
+  uint32_t                  ClassCode;              ///< Class code, sub-class and programming interface
+  uint32_t                  DeviceCap;              ///< Device Capabilities
+  uint32_t                  DeviceCap2;             ///< Device Capabilities 2
+  uint32_t                  LinkCap;                ///< Link Capabilities
+  uint32_t                  BusNumbers;             ///< Original bus number register of a bridge
+  uint8_t                   PcieCapPtr;             ///< PCI Express capability pointer, 0 for PCI functions
+  uint8_t                   PortType;               ///< PCI Express Device/Port type
+  uint8_t                   Parent;                 ///< Index of the upstream bridge node
+  uint8_t                   SecondaryBus;           ///< Temporary secondary bus, 0 when not a bridge
+} MPIO_PCIE_NODE;
+
+/// Hierarchy below one root port, node 0 is the root port itself
+typedef struct {
+  PCIe_ENGINE_CONFIG        *Engine;                ///< Root port engine
+  GNB_HANDLE                *GnbHandle;             ///< Root complex of the root port
+  uint8_t                   NodeCount;              ///< Valid entries in Node
+  uint16_t                  NextBus;                ///< Next temporary bus number, above 0xFF once exhausted
+  uint8_t                   BusLimit;               ///< Last bus number available for the scan
+  bool                      Truncated;              ///< Scan ran out of nodes, buses or depth
+  MPIO_PCIE_NODE            Node[MPIO_PCIE_HIERARCHY_MAX_NODES]; ///< Functions in scan order
+} MPIO_PCIE_HIERARCHY;
+
+SIL_STATUS
+MpioPcieHierarchyScan (
+  PCIe_ENGINE_CONFIG        *Engine,
+  GNB_HANDLE                *GnbHandle,
+  MPIO_PCIE_HIERARCHY       *Hierarchy
+  );
+
+void
+MpioPcieHierarchyRelease (
+  MPIO_PCIE_HIERARCHY       *Hierarchy
+  );
+
+void
+MpioPcieHierarchyTune (
+  PCIe_PLATFORM_CONFIG      *Pcie,
+  MPIOCLASS_INPUT_BLK       *SilData
+  );
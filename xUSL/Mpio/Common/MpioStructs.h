@@ -412,7 +412,7 @@ typedef struct  {
                                                               *  @li @b 0b = Disabled
                                                               *  @li @b 1b = Enabled
                                                               */
-  uint8_t                   Reserved2           :1;   ///< Reserved
+  uint8_t                   TenBitTagDisable    :1;   ///< Exclude the port from 10-bit tag negotiation
   uint8_t                   Reserved3           :1;   ///< Reserved
   uint8_t                   SetGen3FixedPreset  :1;   ///< Gen3 Fixed Preset Set
   uint8_t                   SetGen4FixedPreset  :1;   ///< Gen4 Fixed Preset Set
@@ -927,9 +927,12 @@ typedef enum {
                                    when PP_NPEM_ENABLE = 1.
                                 *  Valid bits are bit[0] to bit[11]
                                 */
-  MPIO_PP_BMC_LOCATION               /**< (BOOLEAN) States the port location of the BMC
+  MPIO_PP_BMC_LOCATION,              /**< (BOOLEAN) States the port location of the BMC
                                 *  Defines the location of the BMC if TRUE
                                 */
+  MPIO_PP_TEN_BIT_TAG_DISABLE        /**< (BOOLEAN) Exclude the port from 10-bit tag negotiation
+                                *  Extended 8-bit tags are still negotiated if TRUE
+                                */
 } MPIO_PCIe_PORT_PARAM_TYPE;
 
 /**
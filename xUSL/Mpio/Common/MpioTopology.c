@@ -368,6 +368,13 @@ MpioManageEngineDescriptor (
     case MPIO_PP_BMC_LOCATION:
       EngineDescriptor->Port.IsBmcLocation = 1;
       break;
+    case MPIO_PP_TEN_BIT_TAG_DISABLE:
+      if (PortParam->ParamValue == true) {
+        EngineDescriptor->Port.TenBitTagDisable = 1;
+      } else {
+        EngineDescriptor->Port.TenBitTagDisable = 0;
+      }
+      break;
     default:
       break;
     }
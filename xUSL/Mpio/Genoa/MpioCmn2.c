@@ -32,12 +32,14 @@ MPIO_COMMON_2_REV_XFER_BLOCK MpioXfer = {
   .PcieSetPortPciAddressMap      = PcieSetPortPciAddressMap,
   .PcieCommonEngineConfiguration = PcieCommonEngineConfiguration,
   .InitBusRangesAndAri           = InitBusRangesAndAri,
-  .MpioIsEverTriedTraining       = MpioIsEverTriedTraining
+  .MpioIsEverTriedTraining       = MpioIsEverTriedTraining,
+  .MpioFlushPcieStraps           = MpioFlushPcieStraps
 };
 
 MPIO_IP2IP_API MpioApi = {
   .MpioServiceRequest                  = MpioServiceRequestCommon,
   .MpioWritePcieStrap                  = WritePcieStrap,
+  .MpioFlushPcieStraps                 = MpioFlushPcieStraps,
   .MpioGetPortStrapIndex               = PcieGetPortStrapIndex,
   .MpioGetDpcCapabilityStrap           = PcieGetPortDpcCapabilityStrap,
   .MpioGetTphSupportStrap              = PcieGetTphSupportStrap,
@@ -401,11 +401,89 @@ PcieSetPortPciAddressMap (
   }
 }
 
+/**
+ * MpioFlushPcieStraps
+ *
+ * @brief Send all pending strap writes of an MPIO instance to MPIO firmware
+ *
+ * @details Strap writes are accumulated by WritePcieStrap and sent here, once per
+ *          configuration point. The strap index adjustment for early silicon is resolved
+ *          once per flush rather than once per write.
+ *
+ * @param  GnbHandle         Any Gnb Handle on the socket whose list is flushed
+ */
+void
+MpioFlushPcieStraps (
+  GNB_HANDLE     *GnbHandle
+  )
+{
+  uint32_t                Index;
+  uint32_t                Response;
+  uint32_t                MpioArg[6];
+  uint16_t                StrapIndexAdjusted;
+  bool                    AdjustIndex;
+  CORE_LOGICAL_ID         LogicalId;
+  MPIO_STRAP_LIST         *StrapList;
+  MPIO_STRAP_LIST_ENTRY   *Entry;
+  MPIO_STRAP_WRITE_STATS  *Stats;
+  MPIOCLASS_INPUT_BLK     *SilData;
+
+  SilData = (MPIOCLASS_INPUT_BLK *)SilFindStructure (SilId_MpioClass,  0);
+  if ((SilData == NULL) || (GnbHandle->SocketId >= MAX_SOCKETS_SUPPORTED)) {
+    return;
+  }
+  StrapList = &SilData->StrapList[GnbHandle->SocketId];
+  Stats = &SilData->StrapWriteStats[GnbHandle->SocketId];
+  if (StrapList->Count == 0) {
+    return;
+  }
+
+  // Adjust strap index to account for 2 additional offsets in Genoa B0 and later
+  AdjustIndex = false;
+  if (GetCoreLogicalIdOnCurrentCore ((CORE_LOGICAL_ID*)&LogicalId) == SilPass) {
+    if (((LogicalId.CoreFamily & AMD_FAMILY_GENOA) != 0) && (LogicalId.CoreRevision & (AMD_REV_F19_GENOA_AX))) {
+      AdjustIndex = true;
+    }
+  }
+
+  for (Index = 0; Index < StrapList->Count; Index++) {
+    Entry = &StrapList->Entry[Index];
+    StrapIndexAdjusted = Entry->StrapIndex;
+    if (AdjustIndex && (StrapIndexAdjusted >= 0xA8)) {
+      StrapIndexAdjusted -= 2;
+    }
+
+    memset (MpioArg, 0x00, sizeof(MpioArg));
+    MpioArg[0] = (uint32_t) StrapIndexAdjusted + ((uint32_t) Entry->Instance << 16);
+    MpioArg[1] = Entry->Value;
+
+    Response = MpioServiceRequestCommon (StrapList->Address, MPIO_MSG_PCIE_WRITE_STRAP, MpioArg, 0);
+    MPIO_TRACEPOINT (SIL_TRACE_INFO, "  Strap 0x%x instance %d MPIO Response = 0x%x\n",
+      Entry->StrapIndex, Entry->Instance, Response);
+
+    Stats->Issued++;
+    if (Entry->Port == MPIO_STRAP_CORE_LEVEL) {
+      Stats->CoreWrites[Entry->Instance]++;
+    } else {
+      Stats->PortWrites[Entry->Instance][Entry->Port]++;
+    }
+  }
+
+  MPIO_TRACEPOINT (SIL_TRACE_INFO, "Socket %d flushed %d straps (requested %d, coalesced %d)\n",
+    GnbHandle->SocketId, StrapList->Count, Stats->Requested, Stats->Coalesced);
+  Stats->Flushes++;
+  StrapList->Count = 0;
+}
+
 /**
  * WritePcieStrap
  *
  * @brief Routine to write pcie soft straps
  *
+ * @details The write is added to the strap list of the socket's MPIO instance and sent by
+ *          MpioFlushPcieStraps. A later write to the same strap of the same core replaces
+ *          the pending value, so only the final value reaches MPIO firmware.
+ *
  * @param  GnbHandle         The associated Gnb Handle
  * @param  StrapIndex        Strap index
  * @param  Value             Contains value of strap register to write with
@@ -419,22 +497,17 @@ WritePcieStrap (
      uint8_t        Wrapper
   )
 {
-  uint32_t  Response;
-  uint32_t  MpioArg[6];
-  uint8_t   InstanceNumber;
-  SIL_STATUS      Status;
-  CORE_LOGICAL_ID LogicalId;
-  uint16_t          StrapIndexAdjusted;
+  uint32_t                Index;
+  uint8_t                 InstanceNumber;
+  uint8_t                 Port;
+  MPIO_STRAP_LIST         *StrapList;
+  MPIO_STRAP_LIST_ENTRY   *Entry;
+  MPIOCLASS_INPUT_BLK     *SilData;
 
-  // Adjust strap index to account for 2 additional offsets in Genoa B0 and later
-  StrapIndexAdjusted = StrapIndex;
-  Status = GetCoreLogicalIdOnCurrentCore ((CORE_LOGICAL_ID*)&LogicalId);
-  if (Status == SilPass) {
-    if (((LogicalId.CoreFamily & AMD_FAMILY_GENOA) != 0) && (LogicalId.CoreRevision & (AMD_REV_F19_GENOA_AX))) {
-      if (StrapIndex >= 0xA8) {
-        StrapIndexAdjusted -= 2;
-      }
-    }
+  SilData = (MPIOCLASS_INPUT_BLK *)SilFindStructure (SilId_MpioClass,  0);
+  if ((SilData == NULL) || (GnbHandle->SocketId >= MAX_SOCKETS_SUPPORTED)) {
+    MPIO_TRACEPOINT (SIL_TRACE_ERROR, "  Strap 0x%x dropped, no strap list\n", StrapIndex);
+    return;
   }
 
   InstanceNumber = GnbHandle->RBIndex + Wrapper * 4; /// RBIndex is the NBIO #
@@ -442,10 +515,36 @@ WritePcieStrap (
     InstanceNumber = 9;
   }
 
-  memset (MpioArg, 0x00, sizeof(MpioArg));
-  MpioArg[0] = (uint32_t) StrapIndexAdjusted + ((uint32_t) InstanceNumber << 16);
-  MpioArg[1] = Value;
+  Port = MPIO_STRAP_CORE_LEVEL;
+  if (StrapIndex >= SIL_RESERVED_834) {
+    Index = (StrapIndex - SIL_RESERVED_834) / SIL_RESERVED_881;
+    if (Index < MPIO_STRAP_PORTS_PER_CORE) {
+      Port = (uint8_t) Index;
+    }
+  }
+
+  StrapList = &SilData->StrapList[GnbHandle->SocketId];
+  SilData->StrapWriteStats[GnbHandle->SocketId].Requested++;
+
+  for (Index = 0; Index < StrapList->Count; Index++) {
+    Entry = &StrapList->Entry[Index];
+    if ((Entry->StrapIndex == StrapIndex) && (Entry->Instance == InstanceNumber)) {
+      Entry->Value = Value;
+      SilData->StrapWriteStats[GnbHandle->SocketId].Coalesced++;
+      return;
+    }
+  }
+
+  if (StrapList->Count >= MPIO_STRAP_LIST_ENTRIES) {
+    MpioFlushPcieStraps (GnbHandle);
+  }
+  if (StrapList->Count == 0) {
+    StrapList->Address = NbioGetHostPciAddress (GnbHandle);
+  }
 
-  Response = MpioServiceRequestCommon (NbioGetHostPciAddress (GnbHandle), MPIO_MSG_PCIE_WRITE_STRAP, MpioArg, 0);
-  MPIO_TRACEPOINT (SIL_TRACE_INFO, "  MPIO Response = 0x%x\n", Response);
+  Entry = &StrapList->Entry[StrapList->Count++];
+  Entry->StrapIndex = StrapIndex;
+  Entry->Instance = InstanceNumber;
+  Entry->Port = Port;
+  Entry->Value = Value;
 }
@@ -24,6 +24,11 @@ WritePcieStrap (
   uint8_t        Wrapper
   );
 
+void
+MpioFlushPcieStraps (
+  GNB_HANDLE     *GnbHandle
+  );
+
 #define SIL_RESERVED_838       0x6
 #define SIL_RESERVED_893       0xe
 #define SIL_RESERVED_844       0x13
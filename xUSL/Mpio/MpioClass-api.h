@@ -107,9 +107,15 @@ typedef struct {
   uint8_t     PcieLinkAspmAllPort;  ///< Pcie LinkAspm
   uint8_t     AmdMCTPMasterSeg;  ///< Specifies segment of the PCI address of the MCTP master
   uint16_t    AmdMCTPMasterID;  ///< Specifies the PCI address of the MCTP master
+  uint8_t     PcieMpsMrrsProfile;  ///< MPIO_PCIE_TUNING_PROFILE applied to every trained hierarchy
+  bool        PcieTagNegotiation;  ///< Negotiate extended and 10-bit tags on every trained hierarchy
+  bool        PcieAspmPolicy;  ///< Limit ASPM to what endpoint exit latency tolerances allow
+  uint8_t     PcieAspmLatencyCritical;  ///< MPIO_ASPM_CRITICAL_* classes that never use L0s or L1
   bool SyncHeaderByPass; ///< User configurable
   bool CxlTempGen5AdvertAltPtcl; ///< User configurable
   PCIe_DPC_STATUS_DATA    DpcStatusData;  ///< DPC status
+  MPIO_STRAP_LIST         StrapList[MAX_SOCKETS_SUPPORTED];  ///< Strap writes pending per MPIO instance
+  MPIO_STRAP_WRITE_STATS  StrapWriteStats[MAX_SOCKETS_SUPPORTED];  ///< Strap write counters per socket
   PCIe_PLATFORM_TOPOLOGY  PcieTopologyData; ///< PCIe Platform topology
 } MPIOCLASS_INPUT_BLK;
 
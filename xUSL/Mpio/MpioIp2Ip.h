@@ -26,6 +26,10 @@ typedef void (*MPIO_WRITE_PCIE_STRAP) (
   uint8_t        Wrapper
   );
 
+typedef void (*MPIO_FLUSH_PCIE_STRAPS) (
+  GNB_HANDLE     *GnbHandle
+  );
+
 typedef uint16_t (*MPIO_GET_PORT_STRAP_INDEX) (
   uint16_t Strap,
   uint16_t Port
@@ -44,6 +48,7 @@ typedef SIL_STATUS (*MPIO_VER_INFO) (
 typedef struct {
   MPIO_SERVICE_REQUEST                MpioServiceRequest;
   MPIO_WRITE_PCIE_STRAP               MpioWritePcieStrap;
+  MPIO_FLUSH_PCIE_STRAPS              MpioFlushPcieStraps;
   MPIO_GET_PORT_STRAP_INDEX           MpioGetPortStrapIndex;
   GET_DPC_CAPABILITY_STRAP            MpioGetDpcCapabilityStrap;
   GET_TPH_SUPPORT_STRAP               MpioGetTphSupportStrap;
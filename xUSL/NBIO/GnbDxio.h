@@ -153,10 +153,18 @@ typedef struct {
 
 ///PCIe ASPM Latency Information
 typedef struct {
-  uint8_t  MaxL0sExitLatency;                             ///< Max L0s exit latency in us
+  uint8_t  MaxL0sExitLatency;                             ///< Max L0s exit latency in 64 ns units
   uint8_t  MaxL1ExitLatency;                              ///< Max L1 exit latency in us
 } PCIe_ASPM_LATENCY_INFO;
 
+/// PCIe_PORT_CONFIG TagNegotiation result bits
+#define PCIE_TAG_NEGOTIATION_DONE             0x01    ///< Hierarchy below the port was negotiated
+#define PCIE_TAG_NEGOTIATION_EXTENDED         0x02    ///< Extended 8-bit tags enabled on the root port
+#define PCIE_TAG_NEGOTIATION_10BIT_ROOT       0x04    ///< Root port issues 10-bit tags to the hierarchy
+#define PCIE_TAG_NEGOTIATION_10BIT_ENDPOINT   0x08    ///< At least one function below issues 10-bit tags
+#define PCIE_TAG_NEGOTIATION_OPT_OUT          0x10    ///< 10-bit tags skipped by the platform descriptor
+#define PCIE_TAG_NEGOTIATION_TRUNCATED        0x20    ///< Part of the hierarchy was not scanned
+
 /// PCI address association
 typedef struct {
   uint8_t NewDeviceAddress;                                ///< New PCI address (Device,Fucntion)
@@ -465,7 +473,10 @@ typedef struct {
     uint32_t                 UNUSED11:5;                  ///< Currently unassigned - for alignment
   } LcFapeSettingsGroup6;
   uint8_t                   ForceSteering:1;              ///< Steering is forced
-  uint8_t                   UNUSED12:7;                   ///< Currently unassigned - for alignment
+  uint8_t                   TenBitTagDisable:1;           ///< Platform opted the port out of 10-bit tags
+  uint8_t                   UNUSED12:6;                   ///< Currently unassigned - for alignment
+  uint8_t                   TagNegotiation;               ///< Tag negotiation result, see PCIE_TAG_NEGOTIATION_*
+  uint8_t                   TenBitTagRequesters;          ///< Functions below the port issuing 10-bit tags
 
 } PCIe_PORT_CONFIG;
 
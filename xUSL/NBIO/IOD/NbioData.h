@@ -26,6 +26,8 @@ typedef struct {
   NBIO_CONFIG_DATA *NbioConfigData;
   // This would point to the host memory for NBIO Input block
   NBIOCLASS_INPUT_BLK *NbioInputBlk;
+  // P2P path report in the host NBIO data block
+  NBIO_P2P_REPORT *P2pReport;
 } NBIOCLASS_DATA;
 
 /**
@@ -10,6 +10,7 @@
 #include <NBIO/NbioIp2Ip.h>
 #include "NbioIod.h"
 #include <NBIO/NbioPcieTopologyHelper.h>
+#include "NbioP2p.h"
 
 static NBIO_IP2IP_API NbioIodApi = {
   .NbioGetHandle                            = NbioGetHandle,
@@ -19,10 +20,18 @@ static NBIO_IP2IP_API NbioIodApi = {
   .PcieConfigGetChild                       = PcieConfigGetChild,
   .PcieConfigGetParent                      = PcieConfigGetParent,
   .PcieConfigRunProcForAllEngines           = PcieConfigRunProcForAllEngines,
+  .PcieConfigRunProcForAllActiveEngines     = PcieConfigRunProcForAllActiveEngines,
+  .PcieConfigUpdateActiveEngineIndex        = PcieConfigUpdateActiveEngineIndex,
   .PcieConfigRunProcForAllEnginesInWrapper  = PcieConfigRunProcForAllEnginesInWrapper,
   .PcieConfigRunProcForAllWrappers          = PcieConfigRunProcForAllWrappers,
   .PcieConfigRunProcForAllWrappersInNbio    = PcieConfigRunProcForAllWrappersInNbio,
   .PcieConfigCheckPortStatus                = PcieConfigCheckPortStatus,
+  .PcieFindCapability                       = PcieFindCapability,
+  .PcieFindExtendedCapability               = PcieFindExtendedCapability,
+  .PcieFindNextExtendedCapability           = PcieFindNextExtendedCapability,
+  .PcieFindDvsec                            = PcieFindDvsec,
+  .PcieCapabilityInvalidateBus              = PcieCapabilityInvalidateBus,
+  .PcieP2pInit                              = NbioPcieP2pInit,
   .GetVersionInfo                           = NULL
 };
 
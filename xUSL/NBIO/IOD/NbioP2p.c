@@ -0,0 +1,313 @@
+/**
+ * @file  NbioP2p.c
+ * @brief OpenSIL NBIO per root port peer-to-peer routing policy
+ *
+ * NBIO_IOHC_P2P_TBL already opens every IOHC to local and fabric-crossing P2P and VDM traffic. When the
+ * host lists the root port pairs that need P2P, ACS on the listed ports is relaxed towards their peers.
+ */
+
+/* Copyright 2023 Advanced Micro Devices, Inc. All rights reserved.    */
+// SPDX-License-Identifier: MIT
+
+#include <string.h>
+#include <Pci.h>
+#include "NbioData.h"
+#include "NbioCommon.h"
+#include "NbioPcieTopologyHelper.h"
+#include "NbioPcieCapability.h"
+#include "NbioP2p.h"
+
+#define PCI_ADDR_REGISTER_MASK    0x00000FFF
+
+extern NBIOCLASS_DATA mNbioIpBlockData;
+
+/// Root port lookup context
+typedef struct {
+  uint32_t            Address;            ///< PCI address of the root port
+  PCIe_ENGINE_CONFIG  *Engine;            ///< Matching trained engine, NULL if not found
+} NBIO_P2P_PORT_LOOKUP;
+
+/**
+ * NbioP2pFindPortCallback
+ *
+ * @brief Match a trained PCIe engine against the requested root port address
+ *
+ * @param[in]     Engine  Engine configuration info
+ * @param[in,out] Buffer  NBIO_P2P_PORT_LOOKUP
+ * @param[in]     Pcie    PCIe configuration info
+ */
+static
+void
+NbioP2pFindPortCallback (
+  PCIe_ENGINE_CONFIG    *Engine,
+  void                  *Buffer,
+  PCIe_PLATFORM_CONFIG  *Pcie
+  )
+{
+  NBIO_P2P_PORT_LOOKUP  *Lookup;
+
+  Lookup = (NBIO_P2P_PORT_LOOKUP *) Buffer;
+  if ((Lookup->Engine == NULL) &&
+      (Engine->Type.Port.Address.AddressValue == Lookup->Address) &&
+      PcieConfigCheckPortStatus (Engine, INIT_STATUS_PCIE_TRAINING_SUCCESS)) {
+    Lookup->Engine = Engine;
+  }
+}
+
+/**
+ * NbioP2pFindPort
+ *
+ * @brief Find the trained root port engine at a PCI address
+ *
+ * @param[in] Address   PCI address of the root port
+ * @param[in] Pcie      PCIe configuration info
+ *
+ * @retval Engine of the root port, NULL if the port is not present or not trained
+ */
+static
+PCIe_ENGINE_CONFIG *
+NbioP2pFindPort (
+  uint32_t              Address,
+  PCIe_PLATFORM_CONFIG  *Pcie
+  )
+{
+  NBIO_P2P_PORT_LOOKUP  Lookup;
+
+  Lookup.Address = Address & ~PCI_ADDR_REGISTER_MASK;
+  Lookup.Engine = NULL;
+  PcieConfigRunProcForAllEngines (
+    DESCRIPTOR_ALLOCATED | DESCRIPTOR_PCIE_ENGINE,
+    NbioP2pFindPortCallback,
+    &Lookup,
+    Pcie
+    );
+  return Lookup.Engine;
+}
+
+/**
+ * NbioP2pAcsPortNumber
+ *
+ * @brief Return the bit of a root port in the ACS egress control vector of its peers
+ *
+ * @param[in] Port      Root port engine
+ *
+ * @retval Port Number from the Link Capabilities register, 0xFFFFFFFF without a PCI Express capability
+ */
+static
+uint32_t
+NbioP2pAcsPortNumber (
+  PCIe_ENGINE_CONFIG    *Port
+  )
+{
+  uint32_t  Address;
+  uint8_t   PcieCapPtr;
+
+  Address = Port->Type.Port.Address.AddressValue;
+  PcieCapPtr = PcieFindCapability (Address, PCIE_CAP_ID_EXPRESS);
+  if (PcieCapPtr == 0) {
+    return 0xFFFFFFFF;
+  }
+  return xUSLPciRead32 (Address | (PcieCapPtr + PCIE_LINK_CAPABILITIES_REG)) >> PCIE_LINK_CAP_PORT_NUMBER_OFFSET;
+}
+
+/**
+ * NbioP2pConfigureAcs
+ *
+ * @brief Relax ACS on a root port towards its P2P peers only
+ *
+ * @details P2P request and completion redirect are cleared so peer traffic is not bounced through the
+ *          IOMMU. When the port supports egress control, the egress vector bits of the same-IOHC peers,
+ *          numbered by their Link Capabilities Port Number, are cleared; no other port is blocked and egress
+ *          control is left as configured. Direct translated P2P is enabled only for pairs asking for IOMMU
+ *          bypass.
+ *
+ * @param[in] Port      Root port engine
+ * @param[in] Peer      Peer engines of all paths through the port, indexed like Report->Path
+ * @param[in] Report    P2P path report
+ */
+static
+void
+NbioP2pConfigureAcs (
+  PCIe_ENGINE_CONFIG    *Port,
+  PCIe_ENGINE_CONFIG    **Peer,
+  NBIO_P2P_REPORT       *Report
+  )
+{
+  uint32_t  Address;
+  uint16_t  AcsPtr;
+  uint16_t  AcsCap;
+  uint16_t  AcsCtrl;
+  uint32_t  VectorSize;
+  uint32_t  Vector[4];
+  uint32_t  PortNumber;
+  uint32_t  Index;
+  bool      DirectTranslated;
+
+  Address = Port->Type.Port.Address.AddressValue;
+  AcsPtr = PcieFindExtendedCapability (Address, PCIE_EXT_CAP_ID_ACS);
+  if (AcsPtr == 0) {
+    NBIO_TRACEPOINT (SIL_TRACE_INFO, "Port 0x%x has no ACS capability\n", Address);
+    return;
+  }
+  AcsCap = xUSLPciRead16 (Address | (AcsPtr + PCIE_ACS_CAP_REG));
+  VectorSize = (uint32_t) (AcsCap >> PCIE_ACS_EGRESS_VECTOR_SIZE_OFFSET);
+  if (VectorSize == 0) {
+    VectorSize = 256;
+  }
+  if (VectorSize > (sizeof (Vector) * 8)) {
+    VectorSize = sizeof (Vector) * 8;
+  }
+
+  memset (Vector, 0, sizeof (Vector));
+  if ((AcsCap & PCIE_ACS_P2P_EGRESS_CONTROL) != 0) {
+    for (Index = 0; Index < ((VectorSize + 31) / 32); Index++) {
+      Vector[Index] = xUSLPciRead32 (Address | (AcsPtr + PCIE_ACS_EGRESS_VECTOR_REG + (Index * 4)));
+    }
+  }
+  DirectTranslated = false;
+  for (Index = 0; Index < Report->PathCount; Index++) {
+    if (Peer[Index] == NULL) {
+      continue;
+    }
+    if ((Report->Path[Index].Status & NBIO_P2P_PATH_SAME_IOHC) != 0) {
+      PortNumber = NbioP2pAcsPortNumber (Peer[Index]);
+      if (PortNumber < VectorSize) {
+        Vector[PortNumber / 32] &= ~(1u << (PortNumber % 32));
+      }
+    }
+    if ((Report->Path[Index].Status & NBIO_P2P_PATH_IOMMU_BYPASS) != 0) {
+      DirectTranslated = true;
+    }
+  }
+
+  AcsCtrl = xUSLPciRead16 (Address | (AcsPtr + PCIE_ACS_CTRL_REG));
+  AcsCtrl &= ~(PCIE_ACS_P2P_REQUEST_REDIRECT | PCIE_ACS_P2P_COMPLETION_REDIRECT);
+  if ((AcsCap & PCIE_ACS_P2P_EGRESS_CONTROL) != 0) {
+    for (Index = 0; Index < ((VectorSize + 31) / 32); Index++) {
+      xUSLPciWrite32 (Address | (AcsPtr + PCIE_ACS_EGRESS_VECTOR_REG + (Index * 4)), Vector[Index]);
+    }
+  }
+  if (DirectTranslated && ((AcsCap & PCIE_ACS_DIRECT_TRANSLATED_P2P) != 0)) {
+    AcsCtrl |= PCIE_ACS_DIRECT_TRANSLATED_P2P;
+  }
+  xUSLPciWrite16 (Address | (AcsPtr + PCIE_ACS_CTRL_REG), AcsCtrl);
+
+  NBIO_TRACEPOINT (SIL_TRACE_INFO, "Port 0x%x ACS control 0x%x egress vector 0x%x\n", Address, AcsCtrl, Vector[0]);
+}
+
+/**
+ * NbioPcieP2pInit
+ *
+ * @brief Apply the host per root port pair P2P routing policy and report the enabled paths
+ *
+ * @details Runs after PCIe training, once root ports have their final PCI addresses. Each requested pair is
+ *          resolved to its root port engines and classified as same-IOHC or crossing the data fabric. The
+ *          result is recorded in the NBIO P2P report, one entry per requested pair.
+ *
+ * @param[in] Pcie  PCIe configuration info
+ */
+void
+NbioPcieP2pInit (
+  PCIe_PLATFORM_CONFIG  *Pcie
+  )
+{
+  NBIOCLASS_INPUT_BLK   *NbioInput;
+  NBIO_P2P_REPORT       *Report;
+  NBIO_P2P_PAIR         *Pair;
+  NBIO_P2P_PATH         *Path;
+  PCIe_ENGINE_CONFIG    *PortA[NBIO_P2P_PAIR_COUNT];
+  PCIe_ENGINE_CONFIG    *PortB[NBIO_P2P_PAIR_COUNT];
+  PCIe_ENGINE_CONFIG    *Peer[NBIO_P2P_PAIR_COUNT];
+  PCIe_ENGINE_CONFIG    *Port;
+  GNB_HANDLE            *GnbA;
+  GNB_HANDLE            *GnbB;
+  uint32_t              PairCount;
+  uint32_t              Index;
+  uint32_t              Other;
+  uint32_t              Side;
+  bool                  Done;
+
+  NbioInput = mNbioIpBlockData.NbioInputBlk;
+  Report = mNbioIpBlockData.P2pReport;
+  if ((NbioInput == NULL) || (Report == NULL) || (NbioInput->P2pPairCount == 0)) {
+    return;
+  }
+
+  NBIO_TRACEPOINT (SIL_TRACE_ENTRY, "\n");
+
+  PairCount = NbioInput->P2pPairCount;
+  if (PairCount > NBIO_P2P_PAIR_COUNT) {
+    NBIO_TRACEPOINT (SIL_TRACE_WARNING, "%d P2P pairs requested, only %d supported\n",
+      PairCount, NBIO_P2P_PAIR_COUNT);
+    PairCount = NBIO_P2P_PAIR_COUNT;
+  }
+
+  memset (Report, 0, sizeof (NBIO_P2P_REPORT));
+  for (Index = 0; Index < PairCount; Index++) {
+    Pair = &NbioInput->P2pPair[Index];
+    Path = &Report->Path[Index];
+    Path->PortA = Pair->PortA;
+    Path->PortB = Pair->PortB;
+    Report->PathCount++;
+
+    PortA[Index] = NbioP2pFindPort (Pair->PortA, Pcie);
+    PortB[Index] = NbioP2pFindPort (Pair->PortB, Pcie);
+    if ((PortA[Index] == NULL) || (PortB[Index] == NULL) || (PortA[Index] == PortB[Index])) {
+      NBIO_TRACEPOINT (SIL_TRACE_WARNING, "P2P pair 0x%x <-> 0x%x: root port not found\n", Pair->PortA, Pair->PortB);
+      Path->Status = NBIO_P2P_PATH_PORT_NOT_FOUND;
+      PortA[Index] = NULL;
+      PortB[Index] = NULL;
+      continue;
+    }
+
+    GnbA = (GNB_HANDLE *) PcieConfigGetParent (DESCRIPTOR_SILICON, &(PortA[Index]->Header));
+    GnbB = (GNB_HANDLE *) PcieConfigGetParent (DESCRIPTOR_SILICON, &(PortB[Index]->Header));
+    assert ((GnbA != NULL) && (GnbB != NULL));
+    Path->SocketA = GnbA->SocketId;
+    Path->RbIndexA = GnbA->RBIndex;
+    Path->SocketB = GnbB->SocketId;
+    Path->RbIndexB = GnbB->RBIndex;
+    Path->Status = NBIO_P2P_PATH_ENABLED;
+    Path->Status |= (GnbA == GnbB) ? NBIO_P2P_PATH_SAME_IOHC : NBIO_P2P_PATH_CROSS_FABRIC;
+    if (((Pair->Flags & NBIO_P2P_FLAG_IOMMU_BYPASS) != 0) && NbioInput->IommuSupport) {
+      Path->Status |= NBIO_P2P_PATH_IOMMU_BYPASS;
+    }
+
+    NBIO_TRACEPOINT (SIL_TRACE_INFO, "P2P path 0x%x (S%d RB%d) <-> 0x%x (S%d RB%d) %s\n",
+      Path->PortA, Path->SocketA, Path->RbIndexA, Path->PortB, Path->SocketB, Path->RbIndexB,
+      ((Path->Status & NBIO_P2P_PATH_SAME_IOHC) != 0) ? "same IOHC" : "cross fabric");
+  }
+
+  // Configure ACS once per listed root port with the peers of all its paths
+  for (Index = 0; Index < PairCount; Index++) {
+    for (Side = 0; Side < 2; Side++) {
+      Port = (Side == 0) ? PortA[Index] : PortB[Index];
+      if (Port == NULL) {
+        continue;
+      }
+      Done = false;
+      for (Other = 0; Other < Index; Other++) {
+        if ((PortA[Other] == Port) || (PortB[Other] == Port)) {
+          Done = true;
+        }
+      }
+      if ((Side == 1) && (PortA[Index] == Port)) {
+        Done = true;
+      }
+      if (Done) {
+        continue;
+      }
+      for (Other = 0; Other < PairCount; Other++) {
+        Peer[Other] = NULL;
+        if (PortA[Other] == Port) {
+          Peer[Other] = PortB[Other];
+        } else if (PortB[Other] == Port) {
+          Peer[Other] = PortA[Other];
+        }
+      }
+      NbioP2pConfigureAcs (Port, Peer, Report);
+    }
+  }
+
+  NBIO_TRACEPOINT (SIL_TRACE_EXIT, "\n");
+}
@@ -0,0 +1,34 @@
+/**
+ * @file  NbioP2p.h
+ * @brief OpenSIL NBIO per root port peer-to-peer routing policy
+ */
+
+/* Copyright 2023 Advanced Micro Devices, Inc. All rights reserved.    */
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <xSIM.h>
+#include <NBIO/GnbDxio.h>
+
+// Access Control Services extended capability
+#define PCIE_EXT_CAP_ID_ACS                   0x0D
+#define PCIE_ACS_CAP_REG                      0x04
+#define PCIE_ACS_CTRL_REG                     0x06
+#define PCIE_ACS_EGRESS_VECTOR_REG            0x08
+
+// ACS capability and control bits share the same layout
+#define PCIE_ACS_P2P_REQUEST_REDIRECT         0x0004
+#define PCIE_ACS_P2P_COMPLETION_REDIRECT      0x0008
+#define PCIE_ACS_P2P_EGRESS_CONTROL           0x0020
+#define PCIE_ACS_DIRECT_TRANSLATED_P2P        0x0040
+#define PCIE_ACS_EGRESS_VECTOR_SIZE_OFFSET    8         ///< Egress Control Vector Size, 0 encodes 256
+
+// PCI Express capability, Link Capabilities[Port Number] numbers the bits of the ACS egress vector
+#define PCIE_LINK_CAPABILITIES_REG            0x0C
+#define PCIE_LINK_CAP_PORT_NUMBER_OFFSET      24
+
+void
+NbioPcieP2pInit (
+  PCIe_PLATFORM_CONFIG  *Pcie
+  );
@@ -204,7 +204,7 @@ SIL_STATUS PcieConfigurationInit (void)
             sizeof(NORTH_BRIDGE_PCIE_SIB) + ComplexesDataLength,  // size
             0,                                                      // Instance
             0,                                                      // rev-major
-            1);                                                     // rev-minor
+            2);                                                     // rev-minor
 
     // Build PCIe Complex
   ComplexIndex = 0;
@@ -314,6 +314,9 @@ SIL_STATUS PcieConfigurationInit (void)
     PcieConfigDebugDump (Pcie);
 
     PcieEnumerateAndHarvestWrappers(Pcie);
+
+    // Flatten the final topology for the RunProcForAll* iterators
+    PcieConfigBuildTopologyIndex (Pcie);
   }
   NBIO_TRACEPOINT (SIL_TRACE_EXIT, "Status [0x%x]\n", Status);
 
@@ -94,6 +94,7 @@
 //(Legacy operation) //01 - Mode 1 : DMA writes not matching a valid P2P range are forwarded to the DF //10 - Mode 2 : all
 //DMA writes are forwarded to the DF //11 - Mode 3: Disable P2P
 #define IOHC_FEATURE_CNTL_P2P_mode_OFFSET      1
+#define IOHC_FEATURE_CNTL_P2P_mode_MASK        0x6
 // Bitfield Description : Enables the per-port ARI_EN signals from the IOHC shadow registers. This is used for decoding
 //external configuration requests to the bridges.
 #define IOHC_FEATURE_CNTL_IOHC_ARI_SUPPORTED_OFFSET      22
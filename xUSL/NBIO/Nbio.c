@@ -84,6 +84,8 @@ NbioClassSetInputBlk (void)
   // Reassign NbioBlockData->NbioInputBlk to the newely created IP block
   NbioDfltBlockData->NbioInputBlk = &NbioInput->NbioInputBlk;
   NbioDfltBlockData->NbioConfigData = &NbioInput->NbioConfigData;
+  NbioDfltBlockData->P2pReport = &NbioInput->P2pReport;
+  memset ((void *)(&NbioInput->P2pReport), 0, sizeof(NBIO_P2P_REPORT));
 
   return SilPass;
 }
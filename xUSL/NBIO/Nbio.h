@@ -21,6 +21,13 @@
 #define MAX_NUM_OF_CORES_PER_ROOT_COMPLEX   3
 #define MAX_NUM_OF_PORTS_PER_ROOT_COMPLEX   22
 
+#define MAX_NUM_OF_PCIE_WRAPPERS_INDEXED   (MAX_NUMBER_OF_COMPLEXES * MAX_NUM_OF_CORES_PER_ROOT_COMPLEX)
+#define MAX_NUM_OF_PCIE_ENGINES_INDEXED    (MAX_NUMBER_OF_COMPLEXES * MAX_NUM_OF_PORTS_PER_ROOT_COMPLEX)
+
+#define PCIE_CAP_MAP_CACHE_ENTRIES         32     ///< Functions tracked by the capability map cache
+#define PCIE_CAP_MAP_MAX_CAPS              16     ///< Legacy capabilities recorded per function
+#define PCIE_CAP_MAP_MAX_EXT_CAPS          24     ///< Extended capabilities recorded per function
+
 #define MAX_NUM_NBIO_PCIE_CONFIG 6
 #define MAX_NUM_NBIO_PCIE_CONFIG_2 2
 
@@ -49,9 +56,71 @@ typedef struct {
   uint8_t                 PortDevMap[MAX_NUM_OF_PORTS_PER_ROOT_COMPLEX];    ///< PortDevMap Allocation
 } COMPLEX_CONFIG_MODEL;
 
+/**
+ * Flattened PCIe topology index
+ *
+ * Dense arrays of wrapper and engine descriptors in topology order, built once the topology has been
+ * created (see PcieConfigBuildTopologyIndex). Entries are byte offsets from the PCIe platform config
+ * header so the index stays valid when the Host relocates the openSIL memory block between timepoints.
+ */
+typedef struct {
+  uint8_t                     Valid;                                          ///< Index matches the linked topology
+  uint8_t                     Reserved;                                       ///< For alignment
+  uint16_t                    NumberOfWrappers;                               ///< Valid entries in Wrapper[]
+  uint16_t                    NumberOfEngines;                                ///< Valid entries in Engine[]
+  uint16_t                    NumberOfActiveEngines;                          ///< Valid entries in ActiveEngine[]
+  uint32_t                    Wrapper[MAX_NUM_OF_PCIE_WRAPPERS_INDEXED];      ///< All wrappers
+  uint32_t                    Engine[MAX_NUM_OF_PCIE_ENGINES_INDEXED];        ///< All engines
+  uint32_t                    ActiveEngine[MAX_NUM_OF_PCIE_ENGINES_INDEXED];  ///< Active PCIe engines only
+} PCIe_TOPOLOGY_INDEX;
+
+/// Legacy (0x34 chain) capability map entry
+typedef struct {
+  uint8_t                     Id;                                             ///< Capability ID
+  uint8_t                     Offset;                                         ///< Config space offset
+} PCIe_CAP_MAP_ENTRY;
+
+/// Extended (0x100 chain) capability map entry
+typedef struct {
+  uint16_t                    Id;                                             ///< Extended capability ID
+  uint16_t                    Offset;                                         ///< Config space offset
+  uint16_t                    VendorId;                                       ///< DVSEC Vendor ID (DVSEC only)
+  uint16_t                    DvsecId;                                        ///< DVSEC ID (DVSEC only)
+} PCIe_EXT_CAP_MAP_ENTRY;
+
+/// Capability map of one PCI function, recorded by a single walk of its config space
+typedef struct {
+  uint32_t                    Address;                                        ///< PCI address, register bits clear
+  uint32_t                    DeviceVendorId;                                 ///< Device/Vendor ID when the map was built
+  uint8_t                     Valid;                                          ///< Entry holds a map
+  uint8_t                     NumberOfCaps;                                   ///< Valid entries in Cap[]
+  uint8_t                     NumberOfExtCaps;                                ///< Valid entries in ExtCap[]
+  uint8_t                     CapResume;                                      ///< First unrecorded legacy capability, 0 if none
+  uint16_t                    ExtCapResume;                                   ///< First unrecorded extended capability, 0 if none
+  uint16_t                    Reserved;                                       ///< For alignment
+  PCIe_CAP_MAP_ENTRY          Cap[PCIE_CAP_MAP_MAX_CAPS];                     ///< Legacy capabilities in chain order
+  PCIe_EXT_CAP_MAP_ENTRY      ExtCap[PCIE_CAP_MAP_MAX_EXT_CAPS];              ///< Extended capabilities in chain order
+} PCIe_CAP_MAP;
+
+/**
+ * PCIe capability map cache
+ *
+ * Per-BDF capability maps shared by the PCIe, CXL, MPIO and SDCI code so each function's capability
+ * chains are walked once per boot rather than once per lookup (see NbioPcieCapability.c).
+ */
+typedef struct {
+  uint8_t                     NextVictim;                                     ///< Round robin replacement slot
+  uint8_t                     Reserved[3];                                    ///< For alignment
+  uint32_t                    Hits;                                           ///< Lookups served from the cache
+  uint32_t                    Misses;                                         ///< Lookups that walked config space
+  PCIe_CAP_MAP                Map[PCIE_CAP_MAP_CACHE_ENTRIES];                ///< Cached maps
+} PCIe_CAP_MAP_CACHE;
+
 typedef struct {
 /// PCIe Information Block
   PCIe_PLATFORM_CONFIG        PciePlatformConfig;                      ///< Platform Config Structure
+  PCIe_TOPOLOGY_INDEX         TopologyIndex;                           ///< Flattened wrapper/engine index
+  PCIe_CAP_MAP_CACHE          CapMapCache;                             ///< Per-BDF capability maps
   //COMPLEX_CONFIG_MODEL        ComplexConfigs[MAX_NUM_OF_ROOT_COMPLEXES_SUPPORTED];    ///< Allocation for Max Complex Structure suported
   uint32_t                      ComplexConfigs;    ///< Allocation for Max Complex Structure suported
 } NORTH_BRIDGE_PCIE_SIB;
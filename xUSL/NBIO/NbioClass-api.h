@@ -152,6 +152,47 @@ typedef struct {
   bool FabricSdci;
 } NBIO_CONFIG_DATA;
 
+#define NBIO_P2P_PAIR_COUNT           8     ///< Root port pairs in the P2P routing policy
+
+/// NBIO_P2P_PAIR.Flags
+#define NBIO_P2P_FLAG_IOMMU_BYPASS    0x01  ///< Route translated requests directly to the peer (ACS Direct Translated P2P)
+
+/**
+ * NBIO_P2P_PAIR
+ *
+ * Root port pair that needs peer-to-peer traffic, e.g. a GPU and a NIC. Ports are identified by the
+ * PCI address (PCI_ADDR.AddressValue) of the root port each device is attached to.
+ */
+typedef struct {
+  uint32_t  PortA;                        ///< PCI address of the first root port
+  uint32_t  PortB;                        ///< PCI address of the second root port
+  uint8_t   Flags;                        ///< NBIO_P2P_FLAG_*
+} NBIO_P2P_PAIR;
+
+/// NBIO_P2P_PATH.Status
+#define NBIO_P2P_PATH_ENABLED         0x01  ///< P2P routing programmed for the pair
+#define NBIO_P2P_PATH_SAME_IOHC       0x02  ///< Both ports are below the same IOHC
+#define NBIO_P2P_PATH_CROSS_FABRIC    0x04  ///< Traffic crosses the data fabric between IOHCs
+#define NBIO_P2P_PATH_IOMMU_BYPASS    0x08  ///< Translated requests go directly to the peer
+#define NBIO_P2P_PATH_PORT_NOT_FOUND  0x10  ///< A port is not a trained root port
+
+/// P2P path enabled by NBIO for one NBIO_P2P_PAIR
+typedef struct {
+  uint32_t  PortA;                        ///< PCI address of the first root port
+  uint32_t  PortB;                        ///< PCI address of the second root port
+  uint8_t   SocketA;                      ///< Socket of the first root port
+  uint8_t   RbIndexA;                     ///< Root bridge (IOHC) of the first root port
+  uint8_t   SocketB;                      ///< Socket of the second root port
+  uint8_t   RbIndexB;                     ///< Root bridge (IOHC) of the second root port
+  uint8_t   Status;                       ///< NBIO_P2P_PATH_*
+} NBIO_P2P_PATH;
+
+/// Report of the P2P paths produced from NBIOCLASS_INPUT_BLK.P2pPair
+typedef struct {
+  uint8_t       PathCount;                ///< Valid entries in Path
+  NBIO_P2P_PATH Path[NBIO_P2P_PAIR_COUNT];///< One entry per requested pair, in request order
+} NBIO_P2P_REPORT;
+
 /**
  *  Establish the NBIO class module's Input Block
  */
@@ -176,12 +217,16 @@ typedef struct {
   uint8_t   HotPlugHandlingMode;          ///< Hotplug
   uint8_t   HotplugPortReset;             ///< Hotplug
   uint8_t   HotPlugNVMEDefaultMaxPayload; ///< Hotplug
+  uint8_t   P2pPairCount;                 ///< Valid entries in P2pPair, 0 keeps the global P2P policy
+  NBIO_P2P_PAIR P2pPair[NBIO_P2P_PAIR_COUNT]; ///< Root port pairs that need peer-to-peer traffic
 } NBIOCLASS_INPUT_BLK;
 
 typedef struct {
   NBIO_CONFIG_DATA    NbioConfigData;
   // This would point to the host memory for NBIO Input block
   NBIOCLASS_INPUT_BLK NbioInputBlk;
+  // P2P paths enabled from NbioInputBlk.P2pPair, filled after PCIe training
+  NBIO_P2P_REPORT     P2pReport;
 } NBIOCLASS_DATA_BLOCK;
 
 #pragma pack(pop)
@@ -13,6 +13,7 @@
 #include "GnbDxio.h"
 #include "NbioPcieTopologyHelper.h"
 #include "NbioCommon.h"
+#include "NbioPcieCapability.h"
 
 
 typedef GNB_HANDLE* (*NBIO_GET_HANDLE) (
@@ -37,6 +38,16 @@ typedef void (*NBIO_PCIE_CONFIG_RUNPROC_FORALL_ENGINES) (
   PCIe_PLATFORM_CONFIG            *Pcie
   );
 
+typedef void (*NBIO_PCIE_CONFIG_RUNPROC_FORALL_ACTIVE_ENGINES) (
+  PCIe_RUN_ON_ENGINE_CALLBACK     Callback,
+  void                            *Buffer,
+  PCIe_PLATFORM_CONFIG            *Pcie
+  );
+
+typedef void (*NBIO_PCIE_CONFIG_UPDATE_ACTIVE_ENGINE_INDEX) (
+  PCIe_PLATFORM_CONFIG            *Pcie
+  );
+
 typedef void (*NBIO_PCIE_CONFIG_RUNPROC_FORALL_ENGINES_WRAPPER) (
   uint32_t                         DescriptorFlags,
   PCIe_RUN_ON_ENGINE_CALLBACK2     Callback,
@@ -63,6 +74,10 @@ typedef bool (*NBIO_PCIE_CONFIG_CHECK_PORT_STATUS) (
   uint32_t                         PortStatus
   );
 
+typedef void (*NBIO_PCIE_P2P_INIT) (
+  PCIe_PLATFORM_CONFIG             *Pcie
+  );
+
 typedef SIL_STATUS (*NBIO_GET_VERSION_INFO) (
   uint8_t                          *VerString
   );
@@ -80,6 +95,32 @@ typedef PCIe_DESCRIPTOR_HEADER* (*NBIO_PCIE_CONFIG_GET_PARENT) (
   PCIe_DESCRIPTOR_HEADER            *Descriptor
   );
 
+typedef uint8_t (*NBIO_PCIE_FIND_CAPABILITY) (
+  uint32_t                          Address,
+  uint8_t                           CapabilityId
+  );
+
+typedef uint16_t (*NBIO_PCIE_FIND_EXTENDED_CAPABILITY) (
+  uint32_t                          Address,
+  uint16_t                          ExtendedCapabilityId
+  );
+
+typedef uint16_t (*NBIO_PCIE_FIND_NEXT_EXTENDED_CAPABILITY) (
+  uint32_t                          Address,
+  uint16_t                          StartCapabilityPtr,
+  uint16_t                          ExtendedCapabilityId
+  );
+
+typedef uint16_t (*NBIO_PCIE_FIND_DVSEC) (
+  uint32_t                          Address,
+  uint16_t                          DvsecVendorId,
+  uint16_t                          DvsecId
+  );
+
+typedef void (*NBIO_PCIE_CAPABILITY_INVALIDATE_BUS) (
+  uint32_t                          Address
+  );
+
 // Define the Ip2Ip API as a struct containing pointers to the above functions
 
 typedef struct {
@@ -90,9 +131,17 @@ typedef struct {
   NBIO_PCIE_CONFIG_GET_CHILD                       PcieConfigGetChild;
   NBIO_PCIE_CONFIG_GET_PARENT                      PcieConfigGetParent;
   NBIO_PCIE_CONFIG_RUNPROC_FORALL_ENGINES          PcieConfigRunProcForAllEngines;
+  NBIO_PCIE_CONFIG_RUNPROC_FORALL_ACTIVE_ENGINES   PcieConfigRunProcForAllActiveEngines;
+  NBIO_PCIE_CONFIG_UPDATE_ACTIVE_ENGINE_INDEX      PcieConfigUpdateActiveEngineIndex;
   NBIO_PCIE_CONFIG_RUNPROC_FORALL_ENGINES_WRAPPER  PcieConfigRunProcForAllEnginesInWrapper;
   NBIO_PCIE_CONFIG_RUNPROC_FORALL_WRAPPERS         PcieConfigRunProcForAllWrappers;
   NBIO_PCIE_CONFIG_RUNPROC_FORALL_WRAPPERS_NBIO    PcieConfigRunProcForAllWrappersInNbio;
   NBIO_PCIE_CONFIG_CHECK_PORT_STATUS               PcieConfigCheckPortStatus;
+  NBIO_PCIE_FIND_CAPABILITY                        PcieFindCapability;
+  NBIO_PCIE_FIND_EXTENDED_CAPABILITY               PcieFindExtendedCapability;
+  NBIO_PCIE_FIND_NEXT_EXTENDED_CAPABILITY          PcieFindNextExtendedCapability;
+  NBIO_PCIE_FIND_DVSEC                             PcieFindDvsec;
+  NBIO_PCIE_CAPABILITY_INVALIDATE_BUS              PcieCapabilityInvalidateBus;
+  NBIO_PCIE_P2P_INIT                               PcieP2pInit;
   NBIO_GET_VERSION_INFO                            GetVersionInfo;
 } NBIO_IP2IP_API;
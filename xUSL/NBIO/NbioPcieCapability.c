@@ -0,0 +1,457 @@
+/**
+ * @file  NbioPcieCapability.c
+ * @brief Per-BDF PCI/PCIe capability map cache
+ *
+ * @details Each PCI function's legacy and extended capability chains (including the vendor and ID of
+ *          every DVSEC instance) are recorded by a single config space walk the first time the function
+ *          is looked up. Later lookups cost one Device/Vendor ID read to validate the entry and are
+ *          otherwise served from the map kept in the NBIO PCIe information block.
+ */
+/* Copyright 2023 Advanced Micro Devices, Inc. All rights reserved.    */
+// SPDX-License-Identifier: MIT
+
+#include <SilCommon.h>
+#include <xSIM.h>
+#include <Pci.h>
+#include <string.h>
+#include "Nbio.h"
+#include "NbioPcieCapability.h"
+
+#define PCIE_CAP_MAP_ADDRESS_MASK   0xFFFFF000ul    ///< Segment/Bus/Device/Function bits of a PCI address
+#define PCIE_CAP_MAP_BUS_MASK       0xFFF00000ul    ///< Segment/Bus bits of a PCI address
+#define PCIE_CAP_MAX_LEGACY_WALK    48              ///< (0x100 - 0x40) / 4 capabilities at most
+#define PCIE_CAP_MAX_EXT_WALK       960             ///< (0x1000 - 0x100) / 4 capabilities at most
+
+/*----------------------------------------------------------------------------------------*/
+/**
+ * PcieGetCapabilityMapCache
+ *
+ * Locate the capability map cache in the NBIO PCIe information block
+ *
+ * @retval      Pointer to the cache, NULL before the PCIe topology has been created
+ */
+static
+PCIe_CAP_MAP_CACHE*
+PcieGetCapabilityMapCache (
+  void
+  )
+{
+  NORTH_BRIDGE_PCIE_SIB *NbPcieData;
+
+  NbPcieData = (NORTH_BRIDGE_PCIE_SIB *) xUslFindStructure (SilId_NorthBridgePcie, 0);
+  if (NbPcieData == NULL) {
+    return NULL;
+  }
+  return &NbPcieData->CapMapCache;
+}
+
+/*----------------------------------------------------------------------------------------*/
+/**
+ * PcieWalkCapability
+ *
+ * Walk the legacy capability chain directly from config space
+ *
+ * @param       Address         PCI address of the function
+ * @param       CapabilityPtr   Offset of the first capability to examine
+ * @param       CapabilityId    Capability ID to find
+ * @retval      Offset of the capability, 0 if not found
+ */
+static
+uint8_t
+PcieWalkCapability (
+  uint32_t  Address,
+  uint8_t   CapabilityPtr,
+  uint8_t   CapabilityId
+  )
+{
+  uint16_t  Header;
+  uint32_t  Count;
+
+  for (Count = 0; (Count < PCIE_CAP_MAX_LEGACY_WALK) && (CapabilityPtr >= PCIE_CAP_LIST_START); Count++) {
+    Header = xUSLPciRead16 (Address | CapabilityPtr);
+    if ((uint8_t) Header == CapabilityId) {
+      return CapabilityPtr;
+    }
+    CapabilityPtr = (uint8_t) (Header >> 8) & 0xFC;
+  }
+  return 0;
+}
+
+/*----------------------------------------------------------------------------------------*/
+/**
+ * PcieWalkExtendedCapability
+ *
+ * Walk the extended capability chain directly from config space
+ *
+ * @param       Address               PCI address of the function
+ * @param       CapabilityPtr         Offset of the first extended capability to examine
+ * @param       ExtendedCapabilityId  Extended capability ID to find
+ * @param       DvsecVendorId         DVSEC Vendor ID to match, 0 to match any extended capability
+ * @param       DvsecId               DVSEC ID to match (only with DvsecVendorId)
+ * @retval      Offset of the extended capability, 0 if not found
+ */
+static
+uint16_t
+PcieWalkExtendedCapability (
+  uint32_t  Address,
+  uint16_t  CapabilityPtr,
+  uint16_t  ExtendedCapabilityId,
+  uint16_t  DvsecVendorId,
+  uint16_t  DvsecId
+  )
+{
+  uint32_t  Header;
+  uint32_t  Count;
+
+  for (Count = 0; (Count < PCIE_CAP_MAX_EXT_WALK) && (CapabilityPtr >= PCIE_EXT_CAP_START); Count++) {
+    Header = xUSLPciRead32 (Address | CapabilityPtr);
+    if ((Header == 0) || (Header == 0xFFFFFFFF)) {
+      break;
+    }
+    if ((uint16_t) Header == ExtendedCapabilityId) {
+      if ((DvsecVendorId == 0) ||
+          ((xUSLPciRead16 (Address | (CapabilityPtr + PCIE_DVSEC_HEADER1_OFFSET)) == DvsecVendorId) &&
+           (xUSLPciRead16 (Address | (CapabilityPtr + PCIE_DVSEC_HEADER2_OFFSET)) == DvsecId))) {
+        return CapabilityPtr;
+      }
+    }
+    CapabilityPtr = (uint16_t) ((Header >> 20) & 0xFFC);
+  }
+  return 0;
+}
+
+/*----------------------------------------------------------------------------------------*/
+/**
+ * PcieBuildCapabilityMap
+ *
+ * Record the legacy and extended capability chains of a function in a single config space pass.
+ * Chains longer than the map are marked with a resume offset so lookups can finish the walk.
+ *
+ * @param       Address         PCI address of the function, register bits clear
+ * @param       DeviceVendorId  Device/Vendor ID read from the function
+ * @param       Map             Map to fill
+ */
+static
+void
+PcieBuildCapabilityMap (
+  uint32_t      Address,
+  uint32_t      DeviceVendorId,
+  PCIe_CAP_MAP  *Map
+  )
+{
+  uint8_t   CapabilityPtr;
+  uint16_t  ExtCapabilityPtr;
+  uint16_t  Header;
+  uint32_t  ExtHeader;
+  uint32_t  Count;
+  bool      IsPcie;
+  PCIe_EXT_CAP_MAP_ENTRY *ExtCap;
+
+  memset (Map, 0, sizeof (PCIe_CAP_MAP));
+  Map->Address = Address;
+  Map->DeviceVendorId = DeviceVendorId;
+  IsPcie = false;
+
+  CapabilityPtr = xUSLPciRead8 (Address | PCIE_CAP_LIST_POINTER) & 0xFC;
+  for (Count = 0; (Count < PCIE_CAP_MAX_LEGACY_WALK) && (CapabilityPtr >= PCIE_CAP_LIST_START); Count++) {
+    if (Map->NumberOfCaps == PCIE_CAP_MAP_MAX_CAPS) {
+      Map->CapResume = CapabilityPtr;
+      // The PCIe capability may be past the end of the map
+      IsPcie = IsPcie || (PcieWalkCapability (Address, CapabilityPtr, PCIE_CAP_ID_EXPRESS) != 0);
+      break;
+    }
+    Header = xUSLPciRead16 (Address | CapabilityPtr);
+    Map->Cap[Map->NumberOfCaps].Id = (uint8_t) Header;
+    Map->Cap[Map->NumberOfCaps].Offset = CapabilityPtr;
+    Map->NumberOfCaps++;
+    if ((uint8_t) Header == PCIE_CAP_ID_EXPRESS) {
+      IsPcie = true;
+    }
+    CapabilityPtr = (uint8_t) (Header >> 8) & 0xFC;
+  }
+
+  if (IsPcie) {
+    ExtCapabilityPtr = PCIE_EXT_CAP_START;
+    for (Count = 0; (Count < PCIE_CAP_MAX_EXT_WALK) && (ExtCapabilityPtr >= PCIE_EXT_CAP_START); Count++) {
+      ExtHeader = xUSLPciRead32 (Address | ExtCapabilityPtr);
+      if ((ExtHeader == 0) || (ExtHeader == 0xFFFFFFFF)) {
+        break;
+      }
+      if (Map->NumberOfExtCaps == PCIE_CAP_MAP_MAX_EXT_CAPS) {
+        Map->ExtCapResume = ExtCapabilityPtr;
+        break;
+      }
+      ExtCap = &Map->ExtCap[Map->NumberOfExtCaps];
+      ExtCap->Id = (uint16_t) ExtHeader;
+      ExtCap->Offset = ExtCapabilityPtr;
+      if (ExtCap->Id == PCIE_EXT_CAP_ID_DVSEC) {
+        ExtCap->VendorId = xUSLPciRead16 (Address | (ExtCapabilityPtr + PCIE_DVSEC_HEADER1_OFFSET));
+        ExtCap->DvsecId = xUSLPciRead16 (Address | (ExtCapabilityPtr + PCIE_DVSEC_HEADER2_OFFSET));
+      }
+      Map->NumberOfExtCaps++;
+      ExtCapabilityPtr = (uint16_t) ((ExtHeader >> 20) & 0xFFC);
+    }
+  }
+  Map->Valid = 1;
+}
+
+/*----------------------------------------------------------------------------------------*/
+/**
+ * PcieGetCapabilityMap
+ *
+ * Get the capability map of a function, building and caching it on first use. Before the NBIO PCIe
+ * information block exists the map is built into the caller's scratch buffer instead.
+ *
+ * @param       Address         PCI address of the function
+ * @param       Scratch         Map storage used when there is no cache
+ * @retval      Pointer to the map, NULL if no function is present at Address
+ */
+static
+const PCIe_CAP_MAP*
+PcieGetCapabilityMap (
+  uint32_t      Address,
+  PCIe_CAP_MAP  *Scratch
+  )
+{
+  PCIe_CAP_MAP_CACHE  *Cache;
+  PCIe_CAP_MAP        *Map;
+  uint32_t            DeviceVendorId;
+  uint32_t            Index;
+
+  Address &= PCIE_CAP_MAP_ADDRESS_MASK;
+  DeviceVendorId = xUSLPciRead32 (Address);
+  Cache = PcieGetCapabilityMapCache ();
+
+  if (DeviceVendorId == 0xFFFFFFFF) {
+    if (Cache != NULL) {
+      for (Index = 0; Index < PCIE_CAP_MAP_CACHE_ENTRIES; Index++) {
+        if (Cache->Map[Index].Valid && (Cache->Map[Index].Address == Address)) {
+          Cache->Map[Index].Valid = 0;
+        }
+      }
+    }
+    return NULL;
+  }
+
+  if (Cache == NULL) {
+    PcieBuildCapabilityMap (Address, DeviceVendorId, Scratch);
+    return Scratch;
+  }
+
+  Map = NULL;
+  for (Index = 0; Index < PCIE_CAP_MAP_CACHE_ENTRIES; Index++) {
+    if (Cache->Map[Index].Valid && (Cache->Map[Index].Address == Address)) {
+      Map = &Cache->Map[Index];
+      if (Map->DeviceVendorId == DeviceVendorId) {
+        Cache->Hits++;
+        return Map;
+      }
+      break;
+    }
+  }
+
+  if (Map == NULL) {
+    for (Index = 0; Index < PCIE_CAP_MAP_CACHE_ENTRIES; Index++) {
+      if (!Cache->Map[Index].Valid) {
+        Map = &Cache->Map[Index];
+        break;
+      }
+    }
+  }
+  if (Map == NULL) {
+    Map = &Cache->Map[Cache->NextVictim];
+    Cache->NextVictim = (uint8_t) ((Cache->NextVictim + 1) % PCIE_CAP_MAP_CACHE_ENTRIES);
+  }
+
+  Cache->Misses++;
+  PcieBuildCapabilityMap (Address, DeviceVendorId, Map);
+  NBIO_TRACEPOINT (
+    SIL_TRACE_INFO,
+    "Capability map for 0x%x: %d caps, %d extended caps\n",
+    Address,
+    Map->NumberOfCaps,
+    Map->NumberOfExtCaps
+    );
+  return Map;
+}
+
+/*----------------------------------------------------------------------------------------*/
+/**
+ * PcieFindCapability
+ *
+ * Find a PCI capability of a function
+ *
+ * @param       Address         PCI address of the function
+ * @param       CapabilityId    PCI capability ID
+ * @retval      Offset of the capability, 0 if not found or no function is present
+ */
+uint8_t
+PcieFindCapability (
+  uint32_t  Address,
+  uint8_t   CapabilityId
+  )
+{
+  PCIe_CAP_MAP        Scratch;
+  const PCIe_CAP_MAP  *Map;
+  uint32_t            Index;
+
+  Map = PcieGetCapabilityMap (Address, &Scratch);
+  if (Map == NULL) {
+    return 0;
+  }
+  for (Index = 0; Index < Map->NumberOfCaps; Index++) {
+    if (Map->Cap[Index].Id == CapabilityId) {
+      return Map->Cap[Index].Offset;
+    }
+  }
+  if (Map->CapResume != 0) {
+    return PcieWalkCapability (Map->Address, Map->CapResume, CapabilityId);
+  }
+  return 0;
+}
+
+/*----------------------------------------------------------------------------------------*/
+/**
+ * PcieFindNextExtendedCapability
+ *
+ * Find the next instance of a PCIe extended capability after a given offset
+ *
+ * @param       Address               PCI address of the function
+ * @param       StartCapabilityPtr    Offset of the previous instance, 0 to start at the head of the chain
+ * @param       ExtendedCapabilityId  Extended PCIe capability ID
+ * @retval      Offset of the extended capability, 0 if not found or no function is present
+ */
+uint16_t
+PcieFindNextExtendedCapability (
+  uint32_t  Address,
+  uint16_t  StartCapabilityPtr,
+  uint16_t  ExtendedCapabilityId
+  )
+{
+  PCIe_CAP_MAP        Scratch;
+  const PCIe_CAP_MAP  *Map;
+  uint32_t            Index;
+  bool                Started;
+
+  Map = PcieGetCapabilityMap (Address, &Scratch);
+  if (Map == NULL) {
+    return 0;
+  }
+  Started = (StartCapabilityPtr == 0);
+  for (Index = 0; Index < Map->NumberOfExtCaps; Index++) {
+    if (!Started) {
+      Started = (Map->ExtCap[Index].Offset == StartCapabilityPtr);
+      continue;
+    }
+    if (Map->ExtCap[Index].Id == ExtendedCapabilityId) {
+      return Map->ExtCap[Index].Offset;
+    }
+  }
+  if (Map->ExtCapResume != 0) {
+    if (!Started) {
+      // Previous instance was itself past the end of the map
+      return PcieWalkExtendedCapability (
+        Map->Address,
+        (uint16_t) ((xUSLPciRead32 (Map->Address | StartCapabilityPtr) >> 20) & 0xFFC),
+        ExtendedCapabilityId,
+        0,
+        0
+        );
+    }
+    return PcieWalkExtendedCapability (Map->Address, Map->ExtCapResume, ExtendedCapabilityId, 0, 0);
+  }
+  return 0;
+}
+
+/*----------------------------------------------------------------------------------------*/
+/**
+ * PcieFindExtendedCapability
+ *
+ * Find the first instance of a PCIe extended capability
+ *
+ * @param       Address               PCI address of the function
+ * @param       ExtendedCapabilityId  Extended PCIe capability ID
+ * @retval      Offset of the extended capability, 0 if not found or no function is present
+ */
+uint16_t
+PcieFindExtendedCapability (
+  uint32_t  Address,
+  uint16_t  ExtendedCapabilityId
+  )
+{
+  return PcieFindNextExtendedCapability (Address, 0, ExtendedCapabilityId);
+}
+
+/*----------------------------------------------------------------------------------------*/
+/**
+ * PcieFindDvsec
+ *
+ * Find a Designated Vendor-Specific Extended Capability by vendor and DVSEC ID
+ *
+ * @param       Address         PCI address of the function
+ * @param       DvsecVendorId   DVSEC Vendor ID
+ * @param       DvsecId         DVSEC ID
+ * @retval      Offset of the DVSEC, 0 if not found or no function is present
+ */
+uint16_t
+PcieFindDvsec (
+  uint32_t  Address,
+  uint16_t  DvsecVendorId,
+  uint16_t  DvsecId
+  )
+{
+  PCIe_CAP_MAP        Scratch;
+  const PCIe_CAP_MAP  *Map;
+  uint32_t            Index;
+
+  Map = PcieGetCapabilityMap (Address, &Scratch);
+  if (Map == NULL) {
+    return 0;
+  }
+  for (Index = 0; Index < Map->NumberOfExtCaps; Index++) {
+    if ((Map->ExtCap[Index].Id == PCIE_EXT_CAP_ID_DVSEC) &&
+        (Map->ExtCap[Index].VendorId == DvsecVendorId) &&
+        (Map->ExtCap[Index].DvsecId == DvsecId)) {
+      return Map->ExtCap[Index].Offset;
+    }
+  }
+  if (Map->ExtCapResume != 0) {
+    return PcieWalkExtendedCapability (
+      Map->Address,
+      Map->ExtCapResume,
+      PCIE_EXT_CAP_ID_DVSEC,
+      DvsecVendorId,
+      DvsecId
+      );
+  }
+  return 0;
+}
+
+/*----------------------------------------------------------------------------------------*/
+/**
+ * PcieCapabilityInvalidateBus
+ *
+ * Drop all cached maps for a bus. Call when a bus number is released or reassigned, since a new
+ * function of the same type at the same BDF would otherwise pass the Device/Vendor ID check.
+ *
+ * @param       Address         PCI address on the bus (device, function and register bits ignored)
+ */
+void
+PcieCapabilityInvalidateBus (
+  uint32_t  Address
+  )
+{
+  PCIe_CAP_MAP_CACHE  *Cache;
+  uint32_t            Index;
+
+  Cache = PcieGetCapabilityMapCache ();
+  if (Cache == NULL) {
+    return;
+  }
+  Address &= PCIE_CAP_MAP_BUS_MASK;
+  for (Index = 0; Index < PCIE_CAP_MAP_CACHE_ENTRIES; Index++) {
+    if ((Cache->Map[Index].Address & PCIE_CAP_MAP_BUS_MASK) == Address) {
+      Cache->Map[Index].Valid = 0;
+    }
+  }
+}
@@ -0,0 +1,35 @@
+/**
+ * @file  NbioPcieCapability.h
+ * @brief Per-BDF PCI/PCIe capability map cache declarations
+ *
+ */
+/* Copyright 2023 Advanced Micro Devices, Inc. All rights reserved.    */
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <SilCommon.h>
+
+/**********************************************************************************************************************
+ * Declare macros here
+ *
+ */
+#define PCIE_CAP_LIST_POINTER              0x34    ///< Capabilities pointer register
+#define PCIE_CAP_LIST_START                0x40    ///< First legal legacy capability offset
+#define PCIE_CAP_ID_EXPRESS                0x10    ///< PCI Express capability ID
+#define PCIE_EXT_CAP_START                 0x100   ///< First extended capability offset
+#define PCIE_EXT_CAP_ID_DVSEC              0x23    ///< Designated Vendor-Specific extended capability ID
+#define PCIE_DVSEC_HEADER1_OFFSET          0x04    ///< DVSEC Vendor ID/Revision/Length
+#define PCIE_DVSEC_HEADER2_OFFSET          0x08    ///< DVSEC ID
+
+/**********************************************************************************************************************
+ * Declare function prototypes here
+ *
+ */
+uint8_t PcieFindCapability (uint32_t Address, uint8_t CapabilityId);
+uint16_t PcieFindExtendedCapability (uint32_t Address, uint16_t ExtendedCapabilityId);
+uint16_t PcieFindNextExtendedCapability (
+  uint32_t Address, uint16_t StartCapabilityPtr, uint16_t ExtendedCapabilityId
+  );
+uint16_t PcieFindDvsec (uint32_t Address, uint16_t DvsecVendorId, uint16_t DvsecId);
+void PcieCapabilityInvalidateBus (uint32_t Address);
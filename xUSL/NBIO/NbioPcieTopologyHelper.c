@@ -11,6 +11,7 @@
 #include "Nbio.h"
 #include "NbioCommon.h"
 #include "NbioPcieTopologyHelper.h"
+#include <string.h>
 
 
 /*----------------------------------------------------------------------------------------*/
@@ -184,6 +185,118 @@ PcieConfigUpdatePortStatus (
   return Engine->InitStatus;
 }
 
+/*----------------------------------------------------------------------------------------*/
+/**
+ * Get the flattened topology index
+ *
+ * The PCIe platform config is the first member of the NBIO PCIe information block, so the
+ * index is located directly from the platform config pointer.
+ *
+ * @param[in]  Pcie            Pointer to global PCIe configuration
+ * @retval                     Pointer to the index, NULL if it has not been built or is stale
+ */
+static
+PCIe_TOPOLOGY_INDEX*
+PcieConfigGetTopologyIndex (
+  PCIe_PLATFORM_CONFIG  *Pcie
+  )
+{
+  PCIe_TOPOLOGY_INDEX   *TopologyIndex;
+
+  TopologyIndex = &((NORTH_BRIDGE_PCIE_SIB *) Pcie)->TopologyIndex;
+  return (TopologyIndex->Valid != 0) ? TopologyIndex : NULL;
+}
+
+/*----------------------------------------------------------------------------------------*/
+/**
+ * Rebuild the active PCIe engine subset of the topology index
+ *
+ * Engine activity depends on training results and hotplug settings, so this must be called
+ * again whenever those change (e.g. after MPIO link training or CXL port detection).
+ *
+ * @param[in]  Pcie            Pointer to global PCIe configuration
+ */
+void
+PcieConfigUpdateActiveEngineIndex (
+  PCIe_PLATFORM_CONFIG  *Pcie
+  )
+{
+  PCIe_TOPOLOGY_INDEX   *TopologyIndex;
+  PCIe_ENGINE_CONFIG    *Engine;
+  uint32_t              Index;
+
+  TopologyIndex = PcieConfigGetTopologyIndex (Pcie);
+  if (TopologyIndex == NULL) {
+    return;
+  }
+
+  TopologyIndex->NumberOfActiveEngines = 0;
+  for (Index = 0; Index < TopologyIndex->NumberOfEngines; Index++) {
+    Engine = (PCIe_ENGINE_CONFIG *) PCIE_TOPOLOGY_INDEX_ENTRY (Pcie, TopologyIndex->Engine[Index]);
+    if (PcieConfigIsPcieEngine (Engine) && PcieConfigIsActivePcieEngine (Engine)) {
+      TopologyIndex->ActiveEngine[TopologyIndex->NumberOfActiveEngines++] = TopologyIndex->Engine[Index];
+    }
+  }
+  NBIO_TRACEPOINT (SIL_TRACE_INFO, "Active PCIe engines: %d of %d\n",
+    TopologyIndex->NumberOfActiveEngines,
+    TopologyIndex->NumberOfEngines
+    );
+}
+
+/*----------------------------------------------------------------------------------------*/
+/**
+ * Build the flattened topology index
+ *
+ * Walks the linked wrapper and engine descriptors once and records them in topology order so
+ * the RunProcForAll* iterators can walk dense arrays. Must be called again after the linked
+ * topology is modified (e.g. when a PCIe core is hidden). If the topology does not fit the
+ * index, the index is left invalid and the iterators fall back to the linked walk.
+ *
+ * @param[in]  Pcie            Pointer to global PCIe configuration
+ */
+void
+PcieConfigBuildTopologyIndex (
+  PCIe_PLATFORM_CONFIG  *Pcie
+  )
+{
+  PCIe_TOPOLOGY_INDEX     *TopologyIndex;
+  PCIe_DESCRIPTOR_HEADER  *Descriptor;
+
+  TopologyIndex = &((NORTH_BRIDGE_PCIE_SIB *) Pcie)->TopologyIndex;
+  memset (TopologyIndex, 0, sizeof (PCIe_TOPOLOGY_INDEX));
+
+  Descriptor = PcieConfigGetChild (DESCRIPTOR_ALL_WRAPPERS, &Pcie->Header);
+  while (Descriptor != NULL) {
+    if (TopologyIndex->NumberOfWrappers >= MAX_NUM_OF_PCIE_WRAPPERS_INDEXED) {
+      NBIO_TRACEPOINT (SIL_TRACE_ERROR, "Too many wrappers for the topology index.\n");
+      return;
+    }
+    TopologyIndex->Wrapper[TopologyIndex->NumberOfWrappers++] =
+      (uint32_t) ((uint8_t *) Descriptor - (uint8_t *) Pcie);
+    Descriptor = (PCIe_DESCRIPTOR_HEADER *) PcieConfigGetNextTopologyDescriptor (Descriptor,
+                                                                                 DESCRIPTOR_TERMINATE_TOPOLOGY);
+  }
+
+  Descriptor = PcieConfigGetChild (DESCRIPTOR_ALL_ENGINES, &Pcie->Header);
+  while (Descriptor != NULL) {
+    if (TopologyIndex->NumberOfEngines >= MAX_NUM_OF_PCIE_ENGINES_INDEXED) {
+      NBIO_TRACEPOINT (SIL_TRACE_ERROR, "Too many engines for the topology index.\n");
+      return;
+    }
+    TopologyIndex->Engine[TopologyIndex->NumberOfEngines++] =
+      (uint32_t) ((uint8_t *) Descriptor - (uint8_t *) Pcie);
+    Descriptor = (PCIe_DESCRIPTOR_HEADER *) PcieConfigGetNextTopologyDescriptor (Descriptor,
+                                                                                 DESCRIPTOR_TERMINATE_TOPOLOGY);
+  }
+
+  TopologyIndex->Valid = 1;
+  NBIO_TRACEPOINT (SIL_TRACE_INFO, "Topology index: %d wrappers, %d engines\n",
+    TopologyIndex->NumberOfWrappers,
+    TopologyIndex->NumberOfEngines
+    );
+  PcieConfigUpdateActiveEngineIndex (Pcie);
+}
+
 /*----------------------------------------------------------------------------------------*/
 /**
  * Execute callback on all descriptor of specific type
@@ -209,8 +322,38 @@ PcieConfigRunProcForAllDescriptors (
   SIL_STATUS              ConfigStatus;
   SIL_STATUS              Status;
   PCIe_DESCRIPTOR_HEADER  *Descriptor;
+  PCIe_TOPOLOGY_INDEX     *TopologyIndex;
+  uint32_t                *IndexList;
+  uint32_t                IndexCount;
+  uint32_t                Index;
 
   ConfigStatus = SilPass;
+  TopologyIndex = PcieConfigGetTopologyIndex (Pcie);
+  IndexList = NULL;
+  IndexCount = 0;
+  // Whole-topology walks of a single descriptor class can be served from the flattened index
+  if ((TopologyIndex != NULL) && (TerminationFlags == DESCRIPTOR_TERMINATE_TOPOLOGY)) {
+    if ((InDescriptorFlags & DESCRIPTOR_ALL_TYPES & ~DESCRIPTOR_ALL_ENGINES) == 0) {
+      IndexList = TopologyIndex->Engine;
+      IndexCount = TopologyIndex->NumberOfEngines;
+    } else if ((InDescriptorFlags & DESCRIPTOR_ALL_TYPES & ~DESCRIPTOR_ALL_WRAPPERS) == 0) {
+      IndexList = TopologyIndex->Wrapper;
+      IndexCount = TopologyIndex->NumberOfWrappers;
+    }
+  }
+
+  if (IndexList != NULL) {
+    for (Index = 0; Index < IndexCount; Index++) {
+      Descriptor = (PCIe_DESCRIPTOR_HEADER *) PCIE_TOPOLOGY_INDEX_ENTRY (Pcie, IndexList[Index]);
+      if ((InDescriptorFlags & Descriptor->DescriptorFlags) != 0 &&
+          (OutDescriptorFlags && Descriptor->DescriptorFlags) == 0) {
+        Status = Callback (Descriptor, Buffer, Pcie);
+        SIL_STATUS_UPDATE (Status, ConfigStatus);
+      }
+    }
+    return ConfigStatus;
+  }
+
   Descriptor = PcieConfigGetChild (InDescriptorFlags & DESCRIPTOR_ALL_TYPES, &Pcie->Header);
   while (Descriptor != NULL) {
     if ((InDescriptorFlags & Descriptor->DescriptorFlags) != 0 &&
@@ -244,8 +387,22 @@ PcieConfigRunProcForAllWrappers (
   SIL_STATUS            SilStatus;
   SIL_STATUS            Status;
   PCIe_WRAPPER_CONFIG   *Wrapper;
+  PCIe_TOPOLOGY_INDEX   *TopologyIndex;
+  uint32_t              Index;
 
   SilStatus = SilPass;
+  TopologyIndex = PcieConfigGetTopologyIndex (Pcie);
+  if (TopologyIndex != NULL) {
+    for (Index = 0; Index < TopologyIndex->NumberOfWrappers; Index++) {
+      Wrapper = (PCIe_WRAPPER_CONFIG *) PCIE_TOPOLOGY_INDEX_ENTRY (Pcie, TopologyIndex->Wrapper[Index]);
+      if ((DescriptorFlags & DESCRIPTOR_ALL_WRAPPERS & Wrapper->Header.DescriptorFlags) != 0) {
+        Status = Callback (Wrapper, Buffer, Pcie);
+        SIL_STATUS_UPDATE (Status, SilStatus);
+      }
+    }
+    return SilStatus;
+  }
+
   Wrapper = (PCIe_WRAPPER_CONFIG *) PcieConfigGetChild (DESCRIPTOR_ALL_WRAPPERS, &Pcie->Header);
   while (Wrapper != NULL) {
     if ((DescriptorFlags & DESCRIPTOR_ALL_WRAPPERS & Wrapper->Header.DescriptorFlags) != 0) {
@@ -309,6 +466,22 @@ PcieConfigRunProcForAllEngines (
 {
 
   PCIe_ENGINE_CONFIG  *Engine;
+  PCIe_TOPOLOGY_INDEX *TopologyIndex;
+  uint32_t            Index;
+
+  TopologyIndex = PcieConfigGetTopologyIndex (Pcie);
+  if (TopologyIndex != NULL) {
+    for (Index = 0; Index < TopologyIndex->NumberOfEngines; Index++) {
+      Engine = (PCIe_ENGINE_CONFIG *) PCIE_TOPOLOGY_INDEX_ENTRY (Pcie, TopologyIndex->Engine[Index]);
+      if (!((DescriptorFlags & DESCRIPTOR_ALLOCATED) != 0 && !PcieLibIsEngineAllocated (Engine))) {
+        if ((Engine->Header.DescriptorFlags & DESCRIPTOR_ALL_ENGINES & DescriptorFlags) != 0) {
+          Callback (Engine, Buffer, Pcie);
+        }
+      }
+    }
+    return;
+  }
+
   Engine = (PCIe_ENGINE_CONFIG *) PcieConfigGetChild (DESCRIPTOR_ALL_ENGINES, &Pcie->Header);
   while (Engine != NULL) {
     if (!((DescriptorFlags & DESCRIPTOR_ALLOCATED) != 0 && !PcieLibIsEngineAllocated (Engine))) {
@@ -320,6 +493,47 @@ PcieConfigRunProcForAllEngines (
   }
 }
 
+/*----------------------------------------------------------------------------------------*/
+/**
+ * Execute callback on all active PCIe engines in topology
+ *
+ * Walks the active engine subset of the topology index (see PcieConfigIsActivePcieEngine).
+ * Falls back to a filtered walk of all engines if the index has not been built.
+ *
+ * @param[in]       Callback        Pointer to callback function
+ * @param[in, out]  Buffer          Pointer to buffer to pass information to callback
+ * @param[in]       Pcie            Pointer to global PCIe configuration
+ */
+
+void
+PcieConfigRunProcForAllActiveEngines (
+  PCIe_RUN_ON_ENGINE_CALLBACK   Callback,
+  void                          *Buffer,
+  PCIe_PLATFORM_CONFIG          *Pcie
+  )
+{
+  PCIe_ENGINE_CONFIG  *Engine;
+  PCIe_TOPOLOGY_INDEX *TopologyIndex;
+  uint32_t            Index;
+
+  TopologyIndex = PcieConfigGetTopologyIndex (Pcie);
+  if (TopologyIndex != NULL) {
+    for (Index = 0; Index < TopologyIndex->NumberOfActiveEngines; Index++) {
+      Engine = (PCIe_ENGINE_CONFIG *) PCIE_TOPOLOGY_INDEX_ENTRY (Pcie, TopologyIndex->ActiveEngine[Index]);
+      Callback (Engine, Buffer, Pcie);
+    }
+    return;
+  }
+
+  Engine = (PCIe_ENGINE_CONFIG *) PcieConfigGetChild (DESCRIPTOR_ALL_ENGINES, &Pcie->Header);
+  while (Engine != NULL) {
+    if (PcieConfigIsPcieEngine (Engine) && PcieConfigIsActivePcieEngine (Engine)) {
+      Callback (Engine, Buffer, Pcie);
+    }
+    Engine = (PCIe_ENGINE_CONFIG *) PcieConfigGetNextTopologyDescriptor (Engine, DESCRIPTOR_TERMINATE_TOPOLOGY);
+  }
+}
+
 /*----------------------------------------------------------------------------------------*/
 /**
  * Execute callback on all engine in wrapper
@@ -21,6 +21,9 @@ if (Current > Aggregated) { \
   Aggregated = Current; \
 }
 
+/// Convert a topology index entry (offset from the platform config) to a descriptor pointer
+#define PCIE_TOPOLOGY_INDEX_ENTRY(Pcie, Offset) \
+  ((void *) ((uint8_t *) (Pcie) + (Offset)))
 
 typedef SIL_STATUS (*PCIe_RUN_ON_DESCRIPTOR_CALLBACK)
   (PCIe_DESCRIPTOR_HEADER *Descriptor, void *Buffer, PCIe_PLATFORM_CONFIG *Pcie);
@@ -51,6 +54,11 @@ void PcieConfigDebugDump (PCIe_PLATFORM_CONFIG *Pcie);
 void PcieConfigRunProcForAllEngines (
   uint32_t DescriptorFlags, PCIe_RUN_ON_ENGINE_CALLBACK Callback, void *Buffer, PCIe_PLATFORM_CONFIG *Pcie
   );
+void PcieConfigRunProcForAllActiveEngines (
+  PCIe_RUN_ON_ENGINE_CALLBACK Callback, void *Buffer, PCIe_PLATFORM_CONFIG *Pcie
+  );
+void PcieConfigBuildTopologyIndex (PCIe_PLATFORM_CONFIG *Pcie);
+void PcieConfigUpdateActiveEngineIndex (PCIe_PLATFORM_CONFIG *Pcie);
 void PcieConfigRunProcForAllEnginesInWrapper (
   uint32_t DescriptorFlags, PCIe_RUN_ON_ENGINE_CALLBACK2 Callback, void *Buffer, PCIe_WRAPPER_CONFIG *Wrapper
   );
@@ -71,6 +71,72 @@ SetNbioMcaCtlMask (
   return McaCtlMask.Value;
 }
 
+/**
+ * BuildCoreMcaBankMap
+ *
+ * @brief Build the MCA bank descriptor table of the executing logical core.
+ *
+ * @details Reads MCG_CAP and the MCA_IPID of every bank once, skips the unpopulated banks and records the IP type
+ *          and the optional registers of the others, so that later MCA walkers do not need to re-discover them.
+ *
+ * @note  This function must be executed on the logical core the map describes.
+ *
+ * @param BankMap  On output, the populated banks of the executing core.
+ *
+ */
+void
+BuildCoreMcaBankMap (
+  SIL_CORE_MCA_BANK_MAP *BankMap
+  )
+{
+  SIL_MCA_IPID_MSR  McaIpid;
+  MCG_CAP_STRUCT    McgCap;
+  SIL_MCA_BANK_DESC *BankDesc;
+  uint32_t          BankNumber;
+  uint32_t          BankCount;
+
+  McgCap.Value = xUslRdMsr (MSR_MCG_CAP); // MCG_CAP
+  BankCount = (uint32_t)McgCap.Field.Count;
+  if (BankCount > XMCA_MAX_BANK_COUNT) {
+    BankCount = XMCA_MAX_BANK_COUNT;
+  }
+
+  BankMap->BankCount = 0;
+  for (BankNumber = 0; BankNumber < BankCount; BankNumber++) {
+    McaIpid.Value = xUslRdMsr ((MCA_EXTENSION_BASE + (BankNumber * SMCA_REG_PER_BANK)) | MCA_IPID_OFFSET);
+    if (McaIpid.Field.HardwareID == 0) {
+      continue;
+    }
+
+    BankDesc = &BankMap->Bank[BankMap->BankCount++];
+    BankDesc->BankNumber = (uint8_t)BankNumber;
+    BankDesc->HardwareId = (uint16_t)McaIpid.Field.HardwareID;
+    BankDesc->McaType    = (uint16_t)McaIpid.Field.McaType;
+    BankDesc->Flags      = SIL_MCA_BANK_DESTAT_VALID;
+
+    switch (BankDesc->HardwareId) {
+      case MCA_CPU_CORE_ID:
+        switch (BankDesc->McaType) {
+          case IF_MCA_TYPE:
+          case DE_MCA_TYPE:
+          case EX_MCA_TYPE:
+          case FP_MCA_TYPE:
+            BankDesc->Flags = 0;
+            break;
+        }
+        break;
+      case MCA_PARAMETER_BLOCK_ID:
+      case MCA_PSP_ID:
+      case MCA_SMU_ID:
+        BankDesc->Flags = 0;
+        break;
+      case MCA_UMC_ID:
+        BankDesc->Flags |= SIL_MCA_BANK_MISC1_VALID | SIL_MCA_BANK_SYND12_VALID;
+        break;
+    }
+  }
+}
+
 /**
  * SetIpMcaCtlMask
  *
@@ -87,21 +153,22 @@ SetNbioMcaCtlMask (
  *                        Currently supported IP structures:
  *
  *                        - SIL_NBIO_RAS_POLICY
+ * @param BankMap         Bank map of the executing core from BuildCoreMcaBankMap, or NULL to discover the banks here.
  *
  */
 void
 SetIpMcaCtlMask (
-  uint16_t          HardwareId,
-  uint16_t          McaType,
-  SIL_IP_RAS_POLICY *IpMcaPolicyCfg
+  uint16_t              HardwareId,
+  uint16_t              McaType,
+  SIL_IP_RAS_POLICY     *IpMcaPolicyCfg,
+  SIL_CORE_MCA_BANK_MAP *BankMap
   )
 {
-  SIL_MCA_IPID_MSR  McaIpid;
-  MCG_CAP_STRUCT    McgCap;
-  uint8_t           BankNumber;
-  uint8_t           BankCount;
-  uint32_t          McaCtlMaskAddr;
-  uint64_t          McaCtlMask;
+  SIL_CORE_MCA_BANK_MAP LocalBankMap;
+  SIL_MCA_BANK_DESC     *BankDesc;
+  uint32_t              Index;
+  uint32_t              McaCtlMaskAddr;
+  uint64_t              McaCtlMask;
 
   /*
    * Call IP specific functions for setting the MCA Control Mask depending
@@ -115,18 +182,18 @@ SetIpMcaCtlMask (
       McaCtlMask = 0; // For invalid HardwareID, do not mask any controls
   }
 
-  // MSR read to MCG_CAP (MSR0000_0179) to get the value of the Count field
-  McgCap.Value = xUslRdMsr (MSR_MCG_CAP); // MCG_CAP
-  BankCount = (uint8_t)(McgCap.Field.Count);
+  if (BankMap == NULL) {
+    BuildCoreMcaBankMap (&LocalBankMap);
+    BankMap = &LocalBankMap;
+  }
 
-  // For all banks
-  for (BankNumber = 0; BankNumber < BankCount; BankNumber++) {
-    // MSR read to MCA_IPID (MSRC000_2005 + (0x10 (bank size) * bank number))
-    McaIpid.Value = xUslRdMsr (((MCA_EXTENSION_BASE + (BankNumber * SMCA_REG_PER_BANK)) | MCA_IPID_OFFSET));
+  // For all populated banks
+  for (Index = 0; Index < BankMap->BankCount; Index++) {
+    BankDesc = &BankMap->Bank[Index];
     // Check for matching bank
-    if ((McaIpid.Field.HardwareID == HardwareId) && (McaIpid.Field.McaType == McaType)) {
+    if ((BankDesc->HardwareId == HardwareId) && (BankDesc->McaType == McaType)) {
       // Program the MCA_CTL_MASK register for this IP
-      McaCtlMaskAddr = MCA_CTL_MASK_BASE + BankNumber;
+      McaCtlMaskAddr = MCA_CTL_MASK_BASE + BankDesc->BankNumber;
       xUslWrMsr (McaCtlMaskAddr, McaCtlMask);
 
       /**
@@ -153,13 +220,18 @@ SetIpMcaCtlMask (
  *          defined in the Processor Programming Reference.
  *
  * @param RasCpuInfo The CPU info structure for the core to program.
+ * @param BankMap    Bank map of the executing core from BuildCoreMcaBankMap, or NULL to discover the banks here.
  *
  */
 void
 ProgramCoreMcaIpIdInstanceId (
-  SIL_CPU_INFO *RasCpuInfo
+  SIL_CPU_INFO          *RasCpuInfo,
+  SIL_CORE_MCA_BANK_MAP *BankMap
   )
 {
+  SIL_CORE_MCA_BANK_MAP LocalBankMap;
+  SIL_MCA_BANK_DESC *BankDesc;
+  uint32_t          Index;
   uint32_t          CoreMcaBankIndex;
   SIL_MCA_IPID_MSR  McaIpidMsr;
   uint8_t           CcdId;
@@ -173,18 +245,23 @@ ProgramCoreMcaIpIdInstanceId (
   ThreadId  = RasCpuInfo->ThreadID;
   SocketId  = RasCpuInfo->SocketId;
 
-  for (CoreMcaBankIndex = 0; CoreMcaBankIndex < MAX_CORE_MCA_BANK_COUNT; CoreMcaBankIndex++) {
-    if (CoreMcaBankIndex == 4) {
-      continue;
-    }
-
-    McaIpidMsr.Value = xUslRdMsr ((MCA_EXTENSION_BASE + ((CoreMcaBankIndex * SMCA_REG_PER_BANK) | MCA_IPID_OFFSET)));
+  if (BankMap == NULL) {
+    BuildCoreMcaBankMap (&LocalBankMap);
+    BankMap = &LocalBankMap;
+  }
 
-    if (McaIpidMsr.Field.HardwareID != MCA_CPU_CORE_ID) {
-      continue; //Should not be here
+  // The core banks are the lowest numbered ones, so the walk stops at the first bank past them
+  for (Index = 0; Index < BankMap->BankCount; Index++) {
+    BankDesc = &BankMap->Bank[Index];
+    CoreMcaBankIndex = BankDesc->BankNumber;
+    if (CoreMcaBankIndex >= MAX_CORE_MCA_BANK_COUNT) {
+      break;
+    }
+    if ((CoreMcaBankIndex == 4) || (BankDesc->HardwareId != MCA_CPU_CORE_ID)) {
+      continue;
     }
 
-    switch (McaIpidMsr.Field.McaType) {
+    switch (BankDesc->McaType) {
       case LS_MCA_TYPE:
         CoreMcaSmnAddrByte1 = LS_THR0_SMNADDR_BYTE1;
         break;
@@ -208,6 +285,7 @@ ProgramCoreMcaIpIdInstanceId (
         break;
     }
 
+    McaIpidMsr.Value = xUslRdMsr ((MCA_EXTENSION_BASE + ((CoreMcaBankIndex * SMCA_REG_PER_BANK) | MCA_IPID_OFFSET)));
     McaIpidMsr.Field.InstanceId = (((0x2000 | ((CcdId * 8) << 4) | (CoreId * 2)) << 16) |
       ((CoreMcaSmnAddrByte1 + ThreadId) << 8));
     McaIpidMsr.Field.InstanceIdHi = SocketId;
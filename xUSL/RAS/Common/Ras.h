@@ -27,16 +27,23 @@
         }\
   } while (0)
 
+void
+BuildCoreMcaBankMap (
+  SIL_CORE_MCA_BANK_MAP *BankMap
+  );
+
 void
 SetIpMcaCtlMask (
-  uint16_t          HardwareId,
-  uint16_t          McaType,
-  SIL_IP_RAS_POLICY *IpMcaPolicyCfg
+  uint16_t              HardwareId,
+  uint16_t              McaType,
+  SIL_IP_RAS_POLICY     *IpMcaPolicyCfg,
+  SIL_CORE_MCA_BANK_MAP *BankMap
   );
 
 void
 ProgramCoreMcaIpIdInstanceId (
-  SIL_CPU_INFO *RasCpuInfo
+  SIL_CPU_INFO          *RasCpuInfo,
+  SIL_CORE_MCA_BANK_MAP *BankMap
   );
 
 /******************************************************************************
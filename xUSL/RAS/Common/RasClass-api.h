@@ -217,6 +217,35 @@ typedef struct {
                               ///< populated by xPRF
 } SIL_CPU_MCA_INFO_BUFFER;
 
+/*
+ * SIL_MCA_BANK_DESC flags: registers of the bank that hold error information
+ */
+#define SIL_MCA_BANK_DESTAT_VALID   0x01  ///< MCA_DESTAT and MCA_DEADDR are implemented
+#define SIL_MCA_BANK_MISC1_VALID    0x02  ///< MCA_MISC1 is implemented
+#define SIL_MCA_BANK_SYND12_VALID   0x04  ///< MCA_SYND1 and MCA_SYND2 are implemented
+
+/*
+ * SIL_MCA_BANK_DESC: Descriptor of one populated MCA bank of a logical core.
+ */
+typedef struct {
+  uint8_t   BankNumber;   ///< MCA bank index
+  uint8_t   Flags;        ///< SIL_MCA_BANK_xxx_VALID flags
+  uint16_t  HardwareId;   ///< MCA_IPID.HardwareID of the bank
+  uint16_t  McaType;      ///< MCA_IPID.McaType of the bank
+} SIL_MCA_BANK_DESC;
+
+/*
+ * SIL_CORE_MCA_BANK_MAP: The populated MCA banks of a logical core.  The Host
+ *                        allocates one per thread and has it filled once at
+ *                        init by xPrfBuildCoreMcaBankMap on that thread. The
+ *                        MCA walkers then only visit the banks listed here.
+ */
+typedef struct {
+  uint32_t          BankCount;                  ///< Number of valid entries in Bank
+  SIL_MCA_BANK_DESC Bank[XMCA_MAX_BANK_COUNT];  ///< Populated banks in ascending
+                                                ///< bank number order
+} SIL_CORE_MCA_BANK_MAP;
+
 ///
 /// Platform RAS configuration data structure
 ///
@@ -276,6 +305,111 @@ typedef struct {
                           ///< resides
 } SIL_DIMM_INFO;
 
+/**
+ * @brief One address of a batched normalized address translation.
+ *
+ * @details The Host fills NormalizedAddress, xPrfMcaErrorAddrTranslateBatch fills the rest.
+ */
+typedef struct {
+  SIL_NORMALIZED_ADDRESS  NormalizedAddress;  ///< Input: UMC address to translate
+  SIL_DIMM_INFO           DimmInfo;           ///< Output: DRAM address of NormalizedAddress
+  uint64_t                SystemAddress;      ///< Output: system address of NormalizedAddress
+  bool                    Translated;         ///< Output: true when SystemAddress is valid
+} SIL_ADDR_TRANSLATE_ENTRY;
+
+/*******************************************************************************
+ * Structures used by the correctable error storm services
+ *
+ */
+
+#define SIL_CE_STORM_MAX_DIMMS      32  ///< DIMMs tracked per socket
+#define SIL_CE_STORM_MAX_BANKS      64  ///< DRAM banks tracked per socket, least recently hit are recycled
+
+/**
+ * @brief Host policy of the correctable error (CE) storm detection.
+ *
+ * @details Every DIMM and every DRAM bank has a leaky bucket: each CE adds one
+ *          to the bucket and one leaks out every LeakPeriodMs. A storm is
+ *          declared when a bucket reaches its threshold.
+ */
+typedef struct {
+  uint32_t  DimmThreshold;        ///< Bucket level that declares a storm on a DIMM
+  uint32_t  BankThreshold;        ///< Bucket level that declares a storm on a DRAM bank
+  uint32_t  LeakPeriodMs;         ///< One error leaks out of every bucket per period, must not be 0
+  uint32_t  QuietPeriodMs;        ///< Time without errors after which an MCA bank leaves storm mode
+  uint16_t  StormIntInterval;     ///< In storm mode the MCA bank thresholding interrupt is raised
+                                  ///< once per StormIntInterval errors, 0 disables it (polled mode)
+} SIL_CE_STORM_POLICY;
+
+/**
+ * @brief Leaky bucket counter.
+ */
+typedef struct {
+  uint32_t  Level;                ///< Errors currently in the bucket
+  uint64_t  LastLeakMs;           ///< Time of the last leak
+} SIL_CE_LEAKY_BUCKET;
+
+/**
+ * @brief CE rate of one DIMM, identified as in SIL_FRUTEXT_ENTRY.
+ */
+typedef struct {
+  bool                Valid;      ///< Entry is in use
+  uint8_t             Die;        ///< Die ID
+  uint8_t             Channel;    ///< Channel ID
+  uint8_t             Module;     ///< Module 0 (CS=0,1):Module 1 (CS=2,3)
+  SIL_CE_LEAKY_BUCKET Bucket;     ///< CE rate of the DIMM
+} SIL_CE_STORM_DIMM;
+
+/**
+ * @brief CE rate of one DRAM bank of a DIMM.
+ */
+typedef struct {
+  bool                Valid;      ///< Entry is in use
+  uint8_t             DimmIndex;  ///< Index of the DIMM in SIL_CE_STORM_CONTEXT.Dimm
+  uint8_t             ChipSelect; ///< Chip select of the bank
+  uint8_t             SubChan;    ///< Subchannel of the bank
+  uint8_t             Bank;       ///< DRAM bank
+  SIL_CE_LEAKY_BUCKET Bucket;     ///< CE rate of the bank
+} SIL_CE_STORM_BANK;
+
+/**
+ * @brief Storm state of one MCA bank.
+ */
+typedef struct {
+  bool      InStorm;              ///< The MCA bank runs in storm mode
+  uint64_t  SavedMisc0;           ///< MCA_MISC0 before storm mode was entered, gives the interrupt type back
+  uint64_t  LastErrorMs;          ///< Time of the last CE reported by this MCA bank
+} SIL_CE_STORM_MCA_BANK;
+
+/**
+ * @brief CE storm detection state of one socket.
+ *
+ * @details The Host allocates one context per socket, initializes it with
+ *          xPrfCeStormInit and calls the storm services on a thread of that
+ *          socket so that its UMC MCA banks are reachable.
+ */
+typedef struct {
+  SIL_CE_STORM_POLICY   Policy;                         ///< Host policy
+  bool                  McaErrThreshEn;                 ///< Normal mode thresholding, from SIL_AMD_RAS_POLICY
+  uint16_t              McaErrThreshCount;              ///< Normal mode error threshold, from SIL_AMD_RAS_POLICY
+  uint32_t              ActiveStorms;                   ///< MCA banks currently in storm mode
+  SIL_CE_STORM_DIMM     Dimm[SIL_CE_STORM_MAX_DIMMS];   ///< Per DIMM counters
+  SIL_CE_STORM_BANK     Bank[SIL_CE_STORM_MAX_BANKS];   ///< Per DRAM bank counters
+  SIL_CE_STORM_MCA_BANK McaBank[XMCA_MAX_BANK_COUNT];   ///< Per MCA bank storm state
+} SIL_CE_STORM_CONTEXT;
+
+/**
+ * @brief Storm state reported to the Host for one CE.
+ */
+typedef struct {
+  uint32_t  DimmLevel;            ///< Bucket level of the DIMM after this error
+  uint32_t  BankLevel;            ///< Bucket level of the DRAM bank after this error
+  bool      DimmStorm;            ///< The DIMM bucket reached DimmThreshold
+  bool      BankStorm;            ///< The DRAM bank bucket reached BankThreshold
+  bool      McaBankInStorm;       ///< The reporting MCA bank runs in storm mode
+  bool      StormEntered;         ///< This error moved the MCA bank into storm mode
+} SIL_CE_STORM_STATUS;
+
 #pragma pack (push, 1)
 
 /**
@@ -378,3 +512,202 @@ typedef struct {
 } RASCLASS_DATA_BLK;
 
 #pragma pack (pop)
+
+#define SIL_MCA_HARVEST_SLOT_ALIGN      64      ///< Cache line size, alignment of the harvest slots
+#define SIL_MCA_HARVEST_MAX_APIC_ID     1024    ///< Size of the APIC ID to processor number table
+#define SIL_MCA_HARVEST_NO_PROCESSOR    0xFFFF  ///< APIC ID without a processor
+
+/**
+ * @brief MCA harvest slot of one logical processor.
+ *
+ * @details The slot is written only by its own processor. Generation is
+ *          updated last, with a locked exchange, so the Host may read
+ *          ErrorInfo as soon as Generation matches the harvest generation.
+ */
+typedef struct {
+  volatile uint32_t         Generation; ///< Harvest generation of the published ErrorInfo
+  uint32_t                  ApicId;     ///< Initial APIC ID of the processor
+  SIL_RAS_MCA_ERROR_INFO_V2 ErrorInfo;  ///< MCA banks with an error
+} SIL_MCA_HARVEST_SLOT;
+
+/**
+ * @brief Per processor MCA harvest buffer.
+ *
+ * @details The Host allocates SlotCount slots of SlotSize bytes (see
+ *          xPrfGetMcaHarvestSlotSize), aligned to SIL_MCA_HARVEST_SLOT_ALIGN,
+ *          one per processor number of xPrfCollectCpuMap, and initializes the
+ *          buffer once with xPrfMcaHarvestInit. For every harvest the Host
+ *          increments Generation, runs xPrfHarvestMcaErrorInfo on all
+ *          processors at once and collects the slots whose Generation matches.
+ */
+typedef struct {
+  uint32_t              Generation;       ///< Current harvest, never 0
+  uint32_t              SlotSize;         ///< Stride of the slots in bytes
+  uint32_t              SlotCount;        ///< Number of slots
+  void                  *Slots;           ///< Host allocated slot array
+  SIL_CORE_MCA_BANK_MAP *CoreMcaBankMaps; ///< Optional bank maps indexed by processor number, or NULL
+  uint16_t              ProcessorOfApicId[SIL_MCA_HARVEST_MAX_APIC_ID]; ///< Filled by xPrfMcaHarvestInit
+} SIL_MCA_HARVEST_BUFFER;
+
+/*******************************************************************************
+ * Structures used by the CPER record services, from the UEFI specification
+ * appendix N, Common Platform Error Record
+ *
+ */
+
+#define SIL_CPER_SIGNATURE            0x52455043  ///< 'CPER'
+#define SIL_CPER_SIGNATURE_END        0xFFFFFFFF
+#define SIL_CPER_REVISION             0x0100
+#define SIL_CPER_SECTION_REVISION     0x0100
+
+/// CPER error and section severity
+#define SIL_CPER_SEVERITY_RECOVERABLE 0
+#define SIL_CPER_SEVERITY_FATAL       1
+#define SIL_CPER_SEVERITY_CORRECTED   2
+#define SIL_CPER_SEVERITY_INFO        3
+
+/// Section descriptor flags
+#define SIL_CPER_SECTION_FLAG_PRIMARY 0x00000001
+
+/// Processor generic section validation bits
+#define SIL_CPER_PROC_VALID_TYPE          0x0001
+#define SIL_CPER_PROC_VALID_ISA           0x0002
+#define SIL_CPER_PROC_VALID_ERROR_TYPE    0x0004
+#define SIL_CPER_PROC_VALID_OPERATION     0x0008
+#define SIL_CPER_PROC_VALID_FLAGS         0x0010
+#define SIL_CPER_PROC_VALID_LEVEL         0x0020
+#define SIL_CPER_PROC_VALID_TARGET_ADDR   0x0200
+
+/// Processor generic section field values
+#define SIL_CPER_PROC_TYPE_IA32_X64       0x00
+#define SIL_CPER_PROC_ISA_X64             0x02
+#define SIL_CPER_PROC_ERROR_UNKNOWN       0x00
+#define SIL_CPER_PROC_ERROR_CACHE         0x01
+#define SIL_CPER_PROC_ERROR_TLB           0x02
+#define SIL_CPER_PROC_ERROR_BUS           0x04
+#define SIL_CPER_PROC_ERROR_MICRO_ARCH    0x08
+#define SIL_CPER_PROC_OP_GENERIC          0x00
+#define SIL_CPER_PROC_OP_DATA_READ        0x01
+#define SIL_CPER_PROC_OP_DATA_WRITE       0x02
+#define SIL_CPER_PROC_OP_INSTRUCTION      0x03
+#define SIL_CPER_PROC_FLAG_RESTARTABLE    0x01
+#define SIL_CPER_PROC_FLAG_OVERFLOW       0x04
+#define SIL_CPER_PROC_FLAG_CORRECTED      0x08
+
+/// Memory error section validation bits
+#define SIL_CPER_MEM_VALID_ERROR_STATUS   0x00000001
+#define SIL_CPER_MEM_VALID_PA             0x00000002
+#define SIL_CPER_MEM_VALID_PA_MASK        0x00000004
+#define SIL_CPER_MEM_VALID_NODE           0x00000008
+#define SIL_CPER_MEM_VALID_CARD           0x00000010
+#define SIL_CPER_MEM_VALID_MODULE         0x00000020
+#define SIL_CPER_MEM_VALID_BANK           0x00000040
+#define SIL_CPER_MEM_VALID_ROW            0x00000100
+#define SIL_CPER_MEM_VALID_COLUMN         0x00000200
+#define SIL_CPER_MEM_VALID_ERROR_TYPE     0x00004000
+#define SIL_CPER_MEM_VALID_RANK           0x00008000
+#define SIL_CPER_MEM_VALID_EXTENDED_ROW   0x00040000
+
+/// Memory error section error types
+#define SIL_CPER_MEM_ERROR_UNKNOWN        0x00
+#define SIL_CPER_MEM_ERROR_SINGLE_BIT_ECC 0x02
+#define SIL_CPER_MEM_ERROR_MULTI_BIT_ECC  0x03
+
+#pragma pack (push, 1)
+
+/**
+ * @brief GUID in the UEFI byte layout.
+ */
+typedef struct {
+  uint32_t  Data1;
+  uint16_t  Data2;
+  uint16_t  Data3;
+  uint8_t   Data4[8];
+} SIL_CPER_GUID;
+
+/**
+ * @brief CPER record header (UEFI N.2.1).
+ */
+typedef struct {
+  uint32_t      SignatureStart;     ///< SIL_CPER_SIGNATURE
+  uint16_t      Revision;           ///< SIL_CPER_REVISION
+  uint32_t      SignatureEnd;       ///< SIL_CPER_SIGNATURE_END
+  uint16_t      SectionCount;       ///< Number of section descriptors
+  uint32_t      ErrorSeverity;      ///< Highest severity of the sections
+  uint32_t      ValidationBits;     ///< PlatformId, TimeStamp and PartitionId valid bits
+  uint32_t      RecordLength;       ///< Size of the record including all sections
+  uint64_t      TimeStamp;          ///< Filled by the Host
+  SIL_CPER_GUID PlatformId;         ///< Filled by the Host
+  SIL_CPER_GUID PartitionId;        ///< Filled by the Host
+  SIL_CPER_GUID CreatorId;          ///< Filled by the Host
+  SIL_CPER_GUID NotificationType;   ///< Machine check or corrected machine check
+  uint64_t      RecordId;           ///< Filled by the Host
+  uint32_t      Flags;
+  uint64_t      PersistenceInfo;
+  uint8_t       Reserved[12];
+} SIL_CPER_RECORD_HEADER;
+
+/**
+ * @brief CPER section descriptor (UEFI N.2.2).
+ */
+typedef struct {
+  uint32_t      SectionOffset;      ///< Offset of the section from the record header
+  uint32_t      SectionLength;
+  uint16_t      Revision;           ///< SIL_CPER_SECTION_REVISION
+  uint8_t       ValidationBits;
+  uint8_t       Reserved;
+  uint32_t      Flags;              ///< SIL_CPER_SECTION_FLAG_xxx
+  SIL_CPER_GUID SectionType;
+  SIL_CPER_GUID FruId;
+  uint32_t      SectionSeverity;
+  uint8_t       FruString[20];
+} SIL_CPER_SECTION_DESCRIPTOR;
+
+/**
+ * @brief Processor generic error section (UEFI N.2.4.1).
+ */
+typedef struct {
+  uint64_t  ValidationBits;         ///< SIL_CPER_PROC_VALID_xxx
+  uint8_t   ProcessorType;
+  uint8_t   ProcessorIsa;
+  uint8_t   ErrorType;
+  uint8_t   Operation;
+  uint8_t   Flags;
+  uint8_t   Level;
+  uint16_t  Reserved;
+  uint64_t  CpuVersionInfo;
+  uint8_t   CpuBrandString[128];
+  uint64_t  ProcessorId;
+  uint64_t  TargetAddress;
+  uint64_t  RequestorId;
+  uint64_t  ResponderId;
+  uint64_t  InstructionIp;
+} SIL_CPER_PROC_GENERIC_SECTION;
+
+/**
+ * @brief Platform memory error section (UEFI N.2.5).
+ */
+typedef struct {
+  uint64_t  ValidationBits;         ///< SIL_CPER_MEM_VALID_xxx
+  uint64_t  ErrorStatus;
+  uint64_t  PhysicalAddress;
+  uint64_t  PhysicalAddressMask;
+  uint16_t  Node;                   ///< Socket
+  uint16_t  Card;                   ///< UMC channel
+  uint16_t  Module;                 ///< DIMM on the channel
+  uint16_t  Bank;
+  uint16_t  Device;
+  uint16_t  Row;                    ///< Row bits 15:0
+  uint16_t  Column;
+  uint16_t  BitPosition;
+  uint64_t  RequestorId;
+  uint64_t  ResponderId;
+  uint64_t  TargetId;
+  uint8_t   ErrorType;              ///< SIL_CPER_MEM_ERROR_xxx
+  uint8_t   Extended;               ///< Row bits 17:16
+  uint16_t  RankNumber;
+  uint16_t  CardHandle;
+  uint16_t  ModuleHandle;
+} SIL_CPER_MEMORY_ERROR_SECTION;
+
+#pragma pack (pop)
@@ -35,7 +35,8 @@ static RAS_IP2IP_API mRasGenoaApi = {
   .UpdateFruTextToUmc           = UpdateFruTextToUmcGenoa,
   .SetIpMcaCtlMask              = SetIpMcaCtlMask,
   .ProgramCoreMcaIpIdInstanceId = ProgramCoreMcaIpIdInstanceId,
-  .ProgramCoreMcaConfigUmc      = ProgramCoreMcaConfigUmcGenoa
+  .ProgramCoreMcaConfigUmc      = ProgramCoreMcaConfigUmcGenoa,
+  .BuildCoreMcaBankMap          = BuildCoreMcaBankMap
 };
 
 /**
@@ -72,14 +72,20 @@ typedef uint64_t (*CALC_SYS_ADDR) (
   uint32_t      UmcPhysChannelNum
 );
 
+typedef void (*BUILD_CORE_MCA_BANK_MAP) (
+  SIL_CORE_MCA_BANK_MAP *BankMap
+  );
+
 typedef void (*SET_IP_MCA_CTL_MASK) (
-  uint16_t          HardwareId,
-  uint16_t          McaType,
-  SIL_IP_RAS_POLICY *IpMcaPolicyCfg
+  uint16_t              HardwareId,
+  uint16_t              McaType,
+  SIL_IP_RAS_POLICY     *IpMcaPolicyCfg,
+  SIL_CORE_MCA_BANK_MAP *BankMap
   );
 
 typedef void (*PROG_CORE_MCA_IPID_INST) (
-  SIL_CPU_INFO *RasCpuInfo
+  SIL_CPU_INFO          *RasCpuInfo,
+  SIL_CORE_MCA_BANK_MAP *BankMap
   );
 
 typedef void (*PROG_CORE_MCA_CFG_UMC) (
@@ -102,4 +108,5 @@ typedef struct {
   SET_IP_MCA_CTL_MASK     SetIpMcaCtlMask;
   PROG_CORE_MCA_IPID_INST ProgramCoreMcaIpIdInstanceId;
   PROG_CORE_MCA_CFG_UMC   ProgramCoreMcaConfigUmc;
+  BUILD_CORE_MCA_BANK_MAP BuildCoreMcaBankMap;
 } RAS_IP2IP_API;
@@ -0,0 +1,421 @@
+/**
+ * @file  FabricRcInitBasedOnDemand4.c
+ * @brief Fabric bus/MMIO/IO distribution sized from the MPIO platform topology for DFX
+ *
+ * Instead of splitting resources evenly, or replaying the previous boot's NV answer, each root bridge is given
+ * what the PCIe ports behind it are expected to need: a budget per port, a reservation per hot-plug slot and the
+ * BAR sizes of known endpoints. The resulting per root bridge sizes are applied with the NV variable routines.
+ */
+/* Copyright 2021-2023 Advanced Micro Devices, Inc. All rights reserved.    */
+// SPDX-License-Identifier: MIT
+
+#include "RcManager4-api.h"
+#include <DF/Df.h>
+#include <Mpio/MpioClass-api.h>
+#include "FabricRcInitDfX.h"
+#include <string.h>
+
+#define DFX_RCMGR_DEMAND_MAX_SHRINK   3               ///< Halvings of the hot-plug MMIO reservation before dropping it
+/// Last attempt, without hot-plug reservation
+#define DFX_RCMGR_DEMAND_NO_HOTPLUG   (DFX_RCMGR_DEMAND_MAX_SHRINK + 1)
+#define DFX_RCMGR_DEMAND_MAX_GROWTH   4               ///< Doublings of the MMIO demand tried for hot-add headroom
+#define DFX_RCMGR_MIN_MMIO_ALIGN      0xFFFFFull      ///< PCI bridge memory windows are 1MB aligned
+#define DFX_RCMGR_PCI_BUS_COUNT       256             ///< Buses shared by all root bridges
+#define DFX_RCMGR_MMIO_GRANULARITY    0x1000000ull    ///< Root bridge MMIO sizes are 16MB multiples
+
+/// MMIO demand of one root bridge
+typedef struct {
+  uint64_t  FixedBelow4G;         ///< Root bridge, port and known endpoint MMIO below 4G
+  uint64_t  HotplugBelow4G;       ///< Hot-plug slot reservations below 4G
+  uint64_t  FixedAbove4G;         ///< Root bridge, port and known endpoint MMIO above 4G
+  uint64_t  HotplugAbove4G;       ///< Hot-plug slot reservations above 4G
+} DFX_RCMGR_RB_MMIO_DEMAND;
+
+/**
+ * DfXRcMgrAlignMask
+ *
+ * @brief Alignment mask of a bridge window holding the given MMIO size
+ */
+static
+uint64_t
+DfXRcMgrAlignMask (
+  uint64_t  Size
+  )
+{
+  uint64_t  Align;
+
+  Align = DFX_RCMGR_MIN_MMIO_ALIGN + 1;
+  while ((Align < Size) && (Align < (1ull << 47))) {
+    Align <<= 1;
+  }
+  return Align - 1;
+}
+
+/**
+ * DfXRcMgrAddDemand
+ *
+ * @brief Adds the demand of one port, or of the root bridge itself, to a root bridge
+ *
+ * @param[in, out]    SilData       RC manager input block, ResourceSizeForEachRb is updated
+ * @param[in, out]    MmioDemand    MMIO demand of the root bridge
+ * @param[in]         Socket        Socket number
+ * @param[in]         RootBridge    Root bridge number on the socket
+ * @param[in]         Demand        Demand to add
+ * @param[in]         Hotplug       Demand is a hot-plug reservation that may be reduced to fit
+ */
+static
+void
+DfXRcMgrAddDemand (
+  DFX_RCMGR_INPUT_BLK           *SilData,
+  DFX_RCMGR_RB_MMIO_DEMAND      *MmioDemand,
+  uint32_t                      Socket,
+  uint32_t                      RootBridge,
+  const DFX_RCMGR_PORT_DEMAND   *Demand,
+  bool                          Hotplug
+  )
+{
+  DFX_FABRIC_RESOURCE_FOR_EACH_RB *Resource;
+  FABRIC_ADDR_APERTURE            *Aperture;
+  uint64_t                        AlignMask;
+
+  Resource = &SilData->ResourceSizeForEachRb;
+  Resource->PciBusNumber[Socket][RootBridge] += Demand->PciBusNumber;
+  Resource->IO[Socket][RootBridge].Size += Demand->IoSize;
+  if (Hotplug) {
+    MmioDemand->HotplugBelow4G += Demand->MmioSizeBelow4G;
+    MmioDemand->HotplugAbove4G += Demand->MmioSizeAbove4G;
+  } else {
+    MmioDemand->FixedBelow4G += Demand->MmioSizeBelow4G;
+    MmioDemand->FixedAbove4G += Demand->MmioSizeAbove4G;
+  }
+
+  if (Demand->MmioSizeBelow4G != 0) {
+    Aperture = &Resource->NonPrefetchableMmioSizeBelow4G[Socket][RootBridge];
+    AlignMask = DfXRcMgrAlignMask (Demand->MmioSizeBelow4G);
+    Aperture->Alignment = (Aperture->Alignment > AlignMask) ? Aperture->Alignment : AlignMask;
+  }
+  if (Demand->MmioSizeAbove4G != 0) {
+    Aperture = &Resource->PrefetchableMmioSizeAbove4G[Socket][RootBridge];
+    AlignMask = DfXRcMgrAlignMask (Demand->MmioSizeAbove4G);
+    Aperture->Alignment = (Aperture->Alignment > AlignMask) ? Aperture->Alignment : AlignMask;
+  }
+}
+
+/**
+ * DfXRcMgrGetPortDemand
+ *
+ * @brief Returns the budget of one MPIO port
+ *
+ * @param[in]   Policy      Demand policy
+ * @param[in]   Socket      Socket of the port
+ * @param[in]   Port        MPIO port descriptor
+ * @param[out]  Hotplug     The budget is a hot-plug reservation
+ *
+ * @retval      Known endpoint demand of the port if listed, else the port or hot-plug slot budget
+ */
+static
+const DFX_RCMGR_PORT_DEMAND *
+DfXRcMgrGetPortDemand (
+  const DFX_RCMGR_DEMAND_POLICY *Policy,
+  uint32_t                      Socket,
+  const MPIO_PORT_DESCRIPTOR    *Port,
+  bool                          *Hotplug
+  )
+{
+  uint32_t  Index;
+
+  for (Index = 0; (Index < Policy->EndpointCount) && (Index < DFX_RCMGR_MAX_ENDPOINT_DEMANDS); Index++) {
+    if ((Policy->Endpoint[Index].Socket == Socket) &&
+        (Policy->Endpoint[Index].StartLane == Port->EngineData.StartLane)) {
+      *Hotplug = false;
+      return &Policy->Endpoint[Index].Demand;
+    }
+  }
+
+  *Hotplug = (Port->Port.LinkHotplug != 0) || (Port->EngineData.HotPluggable != 0);
+  return *Hotplug ? &Policy->HotplugSlot : &Policy->Port;
+}
+
+/**
+ * DfXRcMgrCollectDemand
+ *
+ * @brief Sums the demand of every root bridge from the MPIO platform topology
+ *
+ * @param[in, out]    SilData       RC manager input block, ResourceSizeForEachRb is rebuilt
+ * @param[out]        MmioDemand    MMIO demand of each root bridge
+ *
+ * @retval            SilPass       Demand collected
+ * @retval            SilNotFound   MPIO input block is not available
+ */
+static
+SIL_STATUS
+DfXRcMgrCollectDemand (
+  DFX_RCMGR_INPUT_BLK           *SilData,
+  DFX_RCMGR_RB_MMIO_DEMAND      MmioDemand[RCMGR_MAX_SOCKETS][DFX_MAX_RBS_PER_SOCKET]
+  )
+{
+  MPIOCLASS_INPUT_BLK           *MpioData;
+  MPIO_COMPLEX_DESCRIPTOR       *Complex;
+  MPIO_PORT_DESCRIPTOR          *Port;
+  const DFX_RCMGR_PORT_DEMAND   *Demand;
+  uint32_t                      Socket;
+  uint32_t                      RootBridge;
+  uint32_t                      ComplexIndex;
+  uint32_t                      PortIndex;
+  uint32_t                      Lane;
+  bool                          Hotplug;
+
+  MpioData = (MPIOCLASS_INPUT_BLK *) SilFindStructure (SilId_MpioClass, 0);
+  if (MpioData == NULL) {
+    DF_TRACEPOINT (SIL_TRACE_ERROR, " MPIO input block not found, no topology to size resources from.\n");
+    return SilNotFound;
+  }
+
+  memset (&SilData->ResourceSizeForEachRb, 0, sizeof (SilData->ResourceSizeForEachRb));
+  memset (MmioDemand, 0, sizeof (DFX_RCMGR_RB_MMIO_DEMAND) * RCMGR_MAX_SOCKETS * DFX_MAX_RBS_PER_SOCKET);
+
+  for (Socket = 0; Socket < SilData->SocketNumber; Socket++) {
+    for (RootBridge = 0; RootBridge < SilData->RbsPerSocket; RootBridge++) {
+      DfXRcMgrAddDemand (SilData, &MmioDemand[Socket][RootBridge], Socket, RootBridge,
+        &SilData->DemandPolicy.RootBridge, false);
+    }
+  }
+
+  Complex = &MpioData->PcieTopologyData.PlatformData[0];
+  for (ComplexIndex = 0; ComplexIndex < MAX_SOCKETS_SUPPORTED; ComplexIndex++, Complex++) {
+    Socket = Complex->SocketId;
+    Port = Complex->PciePortList;
+    if ((Socket < SilData->SocketNumber) && (Port != NULL)) {
+      for (PortIndex = 0; PortIndex < MAX_PORTS_SUPPORTED; PortIndex++, Port++) {
+        if (Port->EngineData.EngineType == MpioPcieEngine) {
+          Lane = (Port->EngineData.StartLane < Port->EngineData.EndLane) ?
+            Port->EngineData.StartLane : Port->EngineData.EndLane;
+          RootBridge = DfXSilGetRbFromLane (Lane);
+          if (RootBridge >= SilData->RbsPerSocket) {
+            DF_TRACEPOINT (SIL_TRACE_WARNING, "  Lane %d has no root bridge, counted on RB0\n", Lane);
+            RootBridge = 0;
+          }
+          Demand = DfXRcMgrGetPortDemand (&SilData->DemandPolicy, Socket, Port, &Hotplug);
+          DfXRcMgrAddDemand (SilData, &MmioDemand[Socket][RootBridge], Socket, RootBridge, Demand, Hotplug);
+        }
+        if ((Port->Flags & DESCRIPTOR_TERMINATE_LIST) != 0) {
+          break;
+        }
+      }
+    }
+    if ((Complex->Flags & DESCRIPTOR_TERMINATE_LIST) != 0) {
+      break;
+    }
+  }
+
+  return SilPass;
+}
+
+/**
+ * DfXRcMgrFitPciBus
+ *
+ * @brief Scales the bus demand to the available bus numbers, spreading any spare buses evenly
+ */
+static
+void
+DfXRcMgrFitPciBus (
+  DFX_RCMGR_INPUT_BLK *SilData
+  )
+{
+  uint16_t  (*PciBus)[DFX_MAX_RBS_PER_SOCKET];
+  uint32_t  Socket;
+  uint32_t  RootBridge;
+  uint32_t  Total;
+  uint32_t  Extra;
+  uint32_t  Buses;
+
+  PciBus = SilData->ResourceSizeForEachRb.PciBusNumber;
+  Total = 0;
+  for (Socket = 0; Socket < SilData->SocketNumber; Socket++) {
+    for (RootBridge = 0; RootBridge < SilData->RbsPerSocket; RootBridge++) {
+      if (PciBus[Socket][RootBridge] == 0) {
+        PciBus[Socket][RootBridge] = 1;
+      }
+      Total += PciBus[Socket][RootBridge];
+    }
+  }
+
+  Extra = 0;
+  if (Total < DFX_RCMGR_PCI_BUS_COUNT) {
+    Extra = (DFX_RCMGR_PCI_BUS_COUNT - Total) / (SilData->SocketNumber * SilData->RbsPerSocket);
+  }
+  for (Socket = 0; Socket < SilData->SocketNumber; Socket++) {
+    for (RootBridge = 0; RootBridge < SilData->RbsPerSocket; RootBridge++) {
+      Buses = PciBus[Socket][RootBridge];
+      if (Total > DFX_RCMGR_PCI_BUS_COUNT) {
+        Buses = (Buses * DFX_RCMGR_PCI_BUS_COUNT) / Total;
+        Buses = (Buses == 0) ? 1 : Buses;
+      }
+      PciBus[Socket][RootBridge] = (uint16_t) (Buses + Extra);
+      DF_TRACEPOINT (SIL_TRACE_INFO, "  Socket%x RootBridge%x demands 0x%x buses\n",
+        Socket, RootBridge, PciBus[Socket][RootBridge]);
+    }
+  }
+}
+
+/**
+ * DfXRcMgrFitIo
+ *
+ * @brief Scales the IO demand to the 16-bit IO space left after the legacy range
+ */
+static
+void
+DfXRcMgrFitIo (
+  DFX_RCMGR_INPUT_BLK *SilData
+  )
+{
+  FABRIC_ADDR_APERTURE  (*Io)[DFX_MAX_RBS_PER_SOCKET];
+  uint32_t              Socket;
+  uint32_t              RootBridge;
+  uint64_t              Total;
+  uint64_t              Available;
+
+  Io = SilData->ResourceSizeForEachRb.IO;
+  Available = X86IO_LIMIT - X86_LEGACY_IO_SIZE;
+  Total = 0;
+  for (Socket = 0; Socket < SilData->SocketNumber; Socket++) {
+    for (RootBridge = 0; RootBridge < SilData->RbsPerSocket; RootBridge++) {
+      Io[Socket][RootBridge].Size = (Io[Socket][RootBridge].Size + ~RCMGR_IO_SIZE_MASK) & RCMGR_IO_SIZE_MASK;
+      Total += Io[Socket][RootBridge].Size;
+    }
+  }
+  if (Total <= Available) {
+    return;
+  }
+  for (Socket = 0; Socket < SilData->SocketNumber; Socket++) {
+    for (RootBridge = 0; RootBridge < SilData->RbsPerSocket; RootBridge++) {
+      Io[Socket][RootBridge].Size = ((Io[Socket][RootBridge].Size * Available) / Total) & RCMGR_IO_SIZE_MASK;
+    }
+  }
+}
+
+/**
+ * DfXRcMgrSetMmioDemand
+ *
+ * @brief Sets the MMIO size of every root bridge for one fitting attempt
+ *
+ * @param[in, out]    SilData       RC manager input block, ResourceSizeForEachRb is updated
+ * @param[in]         MmioDemand    MMIO demand of each root bridge
+ * @param[in]         Shrink        Hot-plug reservations are divided by 2^Shrink, or dropped for
+ *                                  DFX_RCMGR_DEMAND_NO_HOTPLUG
+ * @param[in]         GrowBelow4G   MMIO below 4G is multiplied by 2^GrowBelow4G
+ * @param[in]         GrowAbove4G   MMIO above 4G is multiplied by 2^GrowAbove4G
+ */
+static
+void
+DfXRcMgrSetMmioDemand (
+  DFX_RCMGR_INPUT_BLK       *SilData,
+  DFX_RCMGR_RB_MMIO_DEMAND  MmioDemand[RCMGR_MAX_SOCKETS][DFX_MAX_RBS_PER_SOCKET],
+  uint32_t                  Shrink,
+  uint32_t                  GrowBelow4G,
+  uint32_t                  GrowAbove4G
+  )
+{
+  DFX_FABRIC_RESOURCE_FOR_EACH_RB *Resource;
+  DFX_RCMGR_RB_MMIO_DEMAND        *Demand;
+  uint64_t                        Size;
+  uint64_t                        HotplugBelow4G;
+  uint64_t                        HotplugAbove4G;
+  uint32_t                        Socket;
+  uint32_t                        RootBridge;
+
+  Resource = &SilData->ResourceSizeForEachRb;
+  for (Socket = 0; Socket < SilData->SocketNumber; Socket++) {
+    for (RootBridge = 0; RootBridge < SilData->RbsPerSocket; RootBridge++) {
+      Demand = &MmioDemand[Socket][RootBridge];
+      HotplugBelow4G = (Shrink < DFX_RCMGR_DEMAND_NO_HOTPLUG) ? (Demand->HotplugBelow4G >> Shrink) : 0;
+      HotplugAbove4G = (Shrink < DFX_RCMGR_DEMAND_NO_HOTPLUG) ? (Demand->HotplugAbove4G >> Shrink) : 0;
+      Size = (Demand->FixedBelow4G + HotplugBelow4G) << GrowBelow4G;
+      Resource->NonPrefetchableMmioSizeBelow4G[Socket][RootBridge].Size =
+        (Size + (DFX_RCMGR_MMIO_GRANULARITY - 1)) & SIZE_16M_ALIGN;
+      Size = (Demand->FixedAbove4G + HotplugAbove4G) << GrowAbove4G;
+      Resource->PrefetchableMmioSizeAbove4G[Socket][RootBridge].Size =
+        (Size + (DFX_RCMGR_MMIO_GRANULARITY - 1)) & SIZE_16M_ALIGN;
+    }
+  }
+}
+
+/**
+ * SilInitResourceBasedOnDemand4
+ *
+ * @brief Initialize PCI bus, MMIO and IO of each root bridge from the MPIO platform topology.
+ *
+ * @details The MMIO demand is checked with a dry run of the NV variable arrangement. Hot-plug reservations are
+ *          halved until the demand fits, and dropped as a last attempt. Each MMIO class is then doubled while it
+ *          still fits, so that spare space goes to the root bridges in proportion to their demand.
+ *
+ * @param[in, out]    SilData     RC manager input block
+ *                      SilData->DemandPolicy             Per root bridge, port and hot-plug slot budgets
+ *                      SilData->ResourceSizeForEachRb    Receives the sizes that were applied
+ *
+ * @retval            SilPass             Resources distributed
+ * @retval            SilNotFound         No MPIO topology available
+ * @retval            SilOutOfResources   The demand does not fit, even without hot-plug reservations
+ */
+SIL_STATUS
+SilInitResourceBasedOnDemand4 (
+  DFX_RCMGR_INPUT_BLK *SilData
+  )
+{
+  DFX_RCMGR_RB_MMIO_DEMAND  MmioDemand[RCMGR_MAX_SOCKETS][DFX_MAX_RBS_PER_SOCKET];
+  uint32_t                  Shrink;
+  uint32_t                  GrowBelow4G;
+  uint32_t                  GrowAbove4G;
+  SIL_STATUS                Status;
+
+  Status = DfXRcMgrCollectDemand (SilData, MmioDemand);
+  if (Status != SilPass) {
+    return Status;
+  }
+
+  for (Shrink = 0; Shrink <= DFX_RCMGR_DEMAND_NO_HOTPLUG; Shrink++) {
+    DfXRcMgrSetMmioDemand (SilData, MmioDemand, Shrink, 0, 0);
+    if (SilInitMmioBasedOnNvVariable4 (SilData, NULL, false) == SilPass) {
+      break;
+    }
+    DF_TRACEPOINT (SIL_TRACE_WARNING, "  MMIO demand does not fit, reducing hot-plug reservations\n");
+  }
+  if (Shrink > DFX_RCMGR_DEMAND_NO_HOTPLUG) {
+    DF_TRACEPOINT (SIL_TRACE_ERROR, " MMIO demand of the PCIe topology does not fit.\n");
+    return SilOutOfResources;
+  }
+
+  for (GrowAbove4G = 0; GrowAbove4G < DFX_RCMGR_DEMAND_MAX_GROWTH; GrowAbove4G++) {
+    DfXRcMgrSetMmioDemand (SilData, MmioDemand, Shrink, 0, GrowAbove4G + 1);
+    if (SilInitMmioBasedOnNvVariable4 (SilData, NULL, false) != SilPass) {
+      break;
+    }
+  }
+  for (GrowBelow4G = 0; GrowBelow4G < DFX_RCMGR_DEMAND_MAX_GROWTH; GrowBelow4G++) {
+    DfXRcMgrSetMmioDemand (SilData, MmioDemand, Shrink, GrowBelow4G + 1, GrowAbove4G);
+    if (SilInitMmioBasedOnNvVariable4 (SilData, NULL, false) != SilPass) {
+      break;
+    }
+  }
+  DF_TRACEPOINT (SIL_TRACE_INFO, "  MMIO demand: hot-plug shrink %d, growth below 4G %d, above 4G %d\n",
+    Shrink, GrowBelow4G, GrowAbove4G);
+
+  DfXRcMgrSetMmioDemand (SilData, MmioDemand, Shrink, GrowBelow4G, GrowAbove4G);
+  Status = SilInitMmioBasedOnNvVariable4 (SilData, NULL, true);
+  if (Status != SilPass) {
+    return Status;
+  }
+
+  DfXRcMgrFitIo (SilData);
+  Status = SilInitIoBasedOnNvVariable4 (SilData, NULL, true);
+  if (Status != SilPass) {
+    return Status;
+  }
+
+  if (!SilData->McptEnable) {
+    DfXRcMgrFitPciBus (SilData);
+    Status = SilInitPciBusBasedOnNvVariable4 (SilData);
+  }
+
+  return Status;
+}
@@ -86,15 +86,7 @@ SilInitPciBusBasedOnNvVariable4 (
 
     MCTPEnabled = SilData->McptEnable;
     BMCSocket = SilData->BmcSocket;
-    BMCIOM = SilData->EarlyBmcLinkLaneNum;
-    if ((BMCIOM < 16) || (BMCIOM == 128) || (BMCIOM == 129))
-      BMCIOM = 0;
-    else if (BMCIOM < 64)
-      BMCIOM = 1;
-    else if (BMCIOM < 96)
-      BMCIOM = 3;
-    else
-      BMCIOM = 2;
+    BMCIOM = DfXSilGetRbFromLane (SilData->EarlyBmcLinkLaneNum);
 
     CcmEntry = DfIp2IpApi->DfFindDeviceTypeEntryInMap (Ccm);
     assert (CcmEntry != NULL);
@@ -1680,15 +1672,7 @@ SilSetCfgAddrMapReg4 (
   RbsPerSocket = DfIp2IpApi->DfGetNumberOfRootBridgesOnSocket (0);
   MCTPEnabled = SilData->McptEnable;
   BMCSocket = SilData->BmcSocket;
-  BMCIOM = SilData->EarlyBmcLinkLaneNum;
-  if ((BMCIOM < 16) || (BMCIOM == 128) || (BMCIOM == 129))
-    BMCIOM = 0;
-  else if (BMCIOM < 64)
-    BMCIOM = 1;
-  else if (BMCIOM < 96)
-    BMCIOM = 3;
-  else
-    BMCIOM = 2;
+  BMCIOM = DfXSilGetRbFromLane (SilData->EarlyBmcLinkLaneNum);
 
   CcmEntry = DfIp2IpApi->DfFindDeviceTypeEntryInMap (Ccm);
   assert (CcmEntry != NULL);
@@ -1732,6 +1716,32 @@ SilSetCfgAddrMapReg4 (
     RegIndex, CfgAddrMapReg.Field.BusNumBase, CfgAddrLimitReg.Field.BusNumLimit, CfgAddrLimitReg.Field.DstFabricID);
 }
 
+/**
+ * DfXSilGetRbFromLane
+ *
+ * @brief Returns the physical root bridge of a socket that owns a PCIe lane
+ *
+ * @param[in]   Lane    DXIO lane number
+ *
+ * @retval      Root bridge index on the socket
+ */
+uint32_t
+DfXSilGetRbFromLane (
+  uint32_t  Lane
+  )
+{
+  if ((Lane < 16) || (Lane == 128) || (Lane == 129)) {
+    return 0;
+  }
+  if (Lane < 64) {
+    return 1;
+  }
+  if (Lane < 96) {
+    return 3;
+  }
+  return 2;
+}
+
 /**
  * DfXSilGetPhySktRbNum
  *
@@ -62,6 +62,19 @@ InitializeResourceManagerDfXTp1 (void)
   Status = SilPass;
   CalledStatus = SilPass;
 
+  if (SilData->SetRcBasedOnDemand) {
+    // Size each root bridge from the PCIe topology behind it
+    DF_TRACEPOINT (SIL_TRACE_INFO, "  Init PCI bus, MMIO and IO based on topology demand\n");
+    CalledStatus = SilInitResourceBasedOnDemand4 (SilData);
+    if (CalledStatus == SilPass) {
+      return SilPass;
+    }
+    DF_TRACEPOINT (SIL_TRACE_WARNING, " Init based on topology demand failed, init MMIO and IO equally.\n");
+    Status = SilInitMmioEqually4 (SilData);
+    CalledStatus = SilInitIoEqually4 (SilData);
+    return (Status != SilPass) ? Status : CalledStatus;
+  }
+
   // Initialize MMIO
   if (SilData->SetRcBasedOnNv) {
     // Got NvVariable successfully, try to init MMIO based on it
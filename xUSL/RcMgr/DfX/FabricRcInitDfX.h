@@ -47,6 +47,11 @@ SilAdditionalMmioSetting4 (
   bool                ReservedRegionAlreadySet
   );
 
+uint32_t
+DfXSilGetRbFromLane (
+  uint32_t  Lane
+  );
+
 void
 DfXSilGetPhySktRbNum (
   uint32_t  LogSktNum,
@@ -98,6 +103,11 @@ SilInitMmioBasedOnNvVariable4 (
   bool                    SetDfRegisters
   );
 
+SIL_STATUS
+SilInitResourceBasedOnDemand4 (
+  DFX_RCMGR_INPUT_BLK *SilData
+  );
+
 SIL_STATUS
 InitializeResourceManagerDfXTp1 (void);
 
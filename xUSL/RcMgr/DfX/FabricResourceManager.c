@@ -14,6 +14,7 @@
 #include <RcMgr/RcMgrIp2Ip.h>
 #include <DF/DfX/SilFabricRegistersDfX.h>
 #include "DfXFabricRegisterAcc.h"
+#include <string.h>
 
 void
 FabricGetRemainingSizeForThisRegion (
@@ -31,6 +32,398 @@ FabricGetBaseAddress (
   uint8_t            MmioType
   );
 
+/**
+ * FabricMmioPoolOrder
+ *
+ * @brief Returns the order of the smallest buddy block holding Size bytes
+ */
+static
+uint8_t
+FabricMmioPoolOrder (
+  uint64_t  Size
+  )
+{
+  uint64_t  Units;
+  uint8_t   Order;
+
+  Units = (Size + RCMGR_MMIO_MIN_SIZE - 1) >> RCMGR_MMIO_POOL_BLOCK_SHIFT;
+  Order = 0;
+  while ((Order < RCMGR_MMIO_POOL_MAX_ORDER) && ((1ull << Order) < Units)) {
+    Order++;
+  }
+  return Order;
+}
+
+/**
+ * FabricMmioPoolAddFree
+ *
+ * @brief Returns a block to the pool, merging it with its free buddies
+ *
+ * @param[in, out]    Pool        Buddy MMIO pool
+ * @param[in]         Base        Block base in 64KB units
+ * @param[in]         Order       Block order
+ *
+ * @retval            true        Block is free
+ * @retval            false       No free block entry left, the pool is unchanged
+ */
+static
+bool
+FabricMmioPoolAddFree (
+  FABRIC_MMIO_POOL  *Pool,
+  uint64_t          Base,
+  uint8_t           Order
+  )
+{
+  uint64_t  Buddy;
+  uint32_t  Index;
+  bool      Merged;
+
+  do {
+    Merged = false;
+    if (Order < RCMGR_MMIO_POOL_MAX_ORDER) {
+      Buddy = Base ^ (1ull << Order);
+      for (Index = 0; Index < Pool->FreeCount; Index++) {
+        if ((Pool->Free[Index].Base == Buddy) && (Pool->Free[Index].Order == Order)) {
+          Pool->FreeCount--;
+          Pool->Free[Index] = Pool->Free[Pool->FreeCount];
+          Base &= ~(1ull << Order);
+          Order++;
+          Merged = true;
+          break;
+        }
+      }
+    }
+  } while (Merged);
+
+  // Merging frees an entry, so a full list means nothing was changed
+  if (Pool->FreeCount >= RCMGR_MMIO_POOL_MAX_FREE_BLOCKS) {
+    DF_TRACEPOINT (SIL_TRACE_WARNING, "  MMIO pool free list is full\n");
+    return false;
+  }
+  Pool->Free[Pool->FreeCount].Base = Base;
+  Pool->Free[Pool->FreeCount].Order = Order;
+  Pool->FreeCount++;
+  return true;
+}
+
+/**
+ * FabricMmioPoolInit
+ *
+ * @brief Builds a buddy pool over a range, split into the largest naturally aligned blocks
+ *
+ * @param[out]        Pool        Buddy MMIO pool
+ * @param[in]         Base        Base address of the range
+ * @param[in]         Size        Size of the range
+ */
+static
+void
+FabricMmioPoolInit (
+  FABRIC_MMIO_POOL  *Pool,
+  uint64_t          Base,
+  uint64_t          Size
+  )
+{
+  uint64_t  Unit;
+  uint64_t  Limit;
+  uint8_t   Order;
+
+  memset (Pool, 0, sizeof (FABRIC_MMIO_POOL));
+  Pool->Base = Base;
+  Pool->Size = Size;
+
+  Unit = (Base + RCMGR_MMIO_MIN_SIZE - 1) >> RCMGR_MMIO_POOL_BLOCK_SHIFT;
+  Limit = (Base + Size) >> RCMGR_MMIO_POOL_BLOCK_SHIFT;
+  while (Unit < Limit) {
+    Order = 0;
+    while ((Order < RCMGR_MMIO_POOL_MAX_ORDER) && ((Unit & ((2ull << Order) - 1)) == 0) &&
+           ((Unit + (2ull << Order)) <= Limit)) {
+      Order++;
+    }
+    if (Pool->FreeCount >= RCMGR_MMIO_POOL_MAX_FREE_BLOCKS) {
+      DF_TRACEPOINT (SIL_TRACE_WARNING, "  MMIO pool free list is full, 0x%llX bytes unused\n",
+        (Limit - Unit) << RCMGR_MMIO_POOL_BLOCK_SHIFT);
+      break;
+    }
+    Pool->Free[Pool->FreeCount].Base = Unit;
+    Pool->Free[Pool->FreeCount].Order = Order;
+    Pool->FreeCount++;
+    Unit += 1ull << Order;
+  }
+}
+
+/**
+ * FabricGetNonPciPool
+ *
+ * @brief Returns the buddy pool of a region's non-PCI range, rebuilt if the range was rearranged
+ */
+static
+FABRIC_MMIO_POOL *
+FabricGetNonPciPool (
+  FABRIC_MMIO_REGION *MmioRegion
+  )
+{
+  FABRIC_MMIO_POOL *Pool;
+
+  Pool = &MmioRegion->NonPciPool;
+  if ((Pool->Base != MmioRegion->BaseNonPci) || (Pool->Size != MmioRegion->SizeNonPci) ||
+      (Pool->AllocatedSize != MmioRegion->UsedSizeNonPci)) {
+    FabricMmioPoolInit (Pool, MmioRegion->BaseNonPci, MmioRegion->SizeNonPci);
+    MmioRegion->UsedSizeNonPci = 0;
+  }
+  return Pool;
+}
+
+/**
+ * FabricMmioPoolFind
+ *
+ * @brief Finds the smallest free block that can hold an aligned request
+ *
+ * @param[in]         Pool        Buddy MMIO pool
+ * @param[in]         Order       Order of the request
+ * @param[in]         AlignOrder  Order of the requested alignment
+ * @param[out]        Index       Index of the block in the free list
+ *
+ * @retval            true        Block found
+ */
+static
+bool
+FabricMmioPoolFind (
+  FABRIC_MMIO_POOL  *Pool,
+  uint8_t           Order,
+  uint8_t           AlignOrder,
+  uint32_t          *Index
+  )
+{
+  FABRIC_MMIO_BUDDY_BLOCK *Block;
+  uint32_t                i;
+  bool                    Found;
+
+  Found = false;
+  for (i = 0; i < Pool->FreeCount; i++) {
+    Block = &Pool->Free[i];
+    if ((Block->Order < Order) || ((Block->Base & ((1ull << AlignOrder) - 1)) != 0)) {
+      continue;
+    }
+    if (!Found || (Block->Order < Pool->Free[*Index].Order) ||
+        ((Block->Order == Pool->Free[*Index].Order) && (Block->Base < Pool->Free[*Index].Base))) {
+      *Index = i;
+      Found = true;
+    }
+  }
+  return Found;
+}
+
+/**
+ * FabricMmioPoolLargest
+ *
+ * @brief Returns the size of the largest free block meeting an alignment
+ */
+static
+uint64_t
+FabricMmioPoolLargest (
+  FABRIC_MMIO_POOL  *Pool,
+  uint8_t           AlignOrder
+  )
+{
+  uint64_t  Largest;
+  uint32_t  i;
+
+  Largest = 0;
+  for (i = 0; i < Pool->FreeCount; i++) {
+    if (((Pool->Free[i].Base & ((1ull << AlignOrder) - 1)) == 0) &&
+        (((uint64_t) RCMGR_MMIO_MIN_SIZE << Pool->Free[i].Order) > Largest)) {
+      Largest = (uint64_t) RCMGR_MMIO_MIN_SIZE << Pool->Free[i].Order;
+    }
+  }
+  return Largest;
+}
+
+/**
+ * FabricMmioPoolAlloc
+ *
+ * @brief Allocates an aligned block, splitting a larger block and returning its upper halves
+ *
+ * @param[in, out]    Pool        Buddy MMIO pool
+ * @param[in]         Length      Size of the request
+ * @param[in]         Alignment   Alignment bit map
+ *
+ * @retval            Base address of the block, 0 if the request cannot be served
+ */
+static
+uint64_t
+FabricMmioPoolAlloc (
+  FABRIC_MMIO_POOL  *Pool,
+  uint64_t          Length,
+  uint64_t          Alignment
+  )
+{
+  FABRIC_MMIO_BUDDY_BLOCK Block;
+  uint32_t                Index;
+  uint8_t                 Order;
+
+  Order = FabricMmioPoolOrder (Length);
+  if (Pool->AllocatedCount >= RCMGR_MMIO_POOL_MAX_ALLOCATIONS) {
+    DF_TRACEPOINT (SIL_TRACE_WARNING, "  MMIO pool allocation list is full\n");
+    return 0;
+  }
+  if (!FabricMmioPoolFind (Pool, Order, FabricMmioPoolOrder (Alignment + 1), &Index)) {
+    return 0;
+  }
+  if ((Pool->FreeCount + (uint32_t) (Pool->Free[Index].Order - Order)) > RCMGR_MMIO_POOL_MAX_FREE_BLOCKS) {
+    DF_TRACEPOINT (SIL_TRACE_WARNING, "  MMIO pool free list is full, cannot split a block\n");
+    return 0;
+  }
+
+  Block = Pool->Free[Index];
+  Pool->FreeCount--;
+  Pool->Free[Index] = Pool->Free[Pool->FreeCount];
+  while (Block.Order > Order) {
+    Block.Order--;
+    FabricMmioPoolAddFree (Pool, Block.Base + (1ull << Block.Order), Block.Order);
+  }
+  Pool->Allocated[Pool->AllocatedCount] = Block;
+  Pool->AllocatedCount++;
+  Pool->AllocatedSize += (uint64_t) RCMGR_MMIO_MIN_SIZE << Order;
+
+  return (uint64_t) Block.Base << RCMGR_MMIO_POOL_BLOCK_SHIFT;
+}
+
+/**
+ * FabricMmioPoolFree
+ *
+ * @brief Returns an allocated block to the pool
+ *
+ * @details Only a block handed out by FabricMmioPoolAlloc, with the same base and order, is accepted.
+ *
+ * @param[in, out]    Pool          Buddy MMIO pool
+ * @param[in]         BaseAddress   Base address returned by FabricMmioPoolAlloc
+ * @param[in]         Length        Length passed to FabricMmioPoolAlloc
+ *
+ * @retval            SilPass               Block freed
+ * @retval            SilInvalidParameter   The range was not allocated from this pool
+ * @retval            SilOutOfResources     No free block entry left, the block stays allocated
+ */
+static
+SIL_STATUS
+FabricMmioPoolFree (
+  FABRIC_MMIO_POOL  *Pool,
+  uint64_t          BaseAddress,
+  uint64_t          Length
+  )
+{
+  uint64_t  Base;
+  uint32_t  i;
+  uint8_t   Order;
+
+  Order = FabricMmioPoolOrder (Length);
+  if ((BaseAddress & (RCMGR_MMIO_MIN_SIZE - 1)) != 0) {
+    return SilInvalidParameter;
+  }
+  Base = BaseAddress >> RCMGR_MMIO_POOL_BLOCK_SHIFT;
+  for (i = 0; i < Pool->AllocatedCount; i++) {
+    if ((Pool->Allocated[i].Base == Base) && (Pool->Allocated[i].Order == Order)) {
+      break;
+    }
+  }
+  if (i == Pool->AllocatedCount) {
+    return SilInvalidParameter;
+  }
+
+  if (!FabricMmioPoolAddFree (Pool, Base, Order)) {
+    return SilOutOfResources;
+  }
+  Pool->AllocatedCount--;
+  Pool->Allocated[i] = Pool->Allocated[Pool->AllocatedCount];
+  Pool->AllocatedSize -= (uint64_t) RCMGR_MMIO_MIN_SIZE << Order;
+  return SilPass;
+}
+
+/**
+ * FabricGetTargetRb
+ *
+ * @brief Resolves a FABRIC_TARGET to a socket and root bridge
+ *
+ * @param[in]         DfIp2IpApi    DF Ip2Ip API
+ * @param[in]         Target        PCI bus number/RootBridge number of the requestor
+ * @param[out]        Socket        Socket number
+ * @param[out]        Rb            Root bridge number on the socket
+ *
+ * @retval            SilPass       Target resolved
+ * @retval            SilAborted    The PCI bus number does not correspond to any root bridge
+ */
+static
+SIL_STATUS
+FabricGetTargetRb (
+  DF_IP2IP_API      *DfIp2IpApi,
+  FABRIC_TARGET     Target,
+  uint8_t           *Socket,
+  uint8_t           *Rb
+  )
+{
+  uint8_t                   i;
+  uint8_t                   j;
+  uint32_t                  DstFabricID;
+  uint32_t                  CfgAddrMapIndex;
+  uint32_t                  SocketCount;
+  uint32_t                  RbPerDieCount;
+  uint32_t                  RbPerSktCount;
+  CFG_LIMIT_ADDRESS_REGISTER CfgLimit;
+  CFG_BASE_ADDRESS_REGISTER CfgBase;
+
+  SocketCount = DfIp2IpApi->DfGetNumberOfProcessorsPresent ();
+  RbPerDieCount = DfIp2IpApi->DfGetNumberOfRootBridgesOnDie (0);
+  RbPerSktCount = DfIp2IpApi->DfGetNumberOfRootBridgesOnSocket (0);
+
+  // Find out Socket/Rb
+  DstFabricID = 0xFFFFFFFF;
+  *Socket = 0xFF;
+  *Rb = 0xFF;
+  if (Target.TgtType == TARGET_PCI_BUS) {
+    for (CfgAddrMapIndex = 0; CfgAddrMapIndex < DFX_NUMBER_OF_BUS_REGIONS; CfgAddrMapIndex++) {
+      CfgLimit.Value = DfIp2IpApi->DfFabricRegisterAccRead (0, CFGLIMITADDRESS_0_FUNC,
+        (uint32_t)(CFGLIMITADDRESS_0_REG + (CfgAddrMapIndex * (CFGLIMITADDRESS_1_REG - CFGLIMITADDRESS_0_REG))),
+        FABRIC_REG_ACC_BC);
+      CfgBase.Value =  DfIp2IpApi->DfFabricRegisterAccRead (0, CFGBASEADDRESS_0_FUNC,
+        (uint32_t)(CFGBASEADDRESS_0_REG + (CfgAddrMapIndex * (CFGBASEADDRESS_1_REG - CFGBASEADDRESS_0_REG))),
+        FABRIC_REG_ACC_BC);
+      if ((CfgBase.Field.RE == 1) && (CfgBase.Field.WE == 1) && (CfgLimit.Field.BusNumLimit >= Target.PciBusNum) &&
+          (CfgBase.Field.BusNumBase <= Target.PciBusNum) && (CfgBase.Field.SegmentNum == Target.PciSegNum)) {
+        DstFabricID = CfgLimit.Field.DstFabricID;
+        break;
+      }
+    }
+
+    if (CfgAddrMapIndex >= DFX_NUMBER_OF_BUS_REGIONS) {
+      return SilAborted;
+    }
+    assert (DstFabricID != 0xFFFFFFFF);
+    for (i = 0; i < SocketCount; i++) {
+      for (j = 0; j < RbPerSktCount; j++) {
+        if (DfIp2IpApi->DfGetHostBridgeSystemFabricID (i, j % RbPerDieCount) == DstFabricID) {
+          *Socket = i;
+          *Rb = j;
+          break;
+        }
+      }
+    }
+    assert (*Socket != 0xFF);
+    assert (*Rb != 0xFF);
+  } else {
+    *Socket = (uint8_t) (Target.SocketNum);
+    *Rb     = (uint8_t) (Target.RbNum);
+    // This is for combo support for multi/single NBIO in one IOD
+    if (*Rb >= RbPerSktCount) {
+      *Rb = (uint8_t) (RbPerSktCount - 1);
+    }
+  }
+
+  if ((*Socket >= MAX_SOCKETS_SUPPORTED) || (*Rb >= DFX_MAX_RBS_PER_SOCKET)) {
+    assert (false);
+    return SilAborted;
+  }
+  return SilPass;
+}
+
 /**
  * FabricReserveMmio
  *
@@ -58,24 +451,15 @@ FabricReserveMmio (
   FABRIC_MMIO_ATTRIBUTE *Attributes
   )
 {
-  uint8_t                   i;
-  uint8_t                   j;
   uint8_t                   Socket;
   uint8_t                   Rb;
   uint8_t                   TempSocket;
   uint8_t                   TempRb;
-  uint32_t                  DstFabricID;
-  uint32_t                  CfgAddrMapIndex;
   uint64_t                  SizeA;
   uint64_t                  SizeB;
   uint64_t                  TempSize;
-  uint32_t                  SocketCount;
-  uint32_t                  RbPerDieCount;
-  uint32_t                  RbPerSktCount;
   uint32_t                  PrimarySocket;
   uint32_t                  PrimaryRootBridge;
-  CFG_LIMIT_ADDRESS_REGISTER CfgLimit;
-  CFG_BASE_ADDRESS_REGISTER CfgBase;
   DFX_FABRIC_MMIO_MANAGER   *FabricMmioManager;
   FABRIC_MMIO_REGION        *MmioRegion;
   FABRIC_MMIO_REGION        *PrimaryRb2ndMmioRegion;
@@ -98,9 +482,6 @@ FabricReserveMmio (
   ReturnStatus = SilPass;
   FabricMmioManager = &RcMgrData->MmioRcMgr;
 
-  SocketCount = DfIp2IpApi->DfGetNumberOfProcessorsPresent ();
-  RbPerDieCount = DfIp2IpApi->DfGetNumberOfRootBridgesOnDie (0);
-  RbPerSktCount = DfIp2IpApi->DfGetNumberOfRootBridgesOnSocket (0);
   SilGetPrimaryRb (&PrimarySocket, &PrimaryRootBridge);
 
   // Check input parameters
@@ -115,52 +496,9 @@ FabricReserveMmio (
     return SilAborted;
   }
 
-  // Find out Socket/Rb
-  DstFabricID = 0xFFFFFFFF;
-  Socket = 0xFF;
-  Rb = 0xFF;
-  if (Target.TgtType == TARGET_PCI_BUS) {
-    for (CfgAddrMapIndex = 0; CfgAddrMapIndex < DFX_NUMBER_OF_BUS_REGIONS; CfgAddrMapIndex++) {
-      CfgLimit.Value = DfIp2IpApi->DfFabricRegisterAccRead (0, CFGLIMITADDRESS_0_FUNC,
-        (uint32_t)(CFGLIMITADDRESS_0_REG + (CfgAddrMapIndex * (CFGLIMITADDRESS_1_REG - CFGLIMITADDRESS_0_REG))),
-        FABRIC_REG_ACC_BC);
-      CfgBase.Value =  DfIp2IpApi->DfFabricRegisterAccRead (0, CFGBASEADDRESS_0_FUNC,
-        (uint32_t)(CFGBASEADDRESS_0_REG + (CfgAddrMapIndex * (CFGBASEADDRESS_1_REG - CFGBASEADDRESS_0_REG))),
-        FABRIC_REG_ACC_BC);
-      if ((CfgBase.Field.RE == 1) && (CfgBase.Field.WE == 1) && (CfgLimit.Field.BusNumLimit >= Target.PciBusNum) &&
-          (CfgBase.Field.BusNumBase <= Target.PciBusNum) && (CfgBase.Field.SegmentNum == Target.PciSegNum)) {
-        DstFabricID = CfgLimit.Field.DstFabricID;
-        break;
-      }
-    }
-
-    if (CfgAddrMapIndex >= DFX_NUMBER_OF_BUS_REGIONS) {
-      return SilAborted;
-    }
-    assert (DstFabricID != 0xFFFFFFFF);
-    for (i = 0; i < SocketCount; i++) {
-      for (j = 0; j < RbPerSktCount; j++) {
-        if (DfIp2IpApi->DfGetHostBridgeSystemFabricID (i, j % RbPerDieCount) == DstFabricID) {
-          Socket = i;
-          Rb = j;
-          break;
-        }
-      }
-    }
-    assert (Socket != 0xFF);
-    assert (Rb != 0xFF);
-  } else {
-    Socket = (uint8_t) (Target.SocketNum);
-    Rb     = (uint8_t) (Target.RbNum);
-    // This is for combo support for multi/single NBIO in one IOD
-    if (Rb >= RbPerSktCount) {
-      Rb = (uint8_t) (RbPerSktCount - 1);
-    }
-  }
-
-  if ((Socket >= MAX_SOCKETS_SUPPORTED) || (Rb >= DFX_MAX_RBS_PER_SOCKET)) {
-    assert (false);
-    return SilAborted;
+  ReturnStatus = FabricGetTargetRb (DfIp2IpApi, Target, &Socket, &Rb);
+  if (ReturnStatus != SilPass) {
+    return ReturnStatus;
   }
 
   SizeA = 0;
@@ -286,15 +624,18 @@ FabricGetRemainingSizeForThisRegion (
 
   Base = 0;
 
+  if ((MmioType == NON_PCI_DEVICE_BELOW_4G) || (MmioType == NON_PCI_DEVICE_ABOVE_4G)) {
+    // Non-PCI ranges are shared through a buddy pool, aligned blocks need no alignment gap
+    *Size = FabricMmioPoolLargest (FabricGetNonPciPool (MmioRegion), FabricMmioPoolOrder (Alignment + 1));
+    return;
+  }
+
   if ((MmioType == MMIO_BELOW_4G) || (MmioType == MMIO_ABOVE_4G)) {
     Base = MmioRegion->BaseNonPrefetch + MmioRegion->UsedSizeNonPrefetch;
     *Size = MmioRegion->SizeNonPrefetch - MmioRegion->UsedSizeNonPrefetch;
   } else if ((MmioType == P_MMIO_BELOW_4G) || (MmioType == P_MMIO_ABOVE_4G)) {
     Base = MmioRegion->BasePrefetch + MmioRegion->UsedSizePrefetch;
     *Size = MmioRegion->SizePrefetch - MmioRegion->UsedSizePrefetch;
-  } else if ((MmioType == NON_PCI_DEVICE_BELOW_4G) || (MmioType == NON_PCI_DEVICE_ABOVE_4G)) {
-    Base = MmioRegion->BaseNonPci + MmioRegion->UsedSizeNonPci;
-    *Size = MmioRegion->SizeNonPci - MmioRegion->UsedSizeNonPci;
   } else {
     assert (false);
     *Size = 0;
@@ -333,20 +674,25 @@ FabricGetBaseAddress (
   uint64_t MmioBaseAddressAligned;
   uint64_t MmioRemainingSize;
   uint64_t AlignMask;
+  FABRIC_MMIO_POOL *Pool;
 
   MmioBaseAddress = 0;
   MmioBaseAddressAligned = 0;
   MmioRemainingSize = 0;
 
+  if ((MmioType == NON_PCI_DEVICE_BELOW_4G) || (MmioType == NON_PCI_DEVICE_ABOVE_4G)) {
+    Pool = FabricGetNonPciPool (MmioRegion);
+    MmioBaseAddressAligned = FabricMmioPoolAlloc (Pool, Length, Alignment);
+    MmioRegion->UsedSizeNonPci = Pool->AllocatedSize;
+    return MmioBaseAddressAligned;
+  }
+
   if ((MmioType == MMIO_BELOW_4G) || (MmioType == MMIO_ABOVE_4G)) {
     MmioBaseAddress = MmioRegion->BaseNonPrefetch + MmioRegion->UsedSizeNonPrefetch;
     MmioRemainingSize = MmioRegion->SizeNonPrefetch - MmioRegion->UsedSizeNonPrefetch;
   } else if ((MmioType == P_MMIO_BELOW_4G) || (MmioType == P_MMIO_ABOVE_4G)) {
     MmioBaseAddress = MmioRegion->BasePrefetch + MmioRegion->UsedSizePrefetch;
     MmioRemainingSize = MmioRegion->SizePrefetch - MmioRegion->UsedSizePrefetch;
-  } else if ((MmioType == NON_PCI_DEVICE_BELOW_4G) || (MmioType == NON_PCI_DEVICE_ABOVE_4G)) {
-    MmioBaseAddress = MmioRegion->BaseNonPci + MmioRegion->UsedSizeNonPci;
-    MmioRemainingSize = MmioRegion->SizeNonPci - MmioRegion->UsedSizeNonPci;
   }
 
   if ((MmioBaseAddress != 0) && (MmioRemainingSize != 0)) {
@@ -357,8 +703,6 @@ FabricGetBaseAddress (
         MmioRegion->UsedSizeNonPrefetch += Length + MmioBaseAddressAligned - MmioBaseAddress;
       } else if ((MmioType == P_MMIO_BELOW_4G) || (MmioType == P_MMIO_ABOVE_4G)) {
         MmioRegion->UsedSizePrefetch += Length + MmioBaseAddressAligned - MmioBaseAddress;
-      } else if ((MmioType == NON_PCI_DEVICE_BELOW_4G) || (MmioType == NON_PCI_DEVICE_ABOVE_4G)) {
-        MmioRegion->UsedSizeNonPci += Length + MmioBaseAddressAligned - MmioBaseAddress;
       }
     } else {
       MmioBaseAddressAligned = 0;
@@ -368,3 +712,147 @@ FabricGetBaseAddress (
   return MmioBaseAddressAligned;
 }
 
+/**
+ * FabricReleaseMmio
+ *
+ * @brief Returns a range reserved by FabricReserveMmio to its non-PCI MMIO pool
+ *
+ * @param[in]         BaseAddress   Base address returned by FabricReserveMmio
+ * @param[in]         Length        Length passed to FabricReserveMmio
+ *
+ * @retval   SIL_STATUS  SilPass              - The range was freed
+ *                       SilNotFound          - The RC manager input block was not found
+ *                       SilInvalidParameter  - The range was not reserved by FabricReserveMmio
+ *                       SilOutOfResources    - The pool cannot track the freed range, it stays reserved
+ */
+SIL_STATUS
+FabricReleaseMmio (
+  uint64_t              BaseAddress,
+  uint64_t              Length
+  )
+{
+  uint32_t                  Socket;
+  uint32_t                  Rb;
+  DFX_FABRIC_MMIO_MANAGER   *FabricMmioManager;
+  DFX_RCMGR_INPUT_BLK       *RcMgrData;
+  FABRIC_MMIO_REGION        *MmioRegion;
+  SIL_STATUS                Status;
+
+  RcMgrData = (DFX_RCMGR_INPUT_BLK *)SilFindStructure(SilId_RcManager,  0);
+  if (RcMgrData == NULL) {
+    return SilNotFound; // Could not find the IP input block
+  }
+
+  if (Length == 0) {
+    return SilPass;
+  }
+
+  FabricMmioManager = &RcMgrData->MmioRcMgr;
+  for (Socket = 0; Socket < RCMGR_MAX_SOCKETS; Socket++) {
+    for (Rb = 0; Rb < DFX_MAX_RBS_PER_SOCKET; Rb++) {
+      MmioRegion = &FabricMmioManager->MmioRegionBelow4G[Socket][Rb];
+      if ((BaseAddress < MmioRegion->BaseNonPci) ||
+          (BaseAddress >= (MmioRegion->BaseNonPci + MmioRegion->SizeNonPci))) {
+        MmioRegion = &FabricMmioManager->MmioRegionAbove4G[Socket][Rb];
+        if ((BaseAddress < MmioRegion->BaseNonPci) ||
+            (BaseAddress >= (MmioRegion->BaseNonPci + MmioRegion->SizeNonPci))) {
+          continue;
+        }
+      }
+      Status = FabricMmioPoolFree (FabricGetNonPciPool (MmioRegion), BaseAddress, Length);
+      MmioRegion->UsedSizeNonPci = MmioRegion->NonPciPool.AllocatedSize;
+      DF_TRACEPOINT (SIL_TRACE_INFO, "  Release MMIO from 0x%llX ~ 0x%llX, status %d\n",
+        BaseAddress, (BaseAddress + Length - 1), Status);
+      return Status;
+    }
+  }
+
+  return SilInvalidParameter;
+}
+
+/**
+ * FabricGetMmioPoolStats
+ *
+ * @brief Reports usage and fragmentation of the non-PCI MMIO pools of a root bridge
+ *
+ * @details The primary root bridge's 2nd MMIO region below 4G is included in its below 4G statistics.
+ *
+ * @param[in]         Target        PCI bus number/RootBridge number
+ * @param[in]         MmioType      NON_PCI_DEVICE_BELOW_4G or NON_PCI_DEVICE_ABOVE_4G
+ * @param[out]        Stats         Pool statistics
+ *
+ * @retval   SIL_STATUS  SilPass              - Statistics reported
+ *                       SilNotFound          - The RC manager input block was not found
+ *                       SilAborted           - One or more input parameters are invalid
+ */
+SIL_STATUS
+FabricGetMmioPoolStats (
+  FABRIC_TARGET           Target,
+  uint8_t                 MmioType,
+  FABRIC_MMIO_POOL_STATS  *Stats
+  )
+{
+  uint8_t                   Socket;
+  uint8_t                   Rb;
+  uint32_t                  PrimarySocket;
+  uint32_t                  PrimaryRootBridge;
+  uint32_t                  RegionCount;
+  uint32_t                  i;
+  uint32_t                  j;
+  uint64_t                  BlockSize;
+  FABRIC_MMIO_REGION        *MmioRegion[2];
+  FABRIC_MMIO_POOL          *Pool;
+  DFX_FABRIC_MMIO_MANAGER   *FabricMmioManager;
+  DFX_RCMGR_INPUT_BLK       *RcMgrData;
+  DF_IP2IP_API              *DfIp2IpApi;
+  SIL_STATUS                Status;
+
+  Status = SilGetIp2IpApi (SilId_DfClass, (void**) &DfIp2IpApi);
+  assert (Status == SilPass);
+
+  RcMgrData = (DFX_RCMGR_INPUT_BLK *)SilFindStructure(SilId_RcManager,  0);
+  if (RcMgrData == NULL) {
+    return SilNotFound; // Could not find the IP input block
+  }
+
+  if ((Stats == NULL) || ((MmioType != NON_PCI_DEVICE_BELOW_4G) && (MmioType != NON_PCI_DEVICE_ABOVE_4G))) {
+    return SilAborted;
+  }
+
+  Status = FabricGetTargetRb (DfIp2IpApi, Target, &Socket, &Rb);
+  if (Status != SilPass) {
+    return Status;
+  }
+
+  FabricMmioManager = &RcMgrData->MmioRcMgr;
+  RegionCount = 1;
+  if (MmioType == NON_PCI_DEVICE_BELOW_4G) {
+    MmioRegion[0] = &FabricMmioManager->MmioRegionBelow4G[Socket][Rb];
+    SilGetPrimaryRb (&PrimarySocket, &PrimaryRootBridge);
+    if (FabricMmioManager->PrimaryRbHas2ndMmioBelow4G && (Socket == PrimarySocket) && (Rb == PrimaryRootBridge)) {
+      MmioRegion[1] = &FabricMmioManager->MmioRegionBelow4G[(FabricMmioManager->PrimaryRb2ndMmioPairBelow4G >> 4) & 0xF]
+                                                           [FabricMmioManager->PrimaryRb2ndMmioPairBelow4G & 0xF];
+      RegionCount = 2;
+    }
+  } else {
+    MmioRegion[0] = &FabricMmioManager->MmioRegionAbove4G[Socket][Rb];
+  }
+
+  memset (Stats, 0, sizeof (FABRIC_MMIO_POOL_STATS));
+  for (i = 0; i < RegionCount; i++) {
+    Pool = FabricGetNonPciPool (MmioRegion[i]);
+    Stats->TotalSize += Pool->Size;
+    Stats->AllocatedSize += Pool->AllocatedSize;
+    for (j = 0; j < Pool->FreeCount; j++) {
+      BlockSize = (uint64_t) RCMGR_MMIO_MIN_SIZE << Pool->Free[j].Order;
+      Stats->FreeSize += BlockSize;
+      Stats->LargestFreeBlock = (BlockSize > Stats->LargestFreeBlock) ? BlockSize : Stats->LargestFreeBlock;
+      Stats->FreeBlockCount++;
+    }
+  }
+  if (Stats->FreeSize != 0) {
+    Stats->Fragmentation = (uint32_t) (((Stats->FreeSize - Stats->LargestFreeBlock) * 100) / Stats->FreeSize);
+  }
+
+  return SilPass;
+}
@@ -46,6 +46,32 @@
 
 #pragma pack(push, 1)
 
+#define DFX_RCMGR_MAX_ENDPOINT_DEMANDS  16
+
+/// Resources needed below one PCIe port
+typedef struct {
+  uint16_t  PciBusNumber;                       ///< PCI bus numbers
+  uint32_t  IoSize;                             ///< IO space
+  uint64_t  MmioSizeBelow4G;                    ///< Non-prefetchable MMIO below 4G
+  uint64_t  MmioSizeAbove4G;                    ///< Prefetchable MMIO above 4G
+} DFX_RCMGR_PORT_DEMAND;
+
+/// Known endpoint requirement of one port, matched on the socket and start lane of its MPIO port descriptor
+typedef struct {
+  uint8_t               Socket;                 ///< Socket of the port
+  uint8_t               StartLane;              ///< Start lane of the port
+  DFX_RCMGR_PORT_DEMAND Demand;                 ///< Replaces the port or hot-plug slot budget
+} DFX_RCMGR_ENDPOINT_DEMAND;
+
+/// Demand-driven resource distribution policy
+typedef struct {
+  DFX_RCMGR_PORT_DEMAND     RootBridge;         ///< Baseline of every root bridge (integrated devices)
+  DFX_RCMGR_PORT_DEMAND     Port;               ///< Each PCIe port without hot-plug
+  DFX_RCMGR_PORT_DEMAND     HotplugSlot;        ///< Reservation for each hot-plug slot
+  uint8_t                   EndpointCount;      ///< Valid entries in Endpoint
+  DFX_RCMGR_ENDPOINT_DEMAND Endpoint[DFX_RCMGR_MAX_ENDPOINT_DEMANDS];  ///< Known endpoint BAR requirements
+} DFX_RCMGR_DEMAND_POLICY;
+
 typedef struct {
   DFX_FABRIC_IO_MANAGER   IoRcMgr;
   DFX_FABRIC_MMIO_MANAGER MmioRcMgr;
@@ -62,6 +88,8 @@ typedef struct {
   uint8_t   EarlyBmcLinkLaneNum;
   bool      ResourceDistributionNv[RCMGR_MAX_SOCKETS * DFX_MAX_RBS_PER_SOCKET];
   DFX_FABRIC_RESOURCE_FOR_EACH_RB ResourceSizeForEachRb;
+  bool      SetRcBasedOnDemand;                 ///< Size each root bridge from the MPIO topology, overrides NV
+  DFX_RCMGR_DEMAND_POLICY DemandPolicy;         ///< Budgets used when SetRcBasedOnDemand is set
 } DFX_RCMGR_INPUT_BLK;
 
 typedef struct {
@@ -11,7 +11,9 @@
 #include <RcMgr/FabricResourceManager.h>
 
 RCMGR_IP2IP_API RcMgrApi = {
-    .FabricReserveMmio    = FabricReserveMmio
+    .FabricReserveMmio      = FabricReserveMmio,
+    .FabricReleaseMmio      = FabricReleaseMmio,
+    .FabricGetMmioPoolStats = FabricGetMmioPoolStats
 };
 
 /**
@@ -68,6 +68,28 @@ typedef struct _FABRIC_ADDR_SPACE_SIZE {
   uint64_t  MmioSizeAbove4GReqInc; ///< The amount needed over the current size
 } FABRIC_ADDR_SPACE_SIZE;
 
+#define RCMGR_MMIO_POOL_MAX_FREE_BLOCKS  32   ///< Free blocks tracked by one buddy MMIO pool
+#define RCMGR_MMIO_POOL_MAX_ALLOCATIONS  32   ///< Allocated blocks tracked by one buddy MMIO pool
+#define RCMGR_MMIO_POOL_BLOCK_SHIFT      16   ///< Smallest buddy block is RCMGR_MMIO_MIN_SIZE
+#define RCMGR_MMIO_POOL_MAX_ORDER        31   ///< Largest buddy block is 64KB << 31
+
+/// Block of a buddy MMIO pool, naturally aligned to its size
+typedef struct _FABRIC_MMIO_BUDDY_BLOCK {
+  uint64_t  Base;                  ///< Base address in 64KB units
+  uint8_t   Order;                 ///< Block size is 64KB << Order
+} FABRIC_MMIO_BUDDY_BLOCK;
+
+/// Buddy allocator over the non-PCI MMIO of one region
+typedef struct _FABRIC_MMIO_POOL {
+  uint64_t  Base;                  ///< Base address of the range the pool was built on
+  uint64_t  Size;                  ///< Size of the range the pool was built on
+  uint64_t  AllocatedSize;         ///< Size of the blocks handed out
+  uint8_t   FreeCount;             ///< Valid entries in Free
+  uint8_t   AllocatedCount;        ///< Valid entries in Allocated
+  FABRIC_MMIO_BUDDY_BLOCK Free[RCMGR_MMIO_POOL_MAX_FREE_BLOCKS];        ///< Free blocks
+  FABRIC_MMIO_BUDDY_BLOCK Allocated[RCMGR_MMIO_POOL_MAX_ALLOCATIONS];   ///< Blocks handed out
+} FABRIC_MMIO_POOL;
+
 /// MMIO Region
 typedef struct _FABRIC_MMIO_REGION {
   uint64_t  BaseNonPci;            ///< Base address of non-discoverable devices
@@ -81,6 +103,7 @@ typedef struct _FABRIC_MMIO_REGION {
   uint64_t  UsedSizePrefetch;      ///< Already used size of prefetchable
   uint64_t  AlignNonPrefetch;      ///< Alignment bit map. For example, 0xFFFFF means 1MB alignment
   uint64_t  AlignPrefetch;         ///< Alignment bit. For example, 0xFFFFF means 1MB alignment
+  FABRIC_MMIO_POOL NonPciPool;     ///< Allocator of the non-discoverable device range
 } FABRIC_MMIO_REGION;
 
 /// MMIO Manager
@@ -130,4 +153,15 @@ SIL_STATUS FabricReserveMmio (
   FABRIC_MMIO_ATTRIBUTE *Attributes
   );
 
+SIL_STATUS FabricReleaseMmio (
+  uint64_t              BaseAddress,
+  uint64_t              Length
+  );
+
+SIL_STATUS FabricGetMmioPoolStats (
+  FABRIC_TARGET         Target,
+  uint8_t               MmioType,
+  FABRIC_MMIO_POOL_STATS *Stats
+  );
+
 #pragma pack (pop)
@@ -67,9 +67,31 @@ typedef SIL_STATUS (*FABRIC_RESERVE_MMIO) (
   FABRIC_MMIO_ATTRIBUTE *Attributes
   );
 
+/// Usage of the non-PCI MMIO pools of one root bridge
+typedef struct _FABRIC_MMIO_POOL_STATS {
+  uint64_t  TotalSize;            ///< Size managed by the pools
+  uint64_t  AllocatedSize;        ///< Size handed out, in power of two blocks
+  uint64_t  FreeSize;             ///< Size still free
+  uint64_t  LargestFreeBlock;     ///< Largest request that can still be served
+  uint32_t  FreeBlockCount;       ///< Number of free blocks
+  uint32_t  Fragmentation;        ///< Percent of the free size outside the largest free block
+} FABRIC_MMIO_POOL_STATS;
+
+typedef SIL_STATUS (*FABRIC_RELEASE_MMIO) (
+  uint64_t              BaseAddress,
+  uint64_t              Length
+  );
+
+typedef SIL_STATUS (*FABRIC_GET_MMIO_POOL_STATS) (
+  FABRIC_TARGET           Target,
+  uint8_t                 MmioType,
+  FABRIC_MMIO_POOL_STATS  *Stats
+  );
 
 // Resource Manager Ip2Ip API
 
 typedef struct {
-  FABRIC_RESERVE_MMIO   FabricReserveMmio;
+  FABRIC_RESERVE_MMIO         FabricReserveMmio;
+  FABRIC_RELEASE_MMIO         FabricReleaseMmio;        ///< Return a range from FabricReserveMmio
+  FABRIC_GET_MMIO_POOL_STATS  FabricGetMmioPoolStats;   ///< Non-PCI MMIO usage and fragmentation
 } RCMGR_IP2IP_API;
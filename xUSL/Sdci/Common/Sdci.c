@@ -8,6 +8,7 @@
 
 #include <string.h>
 #include <NBIO/NbioIp2Ip.h>
+#include <Mpio/MpioIp2Ip.h>
 #include <Sdci/SdciClass-api.h>
 #include "Sdci.h"
 #include "SdciCmn2Rev.h"
@@ -17,29 +18,26 @@
 #define SDCICLASS_INSTANCE    0
 
 /**--------------------------------------------------------------------
- * SdciConfig
- *
- * @brief Interface to configure SDCI on each PCIe controller
+ * SdciGetServices
  *
- * @details This function is called once for each socket
+ * @brief Locate the services used to configure SDCI
  *
- * @param[in]  GnbHandle  Pointer to the Silicon Descriptor for this node
+ * @param[out] SdciXferTable  SDCI Cmn2Rev transfer table
+ * @param[out] NbioIp2Ip      NBIO Ip2Ip API
+ * @param[out] MpioApi        MPIO Ip2Ip API
  *
- * @returns Nothing
- * @retval Nothing
+ * @retval true   SDCI is enabled and all services were found
+ * @retval false  SDCI is disabled or a service is missing
  */
 static
-void
-SdciConfig (
-  PCIe_PLATFORM_CONFIG  *Pcie
+bool
+SdciGetServices (
+  SDCI_COMMON_2_REV_XFER_BLOCK  **SdciXferTable,
+  NBIO_IP2IP_API                **NbioIp2Ip,
+  MPIO_IP2IP_API                **MpioApi
   )
 {
   SDCICLASS_INPUT_BLK           *SilData;
-  GNB_HANDLE                    *GnbHandle;
-  SDCI_COMMON_2_REV_XFER_BLOCK  *SdciXferTable;
-  NBIO_IP2IP_API                *NbioIp2Ip;
-
-  SDCI_TRACEPOINT (SIL_TRACE_ENTRY, "\n");
 
   /*
    * Get IP block data
@@ -51,37 +49,110 @@ SdciConfig (
   /*
    * Get SDCI Cmn2Rev transfer table
    */
-  if (SilGetCommon2RevXferTable (SilId_SdciClass, (void **)(&SdciXferTable)) != SilPass) {
-    return;
+  if (SilGetCommon2RevXferTable (SilId_SdciClass, (void **)SdciXferTable) != SilPass) {
+    return false;
   }
 
   /*
    * Enable SDCI feature if AmdFabricSdci is set to TRUE. Otherwise, just return.
    */
   if (SilData->AmdFabricSdci == false)
-    return;
+    return false;
 
-  if (SilGetIp2IpApi (SilId_NbioClass, (void **)(&NbioIp2Ip)) != SilPass) {
+  if (SilGetIp2IpApi (SilId_NbioClass, (void **)NbioIp2Ip) != SilPass) {
     SDCI_TRACEPOINT (SIL_TRACE_ERROR, " NBIO API is not found.\n");
-    return;
+    return false;
   }
 
-  GnbHandle = NbioIp2Ip->NbioGetHandle (Pcie);
-  SDCI_TRACEPOINT (SIL_TRACE_INFO, "Socket %d\n", GnbHandle->SocketId);
+  if (SilGetIp2IpApi (SilId_MpioClass, (void **)MpioApi) != SilPass) {
+    SDCI_TRACEPOINT (SIL_TRACE_ERROR, " MPIO API is not found.\n");
+    return false;
+  }
+
+  return true;
+}
+
+/**--------------------------------------------------------------------
+ * SdciConfigSocket
+ *
+ * @brief Interface to configure SDCI on each PCIe controller of a socket
+ *
+ * @details This function is called once for each socket, on the socket
+ *          primary core when xSIM can dispatch it there.
+ *
+ * @param[in]  Pcie    Pointer to the PCIe platform configuration
+ * @param[in]  Socket  Socket to configure
+ *
+ * @returns Nothing
+ * @retval Nothing
+ */
+static
+void
+SdciConfigSocket (
+  PCIe_PLATFORM_CONFIG  *Pcie,
+  uint32_t              Socket
+  )
+{
+  GNB_HANDLE                    *GnbHandle;
+  SDCI_COMMON_2_REV_XFER_BLOCK  *SdciXferTable;
+  NBIO_IP2IP_API                *NbioIp2Ip;
+  MPIO_IP2IP_API                *MpioApi;
+
+  SDCI_TRACEPOINT (SIL_TRACE_ENTRY, "Socket %d\n", Socket);
+
+  if (!SdciGetServices (&SdciXferTable, &NbioIp2Ip, &MpioApi)) {
+    return;
+  }
 
   /*
    * Enable TPH in PCIe root port
    */
+  GnbHandle = NbioIp2Ip->NbioGetHandle (Pcie);
   while (GnbHandle != NULL) {
-    NbioIp2Ip->PcieConfigRunProcForAllWrappersInNbio (
-                 DESCRIPTOR_ALL_WRAPPERS,
-                 SdciXferTable->CmdaConfigPcieRootPortWrapper,
-                 NULL,
-                 GnbHandle
-                 );
+    if (GnbHandle->SocketId == Socket) {
+      NbioIp2Ip->PcieConfigRunProcForAllWrappersInNbio (
+                   DESCRIPTOR_ALL_WRAPPERS,
+                   SdciXferTable->CmdaConfigPcieRootPortWrapper,
+                   NULL,
+                   GnbHandle
+                   );
+      MpioApi->MpioFlushPcieStraps (GnbHandle);
+    }
     GnbHandle = GnbGetNextHandle (GnbHandle);
   }
 
+  SDCI_TRACEPOINT (SIL_TRACE_EXIT, "\n");
+}
+
+/**--------------------------------------------------------------------
+ * SdciConfig
+ *
+ * @brief Interface to complete the SDCI configuration
+ *
+ * @details This function is called once, after SdciConfigSocket has run
+ *          for every socket.
+ *
+ * @param[in]  Pcie  Pointer to the PCIe platform configuration
+ *
+ * @returns Nothing
+ * @retval Nothing
+ */
+static
+void
+SdciConfig (
+  PCIe_PLATFORM_CONFIG  *Pcie
+  )
+{
+  SDCI_COMMON_2_REV_XFER_BLOCK  *SdciXferTable;
+  NBIO_IP2IP_API                *NbioIp2Ip;
+  MPIO_IP2IP_API                *MpioApi;
+
+  SDCI_TRACEPOINT (SIL_TRACE_ENTRY, "\n");
+
+  if (!SdciGetServices (&SdciXferTable, &NbioIp2Ip, &MpioApi)) {
+    return;
+  }
+
   /*
    * Initialize NBIF registers
    */
@@ -102,6 +173,40 @@ SdciConfig (
 
 }
 
+/**--------------------------------------------------------------------
+ * InitializeSdciSocketTp1
+ *
+ * @brief This function initializes the SDCI silicon block of one socket.
+ *
+ * @details  This is an IP private function, not visible to the Host.
+ *           xSIM calls it for every socket, before InitializeSdciTp1, through
+ *           the per-socket entry of the IP block list.
+ * @param[in] Socket  Socket to initialize
+ * @return SIL_STATUS
+ * @retval  SilPass - everything is OK
+ * @retval  SilNotFound - Something went wrong
+ */
+SIL_STATUS InitializeSdciSocketTp1 (uint32_t Socket)
+{
+  NORTH_BRIDGE_PCIE_SIB         *NbPcieData;
+
+  if (xUslFindStructure (SilId_SdciClass,  0) == NULL) {
+    // Could not find the IP input block
+    SDCI_TRACEPOINT (SIL_TRACE_INFO, "SDCI IP block not found \n");
+    return SilNotFound;
+  }
+
+  /*
+   * Get PCIe topology from platform Host Firmware
+   */
+  NbPcieData = (NORTH_BRIDGE_PCIE_SIB*)xUslFindStructure (SilId_NorthBridgePcie, 0);
+  assert (NbPcieData);
+
+  SdciConfigSocket (&NbPcieData->PciePlatformConfig, Socket);
+
+  return SilPass;
+}
+
 /**--------------------------------------------------------------------
  * InitializeSdciTp1
  *
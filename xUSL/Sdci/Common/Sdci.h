@@ -25,3 +25,6 @@ SdciClassSetInputBlock (void);
 
 SIL_STATUS
 InitializeSdciTp1 (void);
+
+SIL_STATUS
+InitializeSdciSocketTp1 (uint32_t Socket);
@@ -13,5 +13,7 @@ const SDCICLASS_INPUT_BLK SdciClassDflts = {
 	 * This is where you declare all input block vars/values you want to share with the Host.
      * This becomes part of the IP API for the Host.
 	 */
-    .AmdFabricSdci = CONFIG_SDCI_SMART_DATA_CACHE_INJECTION_ENABLE
+    .AmdFabricSdci = CONFIG_SDCI_SMART_DATA_CACHE_INJECTION_ENABLE,
+    .SdciDefaultTargetCcx = CONFIG_SDCI_DEFAULT_TARGET_CCX,
+    .SdciPortTargetCount = 0
 };
@@ -14,6 +14,7 @@
 
 // These are common functions for the IP entry point
 extern SIL_STATUS InitializeSdciTp1 (void);
+extern SIL_STATUS InitializeSdciSocketTp1 (uint32_t Socket);
 extern SIL_STATUS SdciClassSetInputBlock (void);
 
 SIL_STATUS
@@ -28,8 +28,20 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
+
+#define SDCI_PORT_TARGET_COUNT  16    ///< Root ports with a host selected target CCX
+
+/// Target CCX of the devices below one root port
+typedef struct {
+  uint32_t PortAddress;     ///< PCI address (PCI_ADDR.AddressValue) of the root port
+  uint8_t  TargetCcx;       ///< CCX index on the socket of the root port
+} SDCI_PORT_TARGET;
 
 ///  SDCI openSIL Input Block
 typedef struct {
   bool AmdFabricSdci; ///< User configurable
+  uint8_t SdciDefaultTargetCcx; ///< CCX index on its socket targeted by ports without an entry below
+  uint8_t SdciPortTargetCount;  ///< Valid entries in SdciPortTarget
+  SDCI_PORT_TARGET SdciPortTarget[SDCI_PORT_TARGET_COUNT];  ///< Per-port target CCX
 } SDCICLASS_INPUT_BLK;